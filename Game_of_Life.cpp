@@ -7,13 +7,27 @@
  * @date March, 2020
  */
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 // Uses cxxopts from https://github.com/jarro2783/cxxopts under the MIT license
 #include "cxxopts/cxxopts.hxx"
 
+#include "checkpoint.h"
 #include "grid.h"
+#include "hashlife.h"
+#include "renderer.h"
+#include "rule.h"
+#include "snapshot_writer.h"
+#include "unbounded_world.h"
 #include "world.h"
 #include "zoo.h"
 
@@ -24,11 +38,24 @@ int main(int argc, char *argv[]) {
 
     // Declare the valid command line arguments and their types and default values.
     options.add_options()
-            ("f,file", "Load an ascii file from the provided path.",  cxxopts::value<std::string>())
-            ("o,output", "Save an ascii file to the provided path.",  cxxopts::value<std::string>())
+            ("f,file", "Load a .gol, .bgol, .rle or .mc file from the provided path, or - to read ascii from standard input.",  cxxopts::value<std::string>())
+            ("o,output", "Save a .gol, .bgol, .rle or .mc file to the provided path.",  cxxopts::value<std::string>())
             ("s,steps","The number of steps to simulate the world.", cxxopts::value<int>()->default_value("10"))
             ("e,every","Print world to the console every N steps. 0 disables printing.", cxxopts::value<int>()->default_value("0"))
+            ("viewport", "Only print the window x,y,w,h of the world, e.g. 0,0,80,40.", cxxopts::value<std::string>())
+            ("scale", "Print each NxN block of cells as one character, darker the more of its cells are alive.", cxxopts::value<int>()->default_value("1"))
+            ("frames", "Save each printed state as a PBM image in the provided directory instead of printing it.", cxxopts::value<std::string>())
             ("t,toroidal", "Simulate the Game of Life on a torus.", cxxopts::value<bool>()->default_value("false"))
+            ("u,unbounded", "Simulate the Game of Life on an unbounded plane.", cxxopts::value<bool>()->default_value("false"))
+            ("rule", "The rule to simulate as a rulestring, e.g. B3/S23 or B36/S23. Defaults to the rule of an .rle file, or B3/S23.", cxxopts::value<std::string>())
+            ("engine", "The kernel used to step the world: stencil, simd, scalar, packed, sparse, tiled, gpu or hashlife.", cxxopts::value<std::string>()->default_value("stencil"))
+            ("j,threads", "The number of threads to split each step across.", cxxopts::value<int>()->default_value("1"))
+            ("temporal-depth", "Compute N generations per pass over the grid with the stencil and simd engines.", cxxopts::value<int>()->default_value("1"))
+            ("checkpoint-every", "Save a checkpoint every N steps. 0 disables checkpoints.", cxxopts::value<int>()->default_value("0"))
+            ("checkpoint-dir", "The directory to save checkpoints in and resume from.", cxxopts::value<std::string>()->default_value("checkpoints"))
+            ("resume", "Resume from the latest checkpoint, carrying on to the requested number of steps.", cxxopts::value<bool>()->default_value("false"))
+            ("stats", "Print a JSON line of step stats to standard error every N steps and at the end.", cxxopts::value<bool>()->default_value("false"))
+            ("cycles", "Skip ahead once the world repeats a state, reporting the period found.", cxxopts::value<bool>()->default_value("false"))
             ("h,help", "Print usage.");
 
     // Actually parse the command line arguments
@@ -44,14 +71,172 @@ int main(int argc, char *argv[]) {
     const int  steps    = result["steps"].as<int>();
     const int  every    = result["every"].as<int>();
     const bool toroidal = result["toroidal"].as<bool>();
+    const bool unbounded = result["unbounded"].as<bool>();
+    const int  threads  = result["threads"].as<int>();
+    const int  temporal_depth = result["temporal-depth"].as<int>();
+    const int  checkpoint_every = result["checkpoint-every"].as<int>();
+    const std::string checkpoint_dir = result["checkpoint-dir"].as<std::string>();
+    const bool resume = result["resume"].as<bool>();
+    const bool stats = result["stats"].as<bool>();
+    const bool cycles = result["cycles"].as<bool>();
+    const int  scale    = result["scale"].as<int>();
+
+    // The window of the world to print, the whole world unless a viewport is given
+    bool has_viewport = false;
+    int viewport_x = 0;
+    int viewport_y = 0;
+    int viewport_width = 0;
+    int viewport_height = 0;
+
+    if (result.count("viewport")) {
+        const std::string viewport = result["viewport"].as<std::string>();
+        char trailing;
+
+        if (std::sscanf(viewport.c_str(), "%d,%d,%d,%d%c", &viewport_x, &viewport_y, &viewport_width,
+                        &viewport_height, &trailing) != 4 || viewport_width < 0 || viewport_height < 0) {
+            std::cerr << "ERROR: The viewport '" << viewport << "' is not of the form x,y,w,h." << std::endl;
+            std::exit(-1);
+        }
+
+        has_viewport = true;
+    }
+
+    if (scale < 1) {
+        std::cerr << "ERROR: The scale must be at least 1." << std::endl;
+        std::exit(-1);
+    }
+
+    // Printed states are saved as numbered frames instead, so they sort into order for a video encoder
+    const bool frames = result.count("frames") > 0;
+    const std::string frames_dir = frames ? result["frames"].as<std::string>() : "";
+
+    if (frames) {
+        std::error_code error;
+        std::filesystem::create_directories(frames_dir, error);
+
+        if (error) {
+            std::cerr << "ERROR: Cannot create frame directory '" << frames_dir << "'." << std::endl;
+            std::exit(-1);
+        }
+    }
+
+    // Look up the requested step kernel, Hashlife replaces the World entirely
+    const std::string engine_name = result["engine"].as<std::string>();
+    const bool hashlife = engine_name == "hashlife";
+    Engine engine = Engine::STENCIL;
+
+    if (engine_name == "scalar") {
+        engine = Engine::SCALAR;
+    }
+    else if (engine_name == "packed") {
+        engine = Engine::PACKED;
+    }
+    else if (engine_name == "sparse") {
+        engine = Engine::SPARSE;
+    }
+    else if (engine_name == "simd") {
+        engine = Engine::SIMD;
+    }
+    else if (engine_name == "tiled") {
+        engine = Engine::TILED;
+    }
+    else if (engine_name == "gpu") {
+        engine = Engine::GPU;
+    }
+    else if (engine_name != "stencil" && !hashlife) {
+        std::cerr << "ERROR: Unknown engine '" << engine_name << "'." << std::endl;
+        std::exit(-1);
+    }
+
+    if (hashlife && toroidal) {
+        std::cerr << "ERROR: The hashlife engine simulates an unbounded plane and cannot be toroidal." << std::endl;
+        std::exit(-1);
+    }
+
+    if (unbounded && toroidal) {
+        std::cerr << "ERROR: An unbounded plane cannot also be toroidal." << std::endl;
+        std::exit(-1);
+    }
+
+    if ((checkpoint_every > 0 || resume) && (hashlife || unbounded)) {
+        std::cerr << "ERROR: Checkpoints can only be saved from a bounded world." << std::endl;
+        std::exit(-1);
+    }
+
+    if (stats && (hashlife || unbounded)) {
+        std::cerr << "ERROR: Stats can only be collected from a bounded world." << std::endl;
+        std::exit(-1);
+    }
+
+    if (cycles && (hashlife || unbounded)) {
+        std::cerr << "ERROR: Cycles can only be detected in a bounded world." << std::endl;
+        std::exit(-1);
+    }
+
+    // An explicit rule wins over the one named by an input file
+    Rule rule;
+
+    if (result.count("rule")) {
+        try {
+            rule = Rule::parse(result["rule"].as<std::string>());
+        }
+        catch (const std::exception &ex) {
+            std::cerr << ex.what() << std::endl;
+            std::exit(-1);
+        }
+    }
+
+    // Files are read and written in the format named by their extension, defaulting to ascii
+    auto has_extension = [](const std::string &path, const std::string &extension) {
+        return path.size() >= extension.size() &&
+               path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+    };
 
     // Start with an empty grid
     Grid grid;
+    HashlifeWorld macrocell;
+    bool is_macrocell = false;
+
+    uint64_t start_generation = 0;
 
-    // Attempt to read in and parse the input file as an ascii .gol file if a path was given
-    if (result.count("file")) {
+    // Restore the latest checkpoint in place of an input file if asked to
+    if (resume) {
+        if (!Checkpoint::load_latest(checkpoint_dir, grid, start_generation)) {
+            std::cerr << "ERROR: No checkpoint found in '" << checkpoint_dir << "'." << std::endl;
+            std::exit(-1);
+        }
+    }
+    // Attempt to read in and parse the input file if a path was given
+    else if (result.count("file")) {
         try {
-            grid = Zoo::load_ascii(result["file"].as<std::string>());
+            const std::string path = result["file"].as<std::string>();
+
+            if (path == "-") {
+                grid = Zoo::load_ascii(std::cin);
+            }
+            else if (has_extension(path, ".bgol")) {
+                grid = Zoo::load_binary(path);
+            }
+            else if (has_extension(path, ".rle")) {
+                Rule file_rule;
+                grid = Zoo::load_rle(path, file_rule);
+
+                if (!result.count("rule")) {
+                    rule = file_rule;
+                }
+            }
+            else if (has_extension(path, ".mc")) {
+                // Macrocells go straight into the quadtree, only becoming a grid if another engine needs one
+                macrocell = Zoo::load_macrocell(path);
+                is_macrocell = true;
+
+                if (!hashlife) {
+                    grid = macrocell.get_state();
+                }
+            }
+            else {
+                grid = Zoo::load_ascii(path);
+            }
         }
         catch (const std::exception &ex) {
             std::cerr << ex.what() << std::endl;
@@ -59,34 +244,210 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    // Construct a world from the parsed grid
-    World world(grid);
+    if ((hashlife || unbounded) && rule != Rule()) {
+        std::cerr << "ERROR: The hashlife engine and unbounded plane can only simulate B3/S23." << std::endl;
+        std::exit(-1);
+    }
 
-    // Print the initial state of the grid
-    std::cout << "Initial state..." << std::endl
-              << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl
-              << world.get_state() << std::endl;
+    // Saves a grid to the output path in the format named by its extension
+    auto save_grid = [&](const std::string &path, const Grid &state) {
+        if (has_extension(path, ".bgol")) {
+            Zoo::save_binary(path, state);
+        }
+        else if (has_extension(path, ".rle")) {
+            Zoo::save_rle(path, state, rule);
+        }
+        else if (has_extension(path, ".mc")) {
+            Zoo::save_macrocell(path, HashlifeWorld(state));
+        }
+        else {
+            Zoo::save_ascii(path, state);
+        }
+    };
 
-    // Perform the requested number of update steps
-    for (int step = 0; step < steps; step++) {
-        world.step(toroidal);
+    // Snapshots are printed and saved on a background thread, so the next step never waits on the console or disk
+    SnapshotWriter writer;
 
-        // Print the state of the grid every N steps
-        if ((every > 0) && (step % every == 0)) {
-            std::cout << "Step " << (step + 1) << " of " << steps << std::endl
-                      << world.get_state() << std::endl;
+    auto snapshot = [&](const Grid &state, SnapshotWriter::Job job) {
+        try {
+            writer.submit(state, std::move(job));
         }
-    }
+        catch (const std::exception &ex) {
+            std::cerr << ex.what() << std::endl;
+            std::exit(-1);
+        }
+    };
 
-    // Print the final state of the grid
-    std::cout << "Final state..." << std::endl
-              << "Alive " << world.get_alive_cells() << " | Dead " << world.get_dead_cells()  << std::endl
-              << world.get_state() << std::endl;
+    // Only used by jobs on the writer thread, which keeps its buffer between frames
+    Renderer renderer(scale);
+    int frame = 0;
+
+    // Only the viewport is copied and drawn, so printing part of a huge world costs only the part printed
+    auto print_snapshot = [&](const Grid &state, const std::string &title, bool show_counts) {
+        int x0 = 0;
+        int y0 = 0;
+        int x1 = state.get_width();
+        int y1 = state.get_height();
+
+        if (has_viewport) {
+            x0 = std::min(std::max(viewport_x, 0), x1);
+            y0 = std::min(std::max(viewport_y, 0), y1);
+            x1 = static_cast<int>(std::max<int64_t>(x0, std::min<int64_t>(static_cast<int64_t>(viewport_x) + viewport_width, x1)));
+            y1 = static_cast<int>(std::max<int64_t>(y0, std::min<int64_t>(static_cast<int64_t>(viewport_y) + viewport_height, y1)));
+        }
+
+        SnapshotWriter::Job job;
+
+        if (frames) {
+            const std::string number = std::to_string(frame++);
+            const std::string path = frames_dir + "/frame_" + std::string(6 - std::min<size_t>(6, number.size()), '0')
+                                     + number + ".pbm";
+
+            job = [&renderer, path](const Grid &window) {
+                std::ofstream file(path, std::ios::binary);
+
+                if (!file) {
+                    throw std::runtime_error("ERROR: Cannot open frame file '" + path + "'.");
+                }
+
+                renderer.write_pbm(file, window);
+            };
+        }
+        else {
+            // Counted over the whole world, not just the viewport
+            const int alive = show_counts ? state.get_alive_cells() : 0;
+            const int dead = show_counts ? state.get_dead_cells() : 0;
+
+            job = [&renderer, title, show_counts, alive, dead](const Grid &window) {
+                std::cout << title << "\n";
+
+                if (show_counts) {
+                    std::cout << "Alive " << alive << " | Dead " << dead << "\n";
+                }
+
+                renderer.write_ascii(std::cout, window);
+                std::cout << std::endl;
+            };
+        }
+
+        try {
+            writer.submit(state, x0, y0, x1, y1, std::move(job));
+        }
+        catch (const std::exception &ex) {
+            std::cerr << ex.what() << std::endl;
+            std::exit(-1);
+        }
+    };
 
     // Attempt to save to the output directory if a path was given
-    if (result.count("output")) {
+    auto save_output = [&](const Grid &state) {
+        if (result.count("output")) {
+            const std::string path = result["output"].as<std::string>();
+            snapshot(state, [&save_grid, path](const Grid &state) { save_grid(path, state); });
+        }
+    };
+
+    // Wait for every snapshot to be written before exiting
+    auto flush_snapshots = [&]() {
+        try {
+            writer.flush();
+        }
+        catch (const std::exception &ex) {
+            std::cerr << ex.what() << std::endl;
+            std::exit(-1);
+        }
+    };
+
+    // Worlds on an unbounded plane are printed through a viewport the size of the parsed grid
+    auto simulate_plane = [&](auto &world) {
+        print_snapshot(world.get_state(), "Initial state...", true);
+
+        // Print after the same steps as the World loop, jumping straight between them
+        if (every > 0) {
+            for (int step = 0; step < steps; step += every) {
+                world.advance((step == 0) ? 1 : every);
+
+                print_snapshot(world.get_state(),
+                               "Step " + std::to_string(world.get_generation()) + " of " + std::to_string(steps), false);
+            }
+        }
+
+        world.advance(static_cast<uint64_t>(std::max(steps, 0)) - world.get_generation());
+
+        print_snapshot(world.get_state(), "Final state...", true);
+    };
+
+    // Hashlife always simulates an unbounded plane
+    if (hashlife) {
+        HashlifeWorld world = is_macrocell ? macrocell : HashlifeWorld(grid);
+        simulate_plane(world);
+
+        // Saving the quadtree keeps the cells outside the viewport too
+        if (result.count("output") && has_extension(result["output"].as<std::string>(), ".mc")) {
+            flush_snapshots();
+
+            try {
+                Zoo::save_macrocell(result["output"].as<std::string>(), world);
+            }
+            catch (const std::exception &ex) {
+                std::cerr << ex.what() << std::endl;
+                std::exit(-1);
+            }
+        }
+        else {
+            save_output(world.get_state());
+            flush_snapshots();
+        }
+
+        return 0;
+    }
+
+    if (unbounded) {
+        UnboundedWorld world(grid);
+        simulate_plane(world);
+        save_output(world.get_state());
+        flush_snapshots();
+        return 0;
+    }
+
+    // Construct a world from the parsed grid, handing it over since it is not needed again
+    World world(std::move(grid));
+    world.set_engine(engine);
+    world.set_rule(rule);
+    world.set_threads(threads);
+    world.set_temporal_depth(temporal_depth);
+    world.set_generation(start_generation);
+    world.set_stats_enabled(stats);
+    world.set_cycle_detection(cycles);
+
+    // Stats go to standard error as one JSON object per line, leaving the printed grids on standard output
+    auto print_stats = [&]() {
+        const WorldStats &counters = world.get_stats();
+
+        std::cerr << "{\"generation\": " << world.get_generation()
+                  << ", \"steps\": " << counters.steps
+                  << ", \"total_seconds\": " << counters.total_seconds
+                  << ", \"last_seconds\": " << counters.last_seconds
+                  << ", \"cells_evaluated\": " << counters.cells_evaluated
+                  << ", \"cells_skipped\": " << counters.cells_skipped
+                  << ", \"total_cells_evaluated\": " << counters.total_cells_evaluated
+                  << ", \"total_cells_skipped\": " << counters.total_cells_skipped
+                  << ", \"births\": " << counters.births
+                  << ", \"deaths\": " << counters.deaths
+                  << ", \"total_births\": " << counters.total_births
+                  << ", \"total_deaths\": " << counters.total_deaths
+                  << ", \"tiles_active\": " << counters.tiles_active
+                  << ", \"tiles_total\": " << counters.tiles_total
+                  << ", \"bytes_allocated\": " << counters.bytes_allocated
+                  << ", \"alive\": " << world.get_alive_cells() << "}" << std::endl;
+    };
+
+    // Only the tiles which changed since the last checkpoint are saved, so checkpointing often stays cheap
+    std::unique_ptr<Checkpoint> checkpoint;
+
+    if (checkpoint_every > 0) {
         try {
-            Zoo::save_ascii(result["output"].as<std::string>(), world.get_state());
+            checkpoint.reset(new Checkpoint(checkpoint_dir));
         }
         catch (const std::exception &ex) {
             std::cerr << ex.what() << std::endl;
@@ -94,6 +455,64 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    // Print the initial state of the grid
+    print_snapshot(world.get_state(), "Initial state...", true);
+
+    // Perform the requested number of update steps, running every step between two snapshots in one go
+    int generation = static_cast<int>(std::min<uint64_t>(start_generation, std::max(steps, 0)));
+
+    while (generation < steps) {
+        int next = steps;
+
+        if (every > 0) {
+            next = std::min(next, ((generation + every - 1) / every) * every + 1);
+        }
+
+        if (checkpoint_every > 0) {
+            next = std::min(next, (generation / checkpoint_every + 1) * checkpoint_every);
+        }
+
+        world.advance(next - generation, toroidal);
+        generation = next;
+
+        // Print the state of the grid every N steps
+        if (every > 0 && (generation - 1) % every == 0) {
+            print_snapshot(world.get_state(), "Step " + std::to_string(generation) + " of " + std::to_string(steps), false);
+
+            if (stats) {
+                print_stats();
+            }
+        }
+
+        // Save a checkpoint every N steps
+        if (checkpoint && generation % checkpoint_every == 0) {
+            try {
+                checkpoint->save(world);
+            }
+            catch (const std::exception &ex) {
+                std::cerr << ex.what() << std::endl;
+                std::exit(-1);
+            }
+        }
+    }
+
+    // Print the final state of the grid
+    print_snapshot(world.get_state(), "Final state...", true);
+
+    if (stats) {
+        print_stats();
+    }
+
+    save_output(world.get_state());
+    flush_snapshots();
+
+    // Printed once the writer is done with std::cout, so it follows the final state
+    if (cycles && world.get_cycle().period > 0) {
+        const WorldCycle &cycle = world.get_cycle();
+        std::cout << "Cycle of period " << cycle.period << " from generation " << cycle.generation
+                  << ", found at generation " << cycle.detected << std::endl;
+    }
+
     // Destructors handle all the memory deallocation
     return 0;
 }
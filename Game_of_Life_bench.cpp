@@ -0,0 +1,550 @@
+/**
+ * Benchmarks the step engines, grid operations and file formats, printing one machine-readable record per run.
+ * Run with -h or --help to print the usage message.
+ * i.e.
+ * ./Game_of_Life_bench --help
+ *
+ * Every record holds the time taken in cells per second and nanoseconds per cell, along with the bytes and
+ * number of allocations made per iteration, so runs can be compared across engines and commits.
+ *      - step and advance time World::step and World::advance over random soups and the Zoo patterns, for
+ *        each engine and thread count, in both toroidal modes. Engine::SCALAR calls World::count_neighbours
+ *        for every cell, so its results are the cost of count_neighbours. The engines simulate the --rule, and
+ *        advance computes --temporal-depth generations per pass with the stencil and simd engines.
+ *        The gpu engine is only run when asked for, since without an offload device it falls back to the host.
+ *      - hashlife times HashlifeWorld::step over the same boards, which are never toroidal.
+ *      - batch times WorldBatch::step over --batch-count random soups of edge --batch-size, reloading the soups
+ *        whenever they have all finished. Its height is that of all the soups stacked, so its cells per second
+ *        compare directly with the World engines.
+ *      - grid times Grid::rotate, Grid::crop and Grid::merge, and TiledGrid::crop and TiledGrid::merge under the
+ *        tiled engine name, and zoo the Zoo load and save functions.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Uses cxxopts from https://github.com/jarro2783/cxxopts under the MIT license
+#include "cxxopts/cxxopts.hxx"
+
+#include "grid.h"
+#include "hashlife.h"
+#include "rule.h"
+#include "tiled_grid.h"
+#include "world.h"
+#include "world_batch.h"
+#include "zoo.h"
+
+// Every allocation made by the program is counted, so each record can report the memory its run allocated.
+// The replacements are kept out of line, since GCC otherwise warns about inlined calls to free on memory from new.
+static std::atomic<uint64_t> allocated_bytes(0);
+static std::atomic<uint64_t> allocation_count(0);
+
+__attribute__((noinline)) void *operator new(size_t size) {
+    allocated_bytes += size;
+    allocation_count++;
+
+    if (void *memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, size_t) noexcept {
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete[](void *memory, size_t) noexcept {
+    std::free(memory);
+}
+
+// Grid cells come from Memory::get_aligned_resource(), which allocates with aligned new
+__attribute__((noinline)) void *operator new(size_t size, std::align_val_t alignment) {
+    allocated_bytes += size;
+    allocation_count++;
+
+    // aligned_alloc needs the size to be a multiple of the alignment
+    const size_t align = static_cast<size_t>(alignment);
+
+    if (void *memory = std::aligned_alloc(align, ((size ? size : 1) + align - 1) / align * align)) {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void *memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+/**
+ * The result of timing one benchmark, along with the settings it was run with.
+ */
+struct Record {
+    std::string suite;
+    std::string name;
+    std::string engine;
+    int threads;
+    int width;
+    int height;
+    double density;
+    bool toroidal;
+    uint64_t iterations;
+    double seconds;
+    uint64_t bytes;
+    uint64_t allocations;
+};
+
+/**
+ * measure(record, min_seconds, work)
+ *
+ * Time a piece of work, doubling the number of iterations until a run lasts at least min_seconds,
+ * and fill in the iterations, time and allocations of the final run.
+ *
+ * @param work
+ *      Called with the number of iterations to run.
+ */
+template <typename Work>
+static void measure(Record &record, double min_seconds, Work work) {
+    for (uint64_t iterations = 1;; iterations *= 2) {
+        const uint64_t bytes_before = allocated_bytes;
+        const uint64_t allocations_before = allocation_count;
+        const auto start = std::chrono::steady_clock::now();
+
+        work(iterations);
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (elapsed.count() >= min_seconds || iterations >= (1ULL << 40)) {
+            record.iterations = iterations;
+            record.seconds = elapsed.count();
+            record.bytes = allocated_bytes - bytes_before;
+            record.allocations = allocation_count - allocations_before;
+            return;
+        }
+    }
+}
+
+/**
+ * print_record(record, format)
+ *
+ * Print a record as a line of JSON, or as a row of CSV after the header printed by print_header.
+ */
+static void print_record(const Record &record, const std::string &format) {
+    const double cells = static_cast<double>(record.width) * record.height * record.iterations;
+    const double cells_per_second = record.seconds > 0 ? cells / record.seconds : 0;
+    const double ns_per_cell = cells > 0 ? record.seconds * 1e9 / cells : 0;
+    const uint64_t bytes = record.bytes / record.iterations;
+    const uint64_t allocations = record.allocations / record.iterations;
+
+    std::ostringstream line;
+
+    if (format == "csv") {
+        line << record.suite << ',' << record.name << ',' << record.engine << ',' << record.threads << ','
+             << record.width << ',' << record.height << ',' << record.density << ',' << record.toroidal << ','
+             << record.iterations << ',' << record.seconds << ',' << cells_per_second << ',' << ns_per_cell << ','
+             << bytes << ',' << allocations;
+    }
+    else {
+        line << "{\"suite\": \"" << record.suite << "\", \"name\": \"" << record.name
+             << "\", \"engine\": \"" << record.engine << "\", \"threads\": " << record.threads
+             << ", \"width\": " << record.width << ", \"height\": " << record.height
+             << ", \"density\": " << record.density << ", \"toroidal\": " << (record.toroidal ? "true" : "false")
+             << ", \"iterations\": " << record.iterations << ", \"seconds\": " << record.seconds
+             << ", \"cells_per_second\": " << cells_per_second << ", \"ns_per_cell\": " << ns_per_cell
+             << ", \"bytes_allocated\": " << bytes << ", \"allocations\": " << allocations << "}";
+    }
+
+    std::cout << line.str() << std::endl;
+}
+
+static void print_header(const std::string &format) {
+    if (format == "csv") {
+        std::cout << "suite,name,engine,threads,width,height,density,toroidal,iterations,seconds,"
+                  << "cells_per_second,ns_per_cell,bytes_allocated,allocations" << std::endl;
+    }
+}
+
+/**
+ * split(list)
+ *
+ * Split a comma separated list into its items.
+ */
+static std::vector<std::string> split(const std::string &list) {
+    std::vector<std::string> items;
+    std::istringstream in(list);
+    std::string item;
+
+    while (std::getline(in, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+
+    return items;
+}
+
+/**
+ * make_board(name, size, density, rng)
+ *
+ * Make a square board holding a random soup of the given density, or a single Zoo pattern in its centre.
+ */
+static Grid make_board(const std::string &name, int size, double density, std::mt19937 &rng) {
+    Grid board(size);
+
+    if (name == "random") {
+        std::bernoulli_distribution alive(density);
+
+        for (int y = 0; y < size; y++) {
+            Cell *cells = board.row(y);
+
+            for (int x = 0; x < size; x++) {
+                cells[x] = alive(rng) ? Cell::ALIVE : Cell::DEAD;
+            }
+        }
+    }
+    else {
+        const Grid pattern = (name == "glider") ? Zoo::glider()
+                           : (name == "r_pentomino") ? Zoo::r_pentomino()
+                           : Zoo::light_weight_spaceship();
+
+        if (size >= pattern.get_width() && size >= pattern.get_height()) {
+            board.merge(pattern, (size - pattern.get_width()) / 2, (size - pattern.get_height()) / 2);
+        }
+    }
+
+    return board;
+}
+
+int main(int argc, char *argv[]) {
+
+    cxxopts::Options options("Game_of_Life_bench",
+            "Benchmarks the Game of Life engines, grid operations and file formats.");
+
+    options.add_options()
+            ("suites", "The benchmarks to run: step, advance, hashlife, batch, grid and zoo.", cxxopts::value<std::string>()->default_value("step,advance,hashlife,batch,grid,zoo"))
+            ("engines", "The World engines to compare: stencil, simd, scalar, packed, sparse, tiled and gpu.", cxxopts::value<std::string>()->default_value("stencil,simd,scalar,packed,sparse,tiled"))
+            ("sizes", "The edge lengths of the square boards, from 64 up to 32768.", cxxopts::value<std::string>()->default_value("64,256,1024,4096"))
+            ("densities", "The densities of the random soups.", cxxopts::value<std::string>()->default_value("0.05,0.35"))
+            ("patterns", "The boards to run: random and Zoo patterns glider, r_pentomino and light_weight_spaceship.", cxxopts::value<std::string>()->default_value("random,glider,r_pentomino"))
+            ("rule", "The rule the World engines simulate, as a rulestring. Hashlife always simulates B3/S23.", cxxopts::value<std::string>()->default_value("B3/S23"))
+            ("batch-size", "The edge length of the soups of the batch suite.", cxxopts::value<int>()->default_value("16"))
+            ("batch-count", "The number of soups in the batch suite.", cxxopts::value<int>()->default_value("4096"))
+            ("threads", "The thread counts to run the engines with.", cxxopts::value<std::string>()->default_value("1"))
+            ("temporal-depth", "The generations World::advance computes per pass with the stencil and simd engines.", cxxopts::value<int>()->default_value("1"))
+            ("min-time", "The least time in seconds each benchmark is run for.", cxxopts::value<double>()->default_value("0.2"))
+            ("format", "The output format: json or csv.", cxxopts::value<std::string>()->default_value("json"))
+            ("scratch", "The directory the zoo benchmarks write their files in.", cxxopts::value<std::string>()->default_value("/tmp"))
+            ("seed", "The seed of the random soups.", cxxopts::value<int>()->default_value("371"))
+            ("h,help", "Print usage.");
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+        std::cout << options.help() << std::endl;
+        std::exit(0);
+    }
+
+    const std::vector<std::string> suites = split(result["suites"].as<std::string>());
+    const std::vector<std::string> engine_names = split(result["engines"].as<std::string>());
+    const std::vector<std::string> sizes = split(result["sizes"].as<std::string>());
+    const std::vector<std::string> densities = split(result["densities"].as<std::string>());
+    const std::vector<std::string> patterns = split(result["patterns"].as<std::string>());
+    const std::vector<std::string> thread_counts = split(result["threads"].as<std::string>());
+    const int temporal_depth = result["temporal-depth"].as<int>();
+    const int batch_size = result["batch-size"].as<int>();
+    const int batch_count = result["batch-count"].as<int>();
+    const double min_seconds = result["min-time"].as<double>();
+    const std::string format = result["format"].as<std::string>();
+    const std::string scratch = result["scratch"].as<std::string>();
+
+    Rule rule;
+
+    try {
+        rule = Rule::parse(result["rule"].as<std::string>());
+    }
+    catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        std::exit(-1);
+    }
+
+    std::mt19937 rng(result["seed"].as<int>());
+
+    auto has_suite = [&](const std::string &suite) {
+        return std::find(suites.begin(), suites.end(), suite) != suites.end();
+    };
+
+    auto to_engine = [](const std::string &name) {
+        if (name == "scalar") {
+            return Engine::SCALAR;
+        }
+        else if (name == "packed") {
+            return Engine::PACKED;
+        }
+        else if (name == "sparse") {
+            return Engine::SPARSE;
+        }
+        else if (name == "simd") {
+            return Engine::SIMD;
+        }
+        else if (name == "tiled") {
+            return Engine::TILED;
+        }
+        else if (name == "gpu") {
+            return Engine::GPU;
+        }
+        else if (name != "stencil") {
+            std::cerr << "ERROR: Unknown engine '" << name << "'." << std::endl;
+            std::exit(-1);
+        }
+
+        return Engine::STENCIL;
+    };
+
+    print_header(format);
+
+    for (const std::string &size_name : sizes) {
+        const int size = std::stoi(size_name);
+
+        for (const std::string &pattern : patterns) {
+            // Patterns are the same at every density, so only run them once
+            const std::vector<std::string> pattern_densities =
+                    (pattern == "random") ? densities : std::vector<std::string>(1, "0");
+
+            for (const std::string &density_name : pattern_densities) {
+                const double density = std::stod(density_name);
+                Grid board = make_board(pattern, size, density, rng);
+
+                Record base = {"", pattern, "-", 1, size, size, density, false, 0, 0, 0, 0};
+
+                for (const std::string &engine_name : engine_names) {
+                    for (const std::string &thread_name : thread_counts) {
+                        for (const bool toroidal : {false, true}) {
+                            Record record = base;
+                            record.engine = engine_name;
+                            record.threads = std::stoi(thread_name);
+                            record.toroidal = toroidal;
+
+                            World world(board);
+                            world.set_engine(to_engine(engine_name));
+                            world.set_rule(rule);
+                            world.set_threads(record.threads);
+                            world.set_temporal_depth(temporal_depth);
+
+                            if (has_suite("step")) {
+                                record.suite = "step";
+                                measure(record, min_seconds, [&](uint64_t iterations) {
+                                    for (uint64_t i = 0; i < iterations; i++) {
+                                        world.step(toroidal);
+                                    }
+                                });
+                                print_record(record, format);
+                            }
+
+                            if (has_suite("advance")) {
+                                record.suite = "advance";
+                                measure(record, min_seconds, [&](uint64_t iterations) {
+                                    world.advance(static_cast<int>(iterations), toroidal);
+                                });
+                                print_record(record, format);
+                            }
+                        }
+                    }
+                }
+
+                // Hashlife only simulates an unbounded plane
+                if (has_suite("hashlife")) {
+                    Record record = base;
+                    record.suite = "hashlife";
+                    record.engine = "hashlife";
+
+                    HashlifeWorld world(board);
+
+                    measure(record, min_seconds, [&](uint64_t iterations) {
+                        for (uint64_t i = 0; i < iterations; i++) {
+                            world.step();
+                        }
+                    });
+                    print_record(record, format);
+                }
+
+                if (has_suite("grid")) {
+                    Record record = base;
+                    record.suite = "grid";
+
+                    const int quarter = size / 4;
+                    const Grid piece = board.crop(0, 0, quarter, quarter);
+
+                    record.name = pattern + "/rotate";
+                    measure(record, min_seconds, [&](uint64_t iterations) {
+                        for (uint64_t i = 0; i < iterations; i++) {
+                            board = board.rotate(1);
+                        }
+                    });
+                    print_record(record, format);
+
+                    record.name = pattern + "/crop";
+                    measure(record, min_seconds, [&](uint64_t iterations) {
+                        for (uint64_t i = 0; i < iterations; i++) {
+                            Grid cropped = board.crop(quarter, quarter, size - quarter, size - quarter);
+                        }
+                    });
+                    print_record(record, format);
+
+                    record.name = pattern + "/merge";
+                    measure(record, min_seconds, [&](uint64_t iterations) {
+                        for (uint64_t i = 0; i < iterations; i++) {
+                            board.merge(piece, quarter, quarter, true);
+                        }
+                    });
+                    print_record(record, format);
+
+                    // The same crop and merge of the board split into tiles
+                    TiledGrid tiled_board(board, TileOrder::MORTON);
+                    const TiledGrid tiled_piece(piece, TileOrder::MORTON);
+                    record.engine = "tiled";
+
+                    record.name = pattern + "/crop";
+                    measure(record, min_seconds, [&](uint64_t iterations) {
+                        for (uint64_t i = 0; i < iterations; i++) {
+                            TiledGrid cropped = tiled_board.crop(quarter, quarter, size - quarter, size - quarter);
+                        }
+                    });
+                    print_record(record, format);
+
+                    record.name = pattern + "/merge";
+                    measure(record, min_seconds, [&](uint64_t iterations) {
+                        for (uint64_t i = 0; i < iterations; i++) {
+                            tiled_board.merge(tiled_piece, quarter, quarter, true);
+                        }
+                    });
+                    print_record(record, format);
+                }
+
+                if (has_suite("zoo")) {
+                    Record record = base;
+                    record.suite = "zoo";
+
+                    const std::string path = scratch + "/Game_of_Life_bench";
+
+                    // Each format is timed saving then loading the same file
+                    const std::vector<std::pair<std::string, std::string>> formats = {
+                            {"ascii", ".gol"}, {"binary_v1", ".bgol"}, {"binary_v2", ".bgol"}, {"rle", ".rle"}};
+
+                    try {
+                        for (const auto &file_format : formats) {
+                            const std::string file = path + file_format.second;
+
+                            record.name = pattern + "/save_" + file_format.first;
+                            measure(record, min_seconds, [&](uint64_t iterations) {
+                                for (uint64_t i = 0; i < iterations; i++) {
+                                    if (file_format.first == "ascii") {
+                                        Zoo::save_ascii(file, board);
+                                    }
+                                    else if (file_format.first == "rle") {
+                                        Zoo::save_rle(file, board);
+                                    }
+                                    else {
+                                        Zoo::save_binary(file, board, (file_format.first == "binary_v2")
+                                                                      ? Zoo::BinaryFormat::V2 : Zoo::BinaryFormat::V1);
+                                    }
+                                }
+                            });
+                            print_record(record, format);
+
+                            record.name = pattern + "/load_" + file_format.first;
+                            measure(record, min_seconds, [&](uint64_t iterations) {
+                                for (uint64_t i = 0; i < iterations; i++) {
+                                    const Grid loaded = (file_format.first == "ascii") ? Zoo::load_ascii(file)
+                                                      : (file_format.first == "rle") ? Zoo::load_rle(file)
+                                                      : Zoo::load_binary(file);
+                                }
+                            });
+                            print_record(record, format);
+
+                            std::remove(file.c_str());
+                        }
+                    }
+                    catch (const std::exception &ex) {
+                        std::cerr << ex.what() << std::endl;
+                        std::exit(-1);
+                    }
+                }
+            }
+        }
+    }
+
+    if (has_suite("batch")) {
+        for (const std::string &density_name : densities) {
+            const double density = std::stod(density_name);
+
+            std::vector<Grid> soups;
+
+            for (int i = 0; i < batch_count; i++) {
+                soups.push_back(make_board("random", batch_size, density, rng));
+            }
+
+            for (const std::string &thread_name : thread_counts) {
+                for (const bool toroidal : {false, true}) {
+                    Record record = {"batch", "random", "batch", std::stoi(thread_name), batch_size,
+                                     batch_size * batch_count, density, toroidal, 0, 0, 0, 0};
+
+                    WorldBatch batch(batch_size, batch_size, batch_count);
+                    batch.set_rule(rule);
+                    batch.set_threads(record.threads);
+
+                    // Finished soups are skipped, so once they all finish they are loaded again
+                    auto reload = [&]() {
+                        for (int i = 0; i < batch_count; i++) {
+                            batch.set_state(i, soups[i]);
+                        }
+                    };
+
+                    reload();
+
+                    measure(record, min_seconds, [&](uint64_t iterations) {
+                        for (uint64_t i = 0; i < iterations; i++) {
+                            if (batch.get_running() == 0) {
+                                reload();
+                            }
+
+                            batch.step(toroidal);
+                        }
+                    });
+                    print_record(record, format);
+                }
+            }
+        }
+    }
+
+    return 0;
+}
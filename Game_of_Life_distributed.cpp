@@ -0,0 +1,184 @@
+/**
+ * Runs the Game of Life on a world split between the processes of an MPI job, for boards too big for one machine.
+ * Run with -h or --help to print the usage message.
+ * i.e.
+ * mpirun -np 16 ./Game_of_Life_distributed --size 100000 --steps 100 --output final.bgol
+ *
+ * Boards are loaded from and saved to .bgol files in parallel, each process only reading and writing its own block.
+ * Smaller .gol and .rle patterns are loaded whole by every process, which then keeps only its own block.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include <mpi.h>
+
+// Uses cxxopts from https://github.com/jarro2783/cxxopts under the MIT license
+#include "cxxopts/cxxopts.hxx"
+
+#include "distributed_world.h"
+#include "grid.h"
+#include "rule.h"
+#include "zoo.h"
+
+/**
+ * soup_cell(seed, x, y, density)
+ *
+ * Decide whether a cell of a random soup is alive by hashing its coordinates, so the soup is the same however the
+ * board is split between processes.
+ *
+ * @return
+ *      Cell::ALIVE with a chance of density, otherwise Cell::DEAD.
+ */
+static Cell soup_cell(uint64_t seed, int x, int y, double density) {
+    // The SplitMix64 finaliser
+    uint64_t hash = seed + (static_cast<uint64_t>(y) << 32 | static_cast<uint32_t>(x)) * 0x9E3779B97F4A7C15ull;
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+    hash ^= hash >> 31;
+
+    return (hash >> 11) * 0x1.0p-53 < density ? Cell::ALIVE : Cell::DEAD;
+}
+
+int main(int argc, char *argv[]) {
+
+    MPI_Init(&argc, &argv);
+
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    // Every process meets the same errors, so only the first reports them before the job is taken down
+    auto fail = [rank](const std::string &message) {
+        if (rank == 0) {
+            std::cerr << message << std::endl;
+        }
+
+        MPI_Abort(MPI_COMM_WORLD, -1);
+    };
+
+    cxxopts::Options options("Game_of_Life_distributed",
+            "Runs the Game of Life on a world split between the processes of an MPI job.");
+
+    options.add_options()
+            ("f,file", "Load a .bgol file in parallel, or a .gol or .rle pattern on every process, from the provided path.", cxxopts::value<std::string>())
+            ("o,output", "Save a .bgol file in parallel to the provided path.", cxxopts::value<std::string>())
+            ("size", "The edge length of a random soup to start from when no file is given.", cxxopts::value<int>()->default_value("4096"))
+            ("density", "The density of the random soup.", cxxopts::value<double>()->default_value("0.35"))
+            ("seed", "The seed of the random soup.", cxxopts::value<int>()->default_value("371"))
+            ("s,steps", "The number of steps to simulate the world.", cxxopts::value<int>()->default_value("10"))
+            ("t,toroidal", "Simulate the Game of Life on a torus.", cxxopts::value<bool>()->default_value("false"))
+            ("rule", "The rule to simulate as a rulestring. Defaults to the rule of an .rle file, or B3/S23.", cxxopts::value<std::string>())
+            ("h,help", "Print usage.");
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+        if (rank == 0) {
+            std::cout << options.help() << std::endl;
+        }
+
+        MPI_Finalize();
+        return 0;
+    }
+
+    const int steps = result["steps"].as<int>();
+    const bool toroidal = result["toroidal"].as<bool>();
+
+    // Files are read and written in the format named by their extension, defaulting to ascii
+    auto has_extension = [](const std::string &path, const std::string &extension) {
+        return path.size() >= extension.size() &&
+               path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+    };
+
+    if (result.count("output") && !has_extension(result["output"].as<std::string>(), ".bgol")) {
+        fail("ERROR: A distributed world can only be saved to a .bgol file.");
+    }
+
+    Rule rule;
+
+    // Build the world, handing it out of the lambda as a world cannot be reassigned
+    DistributedWorld world = [&]() {
+        try {
+            if (!result.count("file")) {
+                const int size = result["size"].as<int>();
+                const double density = result["density"].as<double>();
+                const uint64_t seed = result["seed"].as<int>();
+
+                DistributedWorld soup(MPI_COMM_WORLD, size, size);
+                const Grid &block = soup.get_local_state();
+
+                for (int y = soup.get_local_y(); y < soup.get_local_y() + block.get_height(); y++) {
+                    for (int x = soup.get_local_x(); x < soup.get_local_x() + block.get_width(); x++) {
+                        soup.set(x, y, soup_cell(seed, x, y, density));
+                    }
+                }
+
+                return soup;
+            }
+
+            const std::string path = result["file"].as<std::string>();
+
+            if (has_extension(path, ".bgol")) {
+                return DistributedWorld::load_binary(MPI_COMM_WORLD, path);
+            }
+            else if (has_extension(path, ".rle")) {
+                return DistributedWorld(MPI_COMM_WORLD, Zoo::load_rle(path, rule));
+            }
+            else {
+                return DistributedWorld(MPI_COMM_WORLD, Zoo::load_ascii(path));
+            }
+        }
+        catch (const std::exception &ex) {
+            fail(ex.what());
+            throw;
+        }
+    }();
+
+    // An explicit rule wins over the one named by an input file
+    if (result.count("rule")) {
+        try {
+            rule = Rule::parse(result["rule"].as<std::string>());
+        }
+        catch (const std::exception &ex) {
+            fail(ex.what());
+        }
+    }
+
+    world.set_rule(rule);
+
+    // Time the steps alone, from when every process is ready to when the last has finished
+    MPI_Barrier(MPI_COMM_WORLD);
+    const auto start = std::chrono::steady_clock::now();
+
+    world.advance(steps, toroidal);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const uint64_t alive_cells = world.get_alive_cells();
+
+    if (rank == 0) {
+        std::cout << "Stepped a " << world.get_width() << "x" << world.get_height() << " world " << steps
+                  << " times on " << world.get_ranks() << " processes in " << seconds << " seconds ("
+                  << (seconds > 0 ? world.get_total_cells() * steps / seconds : 0) << " cells per second)."
+                  << std::endl;
+        std::cout << "Alive cells: " << alive_cells << std::endl;
+    }
+
+    if (result.count("output")) {
+        try {
+            world.save_binary(result["output"].as<std::string>());
+        }
+        catch (const std::exception &ex) {
+            fail(ex.what());
+        }
+    }
+
+    MPI_Finalize();
+    return 0;
+}
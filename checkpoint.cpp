@@ -0,0 +1,657 @@
+/**
+ * Implements a class for saving a running world as a base snapshot followed by a journal of small deltas.
+ *      - A checkpoint directory holds a base grid, saved as base_<generation>.bgol in the v2 binary format,
+ *        and a journal of the generations after it, saved as journal_<generation>.gdl.
+ *          - Bases are written to a temporary file and renamed into place, and older bases and journals are
+ *            only removed once the new journal exists, so a crash never leaves no usable checkpoint behind.
+ *
+ *      - Journals are composed of little endian unsigned integers:
+ *          - a header of the 4 byte magic number 'GDLT', followed by 4 byte ints for the version (1), width,
+ *            height, and tile size, and an 8 byte int for the generation of the base.
+ *          - followed by records, each a 4 byte size, then a body of an 8 byte generation, a 4 byte count of
+ *            tiles and the tiles themselves, then a 4 byte FNV-1a checksum of the body.
+ *          - each tile is a 4 byte tile number and a 1 byte encoding, followed by either:
+ *              - encoding 0, a 2 byte count and a 2 byte position y * tile size + x of every flipped cell.
+ *              - encoding 1, a tile size by tile size bitmap with a 1 bit for every flipped cell, row by row,
+ *                bit 0 first, even for tiles cut short by the edge of the grid.
+ *          - records are flushed as they are written, and a record cut short by a crash fails its checksum,
+ *            so restoring stops at the last complete generation.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+
+#include "checkpoint.h"
+#include "zoo.h"
+
+// The magic number opening every journal, before its version
+static const char JOURNAL_MAGIC[4] = {'G', 'D', 'L', 'T'};
+static const uint32_t JOURNAL_VERSION = 1;
+static const size_t JOURNAL_HEADER_SIZE = 28;
+
+// Tiles match those a World reports changes in, and their bitmaps are a bit per cell
+static const int TILE_SIZE = World::TILE_SIZE;
+static const size_t TILE_BITMAP_SIZE = TILE_SIZE * TILE_SIZE / 8;
+
+// The ways the flipped cells of a tile can be encoded
+static const unsigned char ENCODING_POSITIONS = 0;
+static const unsigned char ENCODING_BITMAP = 1;
+
+/**
+ * append_u16(bytes, value), append_u32(bytes, value), append_u64(bytes, value)
+ *
+ * Helper functions appending an unsigned integer to a buffer in little endian order, whatever the host byte order.
+ *
+ * @param bytes
+ *      The buffer to append to.
+ *
+ * @param value
+ *      The integer to append.
+ */
+static void append_u16(std::vector<unsigned char> &bytes, uint16_t value)
+{
+    bytes.push_back(static_cast<unsigned char>(value));
+    bytes.push_back(static_cast<unsigned char>(value >> 8));
+}
+
+static void append_u32(std::vector<unsigned char> &bytes, uint32_t value)
+{
+    append_u16(bytes, static_cast<uint16_t>(value));
+    append_u16(bytes, static_cast<uint16_t>(value >> 16));
+}
+
+static void append_u64(std::vector<unsigned char> &bytes, uint64_t value)
+{
+    append_u32(bytes, static_cast<uint32_t>(value));
+    append_u32(bytes, static_cast<uint32_t>(value >> 32));
+}
+
+/**
+ * read_u16(data), read_u32(data), read_u64(data)
+ *
+ * Helper functions reading a little endian unsigned integer from any byte, whatever the host byte order.
+ *
+ * @param data
+ *      The first byte of the integer.
+ *
+ * @return
+ *      The integer read.
+ */
+static uint16_t read_u16(const unsigned char *data)
+{
+    return static_cast<uint16_t>(data[0] | data[1] << 8);
+}
+
+static uint32_t read_u32(const unsigned char *data)
+{
+    return static_cast<uint32_t>(read_u16(data)) | static_cast<uint32_t>(read_u16(data + 2)) << 16;
+}
+
+static uint64_t read_u64(const unsigned char *data)
+{
+    return static_cast<uint64_t>(read_u32(data)) | static_cast<uint64_t>(read_u32(data + 4)) << 32;
+}
+
+/**
+ * checksum(data, size)
+ *
+ * Helper function computing the 32 bit FNV-1a hash of some bytes, to detect records cut short by a crash.
+ *
+ * @return
+ *      The hash of the bytes.
+ */
+static uint32_t checksum(const unsigned char *data, size_t size)
+{
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * parse_generation(name, prefix, suffix, generation)
+ *
+ * Helper function reading the generation out of a checkpoint file name such as base_42.bgol.
+ *
+ * @return
+ *      True if the name is the prefix, a generation, and the suffix, false otherwise.
+ */
+static bool parse_generation(const std::string &name, const std::string &prefix, const std::string &suffix,
+                             uint64_t &generation)
+{
+    if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+    {
+        return false;
+    }
+
+    const std::string digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+
+    if (digits.size() > 19 ||
+        !std::all_of(digits.begin(), digits.end(), [](unsigned char c) { return std::isdigit(c); }))
+    {
+        return false;
+    }
+
+    generation = std::stoull(digits);
+
+    return true;
+}
+
+/**
+ * read_record(body, size, state, apply)
+ *
+ * Helper function checking the tiles of a journal record against the grid they belong to, and optionally
+ * flipping their cells. Records are checked in full before being applied, so a corrupt record never leaves a
+ * grid half updated.
+ *
+ * @param body
+ *      The body of the record, after its generation.
+ *
+ * @param size
+ *      The number of bytes in the body after its generation.
+ *
+ * @param state
+ *      The grid of the generation before the record.
+ *
+ * @param apply
+ *      If true then flip the cells of the record, otherwise only check it.
+ *
+ * @return
+ *      True if the record is valid for the grid, false otherwise.
+ */
+static bool read_record(const unsigned char *body, size_t size, Grid &state, bool apply)
+{
+    const int tiles_x = (state.get_width() + TILE_SIZE - 1) / TILE_SIZE;
+    const int tiles_y = (state.get_height() + TILE_SIZE - 1) / TILE_SIZE;
+
+    if (size < 4)
+    {
+        return false;
+    }
+
+    const uint32_t tile_count = read_u32(body);
+    size_t offset = 4;
+
+    // Flip a cell at a position within a tile, if it lies within the grid
+    const auto flip = [&](int tile_x0, int tile_y0, int position) {
+        const int x = tile_x0 + position % TILE_SIZE;
+        const int y = tile_y0 + position / TILE_SIZE;
+
+        if (x >= state.get_width() || y >= state.get_height())
+        {
+            return false;
+        }
+
+        if (apply)
+        {
+            Cell *cells = state.row(y);
+            cells[x] = (cells[x] == Cell::ALIVE) ? Cell::DEAD : Cell::ALIVE;
+        }
+
+        return true;
+    };
+
+    for (uint32_t i = 0; i < tile_count; i++)
+    {
+        if (size - offset < 5)
+        {
+            return false;
+        }
+
+        const uint32_t tile = read_u32(body + offset);
+        const unsigned char encoding = body[offset + 4];
+        offset += 5;
+
+        if (tile >= static_cast<uint32_t>(tiles_x) * tiles_y)
+        {
+            return false;
+        }
+
+        const int tile_x0 = (tile % tiles_x) * TILE_SIZE;
+        const int tile_y0 = (tile / tiles_x) * TILE_SIZE;
+
+        if (encoding == ENCODING_POSITIONS)
+        {
+            if (size - offset < 2 || size - offset - 2 < 2 * static_cast<size_t>(read_u16(body + offset)))
+            {
+                return false;
+            }
+
+            const int count = read_u16(body + offset);
+            offset += 2;
+
+            for (int j = 0; j < count; j++, offset += 2)
+            {
+                const int position = read_u16(body + offset);
+
+                if (position >= TILE_SIZE * TILE_SIZE || !flip(tile_x0, tile_y0, position))
+                {
+                    return false;
+                }
+            }
+        }
+        else if (encoding == ENCODING_BITMAP)
+        {
+            if (size - offset < TILE_BITMAP_SIZE)
+            {
+                return false;
+            }
+
+            for (int position = 0; position < TILE_SIZE * TILE_SIZE; position++)
+            {
+                if (((body[offset + position / 8] >> (position % 8)) & 1) && !flip(tile_x0, tile_y0, position))
+                {
+                    return false;
+                }
+            }
+
+            offset += TILE_BITMAP_SIZE;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return offset == size;
+}
+
+/**
+ * Checkpoint::Checkpoint(directory, deltas_per_base)
+ *
+ * Construct a checkpoint writer for a directory, creating the directory if it does not exist.
+ * Nothing is written until the first call to Checkpoint::save or Checkpoint::save_base.
+ *
+ * @example
+ *
+ *      // Checkpoint a world every generation, writing a new base every 100 generations
+ *      Checkpoint checkpoint("path/to/checkpoints", 100);
+ *
+ *      for (int i = 0; i < 1000; i++) {
+ *          world.step();
+ *          checkpoint.save(world);
+ *      }
+ *
+ * @param directory
+ *      The std::string path to the directory to save checkpoints in.
+ *
+ * @param deltas_per_base
+ *      The number of deltas Checkpoint::save writes before starting again from a new base.
+ *      Restoring replays every delta since the last base, so this bounds the time taken to restore.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the directory cannot be created, or std::invalid_argument
+ *      if deltas_per_base is negative.
+ */
+Checkpoint::Checkpoint(const std::string &directory, int deltas_per_base)
+    : directory(directory), deltas_per_base(deltas_per_base), deltas_since_base(-1)
+{
+    if (deltas_per_base < 0)
+    {
+        throw std::invalid_argument("ERROR: The number of deltas per base cannot be negative.");
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    if (error)
+    {
+        throw std::runtime_error("ERROR: Cannot create checkpoint directory '" + directory + "'.");
+    }
+}
+
+/**
+ * Checkpoint::get_base_path(generation), Checkpoint::get_journal_path(generation)
+ *
+ * Private helper functions building the paths of the base and journal starting at a generation.
+ *
+ * @return
+ *      The path of the file within the checkpoint directory.
+ */
+std::string Checkpoint::get_base_path(uint64_t generation) const
+{
+    return directory + "/base_" + std::to_string(generation) + ".bgol";
+}
+
+std::string Checkpoint::get_journal_path(uint64_t generation) const
+{
+    return directory + "/journal_" + std::to_string(generation) + ".gdl";
+}
+
+/**
+ * Checkpoint::save(world)
+ *
+ * Save the current state and generation of a world, as a delta of the tiles the world reports as changed
+ * since the last save, or as a new base on the first save, every deltas_per_base saves, and whenever the
+ * world has been resized.
+ *
+ * With Engine::SPARSE only the changed tiles are visited, otherwise every tile is compared with the last save.
+ *
+ * @param world
+ *      The world to save, whose changed tiles are taken.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if a file cannot be written.
+ */
+void Checkpoint::save(World &world)
+{
+    const std::vector<int> tiles = world.take_changed_tiles();
+    const Grid &state = world.get_state();
+
+    if (deltas_since_base < 0 || deltas_since_base >= deltas_per_base ||
+        state.get_width() != previous.get_width() || state.get_height() != previous.get_height())
+    {
+        save_base(state, world.get_generation());
+    }
+    else
+    {
+        save_delta(state, world.get_generation(), tiles);
+    }
+}
+
+/**
+ * Checkpoint::save_base(state, generation)
+ *
+ * Save a full grid as a new base and start a new, empty journal after it.
+ * Once both are written, every older base and journal in the directory is removed.
+ *
+ * @param state
+ *      The grid to save.
+ *
+ * @param generation
+ *      The generation the grid belongs to.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if a file cannot be written.
+ */
+void Checkpoint::save_base(const Grid &state, uint64_t generation)
+{
+    const std::string base_path = get_base_path(generation);
+    const std::string journal_path = get_journal_path(generation);
+
+    Zoo::save_binary(base_path + ".tmp", state, Zoo::BinaryFormat::V2);
+
+    std::error_code error;
+    std::filesystem::rename(base_path + ".tmp", base_path, error);
+
+    if (error)
+    {
+        throw std::runtime_error("ERROR: Cannot write to file '" + base_path + "'.");
+    }
+
+    std::vector<unsigned char> header(JOURNAL_MAGIC, JOURNAL_MAGIC + sizeof(JOURNAL_MAGIC));
+    append_u32(header, JOURNAL_VERSION);
+    append_u32(header, state.get_width());
+    append_u32(header, state.get_height());
+    append_u32(header, TILE_SIZE);
+    append_u64(header, generation);
+
+    journal.close();
+    journal.clear();
+    journal.open(journal_path, std::ios::binary | std::ios::trunc);
+    journal.write(reinterpret_cast<const char *>(header.data()), header.size());
+    journal.flush();
+
+    if (!journal.is_open() || journal.fail())
+    {
+        throw std::runtime_error("ERROR: Cannot write to file '" + journal_path + "'.");
+    }
+
+    previous = state;
+    deltas_since_base = 0;
+
+    // The new checkpoint is complete, so nothing older is needed
+    for (const auto &entry : std::filesystem::directory_iterator(directory, error))
+    {
+        const std::string name = entry.path().filename().string();
+        uint64_t old_generation = 0;
+
+        if ((parse_generation(name, "base_", ".bgol", old_generation) ||
+             parse_generation(name, "journal_", ".gdl", old_generation)) && old_generation != generation)
+        {
+            std::filesystem::remove(entry.path(), error);
+        }
+    }
+}
+
+/**
+ * Checkpoint::save_delta(state, generation, tiles)
+ *
+ * Append a record to the journal of the cells which flipped since the last record, looking only at the given
+ * tiles. Each changed tile is stored as a list of the flipped cells, or as a bitmap if that would be smaller.
+ * Only the given tiles are compared, so the time taken is proportional to their number rather than to the size
+ * of the grid.
+ *
+ * @param state
+ *      The grid to save, which must be the same size as the last saved grid.
+ *
+ * @param generation
+ *      The generation the grid belongs to.
+ *
+ * @param tiles
+ *      The numbers of every tile which may have changed since the last record, as reported by
+ *      World::take_changed_tiles().
+ *
+ * @throws
+ *      Throws std::logic_error if there is no base yet or the grid has changed size, and std::runtime_error or
+ *      sub-class if the journal cannot be written.
+ */
+void Checkpoint::save_delta(const Grid &state, uint64_t generation, const std::vector<int> &tiles)
+{
+    if (deltas_since_base < 0 || state.get_width() != previous.get_width() ||
+        state.get_height() != previous.get_height())
+    {
+        throw std::logic_error("ERROR: A delta needs a base of the same size.");
+    }
+
+    const int width = state.get_width();
+    const int height = state.get_height();
+    const int tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+
+    std::vector<unsigned char> body;
+    append_u64(body, generation);
+    append_u32(body, 0); // Filled in with the number of changed tiles
+
+    uint32_t tile_count = 0;
+    std::vector<uint16_t> positions;
+
+    for (const int tile : tiles)
+    {
+        const int x0 = (tile % tiles_x) * TILE_SIZE, x1 = std::min(width, x0 + TILE_SIZE);
+        const int y0 = (tile / tiles_x) * TILE_SIZE, y1 = std::min(height, y0 + TILE_SIZE);
+
+        positions.clear();
+
+        for (int y = y0; y < y1; y++)
+        {
+            const Cell *cells = state.row(y);
+            const Cell *old_cells = static_cast<const Grid &>(previous).row(y);
+
+            if (std::memcmp(cells + x0, old_cells + x0, x1 - x0) == 0)
+            {
+                continue;
+            }
+
+            for (int x = x0; x < x1; x++)
+            {
+                if (cells[x] != old_cells[x])
+                {
+                    positions.push_back((y - y0) * TILE_SIZE + (x - x0));
+                }
+            }
+
+            std::memcpy(previous.row(y) + x0, cells + x0, x1 - x0);
+        }
+
+        if (positions.empty())
+        {
+            continue;
+        }
+
+        tile_count++;
+        append_u32(body, tile);
+
+        if (2 + 2 * positions.size() < TILE_BITMAP_SIZE)
+        {
+            body.push_back(ENCODING_POSITIONS);
+            append_u16(body, positions.size());
+
+            for (const uint16_t position : positions)
+            {
+                append_u16(body, position);
+            }
+        }
+        else
+        {
+            body.push_back(ENCODING_BITMAP);
+
+            const size_t bitmap = body.size();
+            body.resize(bitmap + TILE_BITMAP_SIZE, 0);
+
+            for (const uint16_t position : positions)
+            {
+                body[bitmap + position / 8] |= 1 << (position % 8);
+            }
+        }
+    }
+
+    body[8] = static_cast<unsigned char>(tile_count);
+    body[9] = static_cast<unsigned char>(tile_count >> 8);
+    body[10] = static_cast<unsigned char>(tile_count >> 16);
+    body[11] = static_cast<unsigned char>(tile_count >> 24);
+
+    std::vector<unsigned char> record;
+    append_u32(record, body.size());
+    record.insert(record.end(), body.begin(), body.end());
+    append_u32(record, checksum(body.data(), body.size()));
+
+    journal.write(reinterpret_cast<const char *>(record.data()), record.size());
+    journal.flush();
+
+    if (journal.fail())
+    {
+        throw std::runtime_error("ERROR: Cannot write to checkpoint journal in '" + directory + "'.");
+    }
+
+    deltas_since_base++;
+}
+
+/**
+ * Checkpoint::load_latest(directory, state, generation)
+ *
+ * Restore the latest state saved in a checkpoint directory, by loading the newest readable base and replaying
+ * every complete record of its journal. A record cut short or corrupted, such as by a crash while it was being
+ * written, ends the replay at the generation before it.
+ *
+ * @example
+ *
+ *      // Carry on a run from where it was stopped
+ *      Grid grid;
+ *      uint64_t generation = 0;
+ *
+ *      if (Checkpoint::load_latest("path/to/checkpoints", grid, generation)) {
+ *          World world(std::move(grid));
+ *          world.set_generation(generation);
+ *      }
+ *
+ * @param directory
+ *      The std::string path to the checkpoint directory.
+ *
+ * @param state
+ *      Output restored grid.
+ *
+ * @param generation
+ *      Output generation of the restored grid.
+ *
+ * @return
+ *      True if a checkpoint was restored, false if the directory holds no readable base.
+ */
+bool Checkpoint::load_latest(const std::string &directory, Grid &state, uint64_t &generation)
+{
+    std::error_code error;
+    std::vector<uint64_t> bases;
+
+    for (const auto &entry : std::filesystem::directory_iterator(directory, error))
+    {
+        uint64_t base_generation = 0;
+
+        if (parse_generation(entry.path().filename().string(), "base_", ".bgol", base_generation))
+        {
+            bases.push_back(base_generation);
+        }
+    }
+
+    std::sort(bases.rbegin(), bases.rend());
+
+    for (const uint64_t base_generation : bases)
+    {
+        const std::string suffix = std::to_string(base_generation);
+
+        try
+        {
+            state = Zoo::load_binary(directory + "/base_" + suffix + ".bgol");
+        }
+        catch (const std::exception &)
+        {
+            continue;
+        }
+
+        generation = base_generation;
+
+        std::ifstream in(directory + "/journal_" + suffix + ".gdl", std::ios::binary);
+        const std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(in)),
+                                               std::istreambuf_iterator<char>());
+
+        // Without a matching journal, the base alone is the latest state
+        if (bytes.size() < JOURNAL_HEADER_SIZE ||
+            std::memcmp(bytes.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 ||
+            read_u32(bytes.data() + 4) != JOURNAL_VERSION ||
+            read_u32(bytes.data() + 8) != static_cast<uint32_t>(state.get_width()) ||
+            read_u32(bytes.data() + 12) != static_cast<uint32_t>(state.get_height()) ||
+            read_u32(bytes.data() + 16) != static_cast<uint32_t>(TILE_SIZE) ||
+            read_u64(bytes.data() + 20) != base_generation)
+        {
+            return true;
+        }
+
+        size_t offset = JOURNAL_HEADER_SIZE;
+
+        while (bytes.size() - offset >= 4)
+        {
+            const size_t size = read_u32(bytes.data() + offset);
+
+            if (size < 8 || bytes.size() - offset - 4 < size + 4)
+            {
+                break;
+            }
+
+            const unsigned char *body = bytes.data() + offset + 4;
+            const uint64_t record_generation = read_u64(body);
+
+            if (read_u32(body + size) != checksum(body, size) || record_generation <= generation ||
+                !read_record(body + 8, size - 8, state, false))
+            {
+                break;
+            }
+
+            read_record(body + 8, size - 8, state, true);
+            generation = record_generation;
+            offset += size + 8;
+        }
+
+        return true;
+    }
+
+    return false;
+}
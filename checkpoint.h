@@ -0,0 +1,47 @@
+/**
+ * Declares a class for saving a running world as a base snapshot followed by a journal of small deltas.
+ * Rich documentation for the api and behaviour the Checkpoint class can be found in checkpoint.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "grid.h"
+#include "world.h"
+
+/**
+ * Declare the structure of the Checkpoint class for saving and restoring the state of a world.
+ *
+ * A checkpoint directory holds a full base grid and a journal of delta records, each listing the tiles which
+ * changed since the record before along with the cells which flipped in them. Saving a delta only visits the
+ * tiles the world reports as changed, so checkpointing every generation costs time proportional to the activity
+ * of the world rather than its size.
+ */
+class Checkpoint
+{
+    private:
+        std::string directory;
+        int deltas_per_base;
+        int deltas_since_base; // -1 until the first base is written
+
+        Grid previous; // The state as of the last record
+        std::ofstream journal;
+
+        std::string get_base_path(uint64_t generation) const;
+        std::string get_journal_path(uint64_t generation) const;
+
+    public:
+        explicit Checkpoint(const std::string &directory, int deltas_per_base = 1024);
+
+        void save(World &world);
+        void save_base(const Grid &state, uint64_t generation);
+        void save_delta(const Grid &state, uint64_t generation, const std::vector<int> &tiles);
+
+        static bool load_latest(const std::string &directory, Grid &state, uint64_t &generation);
+};
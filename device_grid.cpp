@@ -0,0 +1,610 @@
+/**
+ * Implements a class representing a 2d grid of cells held in the memory of an accelerator such as a GPU.
+ *      - Cells are stored one byte per cell like a Grid, row by row with a ghost border one cell wide, in memory
+ *        allocated on the default OpenMP offload device with omp_target_alloc.
+ *          - The grid is only copied between the host and the device as a whole, by DeviceGrid::upload,
+ *            DeviceGrid::download, and the constructor from a Grid, so a world stepped on the device pays for
+ *            one copy each way however many steps it takes in between.
+ *          - Copies go through a contiguous staging buffer on the host, so each is a single transfer.
+ *      - The kernels run on the device as OpenMP target regions.
+ *          - DeviceGrid::refresh_ghost_border(toroidal) fills the ghost border from the opposite edges, or with
+ *            dead cells, in place on the device.
+ *          - DeviceGrid::step(source, destination, rule) runs the stencil, as one team of threads per
+ *            TILE_WIDTH by TILE_HEIGHT tile. Each team first loads its tile and the cells around it into an
+ *            array declared within the team, which offload compilers place in the memory shared by the threads
+ *            of a GPU block, so the 9 reads of every cell are served from there rather than from global memory.
+ *            The rule is applied by looking each count up in the birth and survival masks, with no branches.
+ *          - DeviceGrid::get_alive_cells() is counted by a reduction on the device and cached until the cells
+ *            change, so reporting the population never copies the grid back.
+ *      - Without an offload device, or with a compiler built without OpenMP, the same code runs on the host, so
+ *        every result is identical but only a GPU makes it fast.
+ *      - New cells are initialized to Cell::DEAD.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#define DEVICE_PRAGMA(...) _Pragma(#__VA_ARGS__)
+#else
+#define DEVICE_PRAGMA(...)
+#endif
+
+#include "device_grid.h"
+#include "memory_pool.h"
+
+/**
+ * host_device()
+ *
+ * Helper function naming the host as a device, for copies between host and device memory.
+ *
+ * @return
+ *      The device number of the host.
+ */
+static int host_device()
+{
+#ifdef _OPENMP
+    return omp_get_initial_device();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * copy_cells(destination, destination_device, source, source_device, count)
+ *
+ * Helper function copying count cells between any two devices, including the host.
+ */
+static void copy_cells(Cell *destination, int destination_device, const Cell *source, int source_device,
+                       size_t count)
+{
+#ifdef _OPENMP
+    if (omp_target_memcpy(destination, source, count * sizeof(Cell), 0, 0, destination_device, source_device) != 0)
+    {
+        throw std::bad_alloc();
+    }
+#else
+    (void)destination_device;
+    (void)source_device;
+    std::memcpy(destination, source, count * sizeof(Cell));
+#endif
+}
+
+/**
+ * DeviceGrid::DeviceGrid()
+ *
+ * Construct an empty grid of size 0x0, which allocates nothing on the device.
+ */
+DeviceGrid::DeviceGrid() : width(0), height(0), pitch(2), device(0), cells(nullptr), alive_cells(0) {}
+
+/**
+ * DeviceGrid::DeviceGrid(width, height)
+ *
+ * Construct a grid of dead cells on the default device.
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ */
+DeviceGrid::DeviceGrid(int width, int height)
+    : width(width), height(height), pitch(width + 2), device(0), cells(nullptr), alive_cells(0)
+{
+    allocate();
+    fill(Cell::DEAD);
+}
+
+/**
+ * DeviceGrid::DeviceGrid(grid)
+ *
+ * Construct a grid on the default device holding a copy of the cells of a Grid.
+ *
+ * @param grid
+ *      The grid to copy to the device.
+ */
+DeviceGrid::DeviceGrid(const Grid &grid)
+    : width(grid.get_width()), height(grid.get_height()), pitch(grid.get_width() + 2), device(0),
+      cells(nullptr), alive_cells(0)
+{
+    allocate();
+    upload(grid);
+}
+
+/**
+ * DeviceGrid::DeviceGrid(other)
+ *
+ * Construct a copy of another grid on the same device, copying the cells without a trip through the host.
+ *
+ * @param other
+ *      The grid to copy.
+ */
+DeviceGrid::DeviceGrid(const DeviceGrid &other)
+    : width(other.width), height(other.height), pitch(other.pitch), device(other.device), cells(nullptr),
+      alive_cells(other.alive_cells)
+{
+    allocate();
+
+    if (cells)
+    {
+        copy_cells(cells, device, other.cells, other.device, get_allocated_cells());
+    }
+}
+
+/**
+ * DeviceGrid::DeviceGrid(other)
+ *
+ * Construct a grid taking over the device memory of another, leaving it empty.
+ *
+ * @param other
+ *      The grid to move from.
+ */
+DeviceGrid::DeviceGrid(DeviceGrid &&other) noexcept
+    : width(other.width), height(other.height), pitch(other.pitch), device(other.device), cells(other.cells),
+      alive_cells(other.alive_cells)
+{
+    other.width = 0;
+    other.height = 0;
+    other.pitch = 2;
+    other.cells = nullptr;
+    other.alive_cells = 0;
+}
+
+/**
+ * DeviceGrid::~DeviceGrid()
+ *
+ * Free the device memory held by the grid.
+ */
+DeviceGrid::~DeviceGrid()
+{
+    release();
+}
+
+/**
+ * DeviceGrid::operator=(other)
+ *
+ * Replace the cells of this grid with a copy of another.
+ *
+ * @return
+ *      A reference to this grid.
+ */
+DeviceGrid &DeviceGrid::operator=(const DeviceGrid &other)
+{
+    if (this != &other)
+    {
+        DeviceGrid copy(other);
+        *this = std::move(copy);
+    }
+
+    return *this;
+}
+
+/**
+ * DeviceGrid::operator=(other)
+ *
+ * Replace this grid by taking over the device memory of another, leaving it empty. Swapping two grids with
+ * std::swap only swaps their pointers, so it is O(1).
+ *
+ * @return
+ *      A reference to this grid.
+ */
+DeviceGrid &DeviceGrid::operator=(DeviceGrid &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+
+        width = other.width;
+        height = other.height;
+        pitch = other.pitch;
+        device = other.device;
+        cells = other.cells;
+        alive_cells = other.alive_cells;
+
+        other.width = 0;
+        other.height = 0;
+        other.pitch = 2;
+        other.cells = nullptr;
+        other.alive_cells = 0;
+    }
+
+    return *this;
+}
+
+/**
+ * DeviceGrid::has_device()
+ *
+ * Check whether the kernels are offloaded to an accelerator, rather than falling back to the host.
+ *
+ * @return
+ *      True if an OpenMP offload device is available.
+ */
+bool DeviceGrid::has_device()
+{
+#ifdef _OPENMP
+    return omp_get_num_devices() > 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * DeviceGrid::get_width()
+ *
+ * @return
+ *      The width of the grid.
+ */
+int DeviceGrid::get_width() const
+{
+    return width;
+}
+
+/**
+ * DeviceGrid::get_height()
+ *
+ * @return
+ *      The height of the grid.
+ */
+int DeviceGrid::get_height() const
+{
+    return height;
+}
+
+/**
+ * DeviceGrid::get_total_cells()
+ *
+ * @return
+ *      The number of total cells.
+ */
+int DeviceGrid::get_total_cells() const
+{
+    return width * height;
+}
+
+/**
+ * DeviceGrid::get_alive_cells()
+ *
+ * Counts how many cells in the grid are alive, with a reduction on the device.
+ * The count is cached until the cells next change, so asking again is free.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+int DeviceGrid::get_alive_cells() const
+{
+    if (alive_cells < 0)
+    {
+        const Cell *const cells = this->cells;
+        const int width = this->width;
+        const int height = this->height;
+        const int pitch = this->pitch;
+        int count = 0;
+
+        DEVICE_PRAGMA(omp target teams distribute parallel for collapse(2) reduction(+ : count) map(tofrom : count) is_device_ptr(cells) device(device))
+        for (int y = 1; y <= height; y++)
+        {
+            for (int x = 1; x <= width; x++)
+            {
+                count += cells[static_cast<size_t>(y) * pitch + x] == Cell::ALIVE;
+            }
+        }
+
+        alive_cells = count;
+    }
+
+    return alive_cells;
+}
+
+/**
+ * DeviceGrid::get_dead_cells()
+ *
+ * @return
+ *      The number of dead cells.
+ */
+int DeviceGrid::get_dead_cells() const
+{
+    return get_total_cells() - get_alive_cells();
+}
+
+/**
+ * DeviceGrid::get_allocated_bytes()
+ *
+ * @return
+ *      The bytes of device memory held by the grid, including its ghost border.
+ */
+size_t DeviceGrid::get_allocated_bytes() const
+{
+    return cells ? get_allocated_cells() * sizeof(Cell) : 0;
+}
+
+/**
+ * DeviceGrid::upload(grid)
+ *
+ * Copy the cells of a Grid to the device in a single transfer, replacing the cells of this grid.
+ * The device memory is reallocated if the size of the grid differs. The ghost border is left dead.
+ *
+ * @param grid
+ *      The grid to copy from.
+ */
+void DeviceGrid::upload(const Grid &grid)
+{
+    if (grid.get_width() != width || grid.get_height() != height)
+    {
+        *this = DeviceGrid(grid);
+        return;
+    }
+
+    if (cells)
+    {
+        // Laid out exactly like the device memory, so it is copied over in one go
+        std::pmr::vector<Cell> staging(get_allocated_cells(), Cell::DEAD, Memory::get_scratch_resource());
+
+        for (int y = 0; y < height; y++)
+        {
+            std::memcpy(staging.data() + static_cast<size_t>(y + 1) * pitch + 1, grid.row(y), width);
+        }
+
+        copy_cells(cells, device, staging.data(), host_device(), staging.size());
+    }
+
+    alive_cells = -1;
+}
+
+/**
+ * DeviceGrid::download(grid)
+ *
+ * Copy the cells of this grid from the device into a Grid in a single transfer.
+ * The grid is only reallocated if its size differs, so downloading into the same grid again reuses its memory.
+ *
+ * @param grid
+ *      The grid to copy into.
+ */
+void DeviceGrid::download(Grid &grid) const
+{
+    if (grid.get_width() != width || grid.get_height() != height)
+    {
+        grid = Grid(width, height);
+    }
+
+    if (cells)
+    {
+        std::pmr::vector<Cell> staging(get_allocated_cells(), Memory::get_scratch_resource());
+        copy_cells(staging.data(), host_device(), cells, device, staging.size());
+
+        for (int y = 0; y < height; y++)
+        {
+            std::memcpy(grid.row(y), staging.data() + static_cast<size_t>(y + 1) * pitch + 1, width);
+        }
+    }
+}
+
+/**
+ * DeviceGrid::to_grid()
+ *
+ * Copy this grid back from the device.
+ *
+ * @return
+ *      A Grid with the same size and cells.
+ */
+Grid DeviceGrid::to_grid() const
+{
+    Grid grid(width, height);
+    download(grid);
+
+    return grid;
+}
+
+/**
+ * DeviceGrid::refresh_ghost_border(toroidal)
+ *
+ * Fill the ghost border on the device, before a step reads through it. The left and right columns are filled
+ * first, so the corners are then copied along with the top and bottom rows.
+ *
+ * @param toroidal
+ *      If true then the edges are wrapped to the opposite side of the grid, otherwise they are dead.
+ */
+void DeviceGrid::refresh_ghost_border(bool toroidal)
+{
+    if (!cells)
+    {
+        return;
+    }
+
+    Cell *const cells = this->cells;
+    const int width = this->width;
+    const int height = this->height;
+    const size_t pitch = this->pitch;
+
+    DEVICE_PRAGMA(omp target teams distribute parallel for is_device_ptr(cells) device(device))
+    for (int y = 1; y <= height; y++)
+    {
+        cells[y * pitch] = toroidal ? cells[y * pitch + width] : Cell::DEAD;
+        cells[y * pitch + width + 1] = toroidal ? cells[y * pitch + 1] : Cell::DEAD;
+    }
+
+    DEVICE_PRAGMA(omp target teams distribute parallel for is_device_ptr(cells) device(device))
+    for (int x = 0; x < width + 2; x++)
+    {
+        cells[x] = toroidal ? cells[height * pitch + x] : Cell::DEAD;
+        cells[(height + 1) * pitch + x] = toroidal ? cells[pitch + x] : Cell::DEAD;
+    }
+}
+
+/**
+ * DeviceGrid::step(source, destination, rule)
+ *
+ * Compute the next state of every cell of a grid on the device, reading the neighbours of the edge cells from
+ * its ghost border, which must have been refreshed first.
+ *
+ * The grid is split into TILE_WIDTH by TILE_HEIGHT tiles, one per team of threads, with one thread per cell.
+ * The team loads its tile and the ring of cells around it into team local memory together, then each thread
+ * counts the neighbours of its cell from there. Tiles are 32 cells wide, so a warp reads a whole row of a tile
+ * from consecutive addresses.
+ *
+ * @param source
+ *      The current state, which is only read.
+ *
+ * @param destination
+ *      The next state, which must be the same size and on the same device as the current state.
+ *
+ * @param rule
+ *      The rule to step under.
+ */
+void DeviceGrid::step(const DeviceGrid &source, DeviceGrid &destination, const Rule &rule)
+{
+    destination.alive_cells = -1;
+
+    if (!source.cells)
+    {
+        return;
+    }
+
+    const Cell *const current = source.cells;
+    Cell *const next = destination.cells;
+    const int width = source.width;
+    const int height = source.height;
+    const size_t pitch = source.pitch;
+    const unsigned int birth = rule.get_birth();
+    const unsigned int survival = rule.get_survival();
+
+    const int tiles_x = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+    const int tiles = tiles_x * ((height + TILE_HEIGHT - 1) / TILE_HEIGHT);
+
+    const int LOADED_WIDTH = TILE_WIDTH + 2;
+    const int LOADED_CELLS = LOADED_WIDTH * (TILE_HEIGHT + 2);
+
+    DEVICE_PRAGMA(omp target teams distribute thread_limit(TILE_WIDTH * TILE_HEIGHT) is_device_ptr(current, next) device(source.device))
+    for (int tile = 0; tile < tiles; tile++)
+    {
+        // Shared by the threads of the team, the tile's cells and their neighbours
+        Cell loaded[LOADED_CELLS];
+
+        // The top left loaded cell, in the coordinates of the memory including the ghost border
+        const int x0 = (tile % tiles_x) * TILE_WIDTH;
+        const int y0 = (tile / tiles_x) * TILE_HEIGHT;
+
+        DEVICE_PRAGMA(omp parallel for)
+        for (int i = 0; i < LOADED_CELLS; i++)
+        {
+            const int x = x0 + i % LOADED_WIDTH;
+            const int y = y0 + i / LOADED_WIDTH;
+
+            loaded[i] = x < width + 2 && y < height + 2 ? current[y * pitch + x] : Cell::DEAD;
+        }
+
+        DEVICE_PRAGMA(omp parallel for)
+        for (int i = 0; i < TILE_WIDTH * TILE_HEIGHT; i++)
+        {
+            const int tile_x = i % TILE_WIDTH;
+            const int tile_y = i / TILE_WIDTH;
+
+            if (x0 + tile_x < width && y0 + tile_y < height)
+            {
+                const Cell *const above = loaded + tile_y * LOADED_WIDTH + tile_x;
+                const Cell *const middle = above + LOADED_WIDTH;
+                const Cell *const below = middle + LOADED_WIDTH;
+
+                const int num_neighbours =
+                    (above[0] == Cell::ALIVE) + (above[1] == Cell::ALIVE) + (above[2] == Cell::ALIVE) +
+                    (middle[0] == Cell::ALIVE) + (middle[2] == Cell::ALIVE) +
+                    (below[0] == Cell::ALIVE) + (below[1] == Cell::ALIVE) + (below[2] == Cell::ALIVE);
+
+                const unsigned int mask = middle[1] == Cell::ALIVE ? survival : birth;
+
+                next[(y0 + tile_y + 1) * pitch + x0 + tile_x + 1] =
+                    (mask >> num_neighbours) & 1 ? Cell::ALIVE : Cell::DEAD;
+            }
+        }
+    }
+}
+
+/**
+ * DeviceGrid::get_allocated_cells()
+ *
+ * Private helper function giving the number of cells in the allocation, including the ghost border.
+ */
+size_t DeviceGrid::get_allocated_cells() const
+{
+    return static_cast<size_t>(pitch) * (height + 2);
+}
+
+/**
+ * DeviceGrid::allocate()
+ *
+ * Private helper function allocating the cells of a grid of the current size on the default device.
+ * Nothing is allocated for an empty grid, so worlds which never use the device never start its runtime.
+ */
+void DeviceGrid::allocate()
+{
+    if (width <= 0 || height <= 0)
+    {
+        cells = nullptr;
+        return;
+    }
+
+#ifdef _OPENMP
+    device = omp_get_default_device();
+    cells = static_cast<Cell *>(omp_target_alloc(get_allocated_cells() * sizeof(Cell), device));
+
+    if (!cells)
+    {
+        throw std::bad_alloc();
+    }
+#else
+    cells = static_cast<Cell *>(Memory::get_aligned_resource()->allocate(get_allocated_cells() * sizeof(Cell),
+                                                                          Memory::CACHE_LINE_SIZE));
+#endif
+}
+
+/**
+ * DeviceGrid::release()
+ *
+ * Private helper function freeing the cells of the grid, if it has any.
+ */
+void DeviceGrid::release()
+{
+    if (!cells)
+    {
+        return;
+    }
+
+#ifdef _OPENMP
+    omp_target_free(cells, device);
+#else
+    Memory::get_aligned_resource()->deallocate(cells, get_allocated_cells() * sizeof(Cell), Memory::CACHE_LINE_SIZE);
+#endif
+
+    cells = nullptr;
+}
+
+/**
+ * DeviceGrid::fill(value)
+ *
+ * Private helper function setting every cell of the grid, including the ghost border, on the device.
+ *
+ * @param value
+ *      The value to set every cell to.
+ */
+void DeviceGrid::fill(const Cell value)
+{
+    if (!cells)
+    {
+        return;
+    }
+
+    Cell *const cells = this->cells;
+    const size_t count = get_allocated_cells();
+
+    DEVICE_PRAGMA(omp target teams distribute parallel for is_device_ptr(cells) device(device))
+    for (size_t i = 0; i < count; i++)
+    {
+        cells[i] = value;
+    }
+
+    alive_cells = value == Cell::ALIVE ? get_total_cells() : 0;
+}
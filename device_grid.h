@@ -0,0 +1,70 @@
+/**
+ * Declares a class representing a 2d grid of cells held in the memory of an accelerator such as a GPU.
+ * Rich documentation for the api and behaviour the DeviceGrid class can be found in device_grid.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <cstddef>
+
+#include "grid.h"
+#include "rule.h"
+
+/**
+ * Declare the structure of the DeviceGrid class for representing a 2d grid of cells in device memory.
+ *
+ * The cells are stored one byte each, row by row, surrounded by a ghost border one cell wide, in memory owned by
+ * the default OpenMP offload device. The cells can only be reached by copying the whole grid to or from a Grid,
+ * or through the kernels of this class, which run on the device.
+ */
+class DeviceGrid
+{
+    public:
+        // Cells along x and y of the tiles the stencil kernel loads into the memory shared by a team of threads
+        static const int TILE_WIDTH = 32;
+        static const int TILE_HEIGHT = 8;
+
+    private:
+        int width;
+        int height;
+        int pitch; // Cells per row of the allocation, including the ghost border
+        int device; // The OpenMP device number holding the cells
+        Cell *cells; // Device memory, (height + 2) rows of pitch cells, or null for an empty grid
+        mutable int alive_cells; // Cached count, -1 once the cells have changed
+
+        size_t get_allocated_cells() const;
+
+        void allocate();
+        void release();
+        void fill(const Cell value);
+
+    public:
+        DeviceGrid();
+        DeviceGrid(int width, int height);
+        explicit DeviceGrid(const Grid &grid);
+        DeviceGrid(const DeviceGrid &other);
+        DeviceGrid(DeviceGrid &&other) noexcept;
+        ~DeviceGrid();
+
+        DeviceGrid &operator=(const DeviceGrid &other);
+        DeviceGrid &operator=(DeviceGrid &&other) noexcept;
+
+        static bool has_device();
+
+        int get_width() const;
+        int get_height() const;
+        int get_total_cells() const;
+        int get_alive_cells() const;
+        int get_dead_cells() const;
+        size_t get_allocated_bytes() const;
+
+        void upload(const Grid &grid);
+        void download(Grid &grid) const;
+        Grid to_grid() const;
+
+        void refresh_ghost_border(bool toroidal);
+
+        static void step(const DeviceGrid &source, DeviceGrid &destination, const Rule &rule);
+};
@@ -0,0 +1,821 @@
+/**
+ * Implements a class representing a 2d grid world split between the processes of an MPI communicator, for worlds
+ * too big to fit in the memory of one machine.
+ *      - The grid is split into a 2d Cartesian arrangement of blocks, one per rank.
+ *          - The ranks are arranged by MPI_Dims_create, with the longer side of the grid split between more ranks.
+ *          - Blocks start on multiples of ALIGNMENT cells, so a grid must be at least ALIGNMENT cells long for
+ *            each rank along each side.
+ *          - Each rank only ever allocates its own block.
+ *
+ *      - Each step exchanges a halo one cell wide with the 8 neighbouring blocks.
+ *          - Both state grids carry a ghost border, as with Engine::STENCIL, and the halo rows and corners are
+ *            received straight into it. The halo columns are packed into and out of small buffers.
+ *          - The sends and receives are started without blocking, the interior of the block, which needs no halo,
+ *            is computed while the messages are in flight, and only then is the outer ring of the block computed.
+ *          - The communicator is periodic, so when toroidal the blocks on the outer edges exchange halos with the
+ *            blocks on the opposite edges. Otherwise they have no neighbour there, and the ghost border is dead.
+ *          - Each cell is computed with the same row kernel as Engine::SIMD, so the results are identical to a
+ *            World stepping the whole grid.
+ *
+ *      - Worlds are loaded from and saved to binary files in parallel, each rank only reading and writing its own
+ *        region of the file.
+ *          - Loading reads the size of the grid from the header, then each rank decodes only its own region with
+ *            Zoo::load_binary_region, from either a v1 or a v2 file.
+ *          - Saving writes a single v2 file, with tiles ALIGNMENT cells wide, through MPI-IO. The ranks share out
+ *            the index and blocks with a prefix sum of their sizes, then each writes its own at once.
+ *
+ *      - Counting the alive cells sums the count of every block with a reduction over the communicator.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "distributed_world.h"
+#include "simd_kernels.h"
+#include "zoo.h"
+
+const std::array<std::array<int, 2>, 8> DistributedWorld::DIRECTIONS = {
+        {{-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}}};
+
+/**
+ * DistributedWorld::DistributedWorld(communicator, width, height)
+ *
+ * Construct a dead world of the given size, split between the ranks of a communicator.
+ * Collective over the communicator.
+ *
+ * @example
+ *
+ *      // Make a 100,000x100,000 world split between every process of the job
+ *      DistributedWorld world(MPI_COMM_WORLD, 100000, 100000);
+ *
+ * @param communicator
+ *      The communicator to split the world between, which is duplicated rather than kept.
+ *
+ * @param width
+ *      The width of the world.
+ *
+ * @param height
+ *      The height of the world.
+ *
+ * @throws
+ *      Throws std::invalid_argument if the world is too small to give every rank a block at least ALIGNMENT cells
+ *      along each side.
+ */
+DistributedWorld::DistributedWorld(MPI_Comm communicator, int width, int height)
+    : comm(MPI_COMM_NULL), rank(0), ranks(1), dims(), coords(), width(width), height(height), x0(0), y0(0),
+      generation(0), rule(), plane_neighbours(), torus_neighbours()
+{
+    MPI_Comm_size(communicator, &ranks);
+
+    // Dims come out largest first, so split the longer side between more ranks
+    int balanced[2] = {0, 0};
+    MPI_Dims_create(ranks, 2, balanced);
+
+    dims = {balanced[0], balanced[1]};
+
+    if (width < height)
+    {
+        std::swap(dims[0], dims[1]);
+    }
+
+    if ((dims[0] > 1 && width / ALIGNMENT < dims[0]) || (dims[1] > 1 && height / ALIGNMENT < dims[1]))
+    {
+        throw std::invalid_argument("ERROR: The world is too small to split between " + std::to_string(ranks) +
+                                    " ranks.");
+    }
+
+    // MPI orders the dimensions of a Cartesian communicator row major, so y comes first
+    const int cart_dims[2] = {dims[1], dims[0]};
+    const int periods[2] = {1, 1};
+    MPI_Cart_create(communicator, 2, cart_dims, periods, 1, &comm);
+    MPI_Comm_rank(comm, &rank);
+
+    int cart_coords[2];
+    MPI_Cart_coords(comm, rank, 2, cart_coords);
+    coords = {cart_coords[1], cart_coords[0]};
+
+    for (int direction = 0; direction < 8; direction++)
+    {
+        const int x = coords[0] + DIRECTIONS[direction][0];
+        const int y = coords[1] + DIRECTIONS[direction][1];
+        const int neighbour_coords[2] = {y, x};
+
+        // Coordinates past the edges wrap around, as the communicator is periodic
+        MPI_Cart_rank(comm, neighbour_coords, &torus_neighbours[direction]);
+
+        plane_neighbours[direction] = x < 0 || y < 0 || x >= dims[0] || y >= dims[1]
+                                      ? MPI_PROC_NULL : torus_neighbours[direction];
+    }
+
+    x0 = get_split(width, dims[0], coords[0]);
+    y0 = get_split(height, dims[1], coords[1]);
+
+    const int local_width = get_split(width, dims[0], coords[0] + 1) - x0;
+    const int local_height = get_split(height, dims[1], coords[1] + 1) - y0;
+
+    current_state = Grid(local_width, local_height);
+    next_state = Grid(local_width, local_height);
+    current_state.set_ghost_border(true);
+    next_state.set_ghost_border(true);
+
+    send_columns.resize(2 * static_cast<size_t>(local_height));
+    receive_columns.resize(2 * static_cast<size_t>(local_height));
+}
+
+/**
+ * DistributedWorld::DistributedWorld(communicator, initial_state)
+ *
+ * Construct a world using the size and values of a grid held whole by every rank, each rank keeping only its own
+ * block. Collective over the communicator.
+ *
+ * @example
+ *
+ *      // Split a pattern small enough to load on every rank
+ *      DistributedWorld world(MPI_COMM_WORLD, Zoo::load_rle("path/to/pattern.rle"));
+ *
+ * @param communicator
+ *      The communicator to split the world between.
+ *
+ * @param initial_state
+ *      The state of the constructed world, the same on every rank.
+ *
+ * @throws
+ *      Throws std::invalid_argument if the world is too small to split between the ranks.
+ */
+DistributedWorld::DistributedWorld(MPI_Comm communicator, const Grid &initial_state)
+    : DistributedWorld::DistributedWorld(communicator, initial_state.get_width(), initial_state.get_height())
+{
+    for (int y = 0; y < current_state.get_height(); y++)
+    {
+        std::memcpy(current_state.row(y), initial_state.row(y0 + y) + x0, current_state.get_width());
+    }
+}
+
+/**
+ * DistributedWorld::DistributedWorld(other)
+ *
+ * Construct a world by taking over the communicator and blocks of another, which is left holding nothing.
+ *
+ * @param other
+ *      The world to move from.
+ */
+DistributedWorld::DistributedWorld(DistributedWorld &&other) noexcept
+    : comm(other.comm), rank(other.rank), ranks(other.ranks), dims(other.dims), coords(other.coords),
+      width(other.width), height(other.height), x0(other.x0), y0(other.y0), generation(other.generation),
+      rule(other.rule), current_state(std::move(other.current_state)), next_state(std::move(other.next_state)),
+      plane_neighbours(other.plane_neighbours), torus_neighbours(other.torus_neighbours),
+      send_columns(std::move(other.send_columns)), receive_columns(std::move(other.receive_columns))
+{
+    other.comm = MPI_COMM_NULL;
+}
+
+/**
+ * DistributedWorld::~DistributedWorld()
+ *
+ * Free the communicator of the world, unless MPI has already been finalized.
+ */
+DistributedWorld::~DistributedWorld()
+{
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+
+    if (comm != MPI_COMM_NULL && !finalized)
+    {
+        MPI_Comm_free(&comm);
+    }
+}
+
+/**
+ * DistributedWorld::get_split(length, parts, index)
+ *
+ * Private helper function finding where a block starts when a side of the grid is split into parts, as evenly as
+ * possible while starting every block on a multiple of ALIGNMENT cells. The last block takes the remainder.
+ *
+ * @param length
+ *      The length of the side of the grid.
+ *
+ * @param parts
+ *      The number of blocks along the side.
+ *
+ * @param index
+ *      The index of the block, or parts for the end of the side.
+ *
+ * @return
+ *      The first cell of the block.
+ */
+int DistributedWorld::get_split(int length, int parts, int index)
+{
+    if (index >= parts)
+    {
+        return length;
+    }
+
+    return static_cast<long long>(length / ALIGNMENT) * index / parts * ALIGNMENT;
+}
+
+/**
+ * DistributedWorld::get_neighbour(direction, toroidal)
+ *
+ * Private helper function getting the rank holding a neighbouring block.
+ *
+ * @param direction
+ *      The index of the direction of the neighbour in DIRECTIONS.
+ *
+ * @param toroidal
+ *      If true then the blocks on the edges of the grid neighbour those on the opposite edges.
+ *
+ * @return
+ *      The rank of the neighbour, or MPI_PROC_NULL past the edges of the grid when not toroidal.
+ */
+int DistributedWorld::get_neighbour(int direction, bool toroidal) const
+{
+    return toroidal ? torus_neighbours[direction] : plane_neighbours[direction];
+}
+
+/**
+ * DistributedWorld::load_binary(communicator, path)
+ *
+ * Load a world from a binary file in the v1 or v2 format, every rank reading only its own block of the file.
+ * Collective over the communicator, and the file must be readable by every rank.
+ *
+ * @example
+ *
+ *      // Load a board too big to load whole on any one machine
+ *      DistributedWorld world = DistributedWorld::load_binary(MPI_COMM_WORLD, "path/to/file.bgol");
+ *
+ * @param communicator
+ *      The communicator to split the world between.
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @return
+ *      The loaded world.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened or is invalid, or std::invalid_argument
+ *      if the world is too small to split between the ranks.
+ */
+DistributedWorld DistributedWorld::load_binary(MPI_Comm communicator, const std::string &path)
+{
+    int width = 0, height = 0;
+    Zoo::read_binary_size(path, width, height);
+
+    DistributedWorld world(communicator, width, height);
+
+    const Grid region = Zoo::load_binary_region(path, world.x0, world.y0,
+                                                world.x0 + world.current_state.get_width(),
+                                                world.y0 + world.current_state.get_height());
+
+    for (int y = 0; y < region.get_height(); y++)
+    {
+        std::memcpy(world.current_state.row(y), region.row(y), region.get_width());
+    }
+
+    return world;
+}
+
+/**
+ * write_at(file, offset, data, size)
+ *
+ * Helper function writing bytes at an offset of a file opened with MPI-IO, in pieces small enough for the int
+ * counts of MPI.
+ *
+ * @return
+ *      True if every byte was written.
+ */
+static bool write_at(MPI_File file, uint64_t offset, const char *data, size_t size)
+{
+    const size_t piece = 1 << 30;
+
+    for (size_t written = 0; written < size; written += piece)
+    {
+        const int count = static_cast<int>(std::min(piece, size - written));
+
+        if (MPI_File_write_at(file, offset + written, data + written, count, MPI_CHAR, MPI_STATUS_IGNORE) !=
+            MPI_SUCCESS)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * DistributedWorld::save_binary(path)
+ *
+ * Save the world to a single binary file in the v2 format, every rank writing only its own block of the file.
+ * Collective over the communicator.
+ *
+ * Each rank encodes the tiles of its block, ALIGNMENT cells wide, then the ranks sum the sizes of their index
+ * entries and blocks so that each knows where its own go, after the header and those of the ranks before it.
+ *
+ * @example
+ *
+ *      // Save a checkpoint of the world
+ *      world.save_binary("path/to/file.bgol");
+ *
+ * @param path
+ *      The std::string path to the file to write to, on a file system shared by every rank.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened or written, or there are too many tiles
+ *      holding alive cells to count in the index.
+ */
+void DistributedWorld::save_binary(const std::string &path) const
+{
+    const Zoo::BinaryPart part = Zoo::encode_binary_part(current_state, x0, y0, width, height, ALIGNMENT);
+
+    // The tiles and block bytes of this rank, those of the ranks before it, and those of every rank
+    const uint64_t counts[2] = {part.tiles.size(), part.blocks.size()};
+    uint64_t before[2] = {0, 0}, totals[2] = {0, 0};
+
+    MPI_Exscan(counts, before, 2, MPI_UINT64_T, MPI_SUM, comm);
+    MPI_Allreduce(counts, totals, 2, MPI_UINT64_T, MPI_SUM, comm);
+
+    // The result of the scan is undefined on the first rank
+    if (rank == 0)
+    {
+        before[0] = before[1] = 0;
+    }
+
+    const uint64_t blocks_start = Zoo::BINARY_HEADER_SIZE + totals[0] * Zoo::BINARY_ENTRY_SIZE;
+    const uint64_t blocks_offset = blocks_start + before[1];
+
+    std::ostringstream header, index;
+    Zoo::write_binary_header(header, width, height, ALIGNMENT, totals[0]);
+    Zoo::write_binary_index(index, part, blocks_offset);
+
+    MPI_File file;
+
+    if (MPI_File_open(comm, path.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS)
+    {
+        throw std::runtime_error("ERROR: Cannot write to file '" + path + "'.");
+    }
+
+    // Cut off anything left past the end by a longer file saved to the same path before
+    bool written = MPI_File_set_size(file, blocks_start + totals[1]) == MPI_SUCCESS;
+
+    if (rank == 0)
+    {
+        written &= write_at(file, 0, header.str().data(), header.str().size());
+    }
+
+    written &= write_at(file, Zoo::BINARY_HEADER_SIZE + before[0] * Zoo::BINARY_ENTRY_SIZE, index.str().data(),
+                        index.str().size());
+    written &= write_at(file, blocks_offset, part.blocks.data(), part.blocks.size());
+
+    if (MPI_File_close(&file) != MPI_SUCCESS || !written)
+    {
+        throw std::runtime_error("ERROR: Cannot write to file '" + path + "'.");
+    }
+}
+
+/**
+ * DistributedWorld::get_rank()
+ *
+ * Gets the rank of the calling process within the communicator of the world, which may differ from its rank in
+ * the communicator the world was constructed with.
+ *
+ * @return
+ *      The rank of the calling process.
+ */
+int DistributedWorld::get_rank() const
+{
+    return rank;
+}
+
+/**
+ * DistributedWorld::get_ranks()
+ *
+ * Gets the number of ranks the world is split between.
+ *
+ * @return
+ *      The number of ranks.
+ */
+int DistributedWorld::get_ranks() const
+{
+    return ranks;
+}
+
+/**
+ * DistributedWorld::get_width()
+ *
+ * Gets the width of the whole world.
+ *
+ * @return
+ *      The width of the world.
+ */
+int DistributedWorld::get_width() const
+{
+    return width;
+}
+
+/**
+ * DistributedWorld::get_height()
+ *
+ * Gets the height of the whole world.
+ *
+ * @return
+ *      The height of the world.
+ */
+int DistributedWorld::get_height() const
+{
+    return height;
+}
+
+/**
+ * DistributedWorld::get_total_cells()
+ *
+ * Gets the number of cells in the whole world, which may be more than an int can count.
+ *
+ * @return
+ *      The width multiplied by the height.
+ */
+uint64_t DistributedWorld::get_total_cells() const
+{
+    return static_cast<uint64_t>(width) * height;
+}
+
+/**
+ * DistributedWorld::get_alive_cells()
+ *
+ * Counts the alive cells of the whole world, summing the counts of every block with a reduction.
+ * Collective over the communicator.
+ *
+ * @return
+ *      The number of alive cells, the same on every rank.
+ */
+uint64_t DistributedWorld::get_alive_cells() const
+{
+    const uint64_t local = current_state.get_alive_cells();
+    uint64_t total = 0;
+
+    MPI_Allreduce(&local, &total, 1, MPI_UINT64_T, MPI_SUM, comm);
+
+    return total;
+}
+
+/**
+ * DistributedWorld::get_dead_cells()
+ *
+ * Counts the dead cells of the whole world. Collective over the communicator.
+ *
+ * @return
+ *      The number of dead cells, the same on every rank.
+ */
+uint64_t DistributedWorld::get_dead_cells() const
+{
+    return get_total_cells() - get_alive_cells();
+}
+
+/**
+ * DistributedWorld::get_local_x()
+ *
+ * Gets the left coordinate of this rank's block within the world.
+ *
+ * @return
+ *      The x coordinate of the first column of the block.
+ */
+int DistributedWorld::get_local_x() const
+{
+    return x0;
+}
+
+/**
+ * DistributedWorld::get_local_y()
+ *
+ * Gets the top coordinate of this rank's block within the world.
+ *
+ * @return
+ *      The y coordinate of the first row of the block.
+ */
+int DistributedWorld::get_local_y() const
+{
+    return y0;
+}
+
+/**
+ * DistributedWorld::get_local_state()
+ *
+ * Gets the current state of this rank's block, with cell (0, 0) at (get_local_x(), get_local_y()) in the world.
+ *
+ * @return
+ *      A reference to the current state of the block.
+ */
+const Grid &DistributedWorld::get_local_state() const
+{
+    return current_state;
+}
+
+/**
+ * DistributedWorld::set(x, y, value)
+ *
+ * Set the value of a cell of the world, if it lies within this rank's block. Every rank can make the same calls,
+ * and only the rank holding each cell stores it, or each rank can set only the cells of its own block.
+ *
+ * @example
+ *
+ *      // Fill the block of every rank with a random soup
+ *      for (int y = world.get_local_y(); y < world.get_local_y() + world.get_local_state().get_height(); y++) {
+ *          for (int x = world.get_local_x(); x < world.get_local_x() + world.get_local_state().get_width(); x++) {
+ *              world.set(x, y, random() % 3 == 0 ? Cell::ALIVE : Cell::DEAD);
+ *          }
+ *      }
+ *
+ * @param x
+ *      The x coordinate of the cell within the world.
+ *
+ * @param y
+ *      The y coordinate of the cell within the world.
+ *
+ * @param value
+ *      The value to set the cell to.
+ */
+void DistributedWorld::set(int x, int y, const Cell value)
+{
+    if (x >= x0 && y >= y0 && x - x0 < current_state.get_width() && y - y0 < current_state.get_height())
+    {
+        current_state.set(x - x0, y - y0, value);
+    }
+}
+
+/**
+ * DistributedWorld::gather_state(root)
+ *
+ * Gather the current state of every block into one grid on a single rank, for worlds small enough to fit on it.
+ * Collective over the communicator.
+ *
+ * @example
+ *
+ *      // Print a small world from the first rank
+ *      Grid state = world.gather_state();
+ *
+ *      if (world.get_rank() == 0) {
+ *          std::cout << state << std::endl;
+ *      }
+ *
+ * @param root
+ *      Optional parameter. The rank to gather the state on. Defaults to 0.
+ *
+ * @return
+ *      The whole state on the root rank, and an empty grid on every other rank.
+ *
+ * @throws
+ *      Throws std::range_error if the world has too many cells to gather into one grid.
+ */
+Grid DistributedWorld::gather_state(int root) const
+{
+    if (get_total_cells() > INT_MAX)
+    {
+        throw std::range_error("ERROR: The world is too large to gather into one grid.");
+    }
+
+    const int local_width = current_state.get_width();
+    const int local_height = current_state.get_height();
+
+    // The rows of a block are not contiguous in the state, so pack them first
+    std::vector<Cell> block(static_cast<size_t>(local_width) * local_height);
+
+    for (int y = 0; y < local_height; y++)
+    {
+        std::copy(current_state.row(y), current_state.row(y) + local_width, block.begin() + y * local_width);
+    }
+
+    const int count = static_cast<int>(block.size());
+    std::vector<int> counts(rank == root ? ranks : 0), offsets(rank == root ? ranks : 0);
+    std::vector<Cell> blocks(rank == root ? get_total_cells() : 0);
+
+    MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, root, comm);
+
+    for (int i = 1; i < static_cast<int>(offsets.size()); i++)
+    {
+        offsets[i] = offsets[i - 1] + counts[i - 1];
+    }
+
+    MPI_Gatherv(block.data(), count, MPI_CHAR, blocks.data(), counts.data(), offsets.data(), MPI_CHAR, root, comm);
+
+    if (rank != root)
+    {
+        return Grid();
+    }
+
+    Grid state(width, height);
+
+    for (int i = 0; i < ranks; i++)
+    {
+        int cart_coords[2];
+        MPI_Cart_coords(comm, i, 2, cart_coords);
+
+        const int left = get_split(width, dims[0], cart_coords[1]);
+        const int right = get_split(width, dims[0], cart_coords[1] + 1);
+        const int top = get_split(height, dims[1], cart_coords[0]);
+        const int bottom = get_split(height, dims[1], cart_coords[0] + 1);
+
+        for (int y = top; y < bottom; y++)
+        {
+            std::copy(blocks.begin() + offsets[i] + (y - top) * (right - left),
+                      blocks.begin() + offsets[i] + (y - top + 1) * (right - left), state.row(y) + left);
+        }
+    }
+
+    return state;
+}
+
+/**
+ * DistributedWorld::get_generation()
+ *
+ * Gets the number of steps the world has taken since it was made.
+ *
+ * @return
+ *      The generation of the current state.
+ */
+uint64_t DistributedWorld::get_generation() const
+{
+    return generation;
+}
+
+/**
+ * DistributedWorld::set_generation(new_generation)
+ *
+ * Set the generation of the current state, such as when resuming from a saved world.
+ *
+ * @param new_generation
+ *      The generation of the current state.
+ */
+void DistributedWorld::set_generation(uint64_t new_generation)
+{
+    generation = new_generation;
+}
+
+/**
+ * DistributedWorld::get_rule()
+ *
+ * Gets the rule the world is simulated with.
+ *
+ * @return
+ *      A reference to the rule of the world.
+ */
+const Rule &DistributedWorld::get_rule() const
+{
+    return rule;
+}
+
+/**
+ * DistributedWorld::set_rule(new_rule)
+ *
+ * Set the rule the world is simulated with from the next step onwards, which must be the same on every rank.
+ *
+ * @param new_rule
+ *      The rule to simulate.
+ */
+void DistributedWorld::set_rule(const Rule &new_rule)
+{
+    rule = new_rule;
+}
+
+/**
+ * DistributedWorld::step_cells(left, top, right, bottom)
+ *
+ * Private helper function computing the next state of a rectangle of the block, [left, right) by [top, bottom),
+ * with the row kernel of Engine::SIMD. Every neighbour of the rectangle must already be in the current state.
+ */
+void DistributedWorld::step_cells(int left, int top, int right, int bottom)
+{
+    if (left >= right)
+    {
+        return;
+    }
+
+    const Simd::RowKernel sweep = Simd::get_row_kernel();
+
+    for (int y = top; y < bottom; y++)
+    {
+        sweep(current_state.raw_row(y - 1), current_state.raw_row(y), current_state.raw_row(y + 1),
+              next_state.raw_row(y), left, right, rule);
+    }
+}
+
+/**
+ * DistributedWorld::step(toroidal)
+ *
+ * Take one step in the Game of Life, or the rule set by DistributedWorld::set_rule. Collective over the
+ * communicator.
+ *
+ * The edges of the block are sent to the 8 neighbouring blocks, and theirs received into the ghost border, without
+ * blocking. The interior of the block is computed while the messages are in flight, then the outer ring of the
+ * block once they have all arrived. The grids are then swapped.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the world as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ */
+void DistributedWorld::step(bool toroidal)
+{
+    const int local_width = current_state.get_width();
+    const int local_height = current_state.get_height();
+
+    // Every block is empty at once, as they all span the whole of an empty side
+    if (local_width > 0 && local_height > 0)
+    {
+        for (int y = 0; y < local_height; y++)
+        {
+            send_columns[y] = current_state.raw_row(y)[0];
+            send_columns[local_height + y] = current_state.raw_row(y)[local_width - 1];
+        }
+
+        MPI_Request requests[16];
+
+        for (int direction = 0; direction < 8; direction++)
+        {
+            const int dx = DIRECTIONS[direction][0];
+            const int dy = DIRECTIONS[direction][1];
+            const int neighbour = get_neighbour(direction, toroidal);
+
+            // Each halo either lies along a row of the ghost border, or is packed along with the other column
+            Cell *halo;
+            const Cell *edge;
+            int count = 1;
+
+            if (dy == 0)
+            {
+                halo = receive_columns.data() + (dx < 0 ? 0 : local_height);
+                edge = send_columns.data() + (dx < 0 ? 0 : local_height);
+                count = local_height;
+            }
+            else
+            {
+                halo = current_state.raw_row(dy < 0 ? -1 : local_height);
+                edge = current_state.raw_row(dy < 0 ? 0 : local_height - 1);
+
+                if (dx == 0)
+                {
+                    count = local_width;
+                }
+                else
+                {
+                    halo += dx < 0 ? -1 : local_width;
+                    edge += dx < 0 ? 0 : local_width - 1;
+                }
+            }
+
+            // Nothing is received past the edges of a world which is not toroidal
+            if (neighbour == MPI_PROC_NULL)
+            {
+                std::fill(halo, halo + count, Cell::DEAD);
+            }
+
+            // Tagged with the direction travelled, so two halos between the same ranks are never mixed up
+            MPI_Irecv(halo, count, MPI_CHAR, neighbour, 7 - direction, comm, &requests[direction]);
+            MPI_Isend(edge, count, MPI_CHAR, neighbour, direction, comm, &requests[8 + direction]);
+        }
+
+        step_cells(1, 1, local_width - 1, local_height - 1);
+
+        MPI_Waitall(16, requests, MPI_STATUSES_IGNORE);
+
+        for (int y = 0; y < local_height; y++)
+        {
+            current_state.raw_row(y)[-1] = receive_columns[y];
+            current_state.raw_row(y)[local_width] = receive_columns[local_height + y];
+        }
+
+        step_cells(0, 0, local_width, 1);
+        step_cells(0, std::max(local_height - 1, 1), local_width, local_height);
+        step_cells(0, 1, 1, local_height - 1);
+        step_cells(std::max(local_width - 1, 1), 1, local_width, local_height - 1);
+
+        // The kernels write rows without keeping count, so the new state must be counted again if asked
+        std::swap(current_state, next_state);
+        current_state.set_cached_alive_cells(-1);
+    }
+
+    generation++;
+}
+
+/**
+ * DistributedWorld::advance(steps, toroidal)
+ *
+ * Advance multiple steps. Collective over the communicator.
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the world as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ */
+void DistributedWorld::advance(int steps, bool toroidal)
+{
+    for (int i = 0; i < steps; i++)
+    {
+        step(toroidal);
+    }
+}
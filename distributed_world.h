@@ -0,0 +1,102 @@
+/**
+ * Declares a class representing a 2d grid world split between the processes of an MPI communicator.
+ * Rich documentation for the api and behaviour the DistributedWorld class can be found in distributed_world.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include "grid.h"
+#include "rule.h"
+
+/**
+ * Declare the structure of the DistributedWorld class for representing a 2d grid world too big for one machine.
+ *
+ * The grid is split into a 2d Cartesian arrangement of blocks, one per rank of the communicator. Each rank holds
+ * the current and next state of only its own block, as two Grid objects with a ghost border one cell wide which
+ * is filled with the edges of the 8 neighbouring blocks before each step.
+ *
+ * Every member function which involves more than the calling rank is collective, and must be called by every
+ * rank of the communicator in the same order.
+ */
+class DistributedWorld
+{
+    private:
+        // The 8 neighbouring blocks, as steps along x and y, ordered so the opposite of direction d is 7 - d
+        static const std::array<std::array<int, 2>, 8> DIRECTIONS;
+
+        MPI_Comm comm; // Cartesian communicator, periodic in both dimensions
+        int rank;
+        int ranks;
+        std::array<int, 2> dims; // Ranks along x and y
+        std::array<int, 2> coords; // Position of this rank's block along x and y
+
+        int width;
+        int height;
+        int x0;
+        int y0;
+        uint64_t generation;
+        Rule rule;
+
+        Grid current_state;
+        Grid next_state;
+
+        std::array<int, 8> plane_neighbours; // MPI_PROC_NULL past the edges of the grid
+        std::array<int, 8> torus_neighbours;
+
+        std::vector<Cell> send_columns; // The left and right edge columns, packed one after the other
+        std::vector<Cell> receive_columns;
+
+        static int get_split(int length, int parts, int index);
+
+        int get_neighbour(int direction, bool toroidal) const;
+        void step_cells(int x0, int y0, int x1, int y1);
+
+    public:
+        // Blocks start on a multiple of this many cells, so each rank saves whole tiles of a v2 binary file
+        static const int ALIGNMENT = 64;
+
+        DistributedWorld(MPI_Comm communicator, int width, int height);
+        DistributedWorld(MPI_Comm communicator, const Grid &initial_state);
+        DistributedWorld(DistributedWorld &&other) noexcept;
+        ~DistributedWorld();
+
+        DistributedWorld(const DistributedWorld &) = delete;
+        DistributedWorld &operator=(const DistributedWorld &) = delete;
+        DistributedWorld &operator=(DistributedWorld &&) = delete;
+
+        static DistributedWorld load_binary(MPI_Comm communicator, const std::string &path);
+        void save_binary(const std::string &path) const;
+
+        int get_rank() const;
+        int get_ranks() const;
+
+        int get_width() const;
+        int get_height() const;
+        uint64_t get_total_cells() const;
+        uint64_t get_alive_cells() const;
+        uint64_t get_dead_cells() const;
+
+        int get_local_x() const;
+        int get_local_y() const;
+        const Grid &get_local_state() const;
+        void set(int x, int y, const Cell value);
+        Grid gather_state(int root = 0) const;
+
+        uint64_t get_generation() const;
+        void set_generation(uint64_t new_generation);
+
+        const Rule &get_rule() const;
+        void set_rule(const Rule &new_rule);
+
+        void step(bool toroidal = false);
+        void advance(int steps, bool toroidal = false);
+};
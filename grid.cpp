@@ -2,8 +2,23 @@
  * Implements a class representing a 2d grid of cells.
  *      - New cells are initialized to Cell::DEAD.
  *      - Grids can be resized while retaining their contents in the remaining area.
- *      - Grids can be rotated, cropped, and merged together.
+ *      - Grids can be rotated, flipped, cropped, and merged together.
+ *          - Rotations and flips can be written into an existing grid, reusing its allocation.
+ *          - Crops and merges copy whole rows at a time, and many patterns can be merged in a single pass.
+ *      - Grids can reserve capacity to grow into.
+ *          - Rows are laid out one allocated row apart, and the padding past the edges is always dead.
+ *          - Resizing within the capacity moves no cells, growing is free and shrinking clears the cut off cells.
+ *      - Grids can optionally be surrounded by a ghost border one cell wide.
+ *          - The ghost cells are filled with the opposite edges or with dead cells before a stencil runs, so it
+ *            can read the neighbours of the edge cells in the same way as any other.
+ *      - Grids allocate their cells from a pluggable std::pmr::memory_resource.
+ *          - By default every grid is allocated from Memory::get_aligned_resource(), so rows start on a cache line
+ *            and large boards are backed by huge pages.
+ *          - Temporary grids can be drawn from the recycled blocks of Memory::get_scratch_resource() instead,
+ *            including the results of Grid::crop and Grid::rotate.
+ *      - Grids can be moved without copying their cells, leaving the moved from grid empty.
  *      - Grids can return counts of the alive and dead cells.
+ *          - The alive count is cached between writes and recounted with a vectorized population count.
  *      - Grids can be serialized directly to an ascii std::ostream.
  *
  * You are encouraged to use STL container types as an underlying storage mechanism for the grid cells.
@@ -11,10 +26,16 @@
  * @author 961500
  * @date April, 2020
  */
-#include <cmath>
+#include <algorithm>
+#include <iterator>
+#include <map>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
 #include "grid.h"
+#include "memory_pool.h"
+#include "simd_kernels.h"
 
 /**
  * Grid::Grid()
@@ -56,7 +77,7 @@ Grid::Grid() : Grid::Grid(0) {}
 Grid::Grid(int square_size) : Grid::Grid(square_size, square_size) {}
 
 /**
- * Grid::Grid(width, height)
+ * Grid::Grid(width, height, resource)
  *
  * Construct a grid with the desired size filled with dead cells.
  *
@@ -65,13 +86,104 @@ Grid::Grid(int square_size) : Grid::Grid(square_size, square_size) {}
  *      // Make a 16x9 grid
  *      Grid grid(16, 9);
  *
+ *      // Make a temporary 16x9 grid from the recycled memory of this thread
+ *      Grid scratch(16, 9, Memory::get_scratch_resource());
+ *
  * @param width
  *      The width of the grid.
  *
  * @param height
  *      The height of the grid.
+ *
+ * @param resource
+ *      Optional parameter. The memory resource to allocate the cells from, which must outlive the grid.
+ *      Defaults to Memory::get_aligned_resource().
  */
-Grid::Grid(int width, int height) : width(width), height(height), cells(width * height, Cell::DEAD) {}
+Grid::Grid(int width, int height, std::pmr::memory_resource *resource)
+    : width(width), height(height), capacity_width(width), capacity_height(height), border(0), pitch(width), origin(0),
+      cells(width * height, Cell::DEAD, resource ? resource : Memory::get_aligned_resource()), alive_cells(0) {}
+
+/**
+ * Grid::Grid(other, resource)
+ *
+ * Construct a copy of a grid, including its capacity and ghost border.
+ * The copy allocates from the aligned resource rather than the resource of the other grid unless told otherwise,
+ * so copying a scratch grid gives a grid which is safe to keep.
+ *
+ * @param other
+ *      The grid to copy.
+ *
+ * @param resource
+ *      Optional parameter. The memory resource to allocate the cells from, which must outlive the grid.
+ *      Defaults to Memory::get_aligned_resource().
+ */
+Grid::Grid(const Grid &other, std::pmr::memory_resource *resource)
+    : width(other.width), height(other.height), capacity_width(other.capacity_width),
+      capacity_height(other.capacity_height), border(other.border), pitch(other.pitch), origin(other.origin),
+      cells(other.cells, resource ? resource : Memory::get_aligned_resource()), alive_cells(other.alive_cells) {}
+
+/**
+ * Grid::Grid(other)
+ *
+ * Construct a grid by taking over the cells of another grid, including its capacity, ghost border and memory
+ * resource, without copying them. The other grid is left as an empty 0x0 grid.
+ *
+ * @param other
+ *      The grid to move from.
+ */
+Grid::Grid(Grid &&other) noexcept
+    : width(other.width), height(other.height), capacity_width(other.capacity_width),
+      capacity_height(other.capacity_height), border(other.border), pitch(other.pitch), origin(other.origin),
+      cells(std::move(other.cells)), alive_cells(other.alive_cells)
+{
+    other.release();
+}
+
+/**
+ * Grid::operator=(other)
+ *
+ * Take over the cells of another grid, as Grid::Grid(other) does, leaving the other grid as an empty 0x0 grid.
+ * The grid keeps its own memory resource, so the cells are only copied if the other grid allocates from a
+ * different resource.
+ *
+ * @param other
+ *      The grid to move from.
+ *
+ * @return
+ *      A reference to this grid.
+ */
+Grid &Grid::operator=(Grid &&other)
+{
+    if (this != &other)
+    {
+        width = other.width;
+        height = other.height;
+        capacity_width = other.capacity_width;
+        capacity_height = other.capacity_height;
+        border = other.border;
+        pitch = other.pitch;
+        origin = other.origin;
+        cells = std::move(other.cells);
+        alive_cells = other.alive_cells;
+
+        other.release();
+    }
+
+    return *this;
+}
+
+/**
+ * Grid::get_memory_resource()
+ *
+ * Gets the memory resource the cells are allocated from.
+ *
+ * @return
+ *      A pointer to the resource.
+ */
+std::pmr::memory_resource *Grid::get_memory_resource() const
+{
+    return cells.get_allocator().resource();
+}
 
 /**
  * Grid::get_width()
@@ -163,6 +275,9 @@ int Grid::get_total_cells() const
  * Counts how many cells in the grid are alive.
  * The function should be callable from a constant context.
  *
+ * The count is cached, so the grid is only scanned again after it has been modified other than through
+ * Grid::set. The scan uses Simd::count_alive, the fastest population count the CPU supports.
+ *
  * @example
  *
  *      // Make a grid
@@ -182,17 +297,28 @@ int Grid::get_total_cells() const
  */
 int Grid::get_alive_cells() const
 {
-    int count = 0;
-
-    for (int i = 0; i < get_total_cells(); i++)
+    if (alive_cells < 0)
     {
-        if (cells[i] == Cell::ALIVE)
+        if (border == 0)
+        {
+            // Padding past the edges of the grid is always dead, so whole rows of the allocation can be counted at once
+            alive_cells = static_cast<int>(Simd::count_alive(cells.data(), static_cast<size_t>(pitch) * height));
+        }
+        else
         {
-            count++;
+            // The ghost cells between the rows may hold copies of the edges, so only count the rows themselves
+            size_t count = 0;
+
+            for (int y = 0; y < height; y++)
+            {
+                count += Simd::count_alive(row(y), width);
+            }
+
+            alive_cells = static_cast<int>(count);
         }
     }
 
-    return count;
+    return alive_cells;
 }
 
 /**
@@ -200,6 +326,7 @@ int Grid::get_alive_cells() const
  *
  * Counts how many cells in the grid are dead.
  * The function should be callable from a constant context.
+ * Derived from the cached count of alive cells, as every cell is either dead or alive, rather than a second scan.
  *
  * @example
  *
@@ -220,17 +347,7 @@ int Grid::get_alive_cells() const
  */
 int Grid::get_dead_cells() const
 {
-    int count = 0;
-
-    for (int i = 0; i < get_total_cells(); i++)
-    {
-        if (cells[i] == Cell::DEAD)
-        {
-            count++;
-        }
-    }
-
-    return count;
+    return get_total_cells() - get_alive_cells();
 }
 
 /**
@@ -261,6 +378,9 @@ void Grid::resize(int square_size)
  * Resize the current grid to a new width and height. The content of the grid
  * should be preserved within the kept region and padded with Grid::DEAD if new cells are added.
  *
+ * Within the capacity of the grid no cells are moved and nothing is allocated. Outgrowing it reallocates to fit
+ * the new size exactly, so use Grid::reserve before growing a grid a little at a time.
+ *
  * @example
  *
  *      // Make a grid
@@ -280,85 +400,278 @@ void Grid::resize(int new_width, int new_height)
     // Sanity check; skip everything if no values change
     if (new_width != width || new_height != height)
     {
-        if (get_total_cells() == 0) // If grid is only default constructed
+        // Ghost cells would otherwise be uncovered as live cells by growing
+        clear_ghost_border();
+
+        if (new_width > capacity_width || new_height > capacity_height)
         {
-            cells.resize(new_width * new_height, Cell::DEAD);
+            // Outgrown the allocation, so move the kept region into a larger one
+            reallocate(std::max(new_width, capacity_width), std::max(new_height, capacity_height),
+                       std::min(width, new_width), std::min(height, new_height), border);
         }
-        else if (new_width > width && new_height > height) // When adding both rows and columns
+        else
         {
-            std::vector<Cell> new_cells(new_width * new_height, Cell::DEAD);
-
-            int y, new_index = 0;
-
-            // For all cells in old grid
-            for (int i = 0; i < get_total_cells(); i++)
+            // Within capacity the cells past each edge are already dead, so growing is free, and shrinking only
+            // has to clear the cells which fall outside the grid
+            if (new_width < width)
             {
-                // Derive old grid's y coordinate
-                y = floor(i / width);
-
-                // Calculate new index value
-                new_index = i + y * (new_width - width);
-
-                // Transfer cell to new grid
-                new_cells[new_index] = cells[i];
+                for (int y = 0; y < std::min(height, new_height); y++)
+                {
+                    std::fill(raw_row(y) + new_width, raw_row(y) + width, Cell::DEAD);
+                }
             }
 
-            cells = new_cells;
-        }
-        else
-        {
-            // When adding or removing rows
-            if (new_height != height)
+            for (int y = new_height; y < height; y++)
             {
-                cells.resize(new_width * new_height, Cell::DEAD);
+                std::fill(raw_row(y), raw_row(y) + width, Cell::DEAD);
             }
+        }
 
-            // When adding columns
-            if (new_width > width)
-            {
-                // Create replacement cell vector
-                std::vector<Cell> new_cells(new_width * new_height, Cell::DEAD);
+        // Only cells being cut off can change the count
+        if (new_width < width || new_height < height)
+        {
+            alive_cells = -1;
+        }
 
-                int y = 0;
+        width = new_width;
+        height = new_height;
+    }
+}
 
-                // For all cells in new grid
-                for (int i = 0; i < (new_width * new_height); i++)
-                {
-                    // Derive old grid's y coordinate
-                    y = floor(i / new_width);
+/**
+ * Grid::reserve(capacity_width, capacity_height)
+ *
+ * Allocate room for the grid to grow up to the given size, so later calls to Grid::resize within it move no
+ * cells and make no allocations. The size and contents of the grid are unchanged, and the capacity never shrinks.
+ *
+ * @example
+ *
+ *      // Make a grid which is going to grow a row at a time
+ *      Grid grid(64, 1);
+ *      grid.reserve(64, 4096);
+ *
+ *      for (int y = 2; y <= 4096; y++)
+ *      {
+ *          grid.resize(64, y);
+ *      }
+ *
+ * @param new_capacity_width
+ *      The widest the grid can grow to without reallocating.
+ *
+ * @param new_capacity_height
+ *      The tallest the grid can grow to without reallocating.
+ */
+void Grid::reserve(int new_capacity_width, int new_capacity_height)
+{
+    if (new_capacity_width > capacity_width || new_capacity_height > capacity_height)
+    {
+        reallocate(std::max(new_capacity_width, capacity_width), std::max(new_capacity_height, capacity_height),
+                   width, height, border);
+    }
+}
 
-                    // Transfer cell to new grid
-                    new_cells[i] = cells[i - y];
-                }
+/**
+ * Grid::get_capacity_width()
+ *
+ * Gets how wide the grid can grow without reallocating.
+ *
+ * @return
+ *      The number of cells allocated per row.
+ */
+int Grid::get_capacity_width() const
+{
+    return capacity_width;
+}
 
-                cells = new_cells;
-            }
+/**
+ * Grid::get_capacity_height()
+ *
+ * Gets how tall the grid can grow without reallocating.
+ *
+ * @return
+ *      The number of rows allocated.
+ */
+int Grid::get_capacity_height() const
+{
+    return capacity_height;
+}
 
-            // When removing columns
-            if (new_width < width)
-            {
-                // Create replacement cell vector
-                std::vector<Cell> new_cells(new_width * new_height, Cell::DEAD);
+/**
+ * Grid::get_allocated_bytes()
+ *
+ * @return
+ *      The bytes of memory held for the cells, including the ghost border and the padding of each row.
+ */
+size_t Grid::get_allocated_bytes() const
+{
+    return cells.capacity() * sizeof(Cell);
+}
+
+/**
+ * Grid::release()
+ *
+ * Private helper function freeing the cells and leaving an empty 0x0 grid with no ghost border, such as after
+ * the cells have been moved to another grid. The memory resource is kept.
+ */
+void Grid::release()
+{
+    width = 0;
+    height = 0;
+    capacity_width = 0;
+    capacity_height = 0;
+    border = 0;
+    pitch = 0;
+    origin = 0;
+    std::pmr::vector<Cell>(cells.get_allocator()).swap(cells);
+    alive_cells = 0;
+}
 
-                int y = 0;
+/**
+ * Grid::reallocate(new_capacity_width, new_capacity_height, kept_width, kept_height, new_border)
+ *
+ * Private helper function moving the cells into a new allocation of the given capacity, copying the top left
+ * region which is kept one row at a time. Every other cell of the new allocation is dead.
+ *
+ * @param new_capacity_width
+ *      The widest the grid can grow to in the new allocation.
+ *
+ * @param new_capacity_height
+ *      The tallest the grid can grow to in the new allocation.
+ *
+ * @param kept_width
+ *      The width of the region to keep, at most the current and new widths.
+ *
+ * @param kept_height
+ *      The height of the region to keep, at most the current and new heights.
+ *
+ * @param new_border
+ *      The width of the ghost border to leave around the grid, 0 or 1.
+ */
+void Grid::reallocate(int new_capacity_width, int new_capacity_height, int kept_width, int kept_height, int new_border)
+{
+    const int new_pitch = new_capacity_width + 2 * new_border;
+    const int new_origin = new_border * new_pitch + new_border;
 
-                // For all cells in new grid
-                for (int i = 0; i < (new_width * new_height); i++)
-                {
-                    // Derive old grid's y-coordinate
-                    y = floor(i / new_width);
+    // Allocated from the same resource, so the buffers can be swapped
+    std::pmr::vector<Cell> new_cells(static_cast<size_t>(new_pitch) * (new_capacity_height + 2 * new_border), Cell::DEAD,
+                                     cells.get_allocator());
 
-                    // Transfer cell to new grid
-                    new_cells[i] = cells[i - y * (new_width - width)];
-                }
+    for (int y = 0; y < kept_height; y++)
+    {
+        std::copy(raw_row(y), raw_row(y) + kept_width, new_cells.data() + new_origin + static_cast<size_t>(y) * new_pitch);
+    }
 
-                cells = new_cells;
-            }
-        }
+    cells.swap(new_cells);
+    capacity_width = new_capacity_width;
+    capacity_height = new_capacity_height;
+    border = new_border;
+    pitch = new_pitch;
+    origin = new_origin;
+}
 
-        width = new_width;
-        height = new_height;
+/**
+ * Grid::has_ghost_border()
+ *
+ * Gets whether the grid is surrounded by a ring of ghost cells, see Grid::set_ghost_border(enabled).
+ *
+ * @return
+ *      True if the cells one step outside each edge of the grid can be read through Grid::row(y).
+ */
+bool Grid::has_ghost_border() const
+{
+    return border != 0;
+}
+
+/**
+ * Grid::set_ghost_border(enabled)
+ *
+ * Surround the grid with a ring of ghost cells one cell wide, or remove it.
+ *
+ * The ghost cells sit just outside each edge, so row(-1) and row(get_height()) are valid rows, and each row can
+ * be read from index -1 up to get_width(). They are not part of the grid, and are only ever written by
+ * Grid::refresh_ghost_border(toroidal), letting a stencil sweep every cell of the grid in the same way.
+ *
+ * @example
+ *
+ *      // Sweep a torus with no special cases at the edges
+ *      grid.set_ghost_border(true);
+ *      grid.refresh_ghost_border(true);
+ *
+ *      for (int y = 0; y < grid.get_height(); y++)
+ *      {
+ *          const Cell *above = grid.row(y - 1);
+ *          ...
+ *      }
+ *
+ * @param enabled
+ *      True to add the ghost border, false to remove it.
+ */
+void Grid::set_ghost_border(bool enabled)
+{
+    if (enabled != has_ghost_border())
+    {
+        reallocate(capacity_width, capacity_height, width, height, enabled ? 1 : 0);
+    }
+}
+
+/**
+ * Grid::refresh_ghost_border(toroidal)
+ *
+ * Fill the ghost border with the cells a stencil should see beyond each edge. Does nothing without a border.
+ *      - When toroidal the ghost cells are copies of the opposite edges, including the corners.
+ *      - Otherwise they are all dead.
+ *
+ * Only the border is touched, so this costs time proportional to the perimeter of the grid.
+ *
+ * @param toroidal
+ *      If true then the grid is treated as a torus, where the left edge wraps to the right edge and the top to the
+ *      bottom.
+ */
+void Grid::refresh_ghost_border(bool toroidal)
+{
+    if (border == 0 || width == 0 || height == 0)
+    {
+        return;
+    }
+    else if (!toroidal)
+    {
+        clear_ghost_border();
+        return;
+    }
+
+    // Wrap the left and right edges of every row, then the top and bottom rows along with their new ghost cells
+    for (int y = 0; y < height; y++)
+    {
+        Cell *cells_row = raw_row(y);
+        cells_row[-1] = cells_row[width - 1];
+        cells_row[width] = cells_row[0];
+    }
+
+    std::copy(raw_row(height - 1) - 1, raw_row(height - 1) + width + 1, raw_row(-1) - 1);
+    std::copy(raw_row(0) - 1, raw_row(0) + width + 1, raw_row(height) - 1);
+}
+
+/**
+ * Grid::clear_ghost_border()
+ *
+ * Private helper function killing every cell of the ghost border, restoring the rule that every cell of the
+ * allocation outside the grid is dead. Does nothing without a border.
+ */
+void Grid::clear_ghost_border()
+{
+    if (border == 0)
+    {
+        return;
     }
+
+    for (int y = 0; y < height; y++)
+    {
+        raw_row(y)[-1] = Cell::DEAD;
+        raw_row(y)[width] = Cell::DEAD;
+    }
+
+    std::fill(raw_row(-1) - 1, raw_row(-1) + width + 1, Cell::DEAD);
+    std::fill(raw_row(height) - 1, raw_row(height) + width + 1, Cell::DEAD);
 }
 
 /**
@@ -379,7 +692,7 @@ void Grid::resize(int new_width, int new_height)
  */
 int Grid::get_index(int x, int y) const
 {
-    return x + (y * width);
+    return origin + x + (y * pitch);
 }
 
 /**
@@ -458,8 +771,14 @@ void Grid::set(int x, int y, Cell value)
     }
     else
     {
-        // Dereference cell and apply value
-        Cell &current_cell = operator()(x, y);
+        // Dereference cell without invalidating the alive count, which is updated in place instead
+        Cell &current_cell = cells[get_index(x, y)];
+
+        if (alive_cells >= 0)
+        {
+            alive_cells += (value == Cell::ALIVE) - (current_cell == Cell::ALIVE);
+        }
+
         current_cell = value;
     }
 }
@@ -469,6 +788,7 @@ void Grid::set(int x, int y, Cell value)
  *
  * Gets a modifiable reference to the value at the desired coordinate.
  * Should be implemented by invoking Grid::get_index(x, y).
+ * As the reference may be written through, the cached count of alive cells is invalidated.
  *
  * @example
  *
@@ -508,6 +828,7 @@ Cell &Grid::operator()(int x, int y)
     }
     else
     {
+        alive_cells = -1;
         return cells[get_index(x, y)];
     }
 }
@@ -556,7 +877,87 @@ const Cell &Grid::operator()(int x, int y) const
 }
 
 /**
- * Grid::crop(x0, y0, x1, y1)
+ * Grid::row(y)
+ *
+ * Gets a pointer to the first cell of a row, for kernels which sweep along whole rows at a time.
+ * The row holds get_width() consecutive cells, and the next row does not necessarily follow straight after it.
+ * Cells past the end of the row must not be written. No bounds checking is performed.
+ * As the row may be written through, the cached count of alive cells is invalidated.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      Grid grid(4, 4);
+ *
+ *      // Fill in the whole of row 2
+ *      Cell *cells = grid.row(2);
+ *      std::fill(cells, cells + grid.get_width(), Cell::ALIVE);
+ *
+ * @param y
+ *      The y coordinate of the row, which must be within the grid.
+ *
+ * @return
+ *      A modifiable pointer to the leftmost cell of the row.
+ */
+Cell *Grid::row(int y)
+{
+    alive_cells = -1;
+    return raw_row(y);
+}
+
+/**
+ * Grid::row(y)
+ *
+ * Gets a read-only pointer to the first cell of a row, for kernels which sweep along whole rows at a time.
+ * The row holds get_width() consecutive cells, and the next row does not necessarily follow straight after it.
+ * With a ghost border, rows -1 and get_height() and the cells either side of each row can be read too.
+ * No bounds checking is performed.
+ * The function should be callable from a constant context.
+ *
+ * @param y
+ *      The y coordinate of the row, which must be within the grid.
+ *
+ * @return
+ *      A read-only pointer to the leftmost cell of the row.
+ */
+const Cell *Grid::row(int y) const
+{
+    return cells.data() + get_index(0, y);
+}
+
+/**
+ * Grid::raw_row(y)
+ *
+ * Private helper function for the kernels of World, getting a modifiable pointer to the first cell of a row
+ * without invalidating the cached count of alive cells, so different threads can write separate rows at once.
+ * The count must be corrected afterwards with Grid::set_cached_alive_cells(count).
+ *
+ * @param y
+ *      The y coordinate of the row, which must be within the grid.
+ *
+ * @return
+ *      A modifiable pointer to the leftmost cell of the row.
+ */
+Cell *Grid::raw_row(int y)
+{
+    return cells.data() + get_index(0, y);
+}
+
+/**
+ * Grid::set_cached_alive_cells(count)
+ *
+ * Private helper function for World to record the number of alive cells after writing through Grid::raw_row.
+ *
+ * @param count
+ *      The number of alive cells, or -1 if it is not known and the grid must be counted again.
+ */
+void Grid::set_cached_alive_cells(int count)
+{
+    alive_cells = count;
+}
+
+/**
+ * Grid::crop(x0, y0, x1, y1, resource)
  *
  * Extract a sub-grid from a Grid.
  * The cropped grid spans the range [x0, x1) by [y0, y1) in the original grid.
@@ -582,6 +983,10 @@ const Cell &Grid::operator()(int x, int y) const
  * @param y1
  *      Bottom coordinate of the crop window on y-axis (1 greater than the largest index).
  *
+ * @param resource
+ *      Optional parameter. The memory resource to allocate the cropped grid from. Defaults to
+ *      Memory::get_aligned_resource().
+ *
  * @return
  *      A new grid of the cropped size containing the values extracted from the original grid.
  *
@@ -589,27 +994,31 @@ const Cell &Grid::operator()(int x, int y) const
  *      std::exception or sub-class if x0,y0 or x1,y1 are not valid coordinates within the grid
  *      or if the crop window has a negative size.
  */
-Grid Grid::crop(int x0, int y0, int x1, int y1) const
+Grid Grid::crop(int x0, int y0, int x1, int y1, std::pmr::memory_resource *resource) const
 {
     // Check x0, y0 within bounds and x1, y1 not negative
     if (x0 >= width || x0 < 0 || y0 >= height || y0 < 0 || x1 < 0 || y1 < 0)
     {
         throw std::out_of_range("ERROR: Attempted resize is out of bounds.");
     }
+    // Check the window ends within the grid, and does not end before it starts
+    else if (x1 > width || y1 > height || x1 < x0 || y1 < y0)
+    {
+        throw std::out_of_range("ERROR: Attempted resize is out of bounds.");
+    }
     else
     {
         // Construct new grid of size dx * dy
-        Grid new_grid(x1 - x0, y1 - y0);
+        Grid new_grid(x1 - x0, y1 - y0, resource);
 
-        // Iterate through new grid and fill values
-        for (int y = 0; y < new_grid.get_height(); y++)
+        // The window is checked up front, so each row is copied as one contiguous run
+        for (int y = y0; y < y1; y++)
         {
-            for (int x = 0; x < new_grid.get_width(); x++)
-            {
-                new_grid.set(x, y, get(x + x0, y + y0));
-            }
+            std::copy(row(y) + x0, row(y) + x1, new_grid.raw_row(y - y0));
         }
 
+        new_grid.alive_cells = -1;
+
         return new_grid;
     }
 }
@@ -657,40 +1066,190 @@ void Grid::merge(const Grid &other, int x0, int y0, bool alive_only)
     {
         throw std::invalid_argument("ERROR: Merging grid too large.");
     }
+    else if (other.get_total_cells() > 0 && (x0 < 0 || y0 < 0))
+    {
+        throw std::out_of_range("ERROR: Requested cell coordinate is out of bounds.");
+    }
     else
     {
-        // Iterate through new grid
         for (int y = 0; y < other.get_height(); y++)
         {
-            for (int x = 0; x < other.get_width(); x++)
+            merge_row(other.row(y), raw_row(y + y0) + x0, other.get_width(), alive_only);
+        }
+
+        alive_cells = -1;
+    }
+}
+
+/**
+ * Grid::merge_many(placements)
+ *
+ * Stamp many patterns onto the grid at once, as if by calling Grid::merge for each placement in order after
+ * rotating its pattern. Each distinct pattern and rotation is only rotated once, however often it is placed.
+ *
+ * The grid is swept a single time from top to bottom, stamping the row of every placement which covers each
+ * row before moving on to the next, so a large grid is only brought through the cache once rather than once
+ * per pattern. Placements covering the same row are stamped in order, so later placements win as with merge.
+ *
+ * @example
+ *
+ *      // Fill a board with a fleet of gliders heading in every direction
+ *      Grid glider = Zoo::glider();
+ *      Grid board(1024);
+ *      std::vector<Placement> fleet;
+ *
+ *      for (int i = 0; i < 100; i++)
+ *      {
+ *          fleet.push_back({&glider, 10 * i, 10 * i, i % 4, true});
+ *      }
+ *
+ *      board.merge_many(fleet);
+ *
+ * @param placements
+ *      The patterns to stamp and where to stamp them.
+ *
+ * @throws
+ *      std::exception or sub-class if any placement has no pattern or does not fit within the bounds of the grid,
+ *      in which case the grid is left unchanged.
+ */
+void Grid::merge_many(const std::vector<Placement> &placements)
+{
+    // Rotate each distinct pattern once, placements without a rotation use their pattern as-is
+    std::map<std::pair<const Grid *, int>, Grid> rotated;
+    std::vector<const Grid *> stamps(placements.size());
+
+    for (size_t i = 0; i < placements.size(); i++)
+    {
+        const Placement &placement = placements[i];
+
+        if (placement.pattern == nullptr)
+        {
+            throw std::invalid_argument("ERROR: A placement has no pattern to merge.");
+        }
+
+        const int rotation = ((placement.rotation % 4) + 4) % 4;
+
+        if (rotation == 0)
+        {
+            stamps[i] = placement.pattern;
+        }
+        else
+        {
+            const std::pair<const Grid *, int> key(placement.pattern, rotation);
+            auto found = rotated.find(key);
+
+            if (found == rotated.end())
             {
-                // Check merge condition
-                if (!alive_only)
-                {
-                    // Transfer cell unconditionally
-                    set(x + x0, y + y0, other.get(x, y));
-                }
-                else
-                {
-                    if (get(x + x0, y + y0) == Cell::DEAD)
-                    {
-                        // Transfer cell only if dead
-                        set(x + x0, y + y0, other.get(x, y));
-                    }
-                }
+                found = rotated.emplace(key, placement.pattern->rotate(rotation)).first;
             }
+
+            stamps[i] = &found->second;
+        }
+
+        const Grid &stamp = *stamps[i];
+
+        if (width < placement.x + stamp.get_width() || height < placement.y + stamp.get_height())
+        {
+            throw std::invalid_argument("ERROR: Merging grid too large.");
+        }
+        else if (stamp.get_total_cells() > 0 && (placement.x < 0 || placement.y < 0))
+        {
+            throw std::out_of_range("ERROR: Requested cell coordinate is out of bounds.");
+        }
+    }
+
+    // Visit the placements in order of their top row, keeping those covering the current row in their given order
+    std::vector<size_t> order;
+
+    for (size_t i = 0; i < placements.size(); i++)
+    {
+        if (stamps[i]->get_total_cells() > 0)
+        {
+            order.push_back(i);
         }
     }
+
+    std::stable_sort(order.begin(), order.end(), [&placements](size_t a, size_t b) {
+        return placements[a].y < placements[b].y;
+    });
+
+    std::vector<size_t> covering;
+    size_t next = 0;
+
+    for (int y = 0; y < height && (next < order.size() || !covering.empty()); y++)
+    {
+        // Drop the placements which ended above this row
+        covering.erase(std::remove_if(covering.begin(), covering.end(), [&](size_t i) {
+            return placements[i].y + stamps[i]->get_height() <= y;
+        }), covering.end());
+
+        // Pick up the placements which start on this row
+        for (; next < order.size() && placements[order[next]].y == y; next++)
+        {
+            covering.insert(std::upper_bound(covering.begin(), covering.end(), order[next]), order[next]);
+        }
+
+        Cell *destination = raw_row(y);
+
+        for (const size_t i : covering)
+        {
+            const Placement &placement = placements[i];
+            merge_row(stamps[i]->row(y - placement.y), destination + placement.x, stamps[i]->get_width(),
+                      placement.alive_only);
+        }
+    }
+
+    alive_cells = -1;
 }
 
 /**
- * Grid::rotate(rotation)
+ * Grid::merge_row(source, destination, count, alive_only)
+ *
+ * Private helper function merging a run of cells from one row into another.
+ *
+ * An unconditional merge is a straight copy. Merging only alive cells is a branch-free blend which the compiler
+ * can auto-vectorize: the bits of Cell::DEAD are a subset of the bits of Cell::ALIVE, so or-ing two cells gives
+ * Cell::ALIVE if either is alive, and Cell::DEAD only if both are dead.
+ *
+ * @param source
+ *      The first cell of the run to merge.
+ *
+ * @param destination
+ *      The first cell of the run to merge into.
+ *
+ * @param count
+ *      The number of cells in the run.
+ *
+ * @param alive_only
+ *      If true then only alive cells are merged, leaving the rest of the destination as it was.
+ */
+void Grid::merge_row(const Cell *source, Cell *destination, int count, bool alive_only)
+{
+    static_assert((Cell::DEAD & Cell::ALIVE) == Cell::DEAD, "Blending relies on the bits of DEAD being within ALIVE");
+
+    if (alive_only)
+    {
+        for (int x = 0; x < count; x++)
+        {
+            destination[x] = static_cast<Cell>(destination[x] | source[x]);
+        }
+    }
+    else
+    {
+        std::copy(source, source + count, destination);
+    }
+}
+
+/**
+ * Grid::rotate(rotation, resource)
  *
  * Create a copy of the grid that is rotated by a multiple of 90 degrees.
  * The rotation can be any integer, positive, negative, or 0.
  * The function should take the same amount of time to execute for any valid integer input.
  * The function should be callable from a constant context.
  *
+ * Implemented by Grid::rotate_into, so the copy is made in a single pass with a single allocation.
+ *
  * @example
  *
  *      // Make a 1x3 grid
@@ -702,10 +1261,53 @@ void Grid::merge(const Grid &other, int x0, int y0, bool alive_only)
  * @param _rotation
  *      An positive or negative integer to rotate by in 90 intervals.
  *
+ * @param resource
+ *      Optional parameter. The memory resource to allocate the rotated grid from. Defaults to
+ *      Memory::get_aligned_resource().
+ *
  * @return
  *      Returns a copy of the grid that has been rotated.
  */
-Grid Grid::rotate(int _rotation) const
+Grid Grid::rotate(int _rotation, std::pmr::memory_resource *resource) const
+{
+    Grid new_grid(0, 0, resource);
+    rotate_into(new_grid, _rotation);
+
+    return new_grid;
+}
+
+/**
+ * Grid::rotate_into(destination, rotation)
+ *
+ * Write the grid rotated clockwise by a multiple of 90 degrees into another grid, resizing it to fit.
+ * The destination keeps its allocation when it is already large enough, so rotating into the same grid again
+ * and again never allocates.
+ *
+ * Each cell is written exactly once.
+ *      - 0 degrees is a copy and 180 degrees reverses the order of every cell, which is done in place when
+ *        the destination is the grid itself.
+ *      - 90 and 270 degrees read down the columns of the grid, so they are swept in square blocks which fit
+ *        in the cache, rather than striding across the whole grid for every row written.
+ *
+ * @example
+ *
+ *      // Stamp a pattern in all 4 orientations, reusing one buffer
+ *      Grid pattern = Zoo::glider();
+ *      Grid rotated;
+ *
+ *      for (int rotation = 0; rotation < 4; rotation++)
+ *      {
+ *          pattern.rotate_into(rotated, rotation);
+ *          board.merge(rotated, 8 * rotation, 0);
+ *      }
+ *
+ * @param destination
+ *      The grid to overwrite with the rotated copy, which may be this grid.
+ *
+ * @param _rotation
+ *      An positive or negative integer to rotate by in 90 intervals.
+ */
+void Grid::rotate_into(Grid &destination, int _rotation) const
 {
     // Normalise rotation amount to range [0, 3]
     int rotation = _rotation % 4;
@@ -716,145 +1318,222 @@ Grid Grid::rotate(int _rotation) const
         rotation += 4;
     }
 
-    // Copy the current grid
-    Grid new_grid(*this);
-
-    if (rotation == 1)
+    if (rotation == 0)
     {
-        // 90 degree rotation:
-        //   Equivalent to a coordinate swap and vertical flip
-        return x_flip(swap_coordinates(new_grid));
+        // 0 degree rotation:
+        //   Equivalent to the grid as-is
+        if (&destination != this)
+        {
+            destination = *this;
+        }
     }
     else if (rotation == 2)
     {
         // 180 degree rotation:
-        //   Equivalent to a vertical and horizontal flip
-        return x_flip(y_flip(new_grid));
+        //   The last cell becomes the first, so each row is the mirror image of the row as far from the other end
+        if (&destination == this)
+        {
+            for (int y = 0; y < height / 2; y++)
+            {
+                Cell *top = destination.raw_row(y);
+                Cell *bottom = destination.raw_row(height - 1 - y);
+
+                std::swap_ranges(top, top + width, std::reverse_iterator<Cell *>(bottom + width));
+            }
+
+            if (height % 2 == 1)
+            {
+                std::reverse(destination.raw_row(height / 2), destination.raw_row(height / 2) + width);
+            }
+        }
+        else
+        {
+            destination.reshape(width, height);
+
+            for (int y = 0; y < height; y++)
+            {
+                std::reverse_copy(row(height - 1 - y), row(height - 1 - y) + width, destination.raw_row(y));
+            }
+        }
     }
-    else if (rotation == 3)
+    else if (&destination == this)
     {
-        // 270 degree rotation:
-        //   Equivalent to a coordinate swap and horizontal flip
-        return y_flip(swap_coordinates(new_grid));
+        // A quarter turn of a grid onto itself cannot be done in a single pass without overwriting cells still
+        // to be read, so rotate into a copy instead
+        // Drawn from the same resource, so moving it back in takes its allocation
+        Grid new_grid(0, 0, get_memory_resource());
+        rotate_into(new_grid, rotation);
+
+        destination = std::move(new_grid);
+        return;
     }
     else
     {
-        // 0 degree rotation:
-        //   Equivalent to the grid as-is
-        return new_grid;
+        // 90 degree rotation:
+        //   Cell (x, y) is taken from (y, height - 1 - x)
+        // 270 degree rotation:
+        //   Cell (x, y) is taken from (width - 1 - y, x)
+        destination.reshape(height, width);
+
+        for (int block_y = 0; block_y < width; block_y += TRANSPOSE_BLOCK_SIZE)
+        {
+            const int block_y1 = std::min(block_y + TRANSPOSE_BLOCK_SIZE, width);
+
+            for (int block_x = 0; block_x < height; block_x += TRANSPOSE_BLOCK_SIZE)
+            {
+                const int block_x1 = std::min(block_x + TRANSPOSE_BLOCK_SIZE, height);
+
+                for (int y = block_y; y < block_y1; y++)
+                {
+                    Cell *target = destination.raw_row(y);
+
+                    for (int x = block_x; x < block_x1; x++)
+                    {
+                        target[x] = (rotation == 1) ? cells[get_index(y, height - 1 - x)]
+                                                    : cells[get_index(width - 1 - y, x)];
+                    }
+                }
+            }
+        }
     }
+
+    // Rotating moves cells around without changing them, so the count still holds
+    destination.alive_cells = alive_cells;
 }
 
 /**
- * Grid::x_flip(old_grid)
+ * Grid::flip_into(destination, flip)
  *
- * Private helper function which returns a copy of the grid flipped along the
- * x-axis (vertical reflection).
+ * Write the grid reflected along an axis into another grid, resizing it to fit.
+ * The destination keeps its allocation when it is already large enough, and Flip::X and Flip::Y are done in
+ * place when the destination is the grid itself.
  *
- * @param old_grid
- *      The grid to be transformed.
+ * @example
  *
- * @return
- *      A copy of the grid reflected along the x-axis.
+ *      // Make the mirror image of a glider
+ *      Grid glider = Zoo::glider();
+ *      Grid mirrored;
+ *      glider.flip_into(mirrored, Flip::X);
+ *
+ *      // Flip a grid upside down without copying it
+ *      glider.flip_into(glider, Flip::Y);
+ *
+ * @param destination
+ *      The grid to overwrite with the reflected copy, which may be this grid.
+ *
+ * @param flip
+ *      The axis to reflect along.
  */
-Grid Grid::x_flip(const Grid &old_grid) const
+void Grid::flip_into(Grid &destination, Flip flip) const
 {
-    if (old_grid.get_width() == 1)
-    {
-        // Do nothing if only one column
-        return old_grid;
-    }
-    else
+    if (flip == Flip::X)
     {
-        int height = old_grid.get_height();
-        int width = old_grid.get_width();
-
-        Grid new_grid(width, height);
+        // Reverse the ordering of the cells within each row
+        if (&destination != this)
+        {
+            destination.reshape(width, height);
+        }
 
-        // For all cells
         for (int y = 0; y < height; y++)
         {
-            for (int x = 0; x < width; x++)
+            const Cell *source = row(y);
+            Cell *target = destination.raw_row(y);
+
+            if (&destination == this)
+            {
+                std::reverse(target, target + width);
+            }
+            else
             {
-                // Reverse the ordering of rows in the grid, to flip
-                new_grid(x, y) = old_grid((width - 1 - x), y);
+                std::reverse_copy(source, source + width, target);
             }
         }
-
-        return new_grid;
     }
-}
+    else if (flip == Flip::Y)
+    {
+        // Reverse the ordering of rows in the grid
+        if (&destination == this)
+        {
+            for (int y = 0; y < height / 2; y++)
+            {
+                std::swap_ranges(destination.raw_row(y), destination.raw_row(y) + width,
+                                 destination.raw_row(height - 1 - y));
+            }
+        }
+        else
+        {
+            destination.reshape(width, height);
 
-/**
- * Grid::y_flip(old_grid)
- *
- * Private helper function which returns a copy of the grid flipped along the
- * y-axis (horizontal reflection).
- *
- * @param old_grid
- *      The grid to be transformed.
- *
- * @return
- *      A copy of the grid reflected along the y-axis.
- */
-Grid Grid::y_flip(const Grid &old_grid) const
-{
-    if (old_grid.get_height() == 1)
+            for (int y = 0; y < height; y++)
+            {
+                std::copy(row(height - 1 - y), row(height - 1 - y) + width, destination.raw_row(y));
+            }
+        }
+    }
+    else if (&destination == this)
     {
-        // Do nothing if only one row
-        return old_grid;
+        // As with a quarter turn, transposing onto itself would overwrite cells still to be read
+        // Drawn from the same resource, so moving it back in takes its allocation
+        Grid new_grid(0, 0, get_memory_resource());
+        flip_into(new_grid, flip);
+
+        destination = std::move(new_grid);
+        return;
     }
     else
     {
-        int height = old_grid.get_height();
-        int width = old_grid.get_width();
+        // Switch the position of each cell's coordinates, in blocks which fit in the cache
+        destination.reshape(height, width);
 
-        Grid new_grid(width, height);
-
-        // For all cells
-        for (int y = 0; y < height; y++)
+        for (int block_y = 0; block_y < width; block_y += TRANSPOSE_BLOCK_SIZE)
         {
-            for (int x = 0; x < width; x++)
+            const int block_y1 = std::min(block_y + TRANSPOSE_BLOCK_SIZE, width);
+
+            for (int block_x = 0; block_x < height; block_x += TRANSPOSE_BLOCK_SIZE)
             {
-                // Reverse the ordering of rows in the grid, to flip
-                new_grid(x, y) = old_grid(x, (height - 1 - y));
+                const int block_x1 = std::min(block_x + TRANSPOSE_BLOCK_SIZE, height);
+
+                for (int y = block_y; y < block_y1; y++)
+                {
+                    Cell *target = destination.raw_row(y);
+
+                    for (int x = block_x; x < block_x1; x++)
+                    {
+                        target[x] = cells[get_index(y, x)];
+                    }
+                }
             }
         }
-
-        return new_grid;
     }
+
+    // Reflecting moves cells around without changing them, so the count still holds
+    destination.alive_cells = alive_cells;
 }
 
 /**
- * Grid::swap_coordinates(old_grid)
+ * Grid::reshape(new_width, new_height)
  *
- * Private helper function which returns a copy of the grid flipped along the
- * main diagonal, by switching the position of each cell's coordinates (diagonal
- * reflection).
+ * Private helper function setting the size of a grid which is about to be completely overwritten, such as the
+ * destination of Grid::rotate_into. Unlike Grid::resize the contents are not kept, and the allocation is reused
+ * whenever it is already large enough.
  *
- * @param old_grid
- *      The grid to be transformed.
+ * @param new_width
+ *      The new width of the grid.
  *
- * @return
- *      A copy of the grid reflected along the main diagonal.
+ * @param new_height
+ *      The new height of the grid.
  */
-Grid Grid::swap_coordinates(const Grid &old_grid) const
+void Grid::reshape(int new_width, int new_height)
 {
-    Grid new_grid;
-
-    //Invert grid dimensions
-    new_grid.resize(old_grid.get_height(), old_grid.get_width());
-
-    // For all cells
-    for (int y = 0; y < new_grid.get_height(); y++)
-    {
-        for (int x = 0; x < new_grid.get_width(); x++)
-        {
-            new_grid(x, y) = old_grid(y, x);
-        }
-    }
-
-    return new_grid;
+    // The rows are packed together with no padding or ghost border, as every cell is about to be written
+    width = new_width;
+    height = new_height;
+    capacity_width = new_width;
+    capacity_height = new_height;
+    border = 0;
+    pitch = new_width;
+    origin = 0;
+    cells.resize(static_cast<size_t>(new_width) * new_height);
 }
 
 /**
@@ -863,6 +1542,8 @@ Grid Grid::swap_coordinates(const Grid &old_grid) const
  * Serializes a grid to an ascii output stream.
  * The grid is printed wrapped in a border of - (dash), | (pipe), and + (plus) characters.
  * Alive cells are shown as # (hash) characters, dead cells with ' ' (space) characters.
+ * The whole grid is formatted into one buffer first and written to the stream in a single call. To print only
+ * a window of a large grid, or to zoom out, use a Renderer.
  *
  * The function should be callable on a constant Grid.
  *
@@ -894,43 +1575,29 @@ Grid Grid::swap_coordinates(const Grid &old_grid) const
  */
 std::ostream &operator<<(std::ostream &output_stream, const Grid &grid)
 {
-    // Create (identical) top & bottom borders
-    std::string border;
+    const int width = grid.get_width();
+    const size_t line_length = width + 3;
 
-    border += "+";
+    // The whole grid is formatted into one buffer and written with a single call, since writing a cell at a
+    // time through the stream costs far more than the cells themselves
+    std::string text(line_length * (grid.get_height() + 2), '-');
 
-    for (int i = 0; i < grid.get_width(); i++)
-    {
-        border += "-";
-    }
-
-    border += "+\n";
-
-    // Print top border
-    output_stream << border;
+    // Create (identical) top & bottom borders
+    text[0] = '+';
+    text[width + 1] = '+';
+    text[width + 2] = '\n';
+    text.replace(text.size() - line_length, line_length, text, 0, line_length);
 
-    // Print grid contents
+    // Fill in the grid contents a row at a time, since the values of Cell are their own ascii characters
     for (int y = 0; y < grid.get_height(); y++)
     {
-        output_stream << "|";
-
-        for (int x = 0; x < grid.get_width(); x++)
-        {
-            if (grid(x, y) == Cell::ALIVE)
-            {
-                output_stream << "#";
-            }
-            else
-            {
-                output_stream << " ";
-            }
-        }
+        char *line = &text[line_length * (y + 1)];
 
-        output_stream << "|\n";
+        line[0] = '|';
+        std::copy(grid.row(y), grid.row(y) + width, line + 1);
+        line[width + 1] = '|';
+        line[width + 2] = '\n';
     }
 
-    // Print bottom border
-    output_stream << border;
-
-    return output_stream;
+    return output_stream.write(text.data(), text.size());
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
  */
 #pragma once
 
+#include <memory_resource>
 #include <sstream>
 #include <vector>
 
@@ -22,26 +23,73 @@ enum Cell : char
     ALIVE = '#'
 };
 
+/**
+ * The axes Grid::flip_into can reflect a grid along.
+ *      - Flip::X reflects along the x-axis, reversing the order of the cells within each row.
+ *      - Flip::Y reflects along the y-axis, reversing the order of the rows.
+ *      - Flip::DIAGONAL reflects along the main diagonal, switching the coordinates of each cell.
+ */
+enum class Flip
+{
+    X,
+    Y,
+    DIAGONAL
+};
+
+class World;
+class DistributedWorld;
+struct Placement;
+
 /**
  * Declare the structure of the Grid class for representing a 2d grid of cells.
+ *
+ * The number of alive cells is cached, kept up to date by Grid::set and invalidated by any other write access.
+ *
+ * The cells are allocated from a std::pmr::memory_resource, Memory::get_aligned_resource() unless another is given.
+ * Copies always allocate from the aligned resource, while moves keep the memory of the grid moved from.
  */
 class Grid
 {
+    friend class World;
+    friend class DistributedWorld;
+
     private:
+        // Edge length of the square blocks quarter turns and transposes are swept in, 4KiB of cells each
+        static const int TRANSPOSE_BLOCK_SIZE = 64;
+
         int width;
         int height;
-        std::vector<Cell> cells; // 1D cell array
+        int capacity_width;
+        int capacity_height;
+        int border; // Width of the ghost border around the grid, 0 or 1
+        int pitch; // Cells per row of the allocation, the distance between the starts of rows
+        int origin; // Index of cell (0, 0)
+        std::pmr::vector<Cell> cells; // 1D cell array, dead past the width and height of the grid
+
+        mutable int alive_cells; // -1 when it needs counting again
 
         int get_index(int x, int y) const;
 
-        Grid x_flip(const Grid &old_grid) const;
-        Grid y_flip(const Grid &old_grid) const;
-        Grid swap_coordinates(const Grid &old_grid) const;
+        Cell *raw_row(int y);
+        void set_cached_alive_cells(int count);
+
+        void release();
+        void reallocate(int new_capacity_width, int new_capacity_height, int kept_width, int kept_height, int new_border);
+        void clear_ghost_border();
+        void reshape(int new_width, int new_height);
+        static void merge_row(const Cell *source, Cell *destination, int count, bool alive_only);
 
     public:
         Grid();
         explicit Grid(int square_size);
-        Grid(int width, int height);
+        Grid(int width, int height, std::pmr::memory_resource *resource = nullptr);
+        Grid(const Grid &other, std::pmr::memory_resource *resource = nullptr);
+        Grid(Grid &&other) noexcept;
+
+        Grid &operator=(const Grid &other) = default;
+        Grid &operator=(Grid &&other);
+
+        std::pmr::memory_resource *get_memory_resource() const;
 
         int get_width() const;
         int get_height() const;
@@ -51,6 +99,15 @@ class Grid
 
         void resize(int square_size);
         void resize(int new_width, int new_height);
+        void reserve(int new_capacity_width, int new_capacity_height);
+
+        int get_capacity_width() const;
+        int get_capacity_height() const;
+        size_t get_allocated_bytes() const;
+
+        bool has_ghost_border() const;
+        void set_ghost_border(bool enabled);
+        void refresh_ghost_border(bool toroidal);
 
         Cell &operator()(int x, int y);
         const Cell &operator()(int x, int y) const;
@@ -58,9 +115,30 @@ class Grid
         Cell get(int x, int y) const;
         void set(int x, int y, const Cell value);
 
-        Grid crop(int x0, int y0, int x1, int y1) const;
+        Cell *row(int y);
+        const Cell *row(int y) const;
+
+        Grid crop(int x0, int y0, int x1, int y1, std::pmr::memory_resource *resource = nullptr) const;
         void merge(const Grid &other, int x0, int y0, bool alive_only = false);
-        Grid rotate(int rotation) const;
+        void merge_many(const std::vector<Placement> &placements);
+        Grid rotate(int rotation, std::pmr::memory_resource *resource = nullptr) const;
+        void rotate_into(Grid &destination, int rotation) const;
+        void flip_into(Grid &destination, Flip flip) const;
 
         friend std::ostream &operator<<(std::ostream &output_stream, const Grid &grid);
+};
+
+/**
+ * A pattern for Grid::merge_many to stamp onto a grid.
+ *      - The pattern is rotated clockwise by rotation lots of 90 degrees, then its top left corner placed at (x, y).
+ *      - As with Grid::merge, alive_only only stamps the alive cells of the pattern.
+ *      - The pattern is not copied, so it must outlive the call to Grid::merge_many.
+ */
+struct Placement
+{
+    const Grid *pattern;
+    int x;
+    int y;
+    int rotation;
+    bool alive_only;
 };
\ No newline at end of file
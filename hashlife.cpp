@@ -0,0 +1,995 @@
+/**
+ * Implements a class for simulating the Game of Life on an unbounded plane using Hashlife.
+ *      - https://en.wikipedia.org/wiki/Hashlife
+ *
+ *      - The world is a quadtree of nodes, where a node of level k is a 2^k by 2^k square of cells made from
+ *        four quadrants of level k - 1, and level 0 nodes are single cells.
+ *          - Nodes are hash-consed, so every distinct square is only ever stored once and is shared by every
+ *            position it appears in, however many times a pattern repeats.
+ *
+ *      - The successor of a level k node is its centre level k - 1 square, advanced by up to 2^(k - 2)
+ *        generations, which only depends on the cells of the node itself.
+ *          - Successors are computed recursively from the successors of smaller nodes and memoized, so
+ *            regular patterns can be advanced by 2^k generations in roughly O(k) time.
+ *
+ *      - HashlifeWorlds are constructed from a Grid, which is placed with its top left corner at the origin.
+ *          - Unlike a World, the plane is unbounded, so nothing is lost at the edges of the initial grid.
+ *          - Any rectangle of the plane can be extracted back out as a Grid, with the initial grid's
+ *            bounds giving the default viewport.
+ *
+ *      - HashlifeWorlds can be read from and written to Golly's macrocell format, which stores the quadtree
+ *        itself, so huge patterns are loaded without ever being expanded into a Grid.
+ *          - https://www.conwaylife.com/wiki/Macrocell
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "hashlife.h"
+
+/**
+ * HashlifeWorld::NodeKey::operator==(other)
+ *
+ * Compare the four quadrants of two node keys.
+ *
+ * @param other
+ *      The key to compare to.
+ *
+ * @return
+ *      True if all four quadrants are the same nodes.
+ */
+bool HashlifeWorld::NodeKey::operator==(const NodeKey &other) const
+{
+    return nw == other.nw && ne == other.ne && sw == other.sw && se == other.se;
+}
+
+/**
+ * HashlifeWorld::NodeKeyHash::operator()(key)
+ *
+ * Hash the four quadrants of a node key.
+ *
+ * @param key
+ *      The key to hash.
+ *
+ * @return
+ *      A well mixed hash of the key.
+ */
+size_t HashlifeWorld::NodeKeyHash::operator()(const NodeKey &key) const
+{
+    uint64_t hash = (static_cast<uint64_t>(key.nw) << 32 | key.ne) * 0x9E3779B97F4A7C15ULL;
+    hash ^= (static_cast<uint64_t>(key.sw) << 32 | key.se) + 0x632BE59BD9B4E019ULL + (hash << 6) + (hash >> 2);
+
+    return static_cast<size_t>(hash ^ (hash >> 31));
+}
+
+/**
+ * HashlifeWorld::HashlifeWorld()
+ *
+ * Construct an empty world with a 0x0 viewport.
+ *
+ * @example
+ *
+ *      // Make an empty world
+ *      HashlifeWorld world;
+ *
+ */
+HashlifeWorld::HashlifeWorld() : HashlifeWorld::HashlifeWorld(Grid()) {}
+
+/**
+ * HashlifeWorld::HashlifeWorld(initial_state)
+ *
+ * Construct a world holding the cells of a grid, with the top left corner of the grid at the origin.
+ * The size of the grid becomes the default viewport returned by HashlifeWorld::get_state().
+ *
+ * @example
+ *
+ *      // Make a world from an r-pentomino
+ *      HashlifeWorld world(Zoo::r_pentomino());
+ *
+ * @param initial_state
+ *      The grid to copy the initial cells from.
+ */
+HashlifeWorld::HashlifeWorld(const Grid &initial_state)
+    : viewport_x(0), viewport_y(0), width(initial_state.get_width()), height(initial_state.get_height()),
+      generation(0),
+      garbage_collection_threshold(GARBAGE_COLLECTION_THRESHOLD)
+{
+    // The two single cell leaves
+    nodes.push_back({0, 0, 0, 0, 0, 0});
+    nodes.push_back({0, 0, 0, 0, 1, 0});
+    empty_nodes.push_back(0);
+
+    // Find the smallest root whose south east quadrant holds the whole grid
+    int level = 3;
+
+    while ((1LL << (level - 1)) < std::max(width, height))
+    {
+        level++;
+    }
+
+    const long long half = 1LL << (level - 1);
+    root = build(initial_state, level, -half, -half);
+}
+
+/**
+ * HashlifeWorld::make_node(nw, ne, sw, se)
+ *
+ * Private helper function to find or create the node made from four quadrants.
+ *
+ * @return
+ *      The id of the unique node with these quadrants.
+ */
+uint32_t HashlifeWorld::make_node(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+    const NodeKey key = {nw, ne, sw, se};
+    const auto existing = node_table.find(key);
+
+    if (existing != node_table.end())
+    {
+        return existing->second;
+    }
+
+    if (nodes.size() >= UINT32_MAX)
+    {
+        throw std::length_error("ERROR: Hashlife node table is full.");
+    }
+
+    const uint32_t id = static_cast<uint32_t>(nodes.size());
+    const uint64_t population = nodes[nw].population + nodes[ne].population +
+                                nodes[sw].population + nodes[se].population;
+
+    nodes.push_back({nw, ne, sw, se, population, nodes[nw].level + 1});
+    node_table.emplace(key, id);
+
+    return id;
+}
+
+/**
+ * HashlifeWorld::make_empty(level)
+ *
+ * Private helper function to find the node of all dead cells at a level.
+ *
+ * @param level
+ *      The level of the node.
+ *
+ * @return
+ *      The id of the empty node.
+ */
+uint32_t HashlifeWorld::make_empty(int level)
+{
+    while (static_cast<int>(empty_nodes.size()) <= level)
+    {
+        const uint32_t below = empty_nodes.back();
+        empty_nodes.push_back(make_node(below, below, below, below));
+    }
+
+    return empty_nodes[level];
+}
+
+/**
+ * HashlifeWorld::build(grid, level, x0, y0)
+ *
+ * Private helper function to build the node for the square of the plane at (x0, y0) from a grid
+ * covering [0, width) by [0, height). Squares missing the grid are built as empty nodes directly.
+ *
+ * @return
+ *      The id of the built node.
+ */
+uint32_t HashlifeWorld::build(const Grid &grid, int level, long long x0, long long y0)
+{
+    const long long size = 1LL << level;
+
+    if (x0 >= grid.get_width() || y0 >= grid.get_height() || x0 + size <= 0 || y0 + size <= 0)
+    {
+        return make_empty(level);
+    }
+    else if (level == 0)
+    {
+        return grid(x0, y0) == Cell::ALIVE ? 1 : 0;
+    }
+    else
+    {
+        const long long half = size / 2;
+
+        const uint32_t nw = build(grid, level - 1, x0, y0);
+        const uint32_t ne = build(grid, level - 1, x0 + half, y0);
+        const uint32_t sw = build(grid, level - 1, x0, y0 + half);
+        const uint32_t se = build(grid, level - 1, x0 + half, y0 + half);
+
+        return make_node(nw, ne, sw, se);
+    }
+}
+
+/**
+ * HashlifeWorld::build_leaf(rows, level, x0, y0)
+ *
+ * Private helper function to build the node for a square of an 8x8 macrocell leaf at (x0, y0),
+ * where cell x of each row is bit x of its byte.
+ *
+ * @return
+ *      The id of the built node.
+ */
+uint32_t HashlifeWorld::build_leaf(const uint8_t *rows, int level, int x0, int y0)
+{
+    if (level == 0)
+    {
+        return (rows[y0] >> x0) & 1;
+    }
+
+    const int half = 1 << (level - 1);
+
+    const uint32_t nw = build_leaf(rows, level - 1, x0, y0);
+    const uint32_t ne = build_leaf(rows, level - 1, x0 + half, y0);
+    const uint32_t sw = build_leaf(rows, level - 1, x0, y0 + half);
+    const uint32_t se = build_leaf(rows, level - 1, x0 + half, y0 + half);
+
+    return make_node(nw, ne, sw, se);
+}
+
+/**
+ * HashlifeWorld::centre(node)
+ *
+ * Private helper function to find the square of the level below centred on a node, without advancing it.
+ */
+uint32_t HashlifeWorld::centre(uint32_t node)
+{
+    const Node n = nodes[node];
+
+    return make_node(nodes[n.nw].se, nodes[n.ne].sw, nodes[n.sw].ne, nodes[n.se].nw);
+}
+
+/**
+ * HashlifeWorld::centre_horizontal(west, east)
+ *
+ * Private helper function to find the square straddling the boundary between two side by side nodes.
+ */
+uint32_t HashlifeWorld::centre_horizontal(uint32_t west, uint32_t east)
+{
+    const Node w = nodes[west];
+    const Node e = nodes[east];
+
+    return make_node(w.ne, e.nw, w.se, e.sw);
+}
+
+/**
+ * HashlifeWorld::centre_vertical(north, south)
+ *
+ * Private helper function to find the square straddling the boundary between two stacked nodes.
+ */
+uint32_t HashlifeWorld::centre_vertical(uint32_t north, uint32_t south)
+{
+    const Node n = nodes[north];
+    const Node s = nodes[south];
+
+    return make_node(n.sw, n.se, s.nw, s.ne);
+}
+
+/**
+ * HashlifeWorld::step_base(node)
+ *
+ * Private helper function to advance the centre 2x2 cells of a 4x4 level 2 node by a single generation
+ * by applying the rules of Conway's Game of Life directly.
+ *
+ * @return
+ *      The id of the level 1 result.
+ */
+uint32_t HashlifeWorld::step_base(uint32_t node)
+{
+    const Node n = nodes[node];
+    int cells[4][4];
+
+    // Unpack the 16 leaves, each quadrant is a level 1 node of 4 leaves
+    const uint32_t quadrants[2][2] = {{n.nw, n.ne}, {n.sw, n.se}};
+
+    for (int qy = 0; qy < 2; qy++)
+    {
+        for (int qx = 0; qx < 2; qx++)
+        {
+            const Node q = nodes[quadrants[qy][qx]];
+
+            cells[qy * 2][qx * 2] = q.nw;
+            cells[qy * 2][qx * 2 + 1] = q.ne;
+            cells[qy * 2 + 1][qx * 2] = q.sw;
+            cells[qy * 2 + 1][qx * 2 + 1] = q.se;
+        }
+    }
+
+    uint32_t result[2][2];
+
+    for (int y = 1; y <= 2; y++)
+    {
+        for (int x = 1; x <= 2; x++)
+        {
+            int num_neighbours = -cells[y][x];
+
+            for (int i = y - 1; i <= y + 1; i++)
+            {
+                for (int j = x - 1; j <= x + 1; j++)
+                {
+                    num_neighbours += cells[i][j];
+                }
+            }
+
+            const bool alive = num_neighbours == UPPER_POPULATION_LIMIT ||
+                               (cells[y][x] && num_neighbours == LOWER_POPULATION_LIMIT);
+
+            result[y - 1][x - 1] = alive ? 1 : 0;
+        }
+    }
+
+    return make_node(result[0][0], result[0][1], result[1][0], result[1][1]);
+}
+
+/**
+ * HashlifeWorld::successor(node, step_log)
+ *
+ * Private helper function to find the centre of a node advanced by 2^step_log generations.
+ *
+ * The node is split into 9 overlapping sub-squares of the level below, which are reduced to the next
+ * level down, either by advancing them when the full 2^(level - 2) generations are being taken, or by
+ * just taking their centres when fewer are. These are regrouped into 4 overlapping squares whose own
+ * successors make up the result, so each half of the generations is taken by a recursive call.
+ *
+ * @param node
+ *      The node to advance, of level 2 or more.
+ *
+ * @param step_log
+ *      The base 2 logarithm of the number of generations, at most level - 2.
+ *
+ * @return
+ *      The id of the advanced centre, one level below the node.
+ */
+uint32_t HashlifeWorld::successor(uint32_t node, int step_log)
+{
+    const Node n = nodes[node];
+
+    if (n.population == 0)
+    {
+        return make_empty(n.level - 1);
+    }
+    else if (n.level == 2)
+    {
+        return step_base(node);
+    }
+
+    const uint64_t key = static_cast<uint64_t>(node) << 8 | static_cast<uint64_t>(step_log);
+    const auto cached = result_cache.find(key);
+
+    if (cached != result_cache.end())
+    {
+        return cached->second;
+    }
+
+    // The 9 overlapping sub-squares, in row major order
+    const uint32_t squares[9] = {
+        n.nw, centre_horizontal(n.nw, n.ne), n.ne,
+        centre_vertical(n.nw, n.sw), centre(node), centre_vertical(n.ne, n.se),
+        n.sw, centre_horizontal(n.sw, n.se), n.se};
+
+    const bool full_speed = step_log == n.level - 2;
+    const int next_step_log = full_speed ? step_log - 1 : step_log;
+
+    uint32_t reduced[9];
+
+    for (int i = 0; i < 9; i++)
+    {
+        reduced[i] = full_speed ? successor(squares[i], next_step_log) : centre(squares[i]);
+    }
+
+    const uint32_t nw = successor(make_node(reduced[0], reduced[1], reduced[3], reduced[4]), next_step_log);
+    const uint32_t ne = successor(make_node(reduced[1], reduced[2], reduced[4], reduced[5]), next_step_log);
+    const uint32_t sw = successor(make_node(reduced[3], reduced[4], reduced[6], reduced[7]), next_step_log);
+    const uint32_t se = successor(make_node(reduced[4], reduced[5], reduced[7], reduced[8]), next_step_log);
+
+    const uint32_t result = make_node(nw, ne, sw, se);
+    result_cache.emplace(key, result);
+
+    return result;
+}
+
+/**
+ * HashlifeWorld::expand(node)
+ *
+ * Private helper function to wrap a node in a border of empty space, doubling its size about the same centre.
+ *
+ * @return
+ *      The id of the expanded node, one level above the original.
+ */
+uint32_t HashlifeWorld::expand(uint32_t node)
+{
+    const Node n = nodes[node];
+    const uint32_t empty = make_empty(n.level - 1);
+
+    const uint32_t nw = make_node(empty, empty, empty, n.nw);
+    const uint32_t ne = make_node(empty, empty, n.ne, empty);
+    const uint32_t sw = make_node(empty, n.sw, empty, empty);
+    const uint32_t se = make_node(n.se, empty, empty, empty);
+
+    return make_node(nw, ne, sw, se);
+}
+
+/**
+ * HashlifeWorld::is_padded(node)
+ *
+ * Private helper function to check whether all the alive cells of a node lie within its central quarter,
+ * in which case nothing can escape its successor for 2^(level - 3) generations.
+ * The node must be at least level 3.
+ *
+ * @return
+ *      True if the node is padded by empty space.
+ */
+bool HashlifeWorld::is_padded(uint32_t node) const
+{
+    const Node n = nodes[node];
+
+    const uint64_t inner_population =
+        nodes[nodes[nodes[n.nw].se].se].population + nodes[nodes[nodes[n.ne].sw].sw].population +
+        nodes[nodes[nodes[n.sw].ne].ne].population + nodes[nodes[nodes[n.se].nw].nw].population;
+
+    return inner_population == n.population;
+}
+
+/**
+ * HashlifeWorld::collect_garbage()
+ *
+ * Private helper function to rebuild the node table from only the nodes reachable from the root,
+ * discarding all memoized results.
+ */
+void HashlifeWorld::collect_garbage()
+{
+    std::vector<Node> old_nodes;
+    old_nodes.swap(nodes);
+
+    node_table.clear();
+    result_cache.clear();
+    empty_nodes.assign(1, 0);
+
+    nodes.push_back(old_nodes[0]);
+    nodes.push_back(old_nodes[1]);
+
+    std::vector<uint32_t> remap(old_nodes.size(), UINT32_MAX);
+    remap[0] = 0;
+    remap[1] = 1;
+
+    root = copy_node(old_nodes, root, remap);
+
+    // Don't collect again until the table has at least doubled, even if most of it is still in use
+    garbage_collection_threshold = std::max(static_cast<size_t>(GARBAGE_COLLECTION_THRESHOLD), 2 * nodes.size());
+}
+
+/**
+ * HashlifeWorld::copy_node(old_nodes, node, remap)
+ *
+ * Private helper function to copy a node and its descendants from an old node table into the current one.
+ *
+ * @return
+ *      The id of the node in the current table.
+ */
+uint32_t HashlifeWorld::copy_node(const std::vector<Node> &old_nodes, uint32_t node, std::vector<uint32_t> &remap)
+{
+    if (remap[node] == UINT32_MAX)
+    {
+        const Node n = old_nodes[node];
+
+        const uint32_t nw = copy_node(old_nodes, n.nw, remap);
+        const uint32_t ne = copy_node(old_nodes, n.ne, remap);
+        const uint32_t sw = copy_node(old_nodes, n.sw, remap);
+        const uint32_t se = copy_node(old_nodes, n.se, remap);
+
+        remap[node] = make_node(nw, ne, sw, se);
+    }
+
+    return remap[node];
+}
+
+/**
+ * HashlifeWorld::get_width()
+ *
+ * Gets the width of the default viewport, which is the width of the initial grid or macrocell pattern.
+ *
+ * @return
+ *      The width of the viewport.
+ */
+int HashlifeWorld::get_width() const
+{
+    return width;
+}
+
+/**
+ * HashlifeWorld::get_height()
+ *
+ * Gets the height of the default viewport, which is the height of the initial grid or macrocell pattern.
+ *
+ * @return
+ *      The height of the viewport.
+ */
+int HashlifeWorld::get_height() const
+{
+    return height;
+}
+
+/**
+ * HashlifeWorld::get_alive_cells()
+ *
+ * Counts how many cells are alive anywhere on the plane, in O(1) time.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+uint64_t HashlifeWorld::get_alive_cells() const
+{
+    return nodes[root].population;
+}
+
+/**
+ * HashlifeWorld::get_generation()
+ *
+ * Gets the number of generations the world has been advanced since construction.
+ *
+ * @return
+ *      The current generation.
+ */
+uint64_t HashlifeWorld::get_generation() const
+{
+    return generation;
+}
+
+/**
+ * HashlifeWorld::get_node_count()
+ *
+ * Gets the number of nodes currently held in the node table, including any no longer in use.
+ *
+ * @return
+ *      The size of the node table.
+ */
+size_t HashlifeWorld::get_node_count() const
+{
+    return nodes.size();
+}
+
+/**
+ * HashlifeWorld::get_state()
+ *
+ * Extract the cells within the default viewport, the bounds of the initial grid or macrocell pattern.
+ *
+ * @example
+ *
+ *      // Print the viewport of a world to the console
+ *      std::cout << world.get_state() << std::endl;
+ *
+ * @return
+ *      A new grid of the viewport size.
+ */
+Grid HashlifeWorld::get_state() const
+{
+    return get_state(viewport_x, viewport_y, viewport_x + width, viewport_y + height);
+}
+
+/**
+ * HashlifeWorld::get_state(x0, y0, x1, y1)
+ *
+ * Extract the cells within any rectangle of the plane as a Grid.
+ * The rectangle spans the range [x0, x1) by [y0, y1), where the initial grid's top left corner was the origin.
+ * Only the parts of the quadtree overlapping the rectangle are visited.
+ *
+ * @example
+ *
+ *      // Take a look around the area a glider has flown to
+ *      Grid view = world.get_state(90, 90, 110, 110);
+ *
+ * @return
+ *      A new grid of the requested size.
+ *
+ * @throws
+ *      std::out_of_range if the rectangle has a negative size.
+ */
+Grid HashlifeWorld::get_state(long long x0, long long y0, long long x1, long long y1) const
+{
+    if (x1 < x0 || y1 < y0)
+    {
+        throw std::out_of_range("ERROR: Requested viewport has a negative size.");
+    }
+
+    Grid grid(x1 - x0, y1 - y0);
+    const long long half = 1LL << (nodes[root].level - 1);
+
+    fill(grid, root, -half, -half, x0, y0);
+
+    return grid;
+}
+
+/**
+ * HashlifeWorld::fill(grid, node, node_x, node_y, x0, y0)
+ *
+ * Private helper function to copy the alive cells of a node at (node_x, node_y) into a grid whose top left
+ * corner is at (x0, y0), skipping empty nodes and nodes outside the grid.
+ */
+void HashlifeWorld::fill(Grid &grid, uint32_t node, long long node_x, long long node_y,
+                         long long x0, long long y0) const
+{
+    const Node n = nodes[node];
+    const long long size = 1LL << n.level;
+
+    if (n.population == 0 || node_x >= x0 + grid.get_width() || node_y >= y0 + grid.get_height() ||
+        node_x + size <= x0 || node_y + size <= y0)
+    {
+        return;
+    }
+    else if (n.level == 0)
+    {
+        grid(node_x - x0, node_y - y0) = Cell::ALIVE;
+    }
+    else
+    {
+        const long long half = size / 2;
+
+        fill(grid, n.nw, node_x, node_y, x0, y0);
+        fill(grid, n.ne, node_x + half, node_y, x0, y0);
+        fill(grid, n.sw, node_x, node_y + half, x0, y0);
+        fill(grid, n.se, node_x + half, node_y + half, x0, y0);
+    }
+}
+
+/**
+ * HashlifeWorld::find_bounds(node, cache)
+ *
+ * Private helper function to find the bounding box of the alive cells of a node, which must not be empty.
+ * The boxes of nodes are memoized, so shared subtrees are only ever measured once.
+ *
+ * @return
+ *      The bounding box, relative to the top left corner of the node.
+ */
+HashlifeWorld::Bounds HashlifeWorld::find_bounds(uint32_t node, std::unordered_map<uint32_t, Bounds> &cache) const
+{
+    const Node n = nodes[node];
+
+    if (n.level == 0)
+    {
+        return {0, 0, 1, 1};
+    }
+
+    const auto existing = cache.find(node);
+
+    if (existing != cache.end())
+    {
+        return existing->second;
+    }
+
+    const long long half = 1LL << (n.level - 1);
+    const uint32_t quadrants[4] = {n.nw, n.ne, n.sw, n.se};
+
+    Bounds bounds = {LLONG_MAX, LLONG_MAX, LLONG_MIN, LLONG_MIN};
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (nodes[quadrants[i]].population != 0)
+        {
+            const Bounds quadrant = find_bounds(quadrants[i], cache);
+            const long long dx = (i % 2) * half, dy = (i / 2) * half;
+
+            bounds.x0 = std::min(bounds.x0, quadrant.x0 + dx);
+            bounds.y0 = std::min(bounds.y0, quadrant.y0 + dy);
+            bounds.x1 = std::max(bounds.x1, quadrant.x1 + dx);
+            bounds.y1 = std::max(bounds.y1, quadrant.y1 + dy);
+        }
+    }
+
+    cache[node] = bounds;
+
+    return bounds;
+}
+
+/**
+ * HashlifeWorld::step()
+ *
+ * Take one step in Conway's Game of Life.
+ */
+void HashlifeWorld::step()
+{
+    advance(1);
+}
+
+/**
+ * HashlifeWorld::advance(steps)
+ *
+ * Advance multiple steps in the Game of Life.
+ *
+ * The steps are taken as a sum of powers of 2, one successor of the root for each set bit. Before each,
+ * the root is expanded until it is large enough and all its cells lie in its central quarter, so nothing
+ * can escape the result. Since successors are memoized, regular patterns can be advanced by 2^k
+ * generations in roughly O(k) time.
+ *
+ * @example
+ *
+ *      // See where an r-pentomino ends up after a billion generations
+ *      HashlifeWorld world(Zoo::r_pentomino());
+ *      world.advance(1000000000);
+ *
+ * @param steps
+ *      The number of steps to advance the world forward, less than 2^58.
+ *
+ * @throws
+ *      std::out_of_range if steps is 2^58 or more, as the plane coordinates would overflow.
+ */
+void HashlifeWorld::advance(uint64_t steps)
+{
+    if (steps >= (1ULL << 58))
+    {
+        throw std::out_of_range("ERROR: Too many steps requested for Hashlife.");
+    }
+
+    for (int step_log = 0; (steps >> step_log) != 0; step_log++)
+    {
+        if ((steps >> step_log) & 1ULL)
+        {
+            while (nodes[root].level < step_log + 3 || !is_padded(root))
+            {
+                root = expand(root);
+            }
+
+            root = successor(root, step_log);
+            generation += 1ULL << step_log;
+
+            if (nodes.size() > garbage_collection_threshold)
+            {
+                collect_garbage();
+            }
+        }
+    }
+}
+
+/**
+ * HashlifeWorld::read_macrocell(in)
+ *
+ * Replace the world with a pattern read from a stream in Golly's macrocell format.
+ *
+ * The format lists the nodes of the quadtree bottom up, one per line, numbered from 1:
+ *      - A leaf line is an 8x8 square of cells, where '.' is Cell::DEAD, '*' is Cell::ALIVE, and '$' ends each row.
+ *        Trailing dead cells of a row and trailing empty rows are left out.
+ *      - A node line "k nw ne sw se" is a node of level k > 3, made from the numbered nodes of level k - 1,
+ *        where 0 stands for an empty node.
+ *
+ * Nodes are added straight to the quadtree, and the last node becomes the root, centred on the origin.
+ * The default viewport is set to the bounding box of the alive cells, clamped to the largest size of a Grid.
+ *
+ * @example
+ *
+ *      // Load a pattern and run it for a trillion generations
+ *      HashlifeWorld world;
+ *      std::ifstream in("path/to/pattern.mc");
+ *      world.read_macrocell(in);
+ *      world.advance(1000000000000);
+ *
+ * @param in
+ *      The stream to read from, starting at the "[M2]" header line.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The header is missing, or the pattern uses a rule other than B3/S23.
+ *          - A line is not a valid leaf or node, or refers to a node that is not of the level below.
+ *          - A node is deeper than the plane coordinates allow.
+ */
+void HashlifeWorld::read_macrocell(std::istream &in)
+{
+    *this = HashlifeWorld();
+
+    std::string line;
+    uint64_t line_number = 1;
+
+    if (!std::getline(in, line) || line.compare(0, 4, "[M2]") != 0)
+    {
+        throw std::runtime_error("ERROR: Macrocell data is missing its [M2] header.");
+    }
+
+    const auto invalid = [&line_number]() {
+        return std::runtime_error("ERROR: Macrocell data is invalid on line " + std::to_string(line_number) + ".");
+    };
+
+    // Node ids and levels by line number, where 0 is the empty node
+    std::vector<uint32_t> ids(1, 0);
+    std::vector<int> levels(1, 0);
+
+    while (std::getline(in, line))
+    {
+        line_number++;
+
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+
+        if (line.empty())
+        {
+            continue;
+        }
+        else if (line[0] == '#')
+        {
+            // Only Conway's rule can be simulated, other comments are ignored
+            if (line.compare(0, 2, "#R") == 0)
+            {
+                std::string rule;
+                std::istringstream(line.substr(2)) >> rule;
+                std::transform(rule.begin(), rule.end(), rule.begin(),
+                               [](unsigned char c) { return std::toupper(c); });
+
+                if (rule != "B3/S23" && rule != "23/3")
+                {
+                    throw std::runtime_error("ERROR: Macrocell rule '" + rule + "' is not supported.");
+                }
+            }
+        }
+        else if (line[0] == '.' || line[0] == '*' || line[0] == '$')
+        {
+            uint8_t rows[8] = {0};
+            int x = 0, y = 0;
+
+            for (const char c : line)
+            {
+                if (c == '$')
+                {
+                    x = 0;
+                    y++;
+                }
+                else if ((c != '.' && c != '*') || x >= 8 || y >= 8)
+                {
+                    throw invalid();
+                }
+                else
+                {
+                    rows[y] |= (c == '*') << x;
+                    x++;
+                }
+            }
+
+            ids.push_back(build_leaf(rows, 3, 0, 0));
+            levels.push_back(3);
+        }
+        else
+        {
+            std::istringstream fields(line);
+            int level = 0;
+            uint64_t children[4];
+
+            if (!(fields >> level >> children[0] >> children[1] >> children[2] >> children[3]) ||
+                level <= 3 || level > MAX_MACROCELL_LEVEL)
+            {
+                throw invalid();
+            }
+
+            uint32_t quadrants[4];
+
+            for (int i = 0; i < 4; i++)
+            {
+                if (children[i] >= ids.size() || (children[i] != 0 && levels[children[i]] != level - 1))
+                {
+                    throw invalid();
+                }
+
+                quadrants[i] = children[i] == 0 ? make_empty(level - 1) : ids[children[i]];
+            }
+
+            ids.push_back(make_node(quadrants[0], quadrants[1], quadrants[2], quadrants[3]));
+            levels.push_back(level);
+        }
+    }
+
+    if (ids.size() == 1 || nodes[ids.back()].population == 0)
+    {
+        return;
+    }
+
+    root = ids.back();
+
+    std::unordered_map<uint32_t, Bounds> cache;
+    const Bounds bounds = find_bounds(root, cache);
+    const long long half = 1LL << (nodes[root].level - 1);
+
+    viewport_x = bounds.x0 - half;
+    viewport_y = bounds.y0 - half;
+    width = std::min<long long>(bounds.x1 - bounds.x0, INT_MAX);
+    height = std::min<long long>(bounds.y1 - bounds.y0, INT_MAX);
+}
+
+/**
+ * HashlifeWorld::write_macrocell(out)
+ *
+ * Write the whole plane to a stream in Golly's macrocell format, as described by HashlifeWorld::read_macrocell().
+ * Every distinct node is written once, however many times it appears in the plane, so the output grows with
+ * the size of the quadtree rather than the area of the pattern.
+ *
+ * @example
+ *
+ *      // Save a world that has been running for a while
+ *      std::ofstream out("path/to/pattern.mc");
+ *      world.write_macrocell(out);
+ *
+ * @param out
+ *      The stream to write to.
+ */
+void HashlifeWorld::write_macrocell(std::ostream &out) const
+{
+    out << "[M2] (Game_of_Life)\n"
+        << "#R B3/S23\n";
+
+    // An empty plane has no nodes to write
+    if (nodes[root].population != 0)
+    {
+        std::unordered_map<uint32_t, uint64_t> lines;
+        write_node(out, root, lines);
+    }
+}
+
+/**
+ * HashlifeWorld::write_node(out, node, lines)
+ *
+ * Private helper function to write a node after its descendants, unless it has been written already.
+ *
+ * @return
+ *      The line number of the node, or 0 if it is empty.
+ */
+uint64_t HashlifeWorld::write_node(std::ostream &out, uint32_t node, std::unordered_map<uint32_t, uint64_t> &lines) const
+{
+    const Node n = nodes[node];
+
+    if (n.population == 0)
+    {
+        return 0;
+    }
+
+    const auto existing = lines.find(node);
+
+    if (existing != lines.end())
+    {
+        return existing->second;
+    }
+
+    if (n.level == 3)
+    {
+        Grid leaf(8);
+        fill(leaf, node, 0, 0, 0, 0);
+
+        // Only write up to the last alive cell of each row, and the last row with any
+        std::string text;
+
+        for (int y = 0; y < 8; y++)
+        {
+            const Cell *cells = leaf.row(y);
+            int length = 8;
+
+            while (length > 0 && cells[length - 1] == Cell::DEAD)
+            {
+                length--;
+            }
+
+            for (int x = 0; x < length; x++)
+            {
+                text += (cells[x] == Cell::ALIVE) ? '*' : '.';
+            }
+
+            text += '$';
+        }
+
+        text.erase(text.find_last_not_of('$') + 2);
+        out << text << '\n';
+    }
+    else
+    {
+        const uint64_t nw = write_node(out, n.nw, lines);
+        const uint64_t ne = write_node(out, n.ne, lines);
+        const uint64_t sw = write_node(out, n.sw, lines);
+        const uint64_t se = write_node(out, n.se, lines);
+
+        out << n.level << ' ' << nw << ' ' << ne << ' ' << sw << ' ' << se << '\n';
+    }
+
+    const uint64_t line_number = lines.size() + 1;
+    lines[node] = line_number;
+
+    return line_number;
+}
@@ -0,0 +1,119 @@
+/**
+ * Declares a class for simulating the Game of Life on an unbounded plane using Hashlife.
+ * Rich documentation for the api and behaviour the HashlifeWorld class can be found in hashlife.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Declare the structure of the HashlifeWorld class for simulating a world stored as a hash-consed quadtree.
+ *
+ * Every distinct square of cells is stored exactly once as a node, and the result of advancing each node
+ * is memoized, so repetitive patterns can be advanced by huge numbers of generations at once.
+ */
+class HashlifeWorld
+{
+    private:
+        static const int UPPER_POPULATION_LIMIT = 3;
+        static const int LOWER_POPULATION_LIMIT = 2;
+
+        // Macrocell nodes deeper than this are refused, so plane coordinates cannot overflow as the root expands
+        static const int MAX_MACROCELL_LEVEL = 56;
+
+        // Unreachable nodes are discarded once the table grows past at least this many
+        static const size_t GARBAGE_COLLECTION_THRESHOLD = 1 << 23;
+
+        /**
+         * A square of 2^level by 2^level cells made from four quadrants of the level below.
+         * Nodes of level 0 are single cells, where node 0 is Cell::DEAD and node 1 is Cell::ALIVE.
+         */
+        struct Node
+        {
+            uint32_t nw, ne, sw, se;
+            uint64_t population;
+            int level;
+        };
+
+        struct NodeKey
+        {
+            uint32_t nw, ne, sw, se;
+
+            bool operator==(const NodeKey &other) const;
+        };
+
+        /**
+         * The bounding box [x0, x1) by [y0, y1) of the alive cells of a node, relative to its top left corner.
+         */
+        struct Bounds
+        {
+            long long x0, y0, x1, y1;
+        };
+
+        struct NodeKeyHash
+        {
+            size_t operator()(const NodeKey &key) const;
+        };
+
+        std::vector<Node> nodes;
+        std::unordered_map<NodeKey, uint32_t, NodeKeyHash> node_table;
+        std::unordered_map<uint64_t, uint32_t> result_cache; // Keyed by node id and log2 of the step
+        std::vector<uint32_t> empty_nodes; // The empty node of each level
+
+        uint32_t root; // Centred on the origin, covering [-2^(level - 1), 2^(level - 1)) on both axes
+        long long viewport_x;
+        long long viewport_y;
+        int width;
+        int height;
+        uint64_t generation;
+        size_t garbage_collection_threshold;
+
+        uint32_t make_node(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se);
+        uint32_t make_empty(int level);
+        uint32_t build(const Grid &grid, int level, long long x0, long long y0);
+        uint32_t build_leaf(const uint8_t *rows, int level, int x0, int y0);
+
+        uint32_t centre(uint32_t node);
+        uint32_t centre_horizontal(uint32_t west, uint32_t east);
+        uint32_t centre_vertical(uint32_t north, uint32_t south);
+        uint32_t step_base(uint32_t node);
+        uint32_t successor(uint32_t node, int step_log);
+
+        uint32_t expand(uint32_t node);
+        bool is_padded(uint32_t node) const;
+        void collect_garbage();
+        uint32_t copy_node(const std::vector<Node> &old_nodes, uint32_t node, std::vector<uint32_t> &remap);
+
+        void fill(Grid &grid, uint32_t node, long long node_x, long long node_y,
+                  long long x0, long long y0) const;
+        Bounds find_bounds(uint32_t node, std::unordered_map<uint32_t, Bounds> &cache) const;
+        uint64_t write_node(std::ostream &out, uint32_t node, std::unordered_map<uint32_t, uint64_t> &lines) const;
+
+    public:
+        HashlifeWorld();
+        explicit HashlifeWorld(const Grid &initial_state);
+
+        int get_width() const;
+        int get_height() const;
+        uint64_t get_alive_cells() const;
+        uint64_t get_generation() const;
+        size_t get_node_count() const;
+
+        Grid get_state() const;
+        Grid get_state(long long x0, long long y0, long long x1, long long y1) const;
+
+        void step();
+        void advance(uint64_t steps);
+
+        void read_macrocell(std::istream &in);
+        void write_macrocell(std::ostream &out) const;
+};
@@ -0,0 +1,114 @@
+/**
+ * Implements a class for reading a whole file through a read-only memory mapping.
+ *      - The file is mapped when the MappedFile is constructed and unmapped when it is destroyed.
+ *      - Pages are read in lazily as they are touched, so nothing is copied up front and very large files
+ *        are never held twice in memory.
+ *      - Uses the POSIX mmap interface.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.h"
+
+/**
+ * MappedFile::MappedFile(path)
+ *
+ * Map the whole of a file into memory for reading.
+ *
+ * @example
+ *
+ *      // Map a board and read its header
+ *      MappedFile file("path/to/file.bgol");
+ *      const unsigned char *header = file.get_data();
+ *
+ * @param path
+ *      The std::string path to the file to map.
+ *
+ * @throws
+ *      Throws std::runtime_error if the file cannot be opened or mapped.
+ */
+MappedFile::MappedFile(const std::string &path) : contents(nullptr), size(0)
+{
+    const int descriptor = open(path.c_str(), O_RDONLY);
+
+    if (descriptor < 0)
+    {
+        throw std::runtime_error("ERROR: File '" + path + "' not found.");
+    }
+
+    struct stat status;
+
+    if (fstat(descriptor, &status) != 0)
+    {
+        close(descriptor);
+        throw std::runtime_error("ERROR: Cannot read file '" + path + "'.");
+    }
+
+    size = static_cast<size_t>(status.st_size);
+
+    // Empty files cannot be mapped, but have nothing to read anyway
+    if (size > 0)
+    {
+        void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+        if (mapping == MAP_FAILED)
+        {
+            close(descriptor);
+            throw std::runtime_error("ERROR: Cannot map file '" + path + "'.");
+        }
+
+        // The file is read front to back, so ask for it to be read ahead aggressively
+        madvise(mapping, size, MADV_SEQUENTIAL);
+
+        contents = static_cast<const unsigned char *>(mapping);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(descriptor);
+}
+
+/**
+ * MappedFile::~MappedFile()
+ *
+ * Unmap the file.
+ */
+MappedFile::~MappedFile()
+{
+    if (contents)
+    {
+        munmap(const_cast<unsigned char *>(contents), size);
+    }
+}
+
+/**
+ * MappedFile::get_data()
+ *
+ * Gets a pointer to the first byte of the file, which stays valid for the lifetime of the MappedFile.
+ *
+ * @return
+ *      A read-only pointer to the contents, or nullptr if the file is empty.
+ */
+const unsigned char *MappedFile::get_data() const
+{
+    return contents;
+}
+
+/**
+ * MappedFile::get_size()
+ *
+ * Gets the size of the file.
+ *
+ * @return
+ *      The number of bytes in the file.
+ */
+size_t MappedFile::get_size() const
+{
+    return size;
+}
@@ -0,0 +1,33 @@
+/**
+ * Declares a class for reading a whole file through a read-only memory mapping.
+ * Rich documentation for the api and behaviour the MappedFile class can be found in mapped_file.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Declare the structure of the MappedFile class for mapping a file into memory for as long as it is alive.
+ *
+ * The contents are paged in by the operating system on first access, rather than copied into a buffer.
+ */
+class MappedFile
+{
+    private:
+        const unsigned char *contents;
+        size_t size;
+
+    public:
+        explicit MappedFile(const std::string &path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        const unsigned char *get_data() const;
+        size_t get_size() const;
+};
@@ -0,0 +1,118 @@
+/**
+ * Implements a Memory namespace with the memory resources grids and scratch buffers are allocated from.
+ *      - The aligned resource hands out memory aligned to at least a 64 byte cache line.
+ *          - Every Grid allocates its cells from it unless given another resource, so the rows the SIMD kernels
+ *            load from start on a cache line.
+ *          - Allocations of 2MiB or more are aligned to 2MiB and marked for transparent huge pages, so sweeping
+ *            a large board touches 512x fewer TLB entries.
+ *
+ *      - The scratch resource is a pool of recycled blocks belonging to the calling thread.
+ *          - Temporary buffers which are allocated and freed over and over, such as file buffers, the tile
+ *            flags of each step, and temporary grids in pattern placement loops, reuse the same blocks rather
+ *            than going back to the system allocator each time.
+ *          - The pool is never shared, so it needs no locks, and is freed when its thread exits.
+ *          - Memory from the scratch resource must be freed by the thread which allocated it, before it exits.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <algorithm>
+#include <new>
+
+#include <sys/mman.h>
+
+#include "memory_pool.h"
+
+/**
+ * Memory::AlignedResource::do_allocate(bytes, alignment)
+ *
+ * Allocate memory aligned to at least a cache line, or to a huge page for allocations of at least a huge page,
+ * which are then advised to be backed by transparent huge pages.
+ *
+ * @throws
+ *      Throws std::bad_alloc if the memory cannot be allocated.
+ */
+void *Memory::AlignedResource::do_allocate(size_t bytes, size_t alignment)
+{
+    const bool huge = bytes >= HUGE_PAGE_SIZE;
+    alignment = std::max(alignment, huge ? HUGE_PAGE_SIZE : CACHE_LINE_SIZE);
+
+    // Aligned new rather than the C allocator, so programs counting allocations by replacing it see these too
+    void *memory = ::operator new(bytes, std::align_val_t(alignment));
+
+#ifdef MADV_HUGEPAGE
+    if (huge)
+    {
+        // Only advice, so carry on with normal pages if it is refused
+        madvise(memory, bytes - bytes % HUGE_PAGE_SIZE, MADV_HUGEPAGE);
+    }
+#endif
+
+    return memory;
+}
+
+/**
+ * Memory::AlignedResource::do_deallocate(memory, bytes, alignment)
+ *
+ * Free memory allocated by Memory::AlignedResource::do_allocate.
+ */
+void Memory::AlignedResource::do_deallocate(void *memory, size_t bytes, size_t alignment)
+{
+    alignment = std::max(alignment, bytes >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : CACHE_LINE_SIZE);
+
+    ::operator delete(memory, std::align_val_t(alignment));
+}
+
+/**
+ * Memory::AlignedResource::do_is_equal(other)
+ *
+ * Compare resources, where memory from one aligned resource can be freed by any other.
+ *
+ * @return
+ *      True if the other resource is also an aligned resource.
+ */
+bool Memory::AlignedResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return dynamic_cast<const AlignedResource *>(&other) != nullptr;
+}
+
+/**
+ * Memory::get_aligned_resource()
+ *
+ * Gets the resource every Grid allocates its cells from by default, shared by every thread.
+ *
+ * @return
+ *      A pointer to the aligned resource, valid for the life of the program.
+ */
+std::pmr::memory_resource *Memory::get_aligned_resource()
+{
+    static AlignedResource resource;
+
+    return &resource;
+}
+
+/**
+ * Memory::get_scratch_resource()
+ *
+ * Gets the pool of recycled blocks belonging to the calling thread, for temporary buffers.
+ * Blocks of up to 4MiB are pooled, drawing from the aligned resource, and larger blocks go straight to it.
+ *
+ * @example
+ *
+ *      // Read a file through a buffer which is reused by the next call on this thread
+ *      std::pmr::vector<char> buffer(1 << 20, Memory::get_scratch_resource());
+ *
+ *      // Place many rotated copies of a pattern without allocating a new grid for each
+ *      Grid rotated(0, 0, Memory::get_scratch_resource());
+ *      pattern.rotate_into(rotated, 1);
+ *
+ * @return
+ *      A pointer to the pool of the calling thread, valid until the thread exits.
+ */
+std::pmr::memory_resource *Memory::get_scratch_resource()
+{
+    thread_local std::pmr::unsynchronized_pool_resource pool(std::pmr::pool_options{0, 4 << 20},
+                                                             get_aligned_resource());
+
+    return &pool;
+}
@@ -0,0 +1,37 @@
+/**
+ * Declares a Memory namespace with the memory resources grids and scratch buffers are allocated from.
+ * Rich documentation for the api and behaviour the Memory namespace can be found in memory_pool.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+/**
+ * Declare the interface of the Memory namespace for allocating aligned and pooled memory.
+ */
+namespace Memory
+{
+    // Every allocation of the aligned resource starts on a cache line, so vector loads never split one
+    const size_t CACHE_LINE_SIZE = 64;
+
+    // Allocations at least this big are aligned to and backed by transparent huge pages where available
+    const size_t HUGE_PAGE_SIZE = 2 << 20;
+
+    /**
+     * Declare the structure of the AlignedResource class for allocating cache line or huge page aligned memory.
+     */
+    class AlignedResource : public std::pmr::memory_resource
+    {
+        protected:
+            void *do_allocate(size_t bytes, size_t alignment) override;
+            void do_deallocate(void *memory, size_t bytes, size_t alignment) override;
+            bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+    };
+
+    std::pmr::memory_resource *get_aligned_resource();
+    std::pmr::memory_resource *get_scratch_resource();
+}
@@ -0,0 +1,795 @@
+/**
+ * Implements a class representing a bit-packed 2d grid of cells.
+ *      - Cells are stored as single bits, 64 cells to a uint64_t word, with each row starting on a new word.
+ *      - New cells are initialized to Cell::DEAD.
+ *      - PackedGrids mirror the api of Grid, and can be converted to and from a Grid.
+ *      - PackedGrids can be resized, rotated, cropped, and merged together.
+ *      - PackedGrids can return counts of the alive and dead cells.
+ *      - PackedGrids can be serialized directly to an ascii std::ostream in the same format as Grid.
+ *
+ * Since a single bit cannot be referenced, the non-const operator() returns a PackedGrid::CellReference
+ * proxy which reads and writes through to the packed word.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "packed_grid.h"
+
+/**
+ * PackedGrid::CellReference::CellReference(word, mask)
+ *
+ * Construct a proxy reference to the single cell selected by mask within a packed word.
+ *
+ * @param word
+ *      The packed word holding the cell.
+ *
+ * @param mask
+ *      A word with only the bit of the referenced cell set.
+ */
+PackedGrid::CellReference::CellReference(uint64_t &word, uint64_t mask) : word(word), mask(mask) {}
+
+/**
+ * PackedGrid::CellReference::operator Cell()
+ *
+ * Read the referenced cell.
+ *
+ * @return
+ *      Cell::ALIVE if the referenced bit is set, otherwise Cell::DEAD.
+ */
+PackedGrid::CellReference::operator Cell() const
+{
+    return (word & mask) ? Cell::ALIVE : Cell::DEAD;
+}
+
+/**
+ * PackedGrid::CellReference::operator=(value)
+ *
+ * Write to the referenced cell.
+ *
+ * @param value
+ *      The value to be written to the referenced cell.
+ *
+ * @return
+ *      Returns a reference to this proxy to enable assignment chaining.
+ */
+PackedGrid::CellReference &PackedGrid::CellReference::operator=(const Cell value)
+{
+    if (value == Cell::ALIVE)
+    {
+        word |= mask;
+    }
+    else
+    {
+        word &= ~mask;
+    }
+
+    return *this;
+}
+
+/**
+ * PackedGrid::CellReference::operator=(other)
+ *
+ * Copy the value of another referenced cell into this referenced cell, as would happen with a Cell &.
+ *
+ * @param other
+ *      The proxy to read the new value from.
+ *
+ * @return
+ *      Returns a reference to this proxy to enable assignment chaining.
+ */
+PackedGrid::CellReference &PackedGrid::CellReference::operator=(const CellReference &other)
+{
+    return operator=(static_cast<Cell>(other));
+}
+
+/**
+ * PackedGrid::PackedGrid()
+ *
+ * Construct an empty packed grid of size 0x0.
+ *
+ * @example
+ *
+ *      // Make a 0x0 empty grid
+ *      PackedGrid grid;
+ *
+ */
+PackedGrid::PackedGrid() : PackedGrid::PackedGrid(0) {}
+
+/**
+ * PackedGrid::PackedGrid(square_size)
+ *
+ * Construct a packed grid with the desired size filled with dead cells.
+ *
+ * @example
+ *
+ *      // Make a 16x16 grid
+ *      PackedGrid grid(16);
+ *
+ * @param square_size
+ *      The edge size to use for the width and height of the grid.
+ */
+PackedGrid::PackedGrid(int square_size) : PackedGrid::PackedGrid(square_size, square_size) {}
+
+/**
+ * PackedGrid::PackedGrid(width, height)
+ *
+ * Construct a packed grid with the desired size filled with dead cells.
+ *
+ * @example
+ *
+ *      // Make a 16x9 grid
+ *      PackedGrid grid(16, 9);
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ */
+PackedGrid::PackedGrid(int width, int height)
+    : width(width), height(height), words_per_row(get_words_for_width(width)),
+      words(static_cast<size_t>(words_per_row) * height, 0) {}
+
+/**
+ * PackedGrid::PackedGrid(grid)
+ *
+ * Construct a packed grid holding a copy of the cells in a byte-per-cell Grid.
+ *
+ * @example
+ *
+ *      // Pack a glider into 1 bit per cell
+ *      PackedGrid packed(Zoo::glider());
+ *
+ * @param grid
+ *      The grid to copy the size and cells from.
+ */
+PackedGrid::PackedGrid(const Grid &grid) : PackedGrid::PackedGrid(grid.get_width(), grid.get_height())
+{
+    for (int y = 0; y < height; y++)
+    {
+        uint64_t *destination = row(y);
+
+        for (int x = 0; x < width; x++)
+        {
+            if (grid(x, y) == Cell::ALIVE)
+            {
+                destination[x / 64] |= 1ULL << (x % 64);
+            }
+        }
+    }
+}
+
+/**
+ * PackedGrid::get_words_for_width(width)
+ *
+ * Private helper function to determine how many words are needed to store a row of cells.
+ *
+ * @param width
+ *      The number of cells in a row.
+ *
+ * @return
+ *      The number of 64 bit words needed to hold the row.
+ */
+int PackedGrid::get_words_for_width(int width)
+{
+    return (width + 63) / 64;
+}
+
+/**
+ * PackedGrid::clear_padding()
+ *
+ * Private helper function to zero the unused bits past the width of the grid in the last word of every row.
+ * Population counts and the step kernels rely on these bits always being 0.
+ */
+void PackedGrid::clear_padding()
+{
+    if (words_per_row > 0)
+    {
+        const uint64_t mask = get_padding_mask();
+
+        for (int y = 0; y < height; y++)
+        {
+            row(y)[words_per_row - 1] &= mask;
+        }
+    }
+}
+
+/**
+ * PackedGrid::get_width()
+ *
+ * Gets the current width of the grid.
+ *
+ * @return
+ *      The width of the grid.
+ */
+int PackedGrid::get_width() const
+{
+    return width;
+}
+
+/**
+ * PackedGrid::get_height()
+ *
+ * Gets the current height of the grid.
+ *
+ * @return
+ *      The height of the grid.
+ */
+int PackedGrid::get_height() const
+{
+    return height;
+}
+
+/**
+ * PackedGrid::get_total_cells()
+ *
+ * Gets the total number of cells in the grid.
+ *
+ * @return
+ *      The number of total cells.
+ */
+int PackedGrid::get_total_cells() const
+{
+    return width * height;
+}
+
+/**
+ * PackedGrid::get_alive_cells()
+ *
+ * Counts how many cells in the grid are alive, by taking the population count of every word.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+int PackedGrid::get_alive_cells() const
+{
+    int count = 0;
+
+    for (const uint64_t word : words)
+    {
+        count += __builtin_popcountll(word);
+    }
+
+    return count;
+}
+
+/**
+ * PackedGrid::get_dead_cells()
+ *
+ * Counts how many cells in the grid are dead.
+ *
+ * @return
+ *      The number of dead cells.
+ */
+int PackedGrid::get_dead_cells() const
+{
+    return get_total_cells() - get_alive_cells();
+}
+
+/**
+ * PackedGrid::get_words_per_row()
+ *
+ * Gets the number of 64 bit words used to store each row.
+ *
+ * @return
+ *      The row length in words.
+ */
+int PackedGrid::get_words_per_row() const
+{
+    return words_per_row;
+}
+
+/**
+ * PackedGrid::get_padding_mask()
+ *
+ * Gets a mask of the bits of the last word in each row which hold cells, rather than padding.
+ *
+ * @return
+ *      A word with a 1 bit for every valid cell position in the last word of a row.
+ */
+uint64_t PackedGrid::get_padding_mask() const
+{
+    const int used_bits = width % 64;
+
+    return used_bits == 0 ? ~0ULL : (1ULL << used_bits) - 1;
+}
+
+/**
+ * PackedGrid::resize(square_size)
+ *
+ * Resize the current grid to a new width and height that are equal. The content of the grid
+ * is preserved within the kept region and padded with Cell::DEAD if new cells are added.
+ *
+ * @param square_size
+ *      The new edge size for both the width and height of the grid.
+ */
+void PackedGrid::resize(int square_size)
+{
+    resize(square_size, square_size);
+}
+
+/**
+ * PackedGrid::resize(new_width, new_height)
+ *
+ * Resize the current grid to a new width and height. The content of the grid
+ * is preserved within the kept region and padded with Cell::DEAD if new cells are added.
+ *
+ * @param new_width
+ *      The new width for the grid.
+ *
+ * @param new_height
+ *      The new height for the grid.
+ */
+void PackedGrid::resize(int new_width, int new_height)
+{
+    // Sanity check; skip everything if no values change
+    if (new_width != width || new_height != height)
+    {
+        PackedGrid new_grid(new_width, new_height);
+
+        const int kept_rows = std::min(height, new_height);
+        const int kept_words = std::min(words_per_row, new_grid.words_per_row);
+
+        // Copy whole words of the kept region, the old padding bits are already 0
+        for (int y = 0; y < kept_rows; y++)
+        {
+            std::copy(row(y), row(y) + kept_words, new_grid.row(y));
+        }
+
+        // Narrowing can leave old cells in the new padding bits
+        new_grid.clear_padding();
+
+        *this = std::move(new_grid);
+    }
+}
+
+/**
+ * PackedGrid::operator()(x, y)
+ *
+ * Gets a modifiable proxy reference to the value at the desired coordinate.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      PackedGrid grid(4, 4);
+ *
+ *      // Directly assign to a cell at coordinate (1, 2)
+ *      grid(1, 2) = Cell::ALIVE;
+ *
+ * @param x
+ *      The x coordinate of the cell to access.
+ *
+ * @param y
+ *      The y coordinate of the cell to access.
+ *
+ * @return
+ *      A proxy that reads and writes the desired cell.
+ *
+ * @throws
+ *      std::out_of_range if x,y is not a valid coordinate within the grid.
+ */
+PackedGrid::CellReference PackedGrid::operator()(int x, int y)
+{
+    // Check x/y within bounds
+    if (x >= width || x < 0 || y >= height || y < 0)
+    {
+        throw std::out_of_range("ERROR: Requested cell coordinate is out of bounds.");
+    }
+    else
+    {
+        return CellReference(row(y)[x / 64], 1ULL << (x % 64));
+    }
+}
+
+/**
+ * PackedGrid::operator()(x, y)
+ *
+ * Gets the value at the desired coordinate.
+ * The operator should be callable from a constant context.
+ *
+ * @param x
+ *      The x coordinate of the cell to access.
+ *
+ * @param y
+ *      The y coordinate of the cell to access.
+ *
+ * @return
+ *      The value of the desired cell.
+ *
+ * @throws
+ *      std::out_of_range if x,y is not a valid coordinate within the grid.
+ */
+Cell PackedGrid::operator()(int x, int y) const
+{
+    // Check x/y within bounds
+    if (x >= width || x < 0 || y >= height || y < 0)
+    {
+        throw std::out_of_range("ERROR: Requested cell coordinate is out of bounds.");
+    }
+    else
+    {
+        return ((row(y)[x / 64] >> (x % 64)) & 1ULL) ? Cell::ALIVE : Cell::DEAD;
+    }
+}
+
+/**
+ * PackedGrid::get(x, y)
+ *
+ * Returns the value of the cell at the desired coordinate.
+ *
+ * @param x
+ *      The x coordinate of the cell.
+ *
+ * @param y
+ *      The y coordinate of the cell.
+ *
+ * @return
+ *      The value of the desired cell.
+ *
+ * @throws
+ *      std::out_of_range if x,y is not a valid coordinate within the grid.
+ */
+Cell PackedGrid::get(int x, int y) const
+{
+    return operator()(x, y);
+}
+
+/**
+ * PackedGrid::set(x, y, value)
+ *
+ * Overwrites the value at the desired coordinate.
+ *
+ * @param x
+ *      The x coordinate of the cell to update.
+ *
+ * @param y
+ *      The y coordinate of the cell to update.
+ *
+ * @param value
+ *      The value to be written to the selected cell.
+ *
+ * @throws
+ *      std::out_of_range if x,y is not a valid coordinate within the grid.
+ */
+void PackedGrid::set(int x, int y, const Cell value)
+{
+    operator()(x, y) = value;
+}
+
+/**
+ * PackedGrid::row(y)
+ *
+ * Gets a pointer to the first word of a row, for use by word-parallel kernels.
+ * No bounds checking is performed.
+ *
+ * @param y
+ *      The y coordinate of the row.
+ *
+ * @return
+ *      A pointer to get_words_per_row() consecutive words.
+ */
+uint64_t *PackedGrid::row(int y)
+{
+    return words.data() + static_cast<size_t>(y) * words_per_row;
+}
+
+/**
+ * PackedGrid::row(y)
+ *
+ * Gets a read-only pointer to the first word of a row, for use by word-parallel kernels.
+ * No bounds checking is performed.
+ *
+ * @param y
+ *      The y coordinate of the row.
+ *
+ * @return
+ *      A pointer to get_words_per_row() consecutive words.
+ */
+const uint64_t *PackedGrid::row(int y) const
+{
+    return words.data() + static_cast<size_t>(y) * words_per_row;
+}
+
+/**
+ * extract_word(source, source_words, bit)
+ *
+ * Helper function to read 64 consecutive cells from a packed row starting at any bit offset.
+ * Cells past the end of the row are read as 0.
+ *
+ * @param source
+ *      The packed row to read from.
+ *
+ * @param source_words
+ *      The number of words in the row.
+ *
+ * @param bit
+ *      The index of the first cell to read.
+ *
+ * @return
+ *      A word holding the cells [bit, bit + 64) of the row.
+ */
+static uint64_t extract_word(const uint64_t *source, int source_words, int bit)
+{
+    const int index = bit / 64;
+    const int shift = bit % 64;
+
+    uint64_t low = index < source_words ? source[index] >> shift : 0;
+    uint64_t high = (shift != 0 && index + 1 < source_words) ? source[index + 1] << (64 - shift) : 0;
+
+    return low | high;
+}
+
+/**
+ * PackedGrid::crop(x0, y0, x1, y1)
+ *
+ * Extract a sub-grid from a PackedGrid, copying whole words at a time.
+ * The cropped grid spans the range [x0, x1) by [y0, y1) in the original grid.
+ *
+ * @param x0
+ *      Left coordinate of the crop window on x-axis.
+ *
+ * @param y0
+ *      Top coordinate of the crop window on y-axis.
+ *
+ * @param x1
+ *      Right coordinate of the crop window on x-axis (1 greater than the largest index).
+ *
+ * @param y1
+ *      Bottom coordinate of the crop window on y-axis (1 greater than the largest index).
+ *
+ * @return
+ *      A new grid of the cropped size containing the values extracted from the original grid.
+ *
+ * @throws
+ *      std::out_of_range if the crop window does not lie within the grid or has a negative size.
+ */
+PackedGrid PackedGrid::crop(int x0, int y0, int x1, int y1) const
+{
+    // Check x0, y0 within bounds and x1, y1 within bounds and not before x0, y0
+    if (x0 >= width || x0 < 0 || y0 >= height || y0 < 0 || x1 < x0 || y1 < y0 || x1 > width || y1 > height)
+    {
+        throw std::out_of_range("ERROR: Attempted crop is out of bounds.");
+    }
+    else
+    {
+        PackedGrid new_grid(x1 - x0, y1 - y0);
+
+        for (int y = 0; y < new_grid.height; y++)
+        {
+            const uint64_t *source = row(y + y0);
+            uint64_t *destination = new_grid.row(y);
+
+            for (int i = 0; i < new_grid.words_per_row; i++)
+            {
+                destination[i] = extract_word(source, words_per_row, x0 + i * 64);
+            }
+        }
+
+        // Cells right of x1 may have been read into the last word of each row
+        new_grid.clear_padding();
+
+        return new_grid;
+    }
+}
+
+/**
+ * PackedGrid::merge(other, x0, y0, alive_only = false)
+ *
+ * Merge two grids together by overlaying the other on the current grid at the desired location,
+ * writing whole words at a time. Follows the same rules as Grid::merge.
+ *
+ * @param other
+ *      The other grid to merge into the current grid.
+ *
+ * @param x0
+ *      The x coordinate of where to place the top left corner of the other grid.
+ *
+ * @param y0
+ *      The y coordinate of where to place the top left corner of the other grid.
+ *
+ * @param alive_only
+ *      Optional parameter. If true then merging only sets alive cells to alive but does not explicitly set
+ *      dead cells, allowing whatever value was already there to persist. Defaults to false.
+ *
+ * @throws
+ *      std::exception or sub-class if the other grid being placed does not fit within the bounds of the current grid.
+ */
+void PackedGrid::merge(const PackedGrid &other, int x0, int y0, bool alive_only)
+{
+    if (x0 < 0 || y0 < 0)
+    {
+        throw std::out_of_range("ERROR: Merging grid out of bounds.");
+    }
+    else if (width < x0 + other.get_width() || height < y0 + other.get_height())
+    {
+        throw std::invalid_argument("ERROR: Merging grid too large.");
+    }
+    else
+    {
+        const int shift = x0 % 64;
+
+        for (int y = 0; y < other.height; y++)
+        {
+            const uint64_t *source = other.row(y);
+            uint64_t *destination = row(y + y0) + x0 / 64;
+
+            for (int i = 0; i < other.words_per_row; i++)
+            {
+                // Only the last word of the other grid's row has padding bits to leave alone
+                const uint64_t mask = (i == other.words_per_row - 1) ? other.get_padding_mask() : ~0ULL;
+                const uint64_t value = source[i];
+
+                // The source word straddles at most two destination words
+                uint64_t low_mask = mask << shift;
+                uint64_t high_mask = shift == 0 ? 0 : mask >> (64 - shift);
+
+                if (alive_only)
+                {
+                    destination[i] |= value << shift;
+                }
+                else
+                {
+                    destination[i] = (destination[i] & ~low_mask) | (value << shift);
+                }
+
+                if (high_mask != 0)
+                {
+                    if (alive_only)
+                    {
+                        destination[i + 1] |= value >> (64 - shift);
+                    }
+                    else
+                    {
+                        destination[i + 1] = (destination[i + 1] & ~high_mask) | (value >> (64 - shift));
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * PackedGrid::rotate(rotation)
+ *
+ * Create a copy of the grid that is rotated by a multiple of 90 degrees, in the same direction as Grid::rotate.
+ *
+ * @param _rotation
+ *      An positive or negative integer to rotate by in 90 intervals.
+ *
+ * @return
+ *      Returns a copy of the grid that has been rotated.
+ */
+PackedGrid PackedGrid::rotate(int _rotation) const
+{
+    // Normalise rotation amount to range [0, 3]
+    int rotation = _rotation % 4;
+
+    // Correct negative results to fix C++'s silly modulus
+    if (rotation < 0)
+    {
+        rotation += 4;
+    }
+
+    if (rotation == 0)
+    {
+        return *this;
+    }
+
+    // Odd rotations swap the width and height
+    PackedGrid new_grid = (rotation == 2) ? PackedGrid(width, height) : PackedGrid(height, width);
+
+    for (int y = 0; y < height; y++)
+    {
+        const uint64_t *source = row(y);
+
+        for (int x = 0; x < width; x++)
+        {
+            if ((source[x / 64] >> (x % 64)) & 1ULL)
+            {
+                int new_x = 0, new_y = 0;
+
+                if (rotation == 1)
+                {
+                    new_x = height - 1 - y;
+                    new_y = x;
+                }
+                else if (rotation == 2)
+                {
+                    new_x = width - 1 - x;
+                    new_y = height - 1 - y;
+                }
+                else
+                {
+                    new_x = y;
+                    new_y = width - 1 - x;
+                }
+
+                new_grid.row(new_y)[new_x / 64] |= 1ULL << (new_x % 64);
+            }
+        }
+    }
+
+    return new_grid;
+}
+
+/**
+ * PackedGrid::to_grid()
+ *
+ * Unpack the grid into a byte-per-cell Grid of the same size.
+ *
+ * @example
+ *
+ *      // Print a packed grid via a Grid
+ *      std::cout << packed.to_grid() << std::endl;
+ *
+ * @return
+ *      A Grid holding a copy of the cells.
+ */
+Grid PackedGrid::to_grid() const
+{
+    Grid grid(width, height);
+
+    for (int y = 0; y < height; y++)
+    {
+        const uint64_t *source = row(y);
+
+        for (int x = 0; x < width; x++)
+        {
+            if ((source[x / 64] >> (x % 64)) & 1ULL)
+            {
+                grid(x, y) = Cell::ALIVE;
+            }
+        }
+    }
+
+    return grid;
+}
+
+/**
+ * operator<<(output_stream, grid)
+ *
+ * Serializes a packed grid to an ascii output stream, in the same bordered format as a Grid.
+ *
+ * @param os
+ *      An ascii mode output stream such as std::cout.
+ *
+ * @param grid
+ *      A packed grid object containing cells to be printed.
+ *
+ * @return
+ *      Returns a reference to the output stream to enable operator chaining.
+ */
+std::ostream &operator<<(std::ostream &output_stream, const PackedGrid &grid)
+{
+    // Create (identical) top & bottom borders
+    const std::string border = "+" + std::string(grid.get_width(), '-') + "+\n";
+
+    // Print top border
+    output_stream << border;
+
+    // Print grid contents a row at a time
+    std::string line(grid.get_width() + 2, ' ');
+    line.front() = '|';
+    line.back() = '|';
+
+    for (int y = 0; y < grid.get_height(); y++)
+    {
+        const uint64_t *source = grid.row(y);
+
+        for (int x = 0; x < grid.get_width(); x++)
+        {
+            line[x + 1] = ((source[x / 64] >> (x % 64)) & 1ULL) ? '#' : ' ';
+        }
+
+        output_stream << line << "\n";
+    }
+
+    // Print bottom border
+    output_stream << border;
+
+    return output_stream;
+}
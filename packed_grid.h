@@ -0,0 +1,183 @@
+/**
+ * Declares a class representing a bit-packed 2d grid of cells.
+ * Rich documentation for the api and behaviour the PackedGrid class can be found in packed_grid.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Declare the structure of the PackedGrid class for representing a 2d grid of cells using 1 bit per cell.
+ *
+ * Each row is stored as a run of 64 bit words, with cell x held in bit (x % 64) of word (x / 64).
+ * Any padding bits past the width of the grid in the last word of a row are always 0.
+ */
+class PackedGrid
+{
+    public:
+        /**
+         * A proxy standing in for a Cell & into a packed word, since single bits cannot be referenced.
+         */
+        class CellReference
+        {
+            private:
+                uint64_t &word;
+                uint64_t mask;
+
+            public:
+                CellReference(uint64_t &word, uint64_t mask);
+
+                operator Cell() const;
+                CellReference &operator=(const Cell value);
+                CellReference &operator=(const CellReference &other);
+        };
+
+    private:
+        int width;
+        int height;
+        int words_per_row;
+        std::vector<uint64_t> words; // 1D word array, words_per_row words per row
+
+        static int get_words_for_width(int width);
+
+        void clear_padding();
+
+    public:
+        PackedGrid();
+        explicit PackedGrid(int square_size);
+        PackedGrid(int width, int height);
+        explicit PackedGrid(const Grid &grid);
+
+        int get_width() const;
+        int get_height() const;
+        int get_total_cells() const;
+        int get_alive_cells() const;
+        int get_dead_cells() const;
+        int get_words_per_row() const;
+        uint64_t get_padding_mask() const;
+
+        void resize(int square_size);
+        void resize(int new_width, int new_height);
+
+        CellReference operator()(int x, int y);
+        Cell operator()(int x, int y) const;
+
+        Cell get(int x, int y) const;
+        void set(int x, int y, const Cell value);
+
+        uint64_t *row(int y);
+        const uint64_t *row(int y) const;
+
+        PackedGrid crop(int x0, int y0, int x1, int y1) const;
+        void merge(const PackedGrid &other, int x0, int y0, bool alive_only = false);
+        PackedGrid rotate(int rotation) const;
+
+        Grid to_grid() const;
+
+        friend std::ostream &operator<<(std::ostream &output_stream, const PackedGrid &grid);
+};
+
+/**
+ * life_word(north_west, north, north_east, west, centre, east, south_west, south, south_east)
+ *
+ * Helper function applying the rules of Conway's Game of Life to 64 cells at once, shared by the packed engines.
+ * Each argument holds one neighbour of every cell, lined up bit for bit with centre.
+ *
+ * The neighbours are summed with a tree of bitwise full adders into a bit-sliced count,
+ * where only the bits for 1s and 2s and a flag for 4 or more are needed:
+ *      - A count of 3 is always a birth or survival.
+ *      - A count of 2 is a survival only if the centre cell is already alive.
+ *
+ * @return
+ *      A word holding the next state of the 64 centre cells.
+ */
+inline uint64_t life_word(uint64_t north_west, uint64_t north, uint64_t north_east,
+                          uint64_t west, uint64_t centre, uint64_t east,
+                          uint64_t south_west, uint64_t south, uint64_t south_east)
+{
+    // Sum each row of neighbours, as a 1s bit and a 2s bit
+    const uint64_t north_ones = north_west ^ north ^ north_east;
+    const uint64_t north_twos = (north_west & north) | (north_east & (north_west ^ north));
+    const uint64_t south_ones = south_west ^ south ^ south_east;
+    const uint64_t south_twos = (south_west & south) | (south_east & (south_west ^ south));
+    const uint64_t middle_ones = west ^ east;
+    const uint64_t middle_twos = west & east;
+
+    // Sum the 1s of each row, carrying in to the 2s
+    const uint64_t ones = north_ones ^ south_ones ^ middle_ones;
+    const uint64_t ones_carry = (north_ones & south_ones) | (middle_ones & (north_ones ^ south_ones));
+
+    // Sum the 2s of each row and the carry, any carry out of which means 4 or more neighbours
+    const uint64_t row_twos = north_twos ^ south_twos ^ middle_twos;
+    const uint64_t row_twos_carry = (north_twos & south_twos) | (middle_twos & (north_twos ^ south_twos));
+    const uint64_t twos = row_twos ^ ones_carry;
+    const uint64_t fours = row_twos_carry | (row_twos & ones_carry);
+
+    return twos & ~fours & (ones | centre);
+}
+
+/**
+ * rule_word(north_west, north, north_east, west, centre, east, south_west, south, south_east, birth, survival)
+ *
+ * Helper function applying any Life-like rule to 64 cells at once, for rules other than Conway's Game of Life.
+ * Each argument holds one neighbour of every cell, lined up bit for bit with centre.
+ *
+ * The neighbours are summed with the same tree of bitwise full adders as life_word, but keeping the full
+ * bit-sliced count from 0 to 8. Each count in the masks then selects the cells whose count bits match it.
+ *
+ * @param birth
+ *      Bit n is set if a dead cell with n alive neighbours is born.
+ *
+ * @param survival
+ *      Bit n is set if an alive cell with n alive neighbours survives.
+ *
+ * @return
+ *      A word holding the next state of the 64 centre cells.
+ */
+inline uint64_t rule_word(uint64_t north_west, uint64_t north, uint64_t north_east,
+                          uint64_t west, uint64_t centre, uint64_t east,
+                          uint64_t south_west, uint64_t south, uint64_t south_east,
+                          uint16_t birth, uint16_t survival)
+{
+    // Sum each row of neighbours, as a 1s bit and a 2s bit
+    const uint64_t north_ones = north_west ^ north ^ north_east;
+    const uint64_t north_twos = (north_west & north) | (north_east & (north_west ^ north));
+    const uint64_t south_ones = south_west ^ south ^ south_east;
+    const uint64_t south_twos = (south_west & south) | (south_east & (south_west ^ south));
+    const uint64_t middle_ones = west ^ east;
+    const uint64_t middle_twos = west & east;
+
+    // Sum the 1s of each row, carrying in to the 2s
+    const uint64_t ones = north_ones ^ south_ones ^ middle_ones;
+    const uint64_t ones_carry = (north_ones & south_ones) | (middle_ones & (north_ones ^ south_ones));
+
+    // Sum the 2s of each row and the carry, where both carries out are only set together by a count of 8
+    const uint64_t row_twos = north_twos ^ south_twos ^ middle_twos;
+    const uint64_t row_twos_carry = (north_twos & south_twos) | (middle_twos & (north_twos ^ south_twos));
+    const uint64_t twos = row_twos ^ ones_carry;
+    const uint64_t fours = row_twos_carry ^ (row_twos & ones_carry);
+    const uint64_t eights = row_twos_carry & row_twos & ones_carry;
+
+    uint64_t next = 0;
+
+    for (int n = 0; n <= 8; n++)
+    {
+        const uint64_t count_is_n = ((n & 1) ? ones : ~ones) & ((n & 2) ? twos : ~twos) &
+                                    ((n & 4) ? fours : ~fours) & ((n & 8) ? eights : ~eights);
+
+        // All-ones when the count is in the mask, so the rule is applied with no branches
+        const uint64_t born = ~centre & (0 - static_cast<uint64_t>((birth >> n) & 1));
+        const uint64_t survives = centre & (0 - static_cast<uint64_t>((survival >> n) & 1));
+
+        next |= count_is_n & (born | survives);
+    }
+
+    return next;
+}
@@ -0,0 +1,317 @@
+/**
+ * Implements a class for drawing a window of a grid as ascii text or a PBM image, optionally zoomed out.
+ *      - Frames are formatted into a single buffer held by the renderer, then written with one call.
+ *          - The buffer keeps its allocation between frames, so drawing a window the same size as the last
+ *            never allocates.
+ *          - At a scale of 1 each row is copied into the buffer in one go, since the values of Cell are their
+ *            own ascii characters.
+ *
+ *      - Any window [x0, x1) by [y0, y1) of the grid can be drawn, so the cost of a frame is the cells in the
+ *        window however big the grid is.
+ *
+ *      - A scale of N draws each N by N block of cells of the window as one character or pixel.
+ *          - Ascii frames show how many cells of each block are alive with the GLYPHS, from ' ' (space) for an
+ *            empty block to # (hash) for a full one, so a scale of 1 looks exactly like a printed Grid. Any
+ *            alive cell at all gives a block a visible glyph.
+ *          - PBM frames show a block as black if any of its cells are alive, so a lone glider stays visible
+ *            however far out the frame is zoomed.
+ *          - Blocks cut short by the edge of the window count against the cells they actually cover.
+ *
+ *      - Ascii frames are wrapped in the same border of - (dash), | (pipe), and + (plus) characters as a Grid.
+ *      - PBM frames are binary (P4) portable bitmaps, which any image tool can convert to PNG or a video.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "renderer.h"
+
+const char Renderer::GLYPHS[] = " .:-=+*#";
+
+/**
+ * Renderer::Renderer(scale)
+ *
+ * Construct a renderer drawing blocks of scale by scale cells.
+ *
+ * @example
+ *
+ *      // Draw a large world at one character per 8x8 block
+ *      Renderer renderer(8);
+ *      renderer.write_ascii(std::cout, world.get_state());
+ *
+ * @param scale
+ *      Optional parameter. The edge length of the blocks of cells drawn as one character or pixel. Defaults to 1.
+ *
+ * @throws
+ *      std::invalid_argument if scale is less than 1.
+ */
+Renderer::Renderer(int scale) : scale(1)
+{
+    set_scale(scale);
+}
+
+/**
+ * Renderer::get_scale()
+ *
+ * @return
+ *      The edge length of the blocks of cells drawn as one character or pixel.
+ */
+int Renderer::get_scale() const
+{
+    return scale;
+}
+
+/**
+ * Renderer::set_scale(new_scale)
+ *
+ * Change the edge length of the blocks of cells drawn as one character or pixel.
+ *
+ * @param new_scale
+ *      The new edge length.
+ *
+ * @throws
+ *      std::invalid_argument if new_scale is less than 1.
+ */
+void Renderer::set_scale(int new_scale)
+{
+    if (new_scale < 1)
+    {
+        throw std::invalid_argument("ERROR: A renderer needs a scale of at least 1.");
+    }
+
+    scale = new_scale;
+}
+
+/**
+ * Renderer::write_ascii(output_stream, grid)
+ *
+ * Draw the whole of a grid as ascii text.
+ *
+ * @param output_stream
+ *      An ascii mode output stream such as std::cout.
+ *
+ * @param grid
+ *      The grid to draw.
+ */
+void Renderer::write_ascii(std::ostream &output_stream, const Grid &grid)
+{
+    write_ascii(output_stream, grid, 0, 0, grid.get_width(), grid.get_height());
+}
+
+/**
+ * Renderer::write_ascii(output_stream, grid, x0, y0, x1, y1)
+ *
+ * Draw a window of a grid as ascii text, one character per block of cells, wrapped in a border.
+ *
+ * @example
+ *
+ *      // Draw the top left 80x40 cells of a world
+ *      Renderer renderer;
+ *      renderer.write_ascii(std::cout, world.get_state(), 0, 0, 80, 40);
+ *
+ *      // A 4x2 grid with the top left 2x2 block full and one cell of the other alive, at a scale of 2
+ *
+ *      +--+
+ *      |#:|
+ *      +--+
+ *
+ * @param output_stream
+ *      An ascii mode output stream such as std::cout.
+ *
+ * @param grid
+ *      The grid to draw.
+ *
+ * @param x0
+ *      The left edge of the window, inclusive.
+ *
+ * @param y0
+ *      The top edge of the window, inclusive.
+ *
+ * @param x1
+ *      The right edge of the window, exclusive.
+ *
+ * @param y1
+ *      The bottom edge of the window, exclusive.
+ *
+ * @throws
+ *      std::out_of_range if the window is not within the grid.
+ */
+void Renderer::write_ascii(std::ostream &output_stream, const Grid &grid, int x0, int y0, int x1, int y1)
+{
+    check_window(grid, x0, y0, x1, y1);
+
+    const int frame_width = (x1 - x0 + scale - 1) / scale;
+    const int frame_height = (y1 - y0 + scale - 1) / scale;
+    const size_t line_length = frame_width + 3;
+
+    buffer.resize(line_length * (frame_height + 2));
+    char *line = &buffer[0];
+
+    // Top & bottom borders
+    std::memset(line, '-', line_length);
+    line[0] = '+';
+    line[frame_width + 1] = '+';
+    line[frame_width + 2] = '\n';
+    std::memcpy(line + line_length * (frame_height + 1), line, line_length);
+
+    for (int frame_y = 0; frame_y < frame_height; frame_y++)
+    {
+        line += line_length;
+        line[0] = '|';
+        line[frame_width + 1] = '|';
+        line[frame_width + 2] = '\n';
+
+        if (scale == 1)
+        {
+            // Cell values are their own ascii characters
+            std::memcpy(line + 1, grid.row(y0 + frame_y) + x0, frame_width);
+            continue;
+        }
+
+        const int block_y0 = y0 + frame_y * scale;
+        const int block_y1 = std::min(block_y0 + scale, y1);
+        count_blocks(grid, x0, x1, block_y0, block_y1);
+
+        for (int frame_x = 0; frame_x < frame_width; frame_x++)
+        {
+            const int block_cells = (std::min(x0 + (frame_x + 1) * scale, x1) - (x0 + frame_x * scale)) *
+                                    (block_y1 - block_y0);
+
+            // Rounded up, so only an empty block is blank and only a full one is drawn as a #
+            line[frame_x + 1] = GLYPHS[(block_counts[frame_x] * (GLYPH_COUNT - 1) + block_cells - 1) / block_cells];
+        }
+    }
+
+    output_stream.write(buffer.data(), buffer.size());
+}
+
+/**
+ * Renderer::write_pbm(output_stream, grid)
+ *
+ * Draw the whole of a grid as a PBM image.
+ *
+ * @param output_stream
+ *      A binary mode output stream, such as an std::ofstream opened with std::ios::binary.
+ *
+ * @param grid
+ *      The grid to draw.
+ */
+void Renderer::write_pbm(std::ostream &output_stream, const Grid &grid)
+{
+    write_pbm(output_stream, grid, 0, 0, grid.get_width(), grid.get_height());
+}
+
+/**
+ * Renderer::write_pbm(output_stream, grid, x0, y0, x1, y1)
+ *
+ * Draw a window of a grid as a binary PBM image, one pixel per block of cells, black where any cell of the
+ * block is alive.
+ *
+ * @example
+ *
+ *      // Save a frame of a world zoomed out to one pixel per 4x4 block
+ *      Renderer renderer(4);
+ *      std::ofstream frame("frame.pbm", std::ios::binary);
+ *      renderer.write_pbm(frame, world.get_state());
+ *
+ * @param output_stream
+ *      A binary mode output stream, such as an std::ofstream opened with std::ios::binary.
+ *
+ * @param grid
+ *      The grid to draw.
+ *
+ * @param x0
+ *      The left edge of the window, inclusive.
+ *
+ * @param y0
+ *      The top edge of the window, inclusive.
+ *
+ * @param x1
+ *      The right edge of the window, exclusive.
+ *
+ * @param y1
+ *      The bottom edge of the window, exclusive.
+ *
+ * @throws
+ *      std::out_of_range if the window is not within the grid.
+ */
+void Renderer::write_pbm(std::ostream &output_stream, const Grid &grid, int x0, int y0, int x1, int y1)
+{
+    check_window(grid, x0, y0, x1, y1);
+
+    const int frame_width = (x1 - x0 + scale - 1) / scale;
+    const int frame_height = (y1 - y0 + scale - 1) / scale;
+    const size_t row_bytes = (frame_width + 7) / 8;
+
+    const std::string header = "P4\n" + std::to_string(frame_width) + " " + std::to_string(frame_height) + "\n";
+
+    // Pixels are packed 8 to a byte, the first in the high bit, with each row padded to a whole byte
+    buffer.assign(header.size() + row_bytes * frame_height, '\0');
+    std::memcpy(&buffer[0], header.data(), header.size());
+
+    for (int frame_y = 0; frame_y < frame_height; frame_y++)
+    {
+        unsigned char *pixels = reinterpret_cast<unsigned char *>(&buffer[header.size() + row_bytes * frame_y]);
+
+        const int block_y0 = y0 + frame_y * scale;
+        const int block_y1 = std::min(block_y0 + scale, y1);
+        count_blocks(grid, x0, x1, block_y0, block_y1);
+
+        for (int frame_x = 0; frame_x < frame_width; frame_x++)
+        {
+            pixels[frame_x / 8] |= (block_counts[frame_x] > 0) << (7 - frame_x % 8);
+        }
+    }
+
+    output_stream.write(buffer.data(), buffer.size());
+}
+
+/**
+ * Renderer::check_window(grid, x0, y0, x1, y1)
+ *
+ * Private helper function checking a window lies within a grid, as Grid::crop does. An empty window is allowed.
+ *
+ * @throws
+ *      std::out_of_range if the window is not within the grid.
+ */
+void Renderer::check_window(const Grid &grid, int x0, int y0, int x1, int y1)
+{
+    if (x0 < 0 || y0 < 0 || x1 > grid.get_width() || y1 > grid.get_height() || x1 < x0 || y1 < y0)
+    {
+        throw std::out_of_range("ERROR: Attempted to draw a window outside of the grid.");
+    }
+}
+
+/**
+ * Renderer::count_blocks(grid, x0, x1, y0, y1)
+ *
+ * Private helper function counting the alive cells of each block along a row of blocks, covering columns
+ * [x0, x1) of rows [y0, y1), into the block counts. Every cell is read once, a row at a time.
+ */
+void Renderer::count_blocks(const Grid &grid, int x0, int x1, int y0, int y1)
+{
+    const int blocks = (x1 - x0 + scale - 1) / scale;
+    block_counts.assign(blocks, 0);
+
+    for (int y = y0; y < y1; y++)
+    {
+        const Cell *row = grid.row(y) + x0;
+
+        // Summed a block at a time, so the inner loop is a plain run of compares the compiler can vectorize
+        for (int block = 0; block < blocks; block++)
+        {
+            const int end = std::min((block + 1) * scale, x1 - x0);
+            int count = 0;
+
+            for (int x = block * scale; x < end; x++)
+            {
+                count += row[x] == Cell::ALIVE;
+            }
+
+            block_counts[block] += count;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * Declares a class for drawing a window of a grid as ascii text or a PBM image, optionally zoomed out.
+ * Rich documentation for the api and behaviour the Renderer class can be found in renderer.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Declare the structure of the Renderer class for drawing grids with a single write per frame.
+ *
+ * Each frame is formatted into one buffer, kept between frames, and written to the stream with one call.
+ * With a scale of N, each N by N block of cells is drawn as a single character or pixel, so drawing costs
+ * the cells in the window rather than the whole grid, and the output shrinks by N squared.
+ */
+class Renderer
+{
+    public:
+        // The characters blocks are drawn with, from no alive cells to every cell alive
+        static const char GLYPHS[];
+        static const int GLYPH_COUNT = 8;
+
+    private:
+        int scale;
+        std::string buffer; // The frame being drawn, reused so a frame the same size as the last never allocates
+        std::vector<int> block_counts; // Alive cells in each block of the row of blocks being drawn
+
+        static void check_window(const Grid &grid, int x0, int y0, int x1, int y1);
+
+        void count_blocks(const Grid &grid, int x0, int x1, int y0, int y1);
+
+    public:
+        explicit Renderer(int scale = 1);
+
+        int get_scale() const;
+        void set_scale(int new_scale);
+
+        void write_ascii(std::ostream &output_stream, const Grid &grid);
+        void write_ascii(std::ostream &output_stream, const Grid &grid, int x0, int y0, int x1, int y1);
+
+        void write_pbm(std::ostream &output_stream, const Grid &grid);
+        void write_pbm(std::ostream &output_stream, const Grid &grid, int x0, int y0, int x1, int y1);
+};
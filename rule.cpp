@@ -0,0 +1,295 @@
+/**
+ * Implements a class representing the birth and survival rule of a Life-like cellular automaton.
+ *      - A rule names the neighbour counts at which a dead cell is born and an alive cell survives,
+ *        every other cell is dead in the next state.
+ *          - https://www.conwaylife.com/wiki/Life-like_cellular_automaton
+ *      - Rules can be parsed from and printed as rulestrings.
+ *          - "B3/S23" lists the birth counts after a B and the survival counts after an S.
+ *          - "23/3" is the older survival/birth notation for the same rule.
+ *      - The default rule is Conway's Game of Life, B3/S23.
+ *
+ *      - Each rule is compiled into a lookup table of the next state for all 512 3x3 neighbourhoods, so a
+ *        kernel can step any rule with a single load per cell and no branches.
+ *      - The common rules are also available as FixedRule types, letting kernels be specialized on them at
+ *        compile time, see Rule::is<Fixed>().
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+#include "rule.h"
+
+/**
+ * Rule::Rule()
+ *
+ * Construct the rule of Conway's Game of Life, B3/S23.
+ *
+ * @example
+ *
+ *      // Make the default rule
+ *      Rule rule;
+ */
+Rule::Rule() : Rule::Rule(Conway::BIRTH_MASK, Conway::SURVIVAL_MASK) {}
+
+/**
+ * Rule::Rule(birth, survival)
+ *
+ * Construct a rule from masks of the neighbour counts for a birth and a survival.
+ *
+ * @example
+ *
+ *      // Make HighLife, B36/S23
+ *      Rule rule((1 << 3) | (1 << 6), (1 << 2) | (1 << 3));
+ *
+ * @param birth
+ *      Bit n is set if a dead cell with n alive neighbours is born.
+ *
+ * @param survival
+ *      Bit n is set if an alive cell with n alive neighbours survives.
+ *
+ * @throws
+ *      Throws std::invalid_argument if either mask has a bit set above bit 8.
+ */
+Rule::Rule(uint16_t birth, uint16_t survival) : birth(birth), survival(survival), table()
+{
+    if (birth >> 9 || survival >> 9)
+    {
+        throw std::invalid_argument("ERROR: A cell cannot have more than 8 neighbours.");
+    }
+
+    build_table();
+}
+
+/**
+ * Rule::build_table()
+ *
+ * Private helper function filling the lookup table with the next state of the centre cell of every neighbourhood.
+ */
+void Rule::build_table()
+{
+    for (int neighbourhood = 0; neighbourhood < 512; neighbourhood++)
+    {
+        const bool alive = (neighbourhood >> 4) & 1;
+        const int num_neighbours = __builtin_popcount(neighbourhood) - alive;
+
+        table[neighbourhood] = ((alive ? survival : birth) >> num_neighbours) & 1 ? Cell::ALIVE : Cell::DEAD;
+    }
+}
+
+/**
+ * Rule::parse(rulestring)
+ *
+ * Parse a rule from a rulestring, in either B/S or S/B notation.
+ * Letters may be upper or lower case, and the slash may be left out between named lists.
+ *
+ * @example
+ *
+ *      // All of these are HighLife
+ *      Rule a = Rule::parse("B36/S23");
+ *      Rule b = Rule::parse("b36s23");
+ *      Rule c = Rule::parse("23/36");
+ *
+ * @param rulestring
+ *      The rulestring to parse.
+ *
+ * @return
+ *      The parsed rule.
+ *
+ * @throws
+ *      Throws std::invalid_argument if the rulestring is malformed or holds a count above 8.
+ */
+Rule Rule::parse(const std::string &rulestring)
+{
+    const std::invalid_argument invalid("ERROR: Invalid rule '" + rulestring + "'.");
+
+    std::string text = rulestring;
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::toupper(c); });
+
+    uint16_t masks[2] = {0, 0}; // Birth then survival
+    bool seen[2] = {false, false};
+
+    // Without any letters the lists are survival then birth
+    const bool named = text.find_first_of("BS") != std::string::npos;
+    int list = named ? -1 : 1;
+
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        const char c = text[i];
+
+        if (named && (c == 'B' || c == 'S'))
+        {
+            list = c == 'B' ? 0 : 1;
+
+            if (seen[list])
+            {
+                throw invalid;
+            }
+
+            seen[list] = true;
+        }
+        else if (c == '/' && named)
+        {
+            // Named lists may only be split by a single slash
+            if (list < 0 || i + 1 == text.size() || (text[i + 1] != 'B' && text[i + 1] != 'S'))
+            {
+                throw invalid;
+            }
+        }
+        else if (c == '/' && list == 1)
+        {
+            list = 0;
+        }
+        else if (c >= '0' && c <= '8' && list >= 0)
+        {
+            masks[list] |= 1 << (c - '0');
+        }
+        else
+        {
+            throw invalid;
+        }
+    }
+
+    if (named ? !seen[0] || !seen[1] : text.find('/') == std::string::npos)
+    {
+        throw invalid;
+    }
+
+    return Rule(masks[0], masks[1]);
+}
+
+/**
+ * Rule::get_birth()
+ *
+ * Gets the neighbour counts at which a dead cell is born.
+ *
+ * @return
+ *      A mask with bit n set if a dead cell with n alive neighbours is born.
+ */
+uint16_t Rule::get_birth() const
+{
+    return birth;
+}
+
+/**
+ * Rule::get_survival()
+ *
+ * Gets the neighbour counts at which an alive cell survives.
+ *
+ * @return
+ *      A mask with bit n set if an alive cell with n alive neighbours survives.
+ */
+uint16_t Rule::get_survival() const
+{
+    return survival;
+}
+
+/**
+ * Rule::next(num_neighbours, cell)
+ *
+ * Decide the next state of a single cell from its number of alive neighbours.
+ *
+ * @example
+ *
+ *      // A dead cell with 3 neighbours is born under Conway's Game of Life
+ *      Cell cell = Rule().next(3, Cell::DEAD);
+ *
+ * @param num_neighbours
+ *      The number of alive neighbours of the cell, from 0 to 8.
+ *
+ * @param cell
+ *      The current state of the cell.
+ *
+ * @return
+ *      The next state of the cell.
+ */
+Cell Rule::next(int num_neighbours, Cell cell) const
+{
+    return ((cell == Cell::ALIVE ? survival : birth) >> num_neighbours) & 1 ? Cell::ALIVE : Cell::DEAD;
+}
+
+/**
+ * Rule::get_table()
+ *
+ * Gets the lookup table of the next state of the centre cell of every 3x3 neighbourhood.
+ * See the Rule class declaration for how neighbourhoods are indexed.
+ *
+ * @example
+ *
+ *      // The next state of a cell with the three cells above it alive
+ *      Cell cell = rule.get_table()[(1 << 0) | (1 << 3) | (1 << 6)];
+ *
+ * @return
+ *      A pointer to the 512 entries of the table, valid for the life of the rule.
+ */
+const Cell *Rule::get_table() const
+{
+    return table.data();
+}
+
+/**
+ * Rule::to_string()
+ *
+ * Gets the rulestring of the rule in B/S notation, with the counts of each list in ascending order.
+ *
+ * @return
+ *      The rulestring, e.g. "B3/S23".
+ */
+std::string Rule::to_string() const
+{
+    std::string rulestring = "B";
+
+    for (int n = 0; n <= 8; n++)
+    {
+        if ((birth >> n) & 1)
+        {
+            rulestring += static_cast<char>('0' + n);
+        }
+    }
+
+    rulestring += "/S";
+
+    for (int n = 0; n <= 8; n++)
+    {
+        if ((survival >> n) & 1)
+        {
+            rulestring += static_cast<char>('0' + n);
+        }
+    }
+
+    return rulestring;
+}
+
+/**
+ * Rule::operator==(other)
+ *
+ * Compare two rules, which are equal when they give the same next state for every neighbourhood.
+ *
+ * @param other
+ *      The rule to compare with.
+ *
+ * @return
+ *      True if both the birth and survival masks match.
+ */
+bool Rule::operator==(const Rule &other) const
+{
+    return birth == other.birth && survival == other.survival;
+}
+
+/**
+ * Rule::operator!=(other)
+ *
+ * Compare two rules, see Rule::operator==(other).
+ *
+ * @param other
+ *      The rule to compare with.
+ *
+ * @return
+ *      True if either the birth or survival masks differ.
+ */
+bool Rule::operator!=(const Rule &other) const
+{
+    return !(*this == other);
+}
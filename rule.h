@@ -0,0 +1,129 @@
+/**
+ * Declares a class representing the birth and survival rule of a Life-like cellular automaton.
+ * Rich documentation for the api and behaviour the Rule class can be found in rule.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "grid.h"
+
+/**
+ * A rule fixed at compile time, for the kernels to specialize the common rules on.
+ * Bit n of BIRTH is set if a dead cell with n alive neighbours is born, and bit n of SURVIVAL if an alive cell
+ * with n alive neighbours survives.
+ */
+template <uint16_t BIRTH, uint16_t SURVIVAL>
+struct FixedRule
+{
+    static constexpr uint16_t BIRTH_MASK = BIRTH;
+    static constexpr uint16_t SURVIVAL_MASK = SURVIVAL;
+
+    /**
+     * FixedRule::next(num_neighbours, alive)
+     *
+     * Decide whether a cell is alive in the next state with no branches or lookups.
+     * The loop is unrolled and every count outside the masks folded away, leaving only the compares a
+     * hand-written kernel for the rule would make, e.g. (num_neighbours == 3) | (alive & (num_neighbours == 2)).
+     */
+    static constexpr bool next(unsigned char num_neighbours, bool alive)
+    {
+        bool result = false;
+
+        for (int n = 0; n <= 8; n++)
+        {
+            result |= (num_neighbours == n) & (alive ? (SURVIVAL_MASK >> n) & 1 : (BIRTH_MASK >> n) & 1);
+        }
+
+        return result;
+    }
+};
+
+/**
+ * The rules the kernels are specialized for.
+ *      - Conway is B3/S23, Conway's Game of Life.
+ *      - HighLife is B36/S23, which has a small replicator.
+ *      - DayAndNight is B3678/S34678, which is symmetric under swapping alive and dead cells.
+ *      - Seeds is B2/S, where every cell dies each step.
+ */
+using Conway = FixedRule<1 << 3, (1 << 2) | (1 << 3)>;
+using HighLife = FixedRule<(1 << 3) | (1 << 6), (1 << 2) | (1 << 3)>;
+using DayAndNight = FixedRule<(1 << 3) | (1 << 6) | (1 << 7) | (1 << 8),
+                              (1 << 3) | (1 << 4) | (1 << 6) | (1 << 7) | (1 << 8)>;
+using Seeds = FixedRule<1 << 2, 0>;
+
+/**
+ * Declare the structure of the Rule class for representing a Life-like rule chosen at runtime.
+ *
+ * The rule is compiled into a table of the next state of the centre cell for each of the 512 3x3 neighbourhoods.
+ * Each neighbourhood is indexed column by column, so bits 0-2 hold the column to the left of the cell,
+ * bits 3-5 the column of the cell, and bits 6-8 the column to the right, from top to bottom within each column.
+ * The cell itself is bit 4, and sliding one cell to the right shifts the index down by 3 bits.
+ */
+class Rule
+{
+    private:
+        uint16_t birth;
+        uint16_t survival;
+        std::array<Cell, 512> table;
+
+        void build_table();
+
+    public:
+        Rule();
+        Rule(uint16_t birth, uint16_t survival);
+
+        static Rule parse(const std::string &rulestring);
+
+        template <class Fixed>
+        static Rule from();
+
+        template <class Fixed>
+        bool is() const;
+
+        uint16_t get_birth() const;
+        uint16_t get_survival() const;
+
+        Cell next(int num_neighbours, Cell cell) const;
+        const Cell *get_table() const;
+
+        std::string to_string() const;
+
+        bool operator==(const Rule &other) const;
+        bool operator!=(const Rule &other) const;
+};
+
+/**
+ * Rule::from<Fixed>()
+ *
+ * Construct the runtime rule for a rule fixed at compile time.
+ *
+ * @example
+ *
+ *      // Simulate HighLife
+ *      world.set_rule(Rule::from<HighLife>());
+ */
+template <class Fixed>
+Rule Rule::from()
+{
+    return Rule(Fixed::BIRTH_MASK, Fixed::SURVIVAL_MASK);
+}
+
+/**
+ * Rule::is<Fixed>()
+ *
+ * Checks whether this rule is a rule fixed at compile time, so a kernel specialized for it can be used.
+ *
+ * @return
+ *      True if the birth and survival masks match.
+ */
+template <class Fixed>
+bool Rule::is() const
+{
+    return birth == Fixed::BIRTH_MASK && survival == Fixed::SURVIVAL_MASK;
+}
@@ -0,0 +1,924 @@
+/**
+ * Implements a Simd namespace with hand-vectorized kernels for stepping and counting byte-per-cell Grid objects.
+ *      - Each kernel computes the cells of a row whose 8 neighbours can all be read, either within the grid or
+ *        from its ghost border, as swept by Engine::STENCIL and Engine::SIMD.
+ *          - A vector of cells is loaded at offsets -1, 0, and +1 from each of the rows above, in line with,
+ *            and below, compared against Cell::ALIVE, and the neighbours summed with byte subtracts of
+ *            the all-ones compare masks.
+ *          - The rule is applied with two byte shuffles, looking each count up in 16 byte tables of the next
+ *            state of a dead and an alive cell, and the result blended by the state of each cell, with no
+ *            branches. Any Rule costs the same.
+ *          - Cells left over past the last full vector are finished by the scalar kernel.
+ *          - Block kernels sweep many rows a fixed pitch apart, such as the rows of a TiledGrid tile, laying out
+ *            the tables once for the whole block rather than once per row.
+ *
+ *      - Population count kernels count the alive cells of a run of cells, comparing a vector of cells against
+ *        Cell::ALIVE and taking the popcount of the resulting bit mask.
+ *
+ *      - Kernels are compiled for AVX2 and AVX-512BW with function target attributes, so the rest of the
+ *        program does not need to be built for those instruction sets, and for NEON when targeting ARM.
+ *          - The best kernel the running CPU supports is picked the first time one is requested.
+ *          - The scalar kernel is always available and gives identical output.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "simd_kernels.h"
+
+/**
+ * sweep_fixed_row<Fixed>(above, middle, below, destination, x0, x1)
+ *
+ * Helper function implementing the scalar kernel for a rule fixed at compile time, with no bounds checks,
+ * lookups, or branches so the loop can still be auto-vectorized.
+ * The pointers are marked as never aliasing, since the next state is always a separate buffer.
+ */
+template <class Fixed>
+static void sweep_fixed_row(const Cell *__restrict above, const Cell *__restrict middle,
+                            const Cell *__restrict below, Cell *__restrict destination, int x0, int x1)
+{
+    for (int x = x0; x < x1; x++)
+    {
+        // Summed in bytes rather than ints so more cells fit in each vector register
+        const unsigned char num_neighbours =
+            (above[x - 1] == Cell::ALIVE) + (above[x] == Cell::ALIVE) + (above[x + 1] == Cell::ALIVE) +
+            (middle[x - 1] == Cell::ALIVE) + (middle[x + 1] == Cell::ALIVE) +
+            (below[x - 1] == Cell::ALIVE) + (below[x] == Cell::ALIVE) + (below[x + 1] == Cell::ALIVE);
+
+        destination[x] = Fixed::next(num_neighbours, middle[x] == Cell::ALIVE) ? Cell::ALIVE : Cell::DEAD;
+    }
+}
+
+/**
+ * sweep_table_row(above, middle, below, destination, x0, x1, table)
+ *
+ * Helper function implementing the scalar kernel for any other rule, looking up each cell in the 512 entry
+ * table of the rule. The index of the 3x3 neighbourhood is rolled along the row, so each step only reads the
+ * column of cells entering it on the right.
+ */
+static void sweep_table_row(const Cell *__restrict above, const Cell *__restrict middle,
+                            const Cell *__restrict below, Cell *__restrict destination, int x0, int x1,
+                            const Cell *__restrict table)
+{
+    const auto column = [=](int x) {
+        return static_cast<unsigned int>((above[x] == Cell::ALIVE) | ((middle[x] == Cell::ALIVE) << 1) |
+                                         ((below[x] == Cell::ALIVE) << 2));
+    };
+
+    unsigned int neighbourhood = column(x0 - 1) | (column(x0) << 3);
+
+    for (int x = x0; x < x1; x++)
+    {
+        neighbourhood |= column(x + 1) << 6;
+        destination[x] = table[neighbourhood];
+        neighbourhood >>= 3;
+    }
+}
+
+/**
+ * Simd::sweep_interior_row(above, middle, below, destination, x0, x1, rule)
+ *
+ * The scalar kernel, computing the next state of cells [x0, x1) of a row whose neighbours can all be read.
+ * Conway's Game of Life, HighLife, Day & Night, and Seeds each get a kernel specialized at compile time which
+ * the compiler is free to auto-vectorize, and any other rule is looked up cell by cell in the table of the rule.
+ *
+ * @param above
+ *      The row of the current state above the row being computed.
+ *
+ * @param middle
+ *      The row of the current state being computed.
+ *
+ * @param below
+ *      The row of the current state below the row being computed.
+ *
+ * @param destination
+ *      The row of the next state to write.
+ *
+ * @param x0
+ *      The first cell to compute. The cell before it must be readable, either in the row or its ghost border.
+ *
+ * @param x1
+ *      The cell after the last cell to compute, which must also be readable.
+ *
+ * @param rule
+ *      The rule deciding the next state of each cell.
+ */
+void Simd::sweep_interior_row(const Cell *above, const Cell *middle, const Cell *below, Cell *destination,
+                              int x0, int x1, const Rule &rule)
+{
+    if (rule.is<Conway>())
+    {
+        sweep_fixed_row<Conway>(above, middle, below, destination, x0, x1);
+    }
+    else if (rule.is<HighLife>())
+    {
+        sweep_fixed_row<HighLife>(above, middle, below, destination, x0, x1);
+    }
+    else if (rule.is<DayAndNight>())
+    {
+        sweep_fixed_row<DayAndNight>(above, middle, below, destination, x0, x1);
+    }
+    else if (rule.is<Seeds>())
+    {
+        sweep_fixed_row<Seeds>(above, middle, below, destination, x0, x1);
+    }
+    else
+    {
+        sweep_table_row(above, middle, below, destination, x0, x1, rule.get_table());
+    }
+}
+
+/**
+ * sweep_fixed_block<Fixed>(source, destination, pitch, width, rows)
+ *
+ * Helper function sweeping a block of rows with the scalar kernel for a rule fixed at compile time.
+ */
+template <class Fixed>
+static void sweep_fixed_block(const Cell *source, Cell *destination, ptrdiff_t pitch, int width, int rows)
+{
+    for (int y = 0; y < rows; y++)
+    {
+        const Cell *middle = source + y * pitch;
+        sweep_fixed_row<Fixed>(middle - pitch, middle, middle + pitch, destination + y * pitch, 0, width);
+    }
+}
+
+/**
+ * Simd::sweep_interior_block(source, destination, pitch, width, rows, rule)
+ *
+ * The scalar block kernel, computing the next state of cells [0, width) of a block of rows whose neighbours can
+ * all be read. Gives the same result as calling Simd::sweep_interior_row for each row, but the rule is only
+ * looked at once, which matters when the rows are short such as the rows of a TiledGrid tile.
+ *
+ * @param source
+ *      The first row of the block in the current state. The rows above and below the block must be readable.
+ *
+ * @param destination
+ *      The first row of the block in the next state.
+ *
+ * @param pitch
+ *      The distance in cells between the starts of consecutive rows, in both the current and next state.
+ *
+ * @param width
+ *      The number of cells to compute in each row. The cells before and after each row must be readable.
+ *
+ * @param rows
+ *      The number of rows in the block.
+ *
+ * @param rule
+ *      The rule deciding the next state of each cell.
+ */
+void Simd::sweep_interior_block(const Cell *source, Cell *destination, ptrdiff_t pitch, int width, int rows,
+                                const Rule &rule)
+{
+    if (rule.is<Conway>())
+    {
+        sweep_fixed_block<Conway>(source, destination, pitch, width, rows);
+    }
+    else if (rule.is<HighLife>())
+    {
+        sweep_fixed_block<HighLife>(source, destination, pitch, width, rows);
+    }
+    else if (rule.is<DayAndNight>())
+    {
+        sweep_fixed_block<DayAndNight>(source, destination, pitch, width, rows);
+    }
+    else if (rule.is<Seeds>())
+    {
+        sweep_fixed_block<Seeds>(source, destination, pitch, width, rows);
+    }
+    else
+    {
+        const Cell *table = rule.get_table();
+
+        for (int y = 0; y < rows; y++)
+        {
+            const Cell *middle = source + y * pitch;
+            sweep_table_row(middle - pitch, middle, middle + pitch, destination + y * pitch, 0, width, table);
+        }
+    }
+}
+
+#if defined(SIMD_X86) || defined(__ARM_NEON)
+
+/**
+ * build_shuffle_tables(rule, births, survivals)
+ *
+ * Helper function laying out the next state of a dead and an alive cell for each neighbour count, as 16 byte
+ * tables the vector kernels look the counts up in with a single byte shuffle.
+ *
+ * @param rule
+ *      The rule to lay out.
+ *
+ * @param births
+ *      Output table, entry n holding the next state of a dead cell with n alive neighbours.
+ *
+ * @param survivals
+ *      Output table, entry n holding the next state of an alive cell with n alive neighbours.
+ */
+static void build_shuffle_tables(const Rule &rule, Cell (&births)[16], Cell (&survivals)[16])
+{
+    for (int n = 0; n < 16; n++)
+    {
+        births[n] = rule.next(n, Cell::DEAD);
+        survivals[n] = rule.next(n, Cell::ALIVE);
+    }
+}
+
+#endif
+
+/**
+ * Simd::count_alive_scalar(cells, count)
+ *
+ * The scalar population count kernel, which the compiler is free to auto-vectorize.
+ *
+ * @param cells
+ *      The first cell of the run.
+ *
+ * @param count
+ *      The number of cells in the run.
+ *
+ * @return
+ *      The number of alive cells in the run.
+ */
+size_t Simd::count_alive_scalar(const Cell *cells, size_t count)
+{
+    size_t alive = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        alive += cells[i] == Cell::ALIVE;
+    }
+
+    return alive;
+}
+
+#ifdef SIMD_X86
+
+/**
+ * alive_avx2(cells)
+ *
+ * Helper function loading 32 cells, giving 0xFF for each alive cell and 0x00 for any other.
+ */
+__attribute__((target("avx2")))
+static inline __m256i alive_avx2(const Cell *cells)
+{
+    return _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells)),
+                             _mm256_set1_epi8(Cell::ALIVE));
+}
+
+/**
+ * load_shuffle_tables_avx2(rule, births, survivals)
+ *
+ * Helper function laying out the shuffle tables of a rule for Isa::AVX2. Byte shuffles look up within each
+ * 128 bit lane, so both lanes get a copy of the tables.
+ */
+__attribute__((target("avx2")))
+static inline void load_shuffle_tables_avx2(const Rule &rule, __m256i &births, __m256i &survivals)
+{
+    Cell birth_table[16], survival_table[16];
+    build_shuffle_tables(rule, birth_table, survival_table);
+
+    births = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(birth_table)));
+    survivals = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(survival_table)));
+}
+
+/**
+ * sweep_vectors_avx2(above, middle, below, destination, x0, x1, births, survivals)
+ *
+ * Helper function computing the cells of a row from x0 with Isa::AVX2, 32 cells at a time, for as many whole
+ * vectors as fit before x1.
+ *
+ * @return
+ *      The first cell left for the scalar kernel.
+ */
+__attribute__((target("avx2")))
+static inline int sweep_vectors_avx2(const Cell *above, const Cell *middle, const Cell *below, Cell *destination,
+                                     int x0, int x1, __m256i births, __m256i survivals)
+{
+    int x = x0;
+
+    for (; x + 32 <= x1; x += 32)
+    {
+        // Subtracting each all-ones mask adds 1 to the count of every alive neighbour
+        __m256i num_neighbours = _mm256_setzero_si256();
+
+        num_neighbours = _mm256_sub_epi8(num_neighbours, alive_avx2(above + x - 1));
+        num_neighbours = _mm256_sub_epi8(num_neighbours, alive_avx2(above + x));
+        num_neighbours = _mm256_sub_epi8(num_neighbours, alive_avx2(above + x + 1));
+        num_neighbours = _mm256_sub_epi8(num_neighbours, alive_avx2(middle + x - 1));
+        num_neighbours = _mm256_sub_epi8(num_neighbours, alive_avx2(middle + x + 1));
+        num_neighbours = _mm256_sub_epi8(num_neighbours, alive_avx2(below + x - 1));
+        num_neighbours = _mm256_sub_epi8(num_neighbours, alive_avx2(below + x));
+        num_neighbours = _mm256_sub_epi8(num_neighbours, alive_avx2(below + x + 1));
+
+        // Look up the next state of every cell both as if it were dead and alive, then pick by its actual state
+        const __m256i next = _mm256_blendv_epi8(_mm256_shuffle_epi8(births, num_neighbours),
+                                                _mm256_shuffle_epi8(survivals, num_neighbours),
+                                                alive_avx2(middle + x));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + x), next);
+    }
+
+    return x;
+}
+
+/**
+ * sweep_interior_row_avx2(above, middle, below, destination, x0, x1, rule)
+ *
+ * Helper function implementing the row kernel for Isa::AVX2, 32 cells at a time.
+ */
+__attribute__((target("avx2")))
+static void sweep_interior_row_avx2(const Cell *above, const Cell *middle, const Cell *below, Cell *destination,
+                                    int x0, int x1, const Rule &rule)
+{
+    __m256i births, survivals;
+    load_shuffle_tables_avx2(rule, births, survivals);
+
+    const int x = sweep_vectors_avx2(above, middle, below, destination, x0, x1, births, survivals);
+
+    Simd::sweep_interior_row(above, middle, below, destination, x, x1, rule);
+}
+
+/**
+ * sweep_interior_block_avx2(source, destination, pitch, width, rows, rule)
+ *
+ * Helper function implementing the block kernel for Isa::AVX2, laying out the tables once for every row.
+ * Rows of at least 32 cells end with a whole vector overlapping the one before, rather than a scalar tail.
+ */
+__attribute__((target("avx2")))
+static void sweep_interior_block_avx2(const Cell *source, Cell *destination, ptrdiff_t pitch, int width, int rows,
+                                      const Rule &rule)
+{
+    __m256i births, survivals;
+    load_shuffle_tables_avx2(rule, births, survivals);
+
+    for (int y = 0; y < rows; y++)
+    {
+        const Cell *middle = source + y * pitch;
+        Cell *row = destination + y * pitch;
+        const int x = sweep_vectors_avx2(middle - pitch, middle, middle + pitch, row, 0, width, births, survivals);
+
+        if (x < width && width >= 32)
+        {
+            // The destination is never the source, so the last vector can overlap the one before it
+            sweep_vectors_avx2(middle - pitch, middle, middle + pitch, row, width - 32, width, births, survivals);
+        }
+        else if (x < width)
+        {
+            Simd::sweep_interior_row(middle - pitch, middle, middle + pitch, row, x, width, rule);
+        }
+    }
+}
+
+/**
+ * count_alive_avx2(cells, count)
+ *
+ * Helper function implementing the population count kernel for Isa::AVX2, 32 cells at a time.
+ */
+__attribute__((target("avx2,popcnt")))
+static size_t count_alive_avx2(const Cell *cells, size_t count)
+{
+    size_t alive = 0, i = 0;
+
+    for (; i + 32 <= count; i += 32)
+    {
+        alive += __builtin_popcount(static_cast<unsigned int>(_mm256_movemask_epi8(alive_avx2(cells + i))));
+    }
+
+    return alive + Simd::count_alive_scalar(cells + i, count - i);
+}
+
+/**
+ * alive_avx512(cells)
+ *
+ * Helper function loading 64 cells, giving a mask with a bit set for each alive cell.
+ */
+__attribute__((target("avx512bw")))
+static inline __mmask64 alive_avx512(const Cell *cells)
+{
+    return _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(cells), _mm512_set1_epi8(Cell::ALIVE));
+}
+
+/**
+ * load_shuffle_tables_avx512(rule, births, survivals)
+ *
+ * Helper function laying out the shuffle tables of a rule for Isa::AVX512. Every 128 bit lane gets a copy of
+ * the tables, with the masked broadcast as GCC warns on the unmasked one.
+ */
+__attribute__((target("avx512bw")))
+static inline void load_shuffle_tables_avx512(const Rule &rule, __m512i &births, __m512i &survivals)
+{
+    Cell birth_table[16], survival_table[16];
+    build_shuffle_tables(rule, birth_table, survival_table);
+
+    births = _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_loadu_si128(reinterpret_cast<const __m128i *>(birth_table)));
+    survivals =
+        _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_loadu_si128(reinterpret_cast<const __m128i *>(survival_table)));
+}
+
+/**
+ * sweep_vectors_avx512(above, middle, below, destination, x0, x1, births, survivals)
+ *
+ * Helper function computing the cells of a row from x0 with Isa::AVX512, 64 cells at a time, for as many whole
+ * vectors as fit before x1. Compares give bit masks rather than byte masks, so each alive neighbour is added
+ * with a masked increment.
+ *
+ * @return
+ *      The first cell left for the scalar kernel.
+ */
+__attribute__((target("avx512bw")))
+static inline int sweep_vectors_avx512(const Cell *above, const Cell *middle, const Cell *below, Cell *destination,
+                                       int x0, int x1, __m512i births, __m512i survivals)
+{
+    const __m512i one = _mm512_set1_epi8(1);
+
+    int x = x0;
+
+    for (; x + 64 <= x1; x += 64)
+    {
+        __m512i num_neighbours = _mm512_setzero_si512();
+
+        num_neighbours = _mm512_mask_add_epi8(num_neighbours, alive_avx512(above + x - 1), num_neighbours, one);
+        num_neighbours = _mm512_mask_add_epi8(num_neighbours, alive_avx512(above + x), num_neighbours, one);
+        num_neighbours = _mm512_mask_add_epi8(num_neighbours, alive_avx512(above + x + 1), num_neighbours, one);
+        num_neighbours = _mm512_mask_add_epi8(num_neighbours, alive_avx512(middle + x - 1), num_neighbours, one);
+        num_neighbours = _mm512_mask_add_epi8(num_neighbours, alive_avx512(middle + x + 1), num_neighbours, one);
+        num_neighbours = _mm512_mask_add_epi8(num_neighbours, alive_avx512(below + x - 1), num_neighbours, one);
+        num_neighbours = _mm512_mask_add_epi8(num_neighbours, alive_avx512(below + x), num_neighbours, one);
+        num_neighbours = _mm512_mask_add_epi8(num_neighbours, alive_avx512(below + x + 1), num_neighbours, one);
+
+        const __m512i next = _mm512_mask_blend_epi8(alive_avx512(middle + x),
+                                                    _mm512_shuffle_epi8(births, num_neighbours),
+                                                    _mm512_shuffle_epi8(survivals, num_neighbours));
+        _mm512_storeu_si512(destination + x, next);
+    }
+
+    return x;
+}
+
+/**
+ * sweep_interior_row_avx512(above, middle, below, destination, x0, x1, rule)
+ *
+ * Helper function implementing the row kernel for Isa::AVX512, 64 cells at a time.
+ */
+__attribute__((target("avx512bw")))
+static void sweep_interior_row_avx512(const Cell *above, const Cell *middle, const Cell *below, Cell *destination,
+                                      int x0, int x1, const Rule &rule)
+{
+    __m512i births, survivals;
+    load_shuffle_tables_avx512(rule, births, survivals);
+
+    const int x = sweep_vectors_avx512(above, middle, below, destination, x0, x1, births, survivals);
+
+    Simd::sweep_interior_row(above, middle, below, destination, x, x1, rule);
+}
+
+/**
+ * sweep_interior_block_avx512(source, destination, pitch, width, rows, rule)
+ *
+ * Helper function implementing the block kernel for Isa::AVX512, laying out the tables once for every row.
+ * Rows of at least 64 cells end with a whole vector overlapping the one before, rather than a scalar tail.
+ */
+__attribute__((target("avx512bw")))
+static void sweep_interior_block_avx512(const Cell *source, Cell *destination, ptrdiff_t pitch, int width, int rows,
+                                        const Rule &rule)
+{
+    __m512i births, survivals;
+    load_shuffle_tables_avx512(rule, births, survivals);
+
+    for (int y = 0; y < rows; y++)
+    {
+        const Cell *middle = source + y * pitch;
+        Cell *row = destination + y * pitch;
+        const int x = sweep_vectors_avx512(middle - pitch, middle, middle + pitch, row, 0, width, births, survivals);
+
+        if (x < width && width >= 64)
+        {
+            // The destination is never the source, so the last vector can overlap the one before it
+            sweep_vectors_avx512(middle - pitch, middle, middle + pitch, row, width - 64, width, births, survivals);
+        }
+        else if (x < width)
+        {
+            Simd::sweep_interior_row(middle - pitch, middle, middle + pitch, row, x, width, rule);
+        }
+    }
+}
+
+/**
+ * count_alive_avx512(cells, count)
+ *
+ * Helper function implementing the population count kernel for Isa::AVX512, 64 cells at a time.
+ */
+__attribute__((target("avx512bw,popcnt")))
+static size_t count_alive_avx512(const Cell *cells, size_t count)
+{
+    size_t alive = 0, i = 0;
+
+    for (; i + 64 <= count; i += 64)
+    {
+        alive += __builtin_popcountll(alive_avx512(cells + i));
+    }
+
+    return alive + Simd::count_alive_scalar(cells + i, count - i);
+}
+
+#elif defined(__ARM_NEON)
+
+/**
+ * alive_neon(cells)
+ *
+ * Helper function loading 16 cells, giving 0xFF for each alive cell and 0x00 for any other.
+ */
+static inline uint8x16_t alive_neon(const Cell *cells)
+{
+    return vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t *>(cells)), vdupq_n_u8(Cell::ALIVE));
+}
+
+/**
+ * sweep_vectors_neon(above, middle, below, destination, x0, x1, births, survivals)
+ *
+ * Helper function computing the cells of a row from x0 with Isa::NEON, 16 cells at a time, for as many whole
+ * vectors as fit before x1.
+ *
+ * @return
+ *      The first cell left for the scalar kernel.
+ */
+static inline int sweep_vectors_neon(const Cell *above, const Cell *middle, const Cell *below, Cell *destination,
+                                     int x0, int x1, uint8x16_t births, uint8x16_t survivals)
+{
+    int x = x0;
+
+    for (; x + 16 <= x1; x += 16)
+    {
+        // Subtracting each all-ones mask adds 1 to the count of every alive neighbour
+        uint8x16_t num_neighbours = vdupq_n_u8(0);
+
+        num_neighbours = vsubq_u8(num_neighbours, alive_neon(above + x - 1));
+        num_neighbours = vsubq_u8(num_neighbours, alive_neon(above + x));
+        num_neighbours = vsubq_u8(num_neighbours, alive_neon(above + x + 1));
+        num_neighbours = vsubq_u8(num_neighbours, alive_neon(middle + x - 1));
+        num_neighbours = vsubq_u8(num_neighbours, alive_neon(middle + x + 1));
+        num_neighbours = vsubq_u8(num_neighbours, alive_neon(below + x - 1));
+        num_neighbours = vsubq_u8(num_neighbours, alive_neon(below + x));
+        num_neighbours = vsubq_u8(num_neighbours, alive_neon(below + x + 1));
+
+        const uint8x16_t next = vbslq_u8(alive_neon(middle + x), vqtbl1q_u8(survivals, num_neighbours),
+                                         vqtbl1q_u8(births, num_neighbours));
+        vst1q_u8(reinterpret_cast<uint8_t *>(destination + x), next);
+    }
+
+    return x;
+}
+
+/**
+ * sweep_interior_row_neon(above, middle, below, destination, x0, x1, rule)
+ *
+ * Helper function implementing the row kernel for Isa::NEON, 16 cells at a time.
+ */
+static void sweep_interior_row_neon(const Cell *above, const Cell *middle, const Cell *below, Cell *destination,
+                                    int x0, int x1, const Rule &rule)
+{
+    Cell birth_table[16], survival_table[16];
+    build_shuffle_tables(rule, birth_table, survival_table);
+
+    const uint8x16_t births = vld1q_u8(reinterpret_cast<const uint8_t *>(birth_table));
+    const uint8x16_t survivals = vld1q_u8(reinterpret_cast<const uint8_t *>(survival_table));
+
+    const int x = sweep_vectors_neon(above, middle, below, destination, x0, x1, births, survivals);
+
+    Simd::sweep_interior_row(above, middle, below, destination, x, x1, rule);
+}
+
+/**
+ * sweep_interior_block_neon(source, destination, pitch, width, rows, rule)
+ *
+ * Helper function implementing the block kernel for Isa::NEON, laying out the tables once for every row.
+ * Rows of at least 16 cells end with a whole vector overlapping the one before, rather than a scalar tail.
+ */
+static void sweep_interior_block_neon(const Cell *source, Cell *destination, ptrdiff_t pitch, int width, int rows,
+                                      const Rule &rule)
+{
+    Cell birth_table[16], survival_table[16];
+    build_shuffle_tables(rule, birth_table, survival_table);
+
+    const uint8x16_t births = vld1q_u8(reinterpret_cast<const uint8_t *>(birth_table));
+    const uint8x16_t survivals = vld1q_u8(reinterpret_cast<const uint8_t *>(survival_table));
+
+    for (int y = 0; y < rows; y++)
+    {
+        const Cell *middle = source + y * pitch;
+        Cell *row = destination + y * pitch;
+        const int x = sweep_vectors_neon(middle - pitch, middle, middle + pitch, row, 0, width, births, survivals);
+
+        if (x < width && width >= 16)
+        {
+            // The destination is never the source, so the last vector can overlap the one before it
+            sweep_vectors_neon(middle - pitch, middle, middle + pitch, row, width - 16, width, births, survivals);
+        }
+        else if (x < width)
+        {
+            Simd::sweep_interior_row(middle - pitch, middle, middle + pitch, row, x, width, rule);
+        }
+    }
+}
+
+/**
+ * count_alive_neon(cells, count)
+ *
+ * Helper function implementing the population count kernel for Isa::NEON, 16 cells at a time.
+ * The all-ones masks are subtracted from a byte counter, which is widened and emptied before it can overflow.
+ */
+static size_t count_alive_neon(const Cell *cells, size_t count)
+{
+    size_t alive = 0, i = 0;
+
+    while (i + 16 <= count)
+    {
+        uint8x16_t counter = vdupq_n_u8(0);
+
+        for (int block = 0; block < 255 && i + 16 <= count; block++, i += 16)
+        {
+            counter = vsubq_u8(counter, alive_neon(cells + i));
+        }
+
+        alive += vaddlvq_u8(counter);
+    }
+
+    return alive + Simd::count_alive_scalar(cells + i, count - i);
+}
+
+#endif
+
+/**
+ * Simd::is_supported(isa)
+ *
+ * Checks whether a kernel for an instruction set was compiled in and can run on this CPU.
+ *
+ * @example
+ *
+ *      // Only benchmark the AVX2 kernel where it will run
+ *      if (Simd::is_supported(Simd::Isa::AVX2)) { ... }
+ *
+ * @param isa
+ *      The instruction set to check.
+ *
+ * @return
+ *      True if Simd::get_row_kernel(isa) can be called.
+ */
+bool Simd::is_supported(Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::SCALAR:
+            return true;
+#ifdef SIMD_X86
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case Isa::AVX512:
+            return __builtin_cpu_supports("avx512bw");
+#elif defined(__ARM_NEON)
+        case Isa::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+/**
+ * Simd::get_best_isa()
+ *
+ * Finds the widest instruction set with a kernel which can run on this CPU.
+ *
+ * @return
+ *      The best supported instruction set, Isa::SCALAR if no others are.
+ */
+Simd::Isa Simd::get_best_isa()
+{
+    for (Isa isa : {Isa::AVX512, Isa::AVX2, Isa::NEON})
+    {
+        if (is_supported(isa))
+        {
+            return isa;
+        }
+    }
+
+    return Isa::SCALAR;
+}
+
+/**
+ * Simd::get_isa_name(isa)
+ *
+ * Gets a printable name for an instruction set.
+ *
+ * @return
+ *      The lower case name of the instruction set.
+ */
+const char *Simd::get_isa_name(Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::AVX2:
+            return "avx2";
+        case Isa::AVX512:
+            return "avx512";
+        case Isa::NEON:
+            return "neon";
+        default:
+            return "scalar";
+    }
+}
+
+/**
+ * Simd::get_row_kernel(isa)
+ *
+ * Gets the kernel for a particular instruction set.
+ *
+ * @example
+ *
+ *      // Step the interior of row y with AVX2
+ *      Simd::RowKernel sweep = Simd::get_row_kernel(Simd::Isa::AVX2);
+ *      sweep(current.row(y - 1), current.row(y), current.row(y + 1), next.row(y), 1, width - 1, Rule());
+ *
+ * @param isa
+ *      The instruction set of the kernel.
+ *
+ * @return
+ *      A pointer to the kernel.
+ *
+ * @throws
+ *      std::invalid_argument if the instruction set is not supported, see Simd::is_supported(isa).
+ */
+Simd::RowKernel Simd::get_row_kernel(Isa isa)
+{
+    if (!is_supported(isa))
+    {
+        throw std::invalid_argument("ERROR: The " + std::string(get_isa_name(isa)) +
+                                    " kernel is not supported on this CPU.");
+    }
+
+    switch (isa)
+    {
+#ifdef SIMD_X86
+        case Isa::AVX2:
+            return sweep_interior_row_avx2;
+        case Isa::AVX512:
+            return sweep_interior_row_avx512;
+#elif defined(__ARM_NEON)
+        case Isa::NEON:
+            return sweep_interior_row_neon;
+#endif
+        default:
+            return sweep_interior_row;
+    }
+}
+
+/**
+ * Simd::get_row_kernel()
+ *
+ * Gets the kernel for the best instruction set supported by this CPU.
+ * The CPU is only queried on the first call, and the same kernel is returned from then on.
+ *
+ * @return
+ *      A pointer to the kernel.
+ */
+Simd::RowKernel Simd::get_row_kernel()
+{
+    static const RowKernel best = get_row_kernel(get_best_isa());
+
+    return best;
+}
+
+/**
+ * Simd::get_block_kernel(isa)
+ *
+ * Gets the block kernel for a particular instruction set.
+ *
+ * @example
+ *
+ *      // Step every row of the top left tile with AVX2
+ *      Simd::BlockKernel sweep = Simd::get_block_kernel(Simd::Isa::AVX2);
+ *      sweep(current.tile_row(0, 0, 0), next.tile_row(0, 0, 0), TiledGrid::TILE_PITCH,
+ *            current.get_tile_width(0), current.get_tile_height(0), Rule());
+ *
+ * @param isa
+ *      The instruction set of the kernel.
+ *
+ * @return
+ *      A pointer to the kernel.
+ *
+ * @throws
+ *      std::invalid_argument if the instruction set is not supported, see Simd::is_supported(isa).
+ */
+Simd::BlockKernel Simd::get_block_kernel(Isa isa)
+{
+    if (!is_supported(isa))
+    {
+        throw std::invalid_argument("ERROR: The " + std::string(get_isa_name(isa)) +
+                                    " kernel is not supported on this CPU.");
+    }
+
+    switch (isa)
+    {
+#ifdef SIMD_X86
+        case Isa::AVX2:
+            return sweep_interior_block_avx2;
+        case Isa::AVX512:
+            return sweep_interior_block_avx512;
+#elif defined(__ARM_NEON)
+        case Isa::NEON:
+            return sweep_interior_block_neon;
+#endif
+        default:
+            return sweep_interior_block;
+    }
+}
+
+/**
+ * Simd::get_block_kernel()
+ *
+ * Gets the block kernel for the best instruction set supported by this CPU.
+ * The CPU is only queried on the first call, and the same kernel is returned from then on.
+ *
+ * @return
+ *      A pointer to the kernel.
+ */
+Simd::BlockKernel Simd::get_block_kernel()
+{
+    static const BlockKernel best = get_block_kernel(get_best_isa());
+
+    return best;
+}
+
+/**
+ * Simd::get_count_kernel(isa)
+ *
+ * Gets the population count kernel for a particular instruction set.
+ *
+ * @param isa
+ *      The instruction set of the kernel.
+ *
+ * @return
+ *      A pointer to the kernel.
+ *
+ * @throws
+ *      std::invalid_argument if the instruction set is not supported, see Simd::is_supported(isa).
+ */
+Simd::CountKernel Simd::get_count_kernel(Isa isa)
+{
+    if (!is_supported(isa))
+    {
+        throw std::invalid_argument("ERROR: The " + std::string(get_isa_name(isa)) +
+                                    " kernel is not supported on this CPU.");
+    }
+
+    switch (isa)
+    {
+#ifdef SIMD_X86
+        case Isa::AVX2:
+            return count_alive_avx2;
+        case Isa::AVX512:
+            return count_alive_avx512;
+#elif defined(__ARM_NEON)
+        case Isa::NEON:
+            return count_alive_neon;
+#endif
+        default:
+            return count_alive_scalar;
+    }
+}
+
+/**
+ * Simd::count_alive(cells, count)
+ *
+ * Count the alive cells in a contiguous run of cells with the best population count kernel for this CPU.
+ *
+ * @example
+ *
+ *      // Count the alive cells in row 3 of a grid
+ *      size_t alive = Simd::count_alive(grid.row(3), grid.get_width());
+ *
+ * @param cells
+ *      The first cell of the run.
+ *
+ * @param count
+ *      The number of cells in the run.
+ *
+ * @return
+ *      The number of alive cells in the run.
+ */
+size_t Simd::count_alive(const Cell *cells, size_t count)
+{
+    static const CountKernel best = get_count_kernel(get_best_isa());
+
+    return best(cells, count);
+}
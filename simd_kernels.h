@@ -0,0 +1,75 @@
+/**
+ * Declares a Simd namespace with hand-vectorized kernels for stepping and counting byte-per-cell Grid objects.
+ * Rich documentation for the api and behaviour the Simd namespace can be found in simd_kernels.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <cstddef>
+
+#include "grid.h"
+#include "rule.h"
+
+/**
+ * Declare the interface of the Simd namespace for picking the fastest kernels the CPU supports.
+ */
+namespace Simd
+{
+    /**
+     * The instruction sets a row kernel can be written for.
+     *      - Isa::SCALAR is plain C++, which the compiler is still free to auto-vectorize.
+     *      - Isa::AVX2 processes 32 cells per instruction on x86.
+     *      - Isa::AVX512 processes 64 cells per instruction on x86 with AVX-512BW.
+     *      - Isa::NEON processes 16 cells per instruction on ARM.
+     */
+    enum class Isa
+    {
+        SCALAR,
+        AVX2,
+        AVX512,
+        NEON
+    };
+
+    /**
+     * A kernel computing the next state of cells [x0, x1) of a row whose neighbours can all be read, from
+     * the rows above, in line with, and below it, under a rule.
+     */
+    using RowKernel = void (*)(const Cell *above, const Cell *middle, const Cell *below, Cell *destination,
+                               int x0, int x1, const Rule &rule);
+
+    void sweep_interior_row(const Cell *above, const Cell *middle, const Cell *below, Cell *destination,
+                            int x0, int x1, const Rule &rule);
+
+    /**
+     * A kernel computing the next state of cells [0, width) of a block of rows, whose rows are pitch cells apart
+     * in both the current and next state and whose neighbours can all be read, under a rule.
+     * The current and next state must not overlap.
+     */
+    using BlockKernel = void (*)(const Cell *source, Cell *destination, ptrdiff_t pitch, int width, int rows,
+                                 const Rule &rule);
+
+    void sweep_interior_block(const Cell *source, Cell *destination, ptrdiff_t pitch, int width, int rows,
+                              const Rule &rule);
+
+    bool is_supported(Isa isa);
+    Isa get_best_isa();
+    const char *get_isa_name(Isa isa);
+
+    RowKernel get_row_kernel(Isa isa);
+    RowKernel get_row_kernel();
+
+    BlockKernel get_block_kernel(Isa isa);
+    BlockKernel get_block_kernel();
+
+    /**
+     * A kernel counting the alive cells in a contiguous run of cells.
+     */
+    using CountKernel = size_t (*)(const Cell *cells, size_t count);
+
+    size_t count_alive_scalar(const Cell *cells, size_t count);
+
+    CountKernel get_count_kernel(Isa isa);
+    size_t count_alive(const Cell *cells, size_t count);
+}; // !namespace Simd
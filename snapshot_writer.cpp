@@ -0,0 +1,287 @@
+/**
+ * Implements a class for writing snapshots of a grid on a background thread while the simulation carries on.
+ *      - Snapshots are copied into a bounded set of recycled buffers, and written out in the order they were taken.
+ *          - The buffers keep their allocations between snapshots, so a snapshot of a grid the same size as
+ *            the last is a single copy with no allocation.
+ *          - Taking a snapshot only blocks when every buffer is still queued, which bounds the memory used
+ *            and stops a slow disk from falling arbitrarily far behind the simulation.
+ *          - A snapshot of a window of the grid only copies the cells in the window, so watching part of a
+ *            huge world costs no more than watching a small one.
+ *
+ *      - Writing is done by jobs, such as printing the grid or saving it to a file, run on the writer thread.
+ *          - The first exception thrown by a job is passed back to the simulation by the next call to
+ *            SnapshotWriter::submit or SnapshotWriter::flush.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "snapshot_writer.h"
+
+/**
+ * SnapshotWriter::SnapshotWriter(capacity)
+ *
+ * Construct a writer with its own background thread, which stays alive until the writer is destroyed.
+ *
+ * @example
+ *
+ *      // Allow up to 4 snapshots to be waiting to be written
+ *      SnapshotWriter writer(4);
+ *
+ * @param capacity
+ *      The number of snapshots which can be waiting to be written before taking another blocks.
+ *
+ * @throws
+ *      std::invalid_argument if capacity is less than 1.
+ */
+SnapshotWriter::SnapshotWriter(int capacity) : writing(false), stopping(false)
+{
+    if (capacity < 1)
+    {
+        throw std::invalid_argument("ERROR: A snapshot writer needs at least one buffer.");
+    }
+
+    for (int i = 0; i < capacity; i++)
+    {
+        buffers.push_back(std::unique_ptr<Grid>(new Grid()));
+        free_buffers.push_back(buffers.back().get());
+    }
+
+    writer = std::thread(&SnapshotWriter::writer_loop, this);
+}
+
+/**
+ * SnapshotWriter::~SnapshotWriter()
+ *
+ * Write out every snapshot still waiting, then join the writer thread.
+ * Any failures are discarded, so call SnapshotWriter::flush first to find out about them.
+ */
+SnapshotWriter::~SnapshotWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    snapshot_ready.notify_all();
+    writer.join();
+}
+
+/**
+ * SnapshotWriter::get_capacity()
+ *
+ * Gets the number of snapshots which can be waiting to be written before taking another blocks.
+ *
+ * @return
+ *      The number of buffers.
+ */
+int SnapshotWriter::get_capacity() const
+{
+    return static_cast<int>(buffers.size());
+}
+
+/**
+ * SnapshotWriter::submit(state, job)
+ *
+ * Take a snapshot of a grid, and queue a job to write it out on the writer thread.
+ * Returns as soon as the snapshot is copied, unless every buffer is still waiting to be written.
+ *
+ * @example
+ *
+ *      // Print the state of a world without waiting for the console
+ *      writer.submit(world.get_state(), [](const Grid &state) {
+ *          std::cout << state << std::endl;
+ *      });
+ *
+ * @param state
+ *      The grid to take a snapshot of, which may be changed again as soon as submit returns.
+ *
+ * @param job
+ *      The job writing out the snapshot.
+ *
+ * @throws
+ *      Rethrows the first exception thrown by an earlier job, in which case the snapshot is not taken.
+ */
+void SnapshotWriter::submit(const Grid &state, Job job)
+{
+    Grid *buffer = take_buffer();
+
+    // The buffer belongs to this thread until it is queued, so copy without holding the lock
+    *buffer = state;
+
+    queue(buffer, std::move(job));
+}
+
+/**
+ * SnapshotWriter::submit(state, x0, y0, x1, y1, job)
+ *
+ * Take a snapshot of the window [x0, x1) by [y0, y1) of a grid, and queue a job to write it out on the writer
+ * thread. The job is given a grid holding just the window, with (x0, y0) as its top left cell.
+ * The buffer is only reallocated when the window changes size, so each snapshot of the same window is a copy of
+ * its rows with no allocation.
+ *
+ * @example
+ *
+ *      // Print the top left 80x40 cells of a world
+ *      writer.submit(world.get_state(), 0, 0, 80, 40, [](const Grid &window) {
+ *          std::cout << window << std::endl;
+ *      });
+ *
+ * @param state
+ *      The grid to take a snapshot of, which may be changed again as soon as submit returns.
+ *
+ * @param job
+ *      The job writing out the snapshot.
+ *
+ * @throws
+ *      std::out_of_range if the window is not within the grid.
+ *      Rethrows the first exception thrown by an earlier job, in which case the snapshot is not taken.
+ */
+void SnapshotWriter::submit(const Grid &state, int x0, int y0, int x1, int y1, Job job)
+{
+    if (x0 < 0 || y0 < 0 || x1 > state.get_width() || y1 > state.get_height() || x1 < x0 || y1 < y0)
+    {
+        throw std::out_of_range("ERROR: Attempted to take a snapshot of a window outside of the grid.");
+    }
+
+    Grid *buffer = take_buffer();
+
+    if (buffer->get_width() != x1 - x0 || buffer->get_height() != y1 - y0)
+    {
+        *buffer = Grid(x1 - x0, y1 - y0);
+    }
+
+    for (int y = y0; y < y1; y++)
+    {
+        std::copy(state.row(y) + x0, state.row(y) + x1, buffer->row(y - y0));
+    }
+
+    queue(buffer, std::move(job));
+}
+
+/**
+ * SnapshotWriter::take_buffer()
+ *
+ * Private helper function taking a free buffer for the next snapshot, waiting for one if every buffer is queued.
+ *
+ * @return
+ *      The buffer, which belongs to the calling thread until it is queued.
+ *
+ * @throws
+ *      Rethrows the first exception thrown by an earlier job.
+ */
+Grid *SnapshotWriter::take_buffer()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    buffer_free.wait(lock, [this] { return !free_buffers.empty() || error; });
+    rethrow_error();
+
+    Grid *buffer = free_buffers.back();
+    free_buffers.pop_back();
+
+    return buffer;
+}
+
+/**
+ * SnapshotWriter::queue(buffer, job)
+ *
+ * Private helper function queueing a buffer holding a snapshot to be written out by a job, and waking the writer.
+ */
+void SnapshotWriter::queue(Grid *buffer, Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back({buffer, std::move(job)});
+    }
+
+    snapshot_ready.notify_one();
+}
+
+/**
+ * SnapshotWriter::flush()
+ *
+ * Wait until every snapshot taken so far has been written out.
+ *
+ * @example
+ *
+ *      // Make sure the final state is on disk before exiting
+ *      writer.flush();
+ *
+ * @throws
+ *      Rethrows the first exception thrown by a job since the last one was rethrown.
+ */
+void SnapshotWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    buffer_free.wait(lock, [this] { return (pending.empty() && !writing) || error; });
+    rethrow_error();
+}
+
+/**
+ * SnapshotWriter::writer_loop()
+ *
+ * Private helper function run by the writer thread, writing out snapshots in order until the writer is stopped
+ * and none are left, then returning each buffer for reuse.
+ */
+void SnapshotWriter::writer_loop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        snapshot_ready.wait(lock, [this] { return !pending.empty() || stopping; });
+
+        if (pending.empty())
+        {
+            return;
+        }
+
+        Snapshot snapshot = std::move(pending.front());
+        pending.pop_front();
+        writing = true;
+
+        lock.unlock();
+
+        std::exception_ptr failure;
+
+        try
+        {
+            snapshot.job(*snapshot.state);
+        }
+        catch (...)
+        {
+            failure = std::current_exception();
+        }
+
+        lock.lock();
+
+        if (failure && !error)
+        {
+            error = failure;
+        }
+
+        writing = false;
+        free_buffers.push_back(snapshot.state);
+        buffer_free.notify_all();
+    }
+}
+
+/**
+ * SnapshotWriter::rethrow_error()
+ *
+ * Private helper function to rethrow the first failure of a job, if there is one, clearing it so it is only
+ * reported once. The mutex must be held by the caller.
+ */
+void SnapshotWriter::rethrow_error()
+{
+    if (error)
+    {
+        std::exception_ptr failure = nullptr;
+        std::swap(failure, error);
+
+        std::rethrow_exception(failure);
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ * Declares a class for writing snapshots of a grid on a background thread while the simulation carries on.
+ * Rich documentation for the api and behaviour the SnapshotWriter class can be found in snapshot_writer.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * Declare the structure of the SnapshotWriter class for handing grids off to a background writer thread.
+ *
+ * Each snapshot is copied into one of a fixed number of recycled buffers, so taking a snapshot costs a
+ * single copy of the cells rather than the formatting and I/O of writing it out. A snapshot can also be of just
+ * a window of the grid, costing only the cells in the window. Only when every buffer
+ * is still waiting to be written does taking another snapshot block.
+ */
+class SnapshotWriter
+{
+    public:
+        /**
+         * A job writing out a snapshot, run on the writer thread. Jobs may throw to report a failure.
+         */
+        using Job = std::function<void(const Grid &state)>;
+
+    private:
+        struct Snapshot
+        {
+            Grid *state;
+            Job job;
+        };
+
+        std::vector<std::unique_ptr<Grid>> buffers;
+        std::vector<Grid *> free_buffers;
+        std::deque<Snapshot> pending;
+
+        std::mutex mutex;
+        std::condition_variable snapshot_ready;
+        std::condition_variable buffer_free;
+        bool writing;
+        bool stopping;
+        std::exception_ptr error; // The first failure of a job, until it is rethrown
+
+        std::thread writer;
+
+        Grid *take_buffer();
+        void queue(Grid *buffer, Job job);
+        void writer_loop();
+        void rethrow_error();
+
+    public:
+        explicit SnapshotWriter(int capacity = 2);
+        ~SnapshotWriter();
+
+        SnapshotWriter(const SnapshotWriter &) = delete;
+        SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+
+        int get_capacity() const;
+
+        void submit(const Grid &state, Job job);
+        void submit(const Grid &state, int x0, int y0, int x1, int y1, Job job);
+        void flush();
+};
@@ -0,0 +1,198 @@
+/**
+ * Implements a persistent pool of worker threads and a reusable barrier for synchronising them.
+ *      - A ThreadPool runs the same task on all of its threads at once, passing each its own index.
+ *          - The calling thread takes part as thread 0, so a pool of N threads starts N - 1 workers.
+ *          - Workers sleep on a condition variable between tasks rather than being re-spawned.
+ *
+ *      - A Barrier blocks each arriving thread until a fixed number have arrived, then releases them all.
+ *          - Barriers can be reused immediately, making them suitable for once per step synchronisation.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <stdexcept>
+#include <utility>
+
+#include "thread_pool.h"
+
+/**
+ * ThreadPool::ThreadPool(thread_count)
+ *
+ * Construct a pool of threads which stay alive until the pool is destroyed.
+ *
+ * @example
+ *
+ *      // Make a pool using every core of the machine
+ *      ThreadPool pool(std::thread::hardware_concurrency());
+ *
+ * @param thread_count
+ *      The number of threads to run tasks on, including the calling thread.
+ *
+ * @throws
+ *      std::invalid_argument if thread_count is less than 1.
+ */
+ThreadPool::ThreadPool(int thread_count) : generation(0), running(0), stopping(false)
+{
+    if (thread_count < 1)
+    {
+        throw std::invalid_argument("ERROR: A thread pool needs at least one thread.");
+    }
+
+    for (int i = 1; i < thread_count; i++)
+    {
+        workers.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+/**
+ * ThreadPool::~ThreadPool()
+ *
+ * Wake and join all of the worker threads.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    work_ready.notify_all();
+
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+/**
+ * ThreadPool::get_thread_count()
+ *
+ * Gets the number of threads tasks are run on, including the calling thread.
+ *
+ * @return
+ *      The number of threads.
+ */
+int ThreadPool::get_thread_count() const
+{
+    return static_cast<int>(workers.size()) + 1;
+}
+
+/**
+ * ThreadPool::run(new_task)
+ *
+ * Run a task once on every thread of the pool concurrently, and wait for all of them to finish.
+ * Every call of the task is running at the same time, so it is safe for them to wait on a Barrier.
+ * Concurrent callers from different threads are run one after another.
+ *
+ * @example
+ *
+ *      // Split some work into one band per thread
+ *      pool.run([&](int thread_index) {
+ *          process_band(thread_index, pool.get_thread_count());
+ *      });
+ *
+ * @param new_task
+ *      The task to run, which is passed the index of the thread running it in [0, get_thread_count()).
+ *      Tasks should not throw, as any other thread waiting on a Barrier would never be released.
+ */
+void ThreadPool::run(const std::function<void(int)> &new_task)
+{
+    std::lock_guard<std::mutex> run_lock(run_mutex);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = new_task;
+        running = static_cast<int>(workers.size());
+        generation++;
+    }
+
+    work_ready.notify_all();
+
+    // The calling thread takes the first share of the work
+    new_task(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [this] { return running == 0; });
+    task = nullptr;
+}
+
+/**
+ * ThreadPool::worker_loop(thread_index)
+ *
+ * Private helper function run by each worker thread, waiting for and running each new task.
+ *
+ * @param thread_index
+ *      The index passed to each task run on this thread.
+ */
+void ThreadPool::worker_loop(int thread_index)
+{
+    unsigned long long seen_generation = 0;
+
+    while (true)
+    {
+        std::function<void(int)> current_task;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [&] { return stopping || generation != seen_generation; });
+
+            if (stopping)
+            {
+                return;
+            }
+
+            seen_generation = generation;
+            current_task = task;
+        }
+
+        current_task(thread_index);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running--;
+        }
+
+        work_done.notify_one();
+    }
+}
+
+/**
+ * Barrier::Barrier(thread_count, completion)
+ *
+ * Construct a barrier for a fixed number of threads.
+ *
+ * @param thread_count
+ *      The number of threads which must arrive before they are released.
+ *
+ * @param completion
+ *      Optional function run by the last thread to arrive, while all others are still held.
+ */
+Barrier::Barrier(int thread_count, std::function<void()> completion)
+    : thread_count(thread_count), waiting(0), generation(0), completion(std::move(completion)) {}
+
+/**
+ * Barrier::arrive_and_wait()
+ *
+ * Block until thread_count threads have called this function, then release them all together.
+ */
+void Barrier::arrive_and_wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    const unsigned long long arrival_generation = generation;
+
+    if (++waiting == thread_count)
+    {
+        if (completion)
+        {
+            completion();
+        }
+
+        waiting = 0;
+        generation++;
+        released.notify_all();
+    }
+    else
+    {
+        released.wait(lock, [&] { return generation != arrival_generation; });
+    }
+}
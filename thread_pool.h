@@ -0,0 +1,71 @@
+/**
+ * Declares a persistent pool of worker threads and a reusable barrier for synchronising them.
+ * Rich documentation for the api and behaviour of the ThreadPool and Barrier classes can be found in thread_pool.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Declare the structure of the ThreadPool class for running the same task on a fixed set of threads.
+ *
+ * The threads are started once by the constructor and sleep between calls to ThreadPool::run,
+ * so repeatedly running short tasks does not pay for spawning threads each time.
+ */
+class ThreadPool
+{
+    private:
+        std::vector<std::thread> workers;
+
+        std::mutex run_mutex; // Serialises callers of run
+        std::mutex mutex;
+        std::condition_variable work_ready;
+        std::condition_variable work_done;
+
+        std::function<void(int)> task;
+        unsigned long long generation;
+        int running;
+        bool stopping;
+
+        void worker_loop(int thread_index);
+
+    public:
+        explicit ThreadPool(int thread_count);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        int get_thread_count() const;
+
+        void run(const std::function<void(int)> &new_task);
+};
+
+/**
+ * Declare the structure of the Barrier class for holding a fixed number of threads at the same point.
+ *
+ * An optional completion function is run by the last thread to arrive, before any thread is released.
+ */
+class Barrier
+{
+    private:
+        std::mutex mutex;
+        std::condition_variable released;
+
+        const int thread_count;
+        int waiting;
+        unsigned long long generation;
+        std::function<void()> completion;
+
+    public:
+        explicit Barrier(int thread_count, std::function<void()> completion = nullptr);
+
+        void arrive_and_wait();
+};
@@ -0,0 +1,795 @@
+/**
+ * Implements a class representing a 2d grid of cells stored as square tiles.
+ *      - Cells are stored one byte per cell like a Grid, but split into tiles of TILE_SIZE by TILE_SIZE cells,
+ *        with each tile contiguous in memory.
+ *          - A row of a Grid thousands of cells wide puts the rows above and below a cell far apart, so a
+ *            stencil sweeping it has evicted them from the caches before it comes back to them. The rows of a
+ *            tile are only TILE_PITCH cells apart, so the three rows around a cell are under 1KiB apart, which
+ *            stays in the L1 cache and on one or two pages while the tile is swept.
+ *          - The tiles can be laid out row by row, or along a Z-order (Morton) curve so the tiles above and below
+ *            a tile are also close in memory, chosen with a TileOrder when the grid is constructed.
+ *      - Each tile is surrounded by an apron one cell wide holding copies of its neighbouring cells.
+ *          - TiledGrid::refresh_aprons(toroidal) fills the aprons from the neighbouring tiles, wrapping around the
+ *            edges of the grid when toroidal or with dead cells otherwise, touching only the edges of each tile.
+ *          - A stencil can then sweep each tile with the same row kernels as a Grid with a ghost border.
+ *      - New cells are initialized to Cell::DEAD.
+ *      - TiledGrids mirror the api of Grid, and can be converted to and from a Grid.
+ *      - TiledGrids can be resized, cropped, and merged together, copying runs of cells a tile row at a time.
+ *      - TiledGrids can return counts of the alive and dead cells.
+ *      - TiledGrids can be serialized directly to an ascii std::ostream in the same format as Grid.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include "memory_pool.h"
+#include "simd_kernels.h"
+#include "tiled_grid.h"
+
+/**
+ * spread_bits(value)
+ *
+ * Helper function spacing the bits of a value out to every other bit, so two spread values can be interleaved.
+ *
+ * @return
+ *      The value with bit i moved to bit 2i.
+ */
+static uint64_t spread_bits(uint32_t value)
+{
+    uint64_t bits = value;
+    bits = (bits | (bits << 16)) & 0x0000FFFF0000FFFFULL;
+    bits = (bits | (bits << 8)) & 0x00FF00FF00FF00FFULL;
+    bits = (bits | (bits << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    bits = (bits | (bits << 2)) & 0x3333333333333333ULL;
+    bits = (bits | (bits << 1)) & 0x5555555555555555ULL;
+
+    return bits;
+}
+
+/**
+ * wrap_coordinate(value, size, toroidal)
+ *
+ * Helper function finding the coordinate a stencil should read for one just outside the grid.
+ *
+ * @return
+ *      The coordinate itself if inside the grid, the opposite edge if toroidal, or -1 for a dead cell.
+ */
+static int wrap_coordinate(int value, int size, bool toroidal)
+{
+    if (value >= 0 && value < size)
+    {
+        return value;
+    }
+
+    return toroidal ? (value + size) % size : -1;
+}
+
+/**
+ * TiledGrid::TiledGrid()
+ *
+ * Construct an empty tiled grid of size 0x0.
+ *
+ * @example
+ *
+ *      // Make a 0x0 empty grid
+ *      TiledGrid grid;
+ *
+ */
+TiledGrid::TiledGrid() : TiledGrid::TiledGrid(0, 0) {}
+
+/**
+ * TiledGrid::TiledGrid(width, height, order)
+ *
+ * Construct a tiled grid with the desired size filled with dead cells.
+ *
+ * @example
+ *
+ *      // Make a 1000x1000 grid with its tiles along a Z-order curve
+ *      TiledGrid grid(1000, 1000, TileOrder::MORTON);
+ *
+ * @param width
+ *      The width of the grid.
+ *
+ * @param height
+ *      The height of the grid.
+ *
+ * @param order
+ *      Optional parameter. The order to lay the tiles out in memory. Defaults to TileOrder::ROW_MAJOR.
+ */
+TiledGrid::TiledGrid(int width, int height, TileOrder order)
+    : width(width), height(height), tiles_x((width + TILE_SIZE - 1) / TILE_SIZE),
+      tiles_y((height + TILE_SIZE - 1) / TILE_SIZE), order(order), tile_slots(tiles_x * tiles_y),
+      cells(static_cast<size_t>(tiles_x) * tiles_y * TILE_CELLS, Cell::DEAD, Memory::get_aligned_resource())
+{
+    std::iota(tile_slots.begin(), tile_slots.end(), 0);
+
+    if (order == TileOrder::MORTON)
+    {
+        // Rank the tiles by their position along the curve, which packs them densely even when not square
+        std::vector<int> tiles(tile_slots);
+        std::vector<uint64_t> codes(tiles.size());
+
+        for (int tile = 0; tile < tiles_x * tiles_y; tile++)
+        {
+            codes[tile] = spread_bits(tile % tiles_x) | (spread_bits(tile / tiles_x) << 1);
+        }
+
+        std::sort(tiles.begin(), tiles.end(), [&codes](int a, int b) { return codes[a] < codes[b]; });
+
+        for (int slot = 0; slot < tiles_x * tiles_y; slot++)
+        {
+            tile_slots[tiles[slot]] = slot;
+        }
+    }
+}
+
+/**
+ * TiledGrid::TiledGrid(grid, order)
+ *
+ * Construct a tiled grid holding a copy of the cells in a Grid.
+ *
+ * @example
+ *
+ *      // Split a glider into tiles
+ *      TiledGrid tiled(Zoo::glider());
+ *
+ * @param grid
+ *      The grid to copy the size and cells from.
+ *
+ * @param order
+ *      Optional parameter. The order to lay the tiles out in memory. Defaults to TileOrder::ROW_MAJOR.
+ */
+TiledGrid::TiledGrid(const Grid &grid, TileOrder order)
+    : TiledGrid::TiledGrid(grid.get_width(), grid.get_height(), order)
+{
+    for (int y = 0; y < height; y++)
+    {
+        const Cell *source = grid.row(y);
+
+        for (int tile_x = 0; tile_x < tiles_x; tile_x++)
+        {
+            const Cell *start = source + tile_x * TILE_SIZE;
+            std::copy(start, start + get_tile_width(tile_x), tile_row(tile_x, y / TILE_SIZE, y % TILE_SIZE));
+        }
+    }
+}
+
+/**
+ * TiledGrid::get_index(x, y)
+ *
+ * Private helper function to find the index of a cell within the tiles. No bounds checking is performed.
+ *
+ * @param x
+ *      The x coordinate of the cell.
+ *
+ * @param y
+ *      The y coordinate of the cell.
+ *
+ * @return
+ *      The index of the cell in the cell array.
+ */
+size_t TiledGrid::get_index(int x, int y) const
+{
+    const size_t slot = tile_slots[(y / TILE_SIZE) * tiles_x + x / TILE_SIZE];
+
+    return slot * TILE_CELLS + (y % TILE_SIZE + 1) * TILE_PITCH + x % TILE_SIZE + 1;
+}
+
+/**
+ * TiledGrid::get_width()
+ *
+ * Gets the current width of the grid.
+ *
+ * @return
+ *      The width of the grid.
+ */
+int TiledGrid::get_width() const
+{
+    return width;
+}
+
+/**
+ * TiledGrid::get_height()
+ *
+ * Gets the current height of the grid.
+ *
+ * @return
+ *      The height of the grid.
+ */
+int TiledGrid::get_height() const
+{
+    return height;
+}
+
+/**
+ * TiledGrid::get_total_cells()
+ *
+ * Gets the total number of cells in the grid.
+ *
+ * @return
+ *      The number of total cells.
+ */
+int TiledGrid::get_total_cells() const
+{
+    return width * height;
+}
+
+/**
+ * TiledGrid::get_alive_cells()
+ *
+ * Counts how many cells in the grid are alive, counting each row of each tile with the vectorized count kernel.
+ * The aprons and padding are skipped, since they may hold copies of cells of other tiles.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+int TiledGrid::get_alive_cells() const
+{
+    size_t count = 0;
+
+    for (int tile_y = 0; tile_y < tiles_y; tile_y++)
+    {
+        for (int tile_x = 0; tile_x < tiles_x; tile_x++)
+        {
+            for (int y = 0; y < get_tile_height(tile_y); y++)
+            {
+                count += Simd::count_alive(tile_row(tile_x, tile_y, y), get_tile_width(tile_x));
+            }
+        }
+    }
+
+    return static_cast<int>(count);
+}
+
+/**
+ * TiledGrid::get_dead_cells()
+ *
+ * Counts how many cells in the grid are dead.
+ *
+ * @return
+ *      The number of dead cells.
+ */
+int TiledGrid::get_dead_cells() const
+{
+    return get_total_cells() - get_alive_cells();
+}
+
+/**
+ * TiledGrid::get_order()
+ *
+ * Gets the order the tiles are laid out in memory.
+ *
+ * @return
+ *      The tile order the grid was constructed with.
+ */
+TileOrder TiledGrid::get_order() const
+{
+    return order;
+}
+
+/**
+ * TiledGrid::get_tiles_x()
+ *
+ * Gets the number of columns of tiles, the last of which may be partly padding.
+ *
+ * @return
+ *      The number of tiles across the grid.
+ */
+int TiledGrid::get_tiles_x() const
+{
+    return tiles_x;
+}
+
+/**
+ * TiledGrid::get_tiles_y()
+ *
+ * Gets the number of rows of tiles, the last of which may be partly padding.
+ *
+ * @return
+ *      The number of tiles down the grid.
+ */
+int TiledGrid::get_tiles_y() const
+{
+    return tiles_y;
+}
+
+/**
+ * TiledGrid::get_tile_width(tile_x)
+ *
+ * Gets how many columns of a column of tiles are part of the grid, which is less than TILE_SIZE only for the
+ * last column when the width is not a multiple of it.
+ *
+ * @param tile_x
+ *      The column of tiles.
+ *
+ * @return
+ *      The width of the tiles in the column.
+ */
+int TiledGrid::get_tile_width(int tile_x) const
+{
+    return std::min(TILE_SIZE, width - tile_x * TILE_SIZE);
+}
+
+/**
+ * TiledGrid::get_tile_height(tile_y)
+ *
+ * Gets how many rows of a row of tiles are part of the grid, which is less than TILE_SIZE only for the last row
+ * when the height is not a multiple of it.
+ *
+ * @param tile_y
+ *      The row of tiles.
+ *
+ * @return
+ *      The height of the tiles in the row.
+ */
+int TiledGrid::get_tile_height(int tile_y) const
+{
+    return std::min(TILE_SIZE, height - tile_y * TILE_SIZE);
+}
+
+/**
+ * TiledGrid::resize(square_size)
+ *
+ * Resize the current grid to a new width and height that are equal. The content of the grid
+ * is preserved within the kept region and padded with Cell::DEAD if new cells are added.
+ *
+ * @param square_size
+ *      The new edge size for both the width and height of the grid.
+ */
+void TiledGrid::resize(int square_size)
+{
+    resize(square_size, square_size);
+}
+
+/**
+ * TiledGrid::resize(new_width, new_height)
+ *
+ * Resize the current grid to a new width and height. The content of the grid
+ * is preserved within the kept region and padded with Cell::DEAD if new cells are added.
+ * The tiles keep their order.
+ *
+ * @param new_width
+ *      The new width for the grid.
+ *
+ * @param new_height
+ *      The new height for the grid.
+ */
+void TiledGrid::resize(int new_width, int new_height)
+{
+    // Sanity check; skip everything if no values change
+    if (new_width != width || new_height != height)
+    {
+        TiledGrid new_grid(new_width, new_height, order);
+
+        copy_region(*this, 0, 0, new_grid, 0, 0, std::min(width, new_width), std::min(height, new_height), false);
+
+        *this = std::move(new_grid);
+    }
+}
+
+/**
+ * TiledGrid::operator()(x, y)
+ *
+ * Gets a modifiable reference to the value at the desired coordinate.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      TiledGrid grid(4, 4);
+ *
+ *      // Directly assign to a cell at coordinate (1, 2)
+ *      grid(1, 2) = Cell::ALIVE;
+ *
+ * @param x
+ *      The x coordinate of the cell to access.
+ *
+ * @param y
+ *      The y coordinate of the cell to access.
+ *
+ * @return
+ *      A modifiable reference to the desired cell.
+ *
+ * @throws
+ *      std::out_of_range if x,y is not a valid coordinate within the grid.
+ */
+Cell &TiledGrid::operator()(int x, int y)
+{
+    // Check x/y within bounds
+    if (x >= width || x < 0 || y >= height || y < 0)
+    {
+        throw std::out_of_range("ERROR: Requested cell coordinate is out of bounds.");
+    }
+    else
+    {
+        return cells[get_index(x, y)];
+    }
+}
+
+/**
+ * TiledGrid::operator()(x, y)
+ *
+ * Gets the value at the desired coordinate.
+ * The operator should be callable from a constant context.
+ *
+ * @param x
+ *      The x coordinate of the cell to access.
+ *
+ * @param y
+ *      The y coordinate of the cell to access.
+ *
+ * @return
+ *      The value of the desired cell.
+ *
+ * @throws
+ *      std::out_of_range if x,y is not a valid coordinate within the grid.
+ */
+Cell TiledGrid::operator()(int x, int y) const
+{
+    // Check x/y within bounds
+    if (x >= width || x < 0 || y >= height || y < 0)
+    {
+        throw std::out_of_range("ERROR: Requested cell coordinate is out of bounds.");
+    }
+    else
+    {
+        return cells[get_index(x, y)];
+    }
+}
+
+/**
+ * TiledGrid::get(x, y)
+ *
+ * Returns the value of the cell at the desired coordinate.
+ *
+ * @param x
+ *      The x coordinate of the cell.
+ *
+ * @param y
+ *      The y coordinate of the cell.
+ *
+ * @return
+ *      The value of the desired cell.
+ *
+ * @throws
+ *      std::out_of_range if x,y is not a valid coordinate within the grid.
+ */
+Cell TiledGrid::get(int x, int y) const
+{
+    return operator()(x, y);
+}
+
+/**
+ * TiledGrid::set(x, y, value)
+ *
+ * Overwrites the value at the desired coordinate.
+ *
+ * @param x
+ *      The x coordinate of the cell to update.
+ *
+ * @param y
+ *      The y coordinate of the cell to update.
+ *
+ * @param value
+ *      The value to be written to the selected cell.
+ *
+ * @throws
+ *      std::out_of_range if x,y is not a valid coordinate within the grid.
+ */
+void TiledGrid::set(int x, int y, const Cell value)
+{
+    operator()(x, y) = value;
+}
+
+/**
+ * TiledGrid::tile_row(tile_x, tile_y, y)
+ *
+ * Gets a pointer to the first cell of a row of a tile, for use by stencil kernels.
+ * Rows -1 and get_tile_height(tile_y) are the apron above and below the tile, and each row can be read from
+ * index -1 up to get_tile_width(tile_x), the apron at either end. No bounds checking is performed.
+ *
+ * @param tile_x
+ *      The column of the tile.
+ *
+ * @param tile_y
+ *      The row of the tile.
+ *
+ * @param y
+ *      The row within the tile.
+ *
+ * @return
+ *      A pointer to the first cell of the row within the tile.
+ */
+Cell *TiledGrid::tile_row(int tile_x, int tile_y, int y)
+{
+    return cells.data() + static_cast<size_t>(tile_slots[tile_y * tiles_x + tile_x]) * TILE_CELLS
+           + (y + 1) * TILE_PITCH + 1;
+}
+
+/**
+ * TiledGrid::tile_row(tile_x, tile_y, y)
+ *
+ * Gets a read-only pointer to the first cell of a row of a tile, see the non-const overload.
+ *
+ * @return
+ *      A pointer to the first cell of the row within the tile.
+ */
+const Cell *TiledGrid::tile_row(int tile_x, int tile_y, int y) const
+{
+    return cells.data() + static_cast<size_t>(tile_slots[tile_y * tiles_x + tile_x]) * TILE_CELLS
+           + (y + 1) * TILE_PITCH + 1;
+}
+
+/**
+ * TiledGrid::refresh_aprons(toroidal)
+ *
+ * Fill the apron of every tile with the cells a stencil should see around it, as Grid::refresh_ghost_border
+ * does for a whole grid. The row above and below each tile is copied in one run from the tile above and below,
+ * and the columns either side a cell at a time from the tiles either side.
+ *      - Around the edges of the grid the apron holds the opposite edges when toroidal, or dead cells otherwise.
+ *      - For the edge tiles of a grid whose size is not a multiple of TILE_SIZE, the column and row just past
+ *        the edge are filled in place of the apron.
+ *
+ * Only the interior of each tile is read, so the aprons can be filled in any order. Only the edges of each tile
+ * are written, so this costs time proportional to the perimeter of the tiles.
+ *
+ * @param toroidal
+ *      If true then the grid is treated as a torus, where the left edge wraps to the right edge and the top to the
+ *      bottom.
+ */
+void TiledGrid::refresh_aprons(bool toroidal)
+{
+    for (int tile_y = 0; tile_y < tiles_y; tile_y++)
+    {
+        const int tile_height = get_tile_height(tile_y);
+
+        for (int tile_x = 0; tile_x < tiles_x; tile_x++)
+        {
+            const int tile_width = get_tile_width(tile_x);
+            const int west = wrap_coordinate(tile_x * TILE_SIZE - 1, width, toroidal);
+            const int east = wrap_coordinate(tile_x * TILE_SIZE + tile_width, width, toroidal);
+
+            // The rows above and below, including the corners
+            for (const int y : {-1, tile_height})
+            {
+                Cell *apron = tile_row(tile_x, tile_y, y);
+                const int source_y = wrap_coordinate(tile_y * TILE_SIZE + y, height, toroidal);
+
+                if (source_y < 0)
+                {
+                    std::fill(apron - 1, apron + tile_width + 1, Cell::DEAD);
+                    continue;
+                }
+
+                const Cell *source = tile_row(tile_x, source_y / TILE_SIZE, source_y % TILE_SIZE);
+                std::copy(source, source + tile_width, apron);
+
+                apron[-1] = west < 0 ? Cell::DEAD : cells[get_index(west, source_y)];
+                apron[tile_width] = east < 0 ? Cell::DEAD : cells[get_index(east, source_y)];
+            }
+
+            // The columns either side, from the same rows of the tiles either side
+            const Cell *west_source = west < 0 ? nullptr : tile_row(west / TILE_SIZE, tile_y, 0) + west % TILE_SIZE;
+            const Cell *east_source = east < 0 ? nullptr : tile_row(east / TILE_SIZE, tile_y, 0) + east % TILE_SIZE;
+            Cell *row = tile_row(tile_x, tile_y, 0);
+
+            for (int y = 0; y < tile_height; y++)
+            {
+                row[-1] = west_source ? west_source[y * TILE_PITCH] : Cell::DEAD;
+                row[tile_width] = east_source ? east_source[y * TILE_PITCH] : Cell::DEAD;
+                row += TILE_PITCH;
+            }
+        }
+    }
+}
+
+/**
+ * TiledGrid::copy_region(source, source_x, source_y, destination, destination_x, destination_y,
+ *                        region_width, region_height, alive_only)
+ *
+ * Private helper function copying a rectangle of cells between tiled grids, which may have different tile
+ * orders. Each row is copied in runs which end at the edges of the tiles of either grid, so every run is a
+ * single contiguous copy. No bounds checking is performed.
+ *
+ * @param alive_only
+ *      If true then only alive cells are copied, leaving the cells under dead cells as they were.
+ */
+void TiledGrid::copy_region(const TiledGrid &source, int source_x, int source_y, TiledGrid &destination,
+                            int destination_x, int destination_y, int region_width, int region_height,
+                            bool alive_only)
+{
+    for (int y = 0; y < region_height; y++)
+    {
+        const int from_y = source_y + y;
+        const int to_y = destination_y + y;
+
+        for (int x = 0; x < region_width;)
+        {
+            const int from_x = source_x + x;
+            const int to_x = destination_x + x;
+            const int run = std::min({region_width - x, TILE_SIZE - from_x % TILE_SIZE, TILE_SIZE - to_x % TILE_SIZE});
+
+            const Cell *from = source.tile_row(from_x / TILE_SIZE, from_y / TILE_SIZE, from_y % TILE_SIZE)
+                               + from_x % TILE_SIZE;
+            Cell *to = destination.tile_row(to_x / TILE_SIZE, to_y / TILE_SIZE, to_y % TILE_SIZE) + to_x % TILE_SIZE;
+
+            if (alive_only)
+            {
+                for (int i = 0; i < run; i++)
+                {
+                    if (from[i] == Cell::ALIVE)
+                    {
+                        to[i] = Cell::ALIVE;
+                    }
+                }
+            }
+            else
+            {
+                std::copy(from, from + run, to);
+            }
+
+            x += run;
+        }
+    }
+}
+
+/**
+ * TiledGrid::crop(x0, y0, x1, y1)
+ *
+ * Extract a sub-grid from a TiledGrid, copying runs of cells a tile row at a time.
+ * The cropped grid spans the range [x0, x1) by [y0, y1) in the original grid, and has the same tile order.
+ *
+ * @param x0
+ *      Left coordinate of the crop window on x-axis.
+ *
+ * @param y0
+ *      Top coordinate of the crop window on y-axis.
+ *
+ * @param x1
+ *      Right coordinate of the crop window on x-axis (1 greater than the largest index).
+ *
+ * @param y1
+ *      Bottom coordinate of the crop window on y-axis (1 greater than the largest index).
+ *
+ * @return
+ *      A new grid of the cropped size containing the values extracted from the original grid.
+ *
+ * @throws
+ *      std::out_of_range if the crop window does not lie within the grid or has a negative size.
+ */
+TiledGrid TiledGrid::crop(int x0, int y0, int x1, int y1) const
+{
+    // Check x0, y0 within bounds and x1, y1 within bounds and not before x0, y0
+    if (x0 >= width || x0 < 0 || y0 >= height || y0 < 0 || x1 < x0 || y1 < y0 || x1 > width || y1 > height)
+    {
+        throw std::out_of_range("ERROR: Attempted crop is out of bounds.");
+    }
+    else
+    {
+        TiledGrid new_grid(x1 - x0, y1 - y0, order);
+
+        copy_region(*this, x0, y0, new_grid, 0, 0, x1 - x0, y1 - y0, false);
+
+        return new_grid;
+    }
+}
+
+/**
+ * TiledGrid::merge(other, x0, y0, alive_only = false)
+ *
+ * Merge two grids together by overlaying the other on the current grid at the desired location,
+ * copying runs of cells a tile row at a time. Follows the same rules as Grid::merge.
+ *
+ * @param other
+ *      The other grid to merge into the current grid.
+ *
+ * @param x0
+ *      The x coordinate of where to place the top left corner of the other grid.
+ *
+ * @param y0
+ *      The y coordinate of where to place the top left corner of the other grid.
+ *
+ * @param alive_only
+ *      Optional parameter. If true then merging only sets alive cells to alive but does not explicitly set
+ *      dead cells, allowing whatever value was already there to persist. Defaults to false.
+ *
+ * @throws
+ *      std::exception or sub-class if the other grid being placed does not fit within the bounds of the current grid.
+ */
+void TiledGrid::merge(const TiledGrid &other, int x0, int y0, bool alive_only)
+{
+    if (x0 < 0 || y0 < 0)
+    {
+        throw std::out_of_range("ERROR: Merging grid out of bounds.");
+    }
+    else if (width < x0 + other.get_width() || height < y0 + other.get_height())
+    {
+        throw std::invalid_argument("ERROR: Merging grid too large.");
+    }
+    else
+    {
+        copy_region(other, 0, 0, *this, x0, y0, other.get_width(), other.get_height(), alive_only);
+    }
+}
+
+/**
+ * TiledGrid::to_grid()
+ *
+ * Copy the tiles back into a row-major Grid of the same size.
+ *
+ * @example
+ *
+ *      // Print a tiled grid via a Grid
+ *      std::cout << tiled.to_grid() << std::endl;
+ *
+ * @return
+ *      A Grid holding a copy of the cells.
+ */
+Grid TiledGrid::to_grid() const
+{
+    Grid grid(width, height);
+
+    for (int y = 0; y < height; y++)
+    {
+        Cell *destination = grid.row(y);
+
+        for (int tile_x = 0; tile_x < tiles_x; tile_x++)
+        {
+            const Cell *source = tile_row(tile_x, y / TILE_SIZE, y % TILE_SIZE);
+            std::copy(source, source + get_tile_width(tile_x), destination + tile_x * TILE_SIZE);
+        }
+    }
+
+    return grid;
+}
+
+/**
+ * operator<<(output_stream, grid)
+ *
+ * Serializes a tiled grid to an ascii output stream, in the same bordered format as a Grid.
+ *
+ * @param os
+ *      An ascii mode output stream such as std::cout.
+ *
+ * @param grid
+ *      A tiled grid object containing cells to be printed.
+ *
+ * @return
+ *      Returns a reference to the output stream to enable operator chaining.
+ */
+std::ostream &operator<<(std::ostream &output_stream, const TiledGrid &grid)
+{
+    // Create (identical) top & bottom borders
+    const std::string border = "+" + std::string(grid.get_width(), '-') + "+\n";
+
+    // Print top border
+    output_stream << border;
+
+    // Print grid contents a row at a time
+    std::string line(grid.get_width() + 2, ' ');
+    line.front() = '|';
+    line.back() = '|';
+
+    for (int y = 0; y < grid.get_height(); y++)
+    {
+        for (int tile_x = 0; tile_x < grid.get_tiles_x(); tile_x++)
+        {
+            const Cell *source = grid.tile_row(tile_x, y / TiledGrid::TILE_SIZE, y % TiledGrid::TILE_SIZE);
+
+            // Cell values are their own ascii characters
+            std::copy(source, source + grid.get_tile_width(tile_x),
+                      line.begin() + 1 + tile_x * TiledGrid::TILE_SIZE);
+        }
+
+        output_stream << line << "\n";
+    }
+
+    // Print bottom border
+    output_stream << border;
+
+    return output_stream;
+}
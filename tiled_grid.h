@@ -0,0 +1,102 @@
+/**
+ * Declares a class representing a 2d grid of cells stored as square tiles.
+ * Rich documentation for the api and behaviour the TiledGrid class can be found in tiled_grid.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <ostream>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * The order the tiles of a TiledGrid are laid out in memory.
+ *      - TileOrder::ROW_MAJOR stores the tiles row by row, like the cells of a Grid.
+ *      - TileOrder::MORTON stores the tiles along a Z-order curve, so tiles which are close in both directions
+ *        are also close in memory.
+ */
+enum class TileOrder
+{
+    ROW_MAJOR,
+    MORTON
+};
+
+/**
+ * Declare the structure of the TiledGrid class for representing a 2d grid of cells split into square tiles.
+ *
+ * Each tile of TILE_SIZE by TILE_SIZE cells is stored contiguously, row by row, surrounded by an apron of cells
+ * one cell wide. The apron holds copies of the neighbouring cells of the tile, written only by
+ * TiledGrid::refresh_aprons, so a stencil can step a tile without reading from any other tile.
+ * Cells of the edge tiles past the width or height of the grid are padding, and are dead but for the column and
+ * row just past the edge, which serve as the apron of those tiles.
+ */
+class TiledGrid
+{
+    public:
+        // Edge length of the square tiles, long enough that the per row cost of the kernels is lost in the row
+        static constexpr int TILE_SIZE = 256;
+
+        // Cells per row of a tile, including the apron on both sides
+        static constexpr int TILE_PITCH = TILE_SIZE + 2;
+
+        // Cells held by each tile, including its apron
+        static constexpr int TILE_CELLS = TILE_PITCH * TILE_PITCH;
+
+    private:
+        int width;
+        int height;
+        int tiles_x;
+        int tiles_y;
+        TileOrder order;
+        std::vector<int> tile_slots; // Position in memory of each tile, numbered row by row
+        std::pmr::vector<Cell> cells; // TILE_CELLS cells per tile, in the order of the slots
+
+        size_t get_index(int x, int y) const;
+
+        static void copy_region(const TiledGrid &source, int source_x, int source_y, TiledGrid &destination,
+                                int destination_x, int destination_y, int region_width, int region_height,
+                                bool alive_only);
+
+    public:
+        TiledGrid();
+        TiledGrid(int width, int height, TileOrder order = TileOrder::ROW_MAJOR);
+        explicit TiledGrid(const Grid &grid, TileOrder order = TileOrder::ROW_MAJOR);
+
+        int get_width() const;
+        int get_height() const;
+        int get_total_cells() const;
+        int get_alive_cells() const;
+        int get_dead_cells() const;
+
+        TileOrder get_order() const;
+        int get_tiles_x() const;
+        int get_tiles_y() const;
+        int get_tile_width(int tile_x) const;
+        int get_tile_height(int tile_y) const;
+
+        void resize(int square_size);
+        void resize(int new_width, int new_height);
+
+        Cell &operator()(int x, int y);
+        Cell operator()(int x, int y) const;
+
+        Cell get(int x, int y) const;
+        void set(int x, int y, const Cell value);
+
+        Cell *tile_row(int tile_x, int tile_y, int y);
+        const Cell *tile_row(int tile_x, int tile_y, int y) const;
+
+        void refresh_aprons(bool toroidal);
+
+        TiledGrid crop(int x0, int y0, int x1, int y1) const;
+        void merge(const TiledGrid &other, int x0, int y0, bool alive_only = false);
+
+        Grid to_grid() const;
+
+        friend std::ostream &operator<<(std::ostream &output_stream, const TiledGrid &grid);
+};
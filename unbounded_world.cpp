@@ -0,0 +1,475 @@
+/**
+ * Implements a class for simulating the Game of Life on an unbounded plane stored as a sparse map of chunks.
+ *      - The plane is split into 64x64 chunks, each stored as 64 bit-packed rows of a single 64 bit word.
+ *          - Chunks are held in a hash map keyed by their coordinates, and only chunks holding at least one
+ *            alive cell are kept, so memory scales with the population instead of the bounding box.
+ *          - A chunk is allocated as soon as a cell is born in it, and freed as soon as it goes empty.
+ *
+ *      - Stepping the world computes every stored chunk, plus each neighbouring chunk that is bordered by an
+ *        alive cell and so could have a birth in it, using the same bitwise full adders as Engine::PACKED.
+ *
+ *      - UnboundedWorlds are constructed from a Grid, which is placed with its top left corner at the origin.
+ *          - Unlike a World, nothing is lost or wrapped at the edges, so spaceships fly on forever.
+ *          - Any rectangle of the plane can be extracted back out as a Grid, with the initial grid's
+ *            bounds giving the default viewport.
+ *          - Chunk coordinates are 32 bit, so the plane spans 2^37 cells in each direction from the origin.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "packed_grid.h"
+#include "unbounded_world.h"
+
+/**
+ * UnboundedWorld::UnboundedWorld()
+ *
+ * Construct an empty world with a 0x0 viewport.
+ *
+ * @example
+ *
+ *      // Make an empty world
+ *      UnboundedWorld world;
+ *
+ */
+UnboundedWorld::UnboundedWorld() : UnboundedWorld::UnboundedWorld(Grid()) {}
+
+/**
+ * UnboundedWorld::UnboundedWorld(initial_state)
+ *
+ * Construct a world holding the cells of a grid, with the top left corner of the grid at the origin.
+ * The size of the grid becomes the default viewport returned by UnboundedWorld::get_state().
+ *
+ * @example
+ *
+ *      // Make a world with a spaceship which will never hit an edge
+ *      UnboundedWorld world(Zoo::light_weight_spaceship());
+ *
+ * @param initial_state
+ *      The grid to copy the initial cells from.
+ */
+UnboundedWorld::UnboundedWorld(const Grid &initial_state)
+    : width(initial_state.get_width()), height(initial_state.get_height()), alive_cells(0), generation(0)
+{
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            if (initial_state(x, y) == Cell::ALIVE)
+            {
+                set(x, y, Cell::ALIVE);
+            }
+        }
+    }
+}
+
+/**
+ * UnboundedWorld::get_key(chunk_x, chunk_y)
+ *
+ * Private helper function packing the coordinates of a chunk into a single key for the chunk map.
+ *
+ * @return
+ *      The low 32 bits of chunk_x followed by the low 32 bits of chunk_y.
+ */
+uint64_t UnboundedWorld::get_key(long long chunk_x, long long chunk_y)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(chunk_x)) << 32) | static_cast<uint32_t>(chunk_y);
+}
+
+/**
+ * UnboundedWorld::get_chunk_coordinate(coordinate)
+ *
+ * Private helper function finding which chunk a cell coordinate falls in, rounding towards negative infinity
+ * so that the cells either side of the origin land in different chunks.
+ *
+ * @return
+ *      The chunk coordinate.
+ */
+long long UnboundedWorld::get_chunk_coordinate(long long coordinate)
+{
+    return coordinate >= 0 ? coordinate / CHUNK_SIZE : -((-coordinate - 1) / CHUNK_SIZE) - 1;
+}
+
+/**
+ * UnboundedWorld::find(chunk_x, chunk_y)
+ *
+ * Private helper function to look up a chunk.
+ *
+ * @return
+ *      A pointer to the chunk, or nullptr if it has no alive cells and so is not stored.
+ */
+const UnboundedWorld::Chunk *UnboundedWorld::find(long long chunk_x, long long chunk_y) const
+{
+    const auto chunk = chunks.find(get_key(chunk_x, chunk_y));
+
+    return chunk == chunks.end() ? nullptr : &chunk->second;
+}
+
+/**
+ * UnboundedWorld::get_width()
+ *
+ * Gets the width of the default viewport, the width of the initial grid.
+ *
+ * @return
+ *      The width of the viewport.
+ */
+int UnboundedWorld::get_width() const
+{
+    return width;
+}
+
+/**
+ * UnboundedWorld::get_height()
+ *
+ * Gets the height of the default viewport, the height of the initial grid.
+ *
+ * @return
+ *      The height of the viewport.
+ */
+int UnboundedWorld::get_height() const
+{
+    return height;
+}
+
+/**
+ * UnboundedWorld::get_alive_cells()
+ *
+ * Gets the number of alive cells on the whole plane, which is kept up to date by every step.
+ *
+ * @return
+ *      The number of alive cells.
+ */
+uint64_t UnboundedWorld::get_alive_cells() const
+{
+    return alive_cells;
+}
+
+/**
+ * UnboundedWorld::get_generation()
+ *
+ * Gets the number of steps the world has been advanced by since it was constructed.
+ *
+ * @return
+ *      The current generation.
+ */
+uint64_t UnboundedWorld::get_generation() const
+{
+    return generation;
+}
+
+/**
+ * UnboundedWorld::get_chunk_count()
+ *
+ * Gets the number of chunks currently allocated, each of which holds at least one alive cell.
+ *
+ * @return
+ *      The number of chunks.
+ */
+size_t UnboundedWorld::get_chunk_count() const
+{
+    return chunks.size();
+}
+
+/**
+ * UnboundedWorld::get(x, y)
+ *
+ * Gets the value of any cell on the plane.
+ *
+ * @param x
+ *      The x coordinate of the cell, relative to the top left corner of the initial grid.
+ *
+ * @param y
+ *      The y coordinate of the cell, relative to the top left corner of the initial grid.
+ *
+ * @return
+ *      The value of the cell.
+ */
+Cell UnboundedWorld::get(long long x, long long y) const
+{
+    const long long chunk_x = get_chunk_coordinate(x);
+    const long long chunk_y = get_chunk_coordinate(y);
+    const Chunk *chunk = find(chunk_x, chunk_y);
+
+    if (chunk && ((chunk->rows[y - chunk_y * CHUNK_SIZE] >> (x - chunk_x * CHUNK_SIZE)) & 1ULL))
+    {
+        return Cell::ALIVE;
+    }
+
+    return Cell::DEAD;
+}
+
+/**
+ * UnboundedWorld::set(x, y, value)
+ *
+ * Sets the value of any cell on the plane, allocating its chunk if it is the first alive cell in it
+ * and freeing the chunk if it is the last.
+ *
+ * @example
+ *
+ *      // Drop a single cell a long way from the origin
+ *      world.set(-1000000, 1000000, Cell::ALIVE);
+ *
+ * @param x
+ *      The x coordinate of the cell, relative to the top left corner of the initial grid.
+ *
+ * @param y
+ *      The y coordinate of the cell, relative to the top left corner of the initial grid.
+ *
+ * @param value
+ *      The new value of the cell.
+ */
+void UnboundedWorld::set(long long x, long long y, Cell value)
+{
+    const long long chunk_x = get_chunk_coordinate(x);
+    const long long chunk_y = get_chunk_coordinate(y);
+    const uint64_t key = get_key(chunk_x, chunk_y);
+    const uint64_t mask = 1ULL << (x - chunk_x * CHUNK_SIZE);
+
+    auto chunk = chunks.find(key);
+
+    if (value == Cell::ALIVE)
+    {
+        if (chunk == chunks.end())
+        {
+            chunk = chunks.emplace(key, Chunk()).first;
+        }
+
+        uint64_t &row = chunk->second.rows[y - chunk_y * CHUNK_SIZE];
+        alive_cells += (row & mask) == 0;
+        row |= mask;
+    }
+    else if (chunk != chunks.end())
+    {
+        uint64_t &row = chunk->second.rows[y - chunk_y * CHUNK_SIZE];
+        alive_cells -= (row & mask) != 0;
+        row &= ~mask;
+
+        const uint64_t *rows = chunk->second.rows;
+
+        if (std::all_of(rows, rows + CHUNK_SIZE, [](uint64_t word) { return word == 0; }))
+        {
+            chunks.erase(chunk);
+        }
+    }
+}
+
+/**
+ * UnboundedWorld::get_state()
+ *
+ * Extract the default viewport, the area covered by the initial grid, as a Grid.
+ *
+ * @example
+ *
+ *      // Print the viewport of a world to the console
+ *      std::cout << world.get_state() << std::endl;
+ *
+ * @return
+ *      A new grid of the viewport size.
+ */
+Grid UnboundedWorld::get_state() const
+{
+    return get_state(0, 0, width, height);
+}
+
+/**
+ * UnboundedWorld::get_state(x0, y0, x1, y1)
+ *
+ * Extract the cells within any rectangle of the plane as a Grid.
+ * The rectangle spans the range [x0, x1) by [y0, y1), where the initial grid's top left corner was the origin.
+ * Only the stored chunks are visited, so empty areas of the rectangle cost nothing beyond allocating the grid.
+ *
+ * @example
+ *
+ *      // Follow a glider which has flown far away from the initial grid
+ *      Grid view = world.get_state(2500, 2500, 2520, 2520);
+ *
+ * @return
+ *      A new grid of the requested size.
+ *
+ * @throws
+ *      std::out_of_range if the rectangle has a negative size.
+ */
+Grid UnboundedWorld::get_state(long long x0, long long y0, long long x1, long long y1) const
+{
+    if (x1 < x0 || y1 < y0)
+    {
+        throw std::out_of_range("ERROR: Requested viewport has a negative size.");
+    }
+
+    Grid grid(x1 - x0, y1 - y0);
+
+    for (const auto &chunk : chunks)
+    {
+        const long long chunk_x = static_cast<int32_t>(chunk.first >> 32) * static_cast<long long>(CHUNK_SIZE);
+        const long long chunk_y = static_cast<int32_t>(chunk.first) * static_cast<long long>(CHUNK_SIZE);
+
+        // Clip the chunk to the rectangle
+        const long long left = std::max(x0, chunk_x), right = std::min(x1, chunk_x + CHUNK_SIZE);
+        const long long top = std::max(y0, chunk_y), bottom = std::min(y1, chunk_y + CHUNK_SIZE);
+
+        for (long long y = top; y < bottom; y++)
+        {
+            const uint64_t row = chunk.second.rows[y - chunk_y];
+
+            for (long long x = left; x < right && row != 0; x++)
+            {
+                if ((row >> (x - chunk_x)) & 1ULL)
+                {
+                    grid(x - x0, y - y0) = Cell::ALIVE;
+                }
+            }
+        }
+    }
+
+    return grid;
+}
+
+/**
+ * UnboundedWorld::step_chunk(chunk_x, chunk_y, result, population)
+ *
+ * Private helper function computing the next state of one chunk from its 3x3 neighbourhood of chunks,
+ * where missing chunks are read as dead.
+ *
+ * Each row word is lined up with its left and right neighbours by shifting, carrying in the edge bits of the
+ * chunks to the west and east, and the rows above and below the chunk are borrowed from the chunks to
+ * the north and south. The 64 cells of each row are then updated at once with life_word.
+ *
+ * @param chunk_x
+ *      The x coordinate of the chunk.
+ *
+ * @param chunk_y
+ *      The y coordinate of the chunk.
+ *
+ * @param result
+ *      Output chunk to write the next state to.
+ *
+ * @param population
+ *      Output number of alive cells in the next state of the chunk.
+ */
+void UnboundedWorld::step_chunk(long long chunk_x, long long chunk_y, Chunk &result, uint64_t &population) const
+{
+    static const Chunk empty_chunk = {};
+
+    const Chunk *neighbourhood[3][3];
+
+    for (int j = 0; j < 3; j++)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            const Chunk *chunk = find(chunk_x + i - 1, chunk_y + j - 1);
+            neighbourhood[j][i] = chunk ? chunk : &empty_chunk;
+        }
+    }
+
+    // Rows -1 to CHUNK_SIZE of the chunk, each with its left and right neighbours lined up
+    uint64_t centre[CHUNK_SIZE + 2], west[CHUNK_SIZE + 2], east[CHUNK_SIZE + 2];
+
+    for (int i = 0; i < CHUNK_SIZE + 2; i++)
+    {
+        const int band = i == 0 ? 0 : (i == CHUNK_SIZE + 1 ? 2 : 1);
+        const int row = (i + CHUNK_SIZE - 1) % CHUNK_SIZE;
+
+        const uint64_t cells = neighbourhood[band][1]->rows[row];
+
+        centre[i] = cells;
+        west[i] = (cells << 1) | (neighbourhood[band][0]->rows[row] >> 63);
+        east[i] = (cells >> 1) | (neighbourhood[band][2]->rows[row] << 63);
+    }
+
+    population = 0;
+
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+        result.rows[y] = life_word(west[y], centre[y], east[y],
+                                   west[y + 1], centre[y + 1], east[y + 1],
+                                   west[y + 2], centre[y + 2], east[y + 2]);
+
+        population += __builtin_popcountll(result.rows[y]);
+    }
+}
+
+/**
+ * UnboundedWorld::step()
+ *
+ * Take one step in Conway's Game of Life.
+ *
+ * Every stored chunk is computed, along with any missing neighbour which an alive cell on the facing edge or
+ * corner of a stored chunk could cause a birth in. Chunks which come out empty are not kept.
+ */
+void UnboundedWorld::step()
+{
+    std::unordered_set<uint64_t> candidates;
+
+    for (const auto &chunk : chunks)
+    {
+        const long long chunk_x = static_cast<int32_t>(chunk.first >> 32);
+        const long long chunk_y = static_cast<int32_t>(chunk.first);
+        const uint64_t *rows = chunk.second.rows;
+
+        // Every column of the chunk which has an alive cell in any row
+        uint64_t any_row = 0;
+
+        for (int y = 0; y < CHUNK_SIZE; y++)
+        {
+            any_row |= rows[y];
+        }
+
+        for (int j = -1; j <= 1; j++)
+        {
+            const uint64_t edge = j < 0 ? rows[0] : (j > 0 ? rows[CHUNK_SIZE - 1] : any_row);
+
+            for (int i = -1; i <= 1; i++)
+            {
+                // The cells of the chunk bordering its neighbour in this direction
+                const uint64_t facing = i < 0 ? (edge & 1ULL) : (i > 0 ? (edge >> 63) : edge);
+
+                if (facing != 0)
+                {
+                    candidates.insert(get_key(chunk_x + i, chunk_y + j));
+                }
+            }
+        }
+    }
+
+    std::unordered_map<uint64_t, Chunk> next_chunks;
+    next_chunks.reserve(candidates.size());
+    alive_cells = 0;
+
+    for (const uint64_t key : candidates)
+    {
+        Chunk result;
+        uint64_t population;
+
+        step_chunk(static_cast<int32_t>(key >> 32), static_cast<int32_t>(key), result, population);
+
+        // Chunks that went empty are freed by leaving them out
+        if (population > 0)
+        {
+            next_chunks.emplace(key, result);
+            alive_cells += population;
+        }
+    }
+
+    chunks = std::move(next_chunks);
+    generation++;
+}
+
+/**
+ * UnboundedWorld::advance(steps)
+ *
+ * Advance multiple steps in the Game of Life.
+ * Implemented by invoking UnboundedWorld::step().
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ */
+void UnboundedWorld::advance(uint64_t steps)
+{
+    for (uint64_t i = 0; i < steps; i++)
+    {
+        step();
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * Declares a class for simulating the Game of Life on an unbounded plane stored as a sparse map of chunks.
+ * Rich documentation for the api and behaviour the UnboundedWorld class can be found in unbounded_world.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "grid.h"
+
+/**
+ * Declare the structure of the UnboundedWorld class for representing an infinite plane of cells.
+ *
+ * The plane is split into square chunks of bit-packed rows, and only chunks holding alive cells are stored,
+ * so memory scales with the population rather than the bounding box of the pattern.
+ */
+class UnboundedWorld
+{
+    private:
+        static const int CHUNK_SIZE = 64;
+
+        /**
+         * A CHUNK_SIZE by CHUNK_SIZE square of cells, with cell x of each row held in bit x of its word.
+         */
+        struct Chunk
+        {
+            uint64_t rows[CHUNK_SIZE];
+        };
+
+        std::unordered_map<uint64_t, Chunk> chunks; // Keyed by the packed chunk coordinates
+
+        int width;
+        int height;
+        uint64_t alive_cells;
+        uint64_t generation;
+
+        static uint64_t get_key(long long chunk_x, long long chunk_y);
+        static long long get_chunk_coordinate(long long coordinate);
+
+        const Chunk *find(long long chunk_x, long long chunk_y) const;
+        void step_chunk(long long chunk_x, long long chunk_y, Chunk &result, uint64_t &population) const;
+
+    public:
+        UnboundedWorld();
+        explicit UnboundedWorld(const Grid &initial_state);
+
+        int get_width() const;
+        int get_height() const;
+        uint64_t get_alive_cells() const;
+        uint64_t get_generation() const;
+        size_t get_chunk_count() const;
+
+        Cell get(long long x, long long y) const;
+        void set(long long x, long long y, Cell value);
+
+        Grid get_state() const;
+        Grid get_state(long long x0, long long y0, long long x1, long long y1) const;
+
+        void step();
+        void advance(uint64_t steps);
+};
@@ -1,15 +1,19 @@
 /**
  * Implements a class representing a 2d grid world for simulating a cellular automaton.
  *      - Worlds can be constructed empty, from a size, or from an existing Grid with an initial state for the world.
+ *          - A Grid passed with std::move is taken over as the current state rather than copied.
  *      - Worlds can be resized.
  *      - Worlds can return counts of the alive and dead cells in the current Grid state.
- *      - Worlds can return their current Grid state.
+ *      - Worlds can return their current Grid state, or hand it over with World::take_state() without a copy.
  *
  *      - A World holds two equally sized Grid objects for the current state and next state.
  *          - These buffers are swapped after each update step.
  *
- *      - Stepping a world forward in time applies the rules of Conway's Game of Life.
+ *      - Stepping a world forward in time applies the rules of Conway's Game of Life by default.
  *          - https://en.wikipedia.org/wiki/Conway%27s_Game_of_Life
+ *          - Any other Life-like rule can be chosen with World::set_rule(rule), e.g. HighLife or Seeds.
+ *          - The rules the stencil kernels are specialized for at compile time step as fast as Conway's, any
+ *            other rule is looked up per cell in the 512 entry neighbourhood table of the Rule.
  *
  *      - Worlds have a private helper function used to count the number of alive cells in a 3x3 neighbours
  *        around a given cell.
@@ -18,9 +22,81 @@
  *          - Moving off the left edge you appear on the right edge and vice versa.
  *          - Moving off the top edge you appear on the bottom edge and vice versa.
  *
+ *      - The kernel used for each update step can be selected with World::set_engine(engine).
+ *          - Engine::STENCIL, the default, sweeps every row with a single unconditional stencil.
+ *              - The sweep reads three rows at a time through raw row pointers with no bounds checks or
+ *                branches, so the compiler can auto-vectorize it.
+ *              - The state grids carry a ghost border one cell wide, refreshed before each step by copying the
+ *                opposite edges when toroidal or clearing it otherwise, so the edges need no special cases.
+ *          - Engine::SIMD is Engine::STENCIL with the rows swept by hand-vectorized AVX2, AVX-512, or NEON
+ *            kernels, picked at runtime for the running CPU by Simd::get_row_kernel().
+ *          - Engine::SCALAR visits every cell and counts its neighbours one by one.
+ *          - Engine::PACKED keeps the state bit-packed in PackedGrid buffers, using 8x less memory, and
+ *            computes 64 cells at a time by summing shifted neighbour words with bitwise full adders.
+ *          - Engine::TILED stores the state in a TiledGrid, as 256x256 tiles laid out contiguously in Morton
+ *            order, and sweeps each tile with the Engine::SIMD kernels, so the neighbourhood of every cell stays
+ *            in a few cache lines and pages however wide the grid is.
+ *              - Each tile carries an apron one cell wide, refreshed before each step from the neighbouring
+ *                tiles, so a tile is swept without reading any other tile.
+ *          - Engine::GPU keeps both buffers in DeviceGrid objects on an OpenMP offload device such as a GPU, for
+ *            as long as the engine is selected, and steps them there with a tiled stencil in team shared memory.
+ *              - The state is only copied back to the host when it is asked for, by World::get_state(), so
+ *                advancing any number of steps between snapshots costs no copies at all.
+ *              - The alive count is taken by a reduction on the device, so it is also free of copies.
+ *              - Stats and cycle detection read the state on the host, so each step is copied back while
+ *                either is enabled.
+ *              - The device runs the whole grid at once, so a thread pool is not used to step it.
+ *          - Engine::SPARSE splits the grid into 64x64 tiles and only recomputes the active tiles.
+ *              - A tile is active if it or any of its 8 neighbouring tiles changed during the last step, since
+ *                a tile whose whole neighbourhood is unchanged must come out unchanged again.
+ *              - Empty space and still lifes are skipped entirely, an inactive tile is identical in both
+ *                buffers so it is never touched.
+ *              - Each tile keeps its own population, and the alive count is updated from the change in
+ *                population of the recomputed tiles instead of rescanning the grid.
+ *
+ *      - The state grids are allocated from Memory::get_aligned_resource(), so their rows start on a cache line
+ *        and large worlds are backed by huge pages. Buffers rebuilt every step, such as the active tile flags of
+ *        Engine::SPARSE, are drawn from the per-thread pool of Memory::get_scratch_resource().
+ *
+ *      - Worlds can optionally collect stats on each step with World::set_stats_enabled(true).
+ *          - The time taken, cells evaluated and skipped, births and deaths, and active tiles are recorded
+ *            once per step, when the buffers are swapped, so collecting stats never touches the kernels.
+ *          - When disabled the only cost is a single branch per step.
+ *
+ *      - Worlds can optionally look for cycles with World::set_cycle_detection(true).
+ *          - A 64 bit hash of each row of the state, or of each tile with Engine::SPARSE, is updated by the
+ *            kernels as they write the next state, only rehashing the tiles which changed with Engine::SPARSE.
+ *          - The hash of the whole state is the XOR of these, and is kept for the last CYCLE_HISTORY generations.
+ *          - Once the state comes back to an earlier hash, World::advance skips every whole period of its
+ *            remaining steps, only stepping through the last part period, so a world which has died out,
+ *            settled into a still life, or started oscillating costs at most one period to finish advancing.
+ *          - The period and the generation it started at are reported by World::get_cycle().
+ *
+ *      - Steps can be run in parallel on a persistent pool of threads with World::set_threads(thread_count).
+ *          - The grid is split into one horizontal band of rows per thread.
+ *          - The halo rows above and below each band are read in place from the shared current state, which
+ *            is never written during a step, wrapping to the opposite edge when toroidal.
+ *          - Each cell is computed exactly as in the serial path, so the results are bit-identical.
+ *
+ *      - World::advance can compute several generations per pass over the grid with
+ *        World::set_temporal_depth(generations), for Engine::STENCIL and Engine::SIMD.
+ *          - The grid is split into 256x256 blocks, and each block is copied into scratch memory along with a halo
+ *            as deep as the pass, then stepped through every generation of the pass while it is in cache.
+ *          - The halo shrinks by one cell each generation, so the block comes out exactly as if stepped one
+ *            generation at a time, at the cost of recomputing the halo cells.
+ *          - Grids too big for the cache are then read from memory once per pass rather than once per generation.
+ *
  * @author 961500
  * @date April, 2020
  */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "memory_pool.h"
+#include "simd_kernels.h"
 #include "world.h"
 
 /**
@@ -72,12 +148,21 @@ World::World(int square_size) : World::World(square_size, square_size) {}
  * @param height
  *      The height of the world.
  */
-World::World(int width, int height) : current_state(width, height), next_state(width, height) {}
+World::World(int width, int height)
+    : engine(Engine::STENCIL), generation(0), current_state(width, height), next_state(width, height),
+      current_state_stale(false), tiles_x(0), tiles_y(0), alive_cells(0),
+      stats_enabled(false), stats(), cycle_detection(false), history_toroidal(false), last_toroidal(false),
+      history_next(0), cycle(), cycle_found(false), temporal_depth(1)
+{
+    update_ghost_borders();
+}
 
 /**
  * World::World(initial_state)
  *
  * Construct a world using the size and values of an existing grid.
+ * The cells are copied straight into the current state, which already has the layout the engine sweeps through,
+ * so the grid is copied exactly once. Pass the grid with std::move to give it to the world without any copy.
  *
  * @example
  *
@@ -93,7 +178,40 @@ World::World(int width, int height) : current_state(width, height), next_state(w
  * @param initial_state
  *      The state of the constructed world.
  */
-World::World(Grid &initial_state) : current_state(initial_state), next_state(initial_state) {}
+World::World(const Grid &initial_state) : World::World(initial_state.get_width(), initial_state.get_height())
+{
+    current_state.merge(initial_state, 0, 0);
+}
+
+/**
+ * World::World(initial_state)
+ *
+ * Construct a world which takes over the cells of a grid as its current state, leaving the grid empty.
+ * Only the next state is allocated. The cells are never copied if the grid already has the ghost border the
+ * engine sweeps through, such as a grid returned by World::take_state, and are otherwise copied once into a
+ * bordered allocation, no more than World::World(const Grid &) costs.
+ *
+ * @example
+ *
+ *      // Load a large pattern and give it to a world without keeping a second copy around
+ *      World world(Zoo::load_binary("big.gol"));
+ *
+ *      // Hand a grid over explicitly, after which it is empty
+ *      Grid grid = Zoo::load_rle("gun.rle");
+ *      World other(std::move(grid));
+ *
+ * @param initial_state
+ *      The state of the constructed world, moved from.
+ */
+World::World(Grid &&initial_state)
+    : engine(Engine::STENCIL), generation(0), current_state(std::move(initial_state)),
+      next_state(current_state.get_width(), current_state.get_height()),
+      current_state_stale(false), tiles_x(0), tiles_y(0), alive_cells(0),
+      stats_enabled(false), stats(), cycle_detection(false), history_toroidal(false), last_toroidal(false),
+      history_next(0), cycle(), cycle_found(false), temporal_depth(1)
+{
+    update_ghost_borders();
+}
 
 /**
  * World::get_width()
@@ -120,7 +238,16 @@ World::World(Grid &initial_state) : current_state(initial_state), next_state(ini
  */
 int World::get_width() const
 {
-    return current_state.get_width();
+    if (engine == Engine::TILED)
+    {
+        return tiled_current_state.get_width();
+    }
+    else if (engine == Engine::GPU)
+    {
+        return device_current_state.get_width();
+    }
+
+    return engine == Engine::PACKED ? packed_current_state.get_width() : current_state.get_width();
 }
 
 /**
@@ -148,7 +275,16 @@ int World::get_width() const
  */
 int World::get_height() const
 {
-    return current_state.get_height();
+    if (engine == Engine::TILED)
+    {
+        return tiled_current_state.get_height();
+    }
+    else if (engine == Engine::GPU)
+    {
+        return device_current_state.get_height();
+    }
+
+    return engine == Engine::PACKED ? packed_current_state.get_height() : current_state.get_height();
 }
 
 /**
@@ -176,7 +312,7 @@ int World::get_height() const
  */
 int World::get_total_cells() const
 {
-    return current_state.get_total_cells();
+    return get_width() * get_height();
 }
 
 /**
@@ -184,6 +320,8 @@ int World::get_total_cells() const
  *
  * Counts how many cells in the world are alive.
  * The function should be callable from a constant context.
+ * The count is cached by the current state grid after the first call following each step, or with
+ * Engine::SPARSE is kept up to date by every step. With Engine::GPU it is counted on the device.
  *
  * @example
  *
@@ -204,7 +342,20 @@ int World::get_total_cells() const
  */
 int World::get_alive_cells() const
 {
-    return current_state.get_alive_cells();
+    if (engine == Engine::SPARSE)
+    {
+        return alive_cells;
+    }
+    else if (engine == Engine::TILED)
+    {
+        return tiled_current_state.get_alive_cells();
+    }
+    else if (engine == Engine::GPU)
+    {
+        return device_current_state.get_alive_cells();
+    }
+
+    return engine == Engine::PACKED ? packed_current_state.get_alive_cells() : current_state.get_alive_cells();
 }
 
 /**
@@ -212,6 +363,7 @@ int World::get_alive_cells() const
  *
  * Counts how many cells in the world are dead.
  * The function should be callable from a constant context.
+ * Derived from the count of alive cells rather than scanning the world again.
  *
  * @example
  *
@@ -232,7 +384,7 @@ int World::get_alive_cells() const
  */
 int World::get_dead_cells() const
 {
-    return current_state.get_dead_cells();
+    return get_total_cells() - get_alive_cells();
 }
 
 /**
@@ -256,243 +408,1948 @@ int World::get_dead_cells() const
  *      // Print the current state of the world to the console without copy
  *      std::cout << read_only_world.get_state() << std::endl;
  *
+ * When using Engine::PACKED or Engine::TILED the current state is copied back into a Grid the first time it is
+ * requested after each step, so the call is no longer free but the returned reference remains valid.
+ * With Engine::GPU this is the copy back from the device, into the same Grid each time.
+ *
  * @return
  *      A reference to the current state.
  */
 const Grid &World::get_state() const
 {
+    if (current_state_stale)
+    {
+        if (engine == Engine::GPU)
+        {
+            device_current_state.download(current_state);
+        }
+        else
+        {
+            current_state = engine == Engine::TILED ? tiled_current_state.to_grid() : packed_current_state.to_grid();
+        }
+
+        current_state_stale = false;
+    }
+
     return current_state;
 }
 
 /**
- * World::resize(square_size)
+ * World::take_state()
  *
- * Resize the current state grid in to the new square width and height.
+ * Move the current state out of the world without copying it, leaving the world empty with a size of 0x0.
+ * The engine, rule, generation and settings are kept, so the world can be given a new state with World::resize.
  *
- * The content of the current state grid should be preserved within the kept region.
- * The values in the next state grid do not need to be preserved, allowing an easy optimization.
+ * With Engine::PACKED, Engine::TILED or Engine::GPU the state is copied back into a Grid first. The returned grid
+ * may keep the ghost border the engine swept through, which is invisible through the public api of Grid, and lets
+ * it be handed straight back to another world with World::World(Grid &&) without a copy.
  *
  * @example
  *
- *      // Make a grid
- *      World world(4, 4);
- *
- *      // Resize the world to be 8x8
- *      world.resize(8);
+ *      // Run a world and keep its final state once the world is no longer needed
+ *      World world(Zoo::load_rle("gun.rle"));
+ *      world.advance(1000);
+ *      Grid result = world.take_state();
  *
- * @param square_size
- *      The new edge size for both the width and height of the grid.
+ * @return
+ *      The current state.
  */
-void World::resize(int square_size)
+Grid World::take_state()
 {
-    resize(square_size, square_size);
+    get_state();
+    Grid state = std::move(current_state);
+
+    current_state = Grid();
+    next_state = Grid();
+    current_state_stale = false;
+
+    packed_current_state = PackedGrid();
+    packed_next_state = PackedGrid();
+    tiled_current_state = TiledGrid();
+    tiled_next_state = TiledGrid();
+    device_current_state = DeviceGrid();
+    device_next_state = DeviceGrid();
+
+    update_ghost_borders();
+
+    if (engine == Engine::SPARSE)
+    {
+        reset_tiles();
+    }
+
+    cycle = WorldCycle();
+    reset_cycle_history();
+
+    return state;
 }
 
 /**
- * World::resize(new_width, new_height)
- *
- * Resize the current state grid in to the new width and height.
- *
- * The content of the current state grid should be preserved within the kept region.
- * The values in the next state grid do not need to be preserved, allowing an easy optimization.
- *
- * @example
- *
- *      // Make a grid
- *      World world(4, 4);
- *
- *      // Resize the world to be 2x8
- *      world.resize(2, 8);
+ * World::get_generation()
  *
- * @param new_width
- *      The new width for the grid.
+ * Gets the number of steps the world has taken since it was constructed, or since the generation was last set.
  *
- * @param new_height
- *      The new height for the grid.
+ * @return
+ *      The current generation.
  */
-void World::resize(int new_width, int new_height)
+uint64_t World::get_generation() const
 {
-    current_state.resize(new_width, new_height);
-    next_state = std::move(Grid(new_width, new_height));
+    return generation;
 }
 
 /**
- * World::count_neighbours(x, y, toroidal)
+ * World::set_generation(new_generation)
  *
- * Private helper function to count the number of alive neighbours of a cell.
- * The function should not be visible from outside the World class.
- *
- * Neighbours are considered within the 3x3 square centred around the cell at x,y in the current state grid.
- * Ignore the centre coordinate, a cell is not its own neighbour.
- * Attempt to keep the logic as simple, expressive, and readable as possible.
+ * Sets the generation counter, such as when restoring a world from a checkpoint. The cells are not changed.
  *
- * If toroidal = false then skip any neighbours that would be outside of the grid,
- * this assumes the grid is Cell::DEAD outside its bounds.
+ * @param new_generation
+ *      The generation the current state belongs to.
+ */
+void World::set_generation(uint64_t new_generation)
+{
+    generation = new_generation;
+
+    // The recorded generations no longer line up with the new count
+    reset_cycle_history();
+}
+
+/**
+ * World::take_changed_tiles()
  *
- * If toroidal = true then correctly wrap out of bounds coordinates to the opposite side of the grid.
+ * Gets the tiles of TILE_SIZE by TILE_SIZE cells which may have changed since the last call, and starts
+ * tracking afresh. Tiles are numbered row by row, so tile (tile_x, tile_y) is tile_y * ceil(width / TILE_SIZE) + tile_x.
  *
- * This function is in World and not Grid because the 3x3 sized neighbourhood is specific to Conway's Game of Life,
- * while Grid is more generic to any 2D grid based cellular automaton.
+ * Engine::SPARSE already knows which tiles changed every step, so only those are reported, in O(1) time per tile.
+ * The other engines do not track changes, so every tile is reported.
  *
- * @param x
- *      The x coordinate of the centre of the neighbourhood.
+ * @example
  *
- * @param y
- *      The y coordinate of the centre of the neighbourhood.
+ *      // Only look at the parts of a large world which have changed
+ *      world.set_engine(Engine::SPARSE);
+ *      world.take_changed_tiles();
+ *      world.advance(10);
  *
- * @param toroidal
- *      If true then the step will consider the grid as a torus, where the left edge
- *      wraps to the right edge and the top to the bottom.
+ *      for (int tile : world.take_changed_tiles()) {
+ *          ...
+ *      }
  *
  * @return
- *      Returns the number of alive neighbours.
+ *      The numbers of the changed tiles, in no particular order.
  */
-int World::count_neighbours(int x, int y, bool toroidal) const
+std::vector<int> World::take_changed_tiles()
 {
-    int count = 0, new_x = 0, new_y = 0;
+    std::vector<int> tiles;
 
-    for (int i = y - 1; i <= y + 1; i++)
+    if (engine == Engine::SPARSE)
     {
-        for (int j = x - 1; j <= x + 1; j++)
-        {
-            if (toroidal)
-            {
-                // Wrap out-of-bounds values back into grid range
-                if (j < 0)
-                {
-                    // x underflow
-                    new_x = j + get_width();
-                }
-                else if (j >= get_width())
-                {
-                    // x overflow
-                    new_x = j - get_width();
-                }
-                else
-                {
-                    // x already in range
-                    new_x = j;
-                }
+        tiles.swap(dirty_tile_list);
 
-                if (i < 0)
-                {
-                    // y underflow
-                    new_y = i + get_height();
-                }
-                else if (i >= get_height())
-                {
-                    // y overflow
-                    new_y = i - get_height();
-                }
-                else
-                {
-                    // y already in range
-                    new_y = i;
-                }
+        for (const int tile : tiles)
+        {
+            dirty_tiles[tile] = 0;
+        }
+    }
+    else
+    {
+        const int tile_count = ((get_width() + TILE_SIZE - 1) / TILE_SIZE) *
+                               ((get_height() + TILE_SIZE - 1) / TILE_SIZE);
+        tiles.resize(tile_count);
 
-                // Check cell value, ignoring centre cell
-                if (!(j == x && i == y) &&
-                    current_state(new_x, new_y) == Cell::ALIVE)
-                {
-                    count++;
-                }
-            }
-            else
-            {
-                // Only check for neighbour cells in range, not centre cell
-                if (j >= 0 &&
-                    j < get_width() &&
-                    i >= 0 &&
-                    i < get_height() &&
-                    !(j == x && i == y))
-                {
-                    // Check cell value only when we know that x, y are in bounds
-                    if (current_state(j, i) == Cell::ALIVE)
-                    {
-                        count++;
-                    }
-                }
-            }
+        for (int tile = 0; tile < tile_count; tile++)
+        {
+            tiles[tile] = tile;
         }
     }
 
-    return count;
+    return tiles;
 }
 
 /**
- * World::step(toroidal)
+ * World::get_engine()
  *
- * Take one step in Conway's Game of Life.
+ * Gets the kernel currently used to compute update steps.
  *
- * Reads from the current state grid and writes to the next state grid. Then swaps the grids.
- * Should be implemented by invoking World::count_neighbours(x, y, toroidal).
- * Swapping the grids should be done in O(1) constant time, and should not invoke a copy.
- * Try and boil the logic down to the fewest and most simple conditional statements.
+ * @return
+ *      The current engine.
+ */
+Engine World::get_engine() const
+{
+    return engine;
+}
+
+/**
+ * World::set_engine(new_engine)
  *
- * Rules: https://en.wikipedia.org/wiki/Conway%27s_Game_of_Life
- *      - Any live cell with fewer than two live neighbours dies, as if by underpopulation.
- *      - Any live cell with two or three live neighbours lives on to the next generation.
- *      - Any live cell with more than three live neighbours dies, as if by overpopulation.
- *      - Any dead cell with exactly three live neighbours becomes a live cell, as if by reproduction.
+ * Change the kernel used to compute update steps, converting the current state to the storage it needs.
+ * Switching to Engine::PACKED, Engine::TILED or Engine::GPU releases both byte-per-cell buffers, and switching
+ * away restores them. Switching to and from Engine::GPU copies the state to and from the device.
+ * Switching to Engine::SPARSE marks every tile as active, so the first step recomputes the whole grid.
+ * The current state is preserved either way.
  *
- * @param toroidal
- *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
- *      wraps to the right edge and the top to the bottom. Defaults to false.
+ * @example
+ *
+ *      // Make a world and simulate it 64 cells at a time
+ *      Grid glider = Zoo::glider();
+ *      World world(glider);
+ *      world.set_engine(Engine::PACKED);
+ *      world.advance(100);
+ *
+ * @param new_engine
+ *      The engine to use for all following steps.
  */
-void World::step(bool toroidal)
+void World::set_engine(Engine new_engine)
 {
-    int num_neighbours = 0;
+    const bool compact = engine == Engine::PACKED || engine == Engine::TILED || engine == Engine::GPU;
 
-    // For all cells
-    for (int y = 0; y < get_height(); y++)
+    if (new_engine != engine)
     {
-        for (int x = 0; x < get_width(); x++)
+        if (compact)
         {
-            num_neighbours = count_neighbours(x, y, toroidal);
+            // Bring the grid up to date before the packed, tiled or device buffers are released
+            get_state();
+            next_state = Grid(get_width(), get_height());
 
-            if (num_neighbours < LOWER_POPULATION_LIMIT)
-            {
-                // Cell died of underpopulation
-                next_state(x, y) = Cell::DEAD;
-            }
-            else if (num_neighbours > UPPER_POPULATION_LIMIT)
-            {
-                // Cell died of overpopulation
-                next_state(x, y) = Cell::DEAD;
-            }
-            else if (num_neighbours == UPPER_POPULATION_LIMIT)
-            {
-                // Cell made alive through reproduction
-                next_state(x, y) = Cell::ALIVE;
-            }
-            else
-            {
-                next_state(x, y) = current_state(x, y);
-            }
+            packed_current_state = PackedGrid();
+            packed_next_state = PackedGrid();
+            tiled_current_state = TiledGrid();
+            tiled_next_state = TiledGrid();
+            device_current_state = DeviceGrid();
+            device_next_state = DeviceGrid();
+        }
+
+        if (new_engine == Engine::PACKED)
+        {
+            packed_current_state = PackedGrid(current_state);
+            packed_next_state = PackedGrid(current_state.get_width(), current_state.get_height());
+        }
+        else if (new_engine == Engine::TILED)
+        {
+            tiled_current_state = TiledGrid(current_state, TileOrder::MORTON);
+            tiled_next_state = TiledGrid(current_state.get_width(), current_state.get_height(), TileOrder::MORTON);
+        }
+        else if (new_engine == Engine::GPU)
+        {
+            device_current_state = DeviceGrid(current_state);
+            device_next_state = DeviceGrid(current_state.get_width(), current_state.get_height());
+        }
+
+        if (new_engine == Engine::PACKED || new_engine == Engine::TILED || new_engine == Engine::GPU)
+        {
+            // Only keep the packed, tiled or device buffers, the grid is copied back again on demand
+            current_state = Grid();
+            next_state = Grid();
+            current_state_stale = true;
+        }
+
+        engine = new_engine;
+        update_ghost_borders();
+
+        if (new_engine == Engine::SPARSE)
+        {
+            reset_tiles();
         }
+
+        // Each engine hashes the state in its own units
+        reset_cycle_history();
     }
+}
 
-    // Swap the grids
-    std::swap(current_state, next_state);
+/**
+ * World::get_rule()
+ *
+ * Gets the rule applied by each update step.
+ *
+ * @return
+ *      A reference to the current rule, B3/S23 unless changed.
+ */
+const Rule &World::get_rule() const
+{
+    return rule;
 }
 
 /**
- * World::advance(steps, toroidal)
+ * World::set_rule(new_rule)
  *
- * Advance multiple steps in the Game of Life.
- * Should be implemented by invoking World::step(toroidal).
+ * Change the rule applied by each update step. The current state is preserved.
+ * With Engine::SPARSE every tile is marked as active, since a still life under the old rule need not be one
+ * under the new rule.
  *
- * @param steps
- *      The number of steps to advance the world forward.
+ * @example
  *
- * @param toroidal
- *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
- *      wraps to the right edge and the top to the bottom. Defaults to false.
+ *      // Make a world and simulate it as HighLife
+ *      World world(glider);
+ *      world.set_rule(Rule::parse("B36/S23"));
+ *      world.advance(100);
+ *
+ * @param new_rule
+ *      The rule to apply in all following steps.
  */
-void World::advance(int steps, bool toroidal)
+void World::set_rule(const Rule &new_rule)
 {
-    for (int i = 0; i < steps; i++)
+    if (new_rule != rule)
     {
-        step(toroidal);
+        rule = new_rule;
+
+        std::fill(active_tiles.begin(), active_tiles.end(), 1);
+
+        cycle = WorldCycle();
+        reset_cycle_history();
+    }
+}
+
+/**
+ * World::get_threads()
+ *
+ * Gets the number of threads each step is split across.
+ *
+ * @return
+ *      The number of threads, 1 when stepping serially.
+ */
+int World::get_threads() const
+{
+    return pool ? pool->get_thread_count() : 1;
+}
+
+/**
+ * World::set_threads(thread_count)
+ *
+ * Start a persistent pool of threads to split each step across, or stop it by asking for a single thread.
+ * The threads live until the next call or until the world is destroyed, and are reused by every step.
+ * Copies of a world share its pool, so steps taken on copies from different threads run one at a time.
+ *
+ * @example
+ *
+ *      // Make a large world and simulate it using every core of the machine
+ *      World world(4096);
+ *      world.set_threads(std::thread::hardware_concurrency());
+ *      world.advance(1000);
+ *
+ * @param thread_count
+ *      The number of threads to use, including the calling thread. Values of 1 or less step serially.
+ */
+void World::set_threads(int thread_count)
+{
+    if (thread_count <= 1)
+    {
+        pool.reset();
+    }
+    else if (thread_count != get_threads())
+    {
+        pool = std::make_shared<ThreadPool>(thread_count);
+    }
+}
+
+/**
+ * World::get_stats_enabled()
+ *
+ * Gets whether stats are being collected on each step.
+ *
+ * @return
+ *      True if World::get_stats() is updated by each step.
+ */
+bool World::get_stats_enabled() const
+{
+    return stats_enabled;
+}
+
+/**
+ * World::set_stats_enabled(enabled)
+ *
+ * Start or stop collecting stats on each step. The stats collected so far are kept until World::reset_stats().
+ *
+ * Counting the births and deaths of a step compares the states before and after it, so expect each step to
+ * cost around one extra pass over the recomputed cells while enabled. When disabled each step only pays for a
+ * single branch.
+ *
+ * @example
+ *
+ *      // Find out how much of a large world the sparse engine is skipping
+ *      world.set_engine(Engine::SPARSE);
+ *      world.set_stats_enabled(true);
+ *      world.advance(100);
+ *
+ *      std::cout << world.get_stats().total_cells_skipped << std::endl;
+ *
+ * @param enabled
+ *      True to collect stats on every following step.
+ */
+void World::set_stats_enabled(bool enabled)
+{
+    stats_enabled = enabled;
+}
+
+/**
+ * World::get_stats()
+ *
+ * Gets the stats collected since they were last reset.
+ *
+ * @return
+ *      A reference to the stats, which is updated in place by each step.
+ */
+const WorldStats &World::get_stats() const
+{
+    return stats;
+}
+
+/**
+ * World::reset_stats()
+ *
+ * Zero every counter of the collected stats.
+ */
+void World::reset_stats()
+{
+    stats = WorldStats();
+}
+
+/**
+ * World::get_cycle_detection()
+ *
+ * Gets whether the world is looking for cycles on each step.
+ *
+ * @return
+ *      True if each step records the hash of the new state.
+ */
+bool World::get_cycle_detection() const
+{
+    return cycle_detection;
+}
+
+/**
+ * World::set_cycle_detection(enabled)
+ *
+ * Start or stop looking for cycles. Enabling detection hashes the whole current state once, after which each
+ * step only hashes what it wrote, costing around one extra read of the recomputed cells.
+ * The hashes are 64 bit, so two different states are taken as equal with a chance of around 2^-64.
+ *
+ * @example
+ *
+ *      // Run a soup for up to a million generations, stopping early once it settles
+ *      world.set_cycle_detection(true);
+ *      world.advance(1000000);
+ *
+ *      if (world.get_cycle().period > 0) {
+ *          std::cout << "Period " << world.get_cycle().period << std::endl;
+ *      }
+ *
+ * @param enabled
+ *      True to look for cycles in every following step.
+ */
+void World::set_cycle_detection(bool enabled)
+{
+    if (enabled != cycle_detection)
+    {
+        cycle_detection = enabled;
+        cycle = WorldCycle();
+        reset_cycle_history();
+    }
+}
+
+/**
+ * World::get_cycle()
+ *
+ * Gets the cycle found while stepping with cycle detection enabled.
+ * The cycle is forgotten when the world is resized or its rule changed.
+ *
+ * @return
+ *      A reference to the cycle, with a period of 0 if none has been found.
+ */
+const WorldCycle &World::get_cycle() const
+{
+    return cycle;
+}
+
+/**
+ * World::get_temporal_depth()
+ *
+ * Gets the number of generations World::advance computes in each pass over the grid.
+ *
+ * @return
+ *      The number of generations per pass, 1 when every generation is a pass of its own.
+ */
+int World::get_temporal_depth() const
+{
+    return temporal_depth;
+}
+
+/**
+ * World::set_temporal_depth(generations)
+ *
+ * Set the number of generations World::advance computes in each pass over the grid with Engine::STENCIL and
+ * Engine::SIMD. Each block of the grid is loaded into cache once and stepped through every generation of the
+ * pass before moving on, so a grid too big for the cache is read from and written to memory once per pass
+ * rather than once per generation. Each block recomputes a halo as wide as the depth around it, so the extra work
+ * grows with the depth, and depths of 4 to 16 usually run fastest.
+ *
+ * Passes are only taken while neither stats nor cycle detection are enabled, as both look at every generation.
+ * The other engines, and World::step, always compute one generation at a time.
+ *
+ * @example
+ *
+ *      // Advance a grid far bigger than the cache, reading it from memory once every 8 generations
+ *      World world(16384);
+ *      world.set_engine(Engine::SIMD);
+ *      world.set_temporal_depth(8);
+ *      world.advance(1000, true);
+ *
+ * @param generations
+ *      The number of generations per pass. Values of 1 or less compute one generation per pass.
+ */
+void World::set_temporal_depth(int generations)
+{
+    temporal_depth = std::max(generations, 1);
+}
+
+/**
+ * World::resize(square_size)
+ *
+ * Resize the current state grid in to the new square width and height.
+ *
+ * The content of the current state grid should be preserved within the kept region.
+ * The values in the next state grid do not need to be preserved, allowing an easy optimization.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      World world(4, 4);
+ *
+ *      // Resize the world to be 8x8
+ *      world.resize(8);
+ *
+ * @param square_size
+ *      The new edge size for both the width and height of the grid.
+ */
+void World::resize(int square_size)
+{
+    resize(square_size, square_size);
+}
+
+/**
+ * World::resize(new_width, new_height)
+ *
+ * Resize the current state grid in to the new width and height.
+ *
+ * The content of the current state grid should be preserved within the kept region.
+ * The values in the next state grid do not need to be preserved, allowing an easy optimization.
+ * Both grids are resized in place with Grid::resize, so shrinking or growing within their capacity never allocates.
+ *
+ * @example
+ *
+ *      // Make a grid
+ *      World world(4, 4);
+ *
+ *      // Resize the world to be 2x8
+ *      world.resize(2, 8);
+ *
+ * @param new_width
+ *      The new width for the grid.
+ *
+ * @param new_height
+ *      The new height for the grid.
+ */
+void World::resize(int new_width, int new_height)
+{
+    if (engine == Engine::PACKED)
+    {
+        packed_current_state.resize(new_width, new_height);
+        packed_next_state = PackedGrid(new_width, new_height);
+        current_state_stale = true;
+    }
+    else if (engine == Engine::TILED)
+    {
+        tiled_current_state.resize(new_width, new_height);
+        tiled_next_state = TiledGrid(new_width, new_height, TileOrder::MORTON);
+        current_state_stale = true;
+    }
+    else if (engine == Engine::GPU)
+    {
+        // Device memory cannot be resized in place, so the state makes a round trip through the current state grid
+        get_state();
+        current_state.resize(new_width, new_height);
+        device_current_state.upload(current_state);
+        device_next_state = DeviceGrid(new_width, new_height);
+    }
+    else
+    {
+        // Both buffers are resized in place, the next state is overwritten by the next step so its cells don't matter
+        current_state.resize(new_width, new_height);
+        next_state.resize(new_width, new_height);
+
+        if (engine == Engine::SPARSE)
+        {
+            reset_tiles();
+        }
+    }
+
+    cycle = WorldCycle();
+    reset_cycle_history();
+}
+
+/**
+ * World::count_neighbours(x, y, toroidal)
+ *
+ * Private helper function to count the number of alive neighbours of a cell.
+ * The function should not be visible from outside the World class.
+ *
+ * Neighbours are considered within the 3x3 square centred around the cell at x,y in the current state grid.
+ * Ignore the centre coordinate, a cell is not its own neighbour.
+ * Attempt to keep the logic as simple, expressive, and readable as possible.
+ *
+ * If toroidal = false then skip any neighbours that would be outside of the grid,
+ * this assumes the grid is Cell::DEAD outside its bounds.
+ *
+ * If toroidal = true then correctly wrap out of bounds coordinates to the opposite side of the grid.
+ *
+ * This function is in World and not Grid because the 3x3 sized neighbourhood is specific to Conway's Game of Life,
+ * while Grid is more generic to any 2D grid based cellular automaton.
+ *
+ * @param x
+ *      The x coordinate of the centre of the neighbourhood.
+ *
+ * @param y
+ *      The y coordinate of the centre of the neighbourhood.
+ *
+ * @param toroidal
+ *      If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom.
+ *
+ * @return
+ *      Returns the number of alive neighbours.
+ */
+int World::count_neighbours(int x, int y, bool toroidal) const
+{
+    int count = 0, new_x = 0, new_y = 0;
+
+    // Read through a const reference, the current state is mutable so it can be unpacked on demand
+    const Grid &current = current_state;
+
+    for (int i = y - 1; i <= y + 1; i++)
+    {
+        for (int j = x - 1; j <= x + 1; j++)
+        {
+            if (toroidal)
+            {
+                // Wrap out-of-bounds values back into grid range
+                if (j < 0)
+                {
+                    // x underflow
+                    new_x = j + get_width();
+                }
+                else if (j >= get_width())
+                {
+                    // x overflow
+                    new_x = j - get_width();
+                }
+                else
+                {
+                    // x already in range
+                    new_x = j;
+                }
+
+                if (i < 0)
+                {
+                    // y underflow
+                    new_y = i + get_height();
+                }
+                else if (i >= get_height())
+                {
+                    // y overflow
+                    new_y = i - get_height();
+                }
+                else
+                {
+                    // y already in range
+                    new_y = i;
+                }
+
+                // Check cell value, ignoring centre cell
+                if (!(j == x && i == y) &&
+                    current(new_x, new_y) == Cell::ALIVE)
+                {
+                    count++;
+                }
+            }
+            else
+            {
+                // Only check for neighbour cells in range, not centre cell
+                if (j >= 0 &&
+                    j < get_width() &&
+                    i >= 0 &&
+                    i < get_height() &&
+                    !(j == x && i == y))
+                {
+                    // Check cell value only when we know that x, y are in bounds
+                    if (current(j, i) == Cell::ALIVE)
+                    {
+                        count++;
+                    }
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+/**
+ * World::step(toroidal)
+ *
+ * Take one step in Conway's Game of Life.
+ *
+ * Reads from the current state grid and writes to the next state grid. Then swaps the grids.
+ * Dispatches to the kernel selected by World::set_engine(engine).
+ * Swapping the grids should be done in O(1) constant time, and should not invoke a copy.
+ * Try and boil the logic down to the fewest and most simple conditional statements.
+ *
+ * Rules: https://en.wikipedia.org/wiki/Conway%27s_Game_of_Life
+ *      - Any live cell with fewer than two live neighbours dies, as if by underpopulation.
+ *      - Any live cell with two or three live neighbours lives on to the next generation.
+ *      - Any live cell with more than three live neighbours dies, as if by overpopulation.
+ *      - Any dead cell with exactly three live neighbours becomes a live cell, as if by reproduction.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ */
+void World::step(bool toroidal)
+{
+    if (stats_enabled)
+    {
+        step_start = std::chrono::steady_clock::now();
+    }
+
+    match_history_topology(toroidal);
+
+    refresh_ghost_borders(toroidal);
+
+    // The device steps the whole grid at once, so it is never split into bands
+    if (pool && engine != Engine::GPU)
+    {
+        const int height = get_height();
+        const int bands = pool->get_thread_count();
+
+        // One band of rows per thread
+        pool->run([&](int band) {
+            step_rows(static_cast<long long>(height) * band / bands,
+                      static_cast<long long>(height) * (band + 1) / bands, toroidal);
+        });
+    }
+    else
+    {
+        step_rows(0, get_height(), toroidal);
+    }
+
+    swap_states();
+}
+
+/**
+ * World::step_rows(y0, y1, toroidal)
+ *
+ * Private helper function computing the next state of a band of rows with the selected engine.
+ * Only reads from the current state, and only writes the band's rows of the next state, so bands can
+ * safely be computed at the same time by different threads.
+ *
+ * @param y0
+ *      The first row of the band.
+ *
+ * @param y1
+ *      The row after the last row of the band.
+ *
+ * @param toroidal
+ *      If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom.
+ */
+void World::step_rows(int y0, int y1, bool toroidal)
+{
+    if (engine == Engine::PACKED)
+    {
+        step_packed(y0, y1, toroidal);
+    }
+    else if (engine == Engine::SPARSE)
+    {
+        step_sparse(y0, y1);
+    }
+    else if (engine == Engine::STENCIL || engine == Engine::SIMD)
+    {
+        step_stencil(y0, y1);
+    }
+    else if (engine == Engine::TILED)
+    {
+        step_tiled(y0, y1);
+    }
+    else if (engine == Engine::GPU)
+    {
+        step_device();
+    }
+    else
+    {
+        step_scalar(y0, y1, toroidal);
+    }
+
+    if (cycle_detection && engine != Engine::SPARSE)
+    {
+        hash_rows(y0, y1, true);
+    }
+}
+
+/**
+ * World::swap_states()
+ *
+ * Private helper function swapping the current and next state buffers of the selected engine in O(1) time.
+ *
+ * With Engine::SPARSE this also applies the change in population of each recomputed tile to the alive count,
+ * and activates every tile which changed along with its neighbours for the next step. Neighbours are always
+ * wrapped across the edges of the grid, which at worst recomputes a few unchanged tiles when not toroidal.
+ */
+void World::swap_states()
+{
+    generation++;
+
+    if (stats_enabled)
+    {
+        collect_stats();
+    }
+
+    if (engine == Engine::PACKED)
+    {
+        std::swap(packed_current_state, packed_next_state);
+        current_state_stale = true;
+    }
+    else if (engine == Engine::TILED)
+    {
+        std::swap(tiled_current_state, tiled_next_state);
+        current_state_stale = true;
+    }
+    else if (engine == Engine::GPU)
+    {
+        std::swap(device_current_state, device_next_state);
+
+        // The copy of the new state made for the stats or cycle detection keeps the current state grid in step
+        if (stats_enabled || cycle_detection)
+        {
+            std::swap(current_state, next_state);
+            current_state.set_cached_alive_cells(-1);
+        }
+        else
+        {
+            current_state_stale = true;
+        }
+    }
+    else
+    {
+        // The kernels write rows without keeping count, so the new state must be counted again if asked
+        std::swap(current_state, next_state);
+        current_state.set_cached_alive_cells(-1);
+    }
+
+    if (engine == Engine::SPARSE)
+    {
+        // Rebuilt every step, so drawn from the recycled blocks of this thread
+        std::pmr::vector<unsigned char> next_active_tiles(active_tiles.size(), 0, Memory::get_scratch_resource());
+
+        for (int tile_y = 0; tile_y < tiles_y; tile_y++)
+        {
+            for (int tile_x = 0; tile_x < tiles_x; tile_x++)
+            {
+                const int tile = tile_y * tiles_x + tile_x;
+
+                if (!active_tiles[tile])
+                {
+                    continue;
+                }
+
+                alive_cells += tile_deltas[tile];
+
+                if (changed_tiles[tile])
+                {
+                    if (!dirty_tiles[tile])
+                    {
+                        dirty_tiles[tile] = 1;
+                        dirty_tile_list.push_back(tile);
+                    }
+
+                    for (int j = tile_y - 1; j <= tile_y + 1; j++)
+                    {
+                        for (int i = tile_x - 1; i <= tile_x + 1; i++)
+                        {
+                            next_active_tiles[((j + tiles_y) % tiles_y) * tiles_x + (i + tiles_x) % tiles_x] = 1;
+                        }
+                    }
+                }
+            }
+        }
+
+        active_tiles.assign(next_active_tiles.begin(), next_active_tiles.end());
+        current_state.set_cached_alive_cells(alive_cells);
+    }
+
+    if (cycle_detection)
+    {
+        record_state();
+    }
+}
+
+/**
+ * World::collect_stats()
+ *
+ * Private helper function recording the stats of the step just computed, called with the new state still in the
+ * next state buffers. Births and deaths are counted by comparing the two buffers, 64 cells at a time with
+ * Engine::PACKED, tile by tile with Engine::TILED, and only over the recomputed tiles with Engine::SPARSE since
+ * the rest are unchanged.
+ */
+void World::collect_stats()
+{
+    const auto now = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> elapsed = now - step_start;
+    step_start = now;
+
+    const int width = get_width();
+    const int height = get_height();
+    const uint64_t total_cells = static_cast<uint64_t>(width) * height;
+
+    uint64_t births = 0;
+    uint64_t deaths = 0;
+    uint64_t evaluated = total_cells;
+
+    const int tiles_total = ((width + TILE_SIZE - 1) / TILE_SIZE) * ((height + TILE_SIZE - 1) / TILE_SIZE);
+    int tiles_active = tiles_total;
+
+    if (engine == Engine::PACKED)
+    {
+        const int words = packed_current_state.get_words_per_row();
+
+        for (int y = 0; y < height; y++)
+        {
+            const uint64_t *before = packed_current_state.row(y);
+            const uint64_t *after = packed_next_state.row(y);
+
+            for (int i = 0; i < words; i++)
+            {
+                births += __builtin_popcountll(after[i] & ~before[i]);
+                deaths += __builtin_popcountll(before[i] & ~after[i]);
+            }
+        }
+    }
+    else if (engine == Engine::TILED)
+    {
+        for (int tile_y = 0; tile_y < tiled_current_state.get_tiles_y(); tile_y++)
+        {
+            for (int tile_x = 0; tile_x < tiled_current_state.get_tiles_x(); tile_x++)
+            {
+                const int tile_width = tiled_current_state.get_tile_width(tile_x);
+
+                for (int y = 0; y < tiled_current_state.get_tile_height(tile_y); y++)
+                {
+                    const Cell *before = tiled_current_state.tile_row(tile_x, tile_y, y);
+                    const Cell *after = tiled_next_state.tile_row(tile_x, tile_y, y);
+
+                    for (int x = 0; x < tile_width; x++)
+                    {
+                        const bool was_alive = before[x] == Cell::ALIVE;
+                        const bool is_alive = after[x] == Cell::ALIVE;
+
+                        births += is_alive & !was_alive;
+                        deaths += was_alive & !is_alive;
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        const Grid &current = current_state;
+        evaluated = 0;
+        tiles_active = 0;
+
+        for (int tile_y = 0; tile_y * TILE_SIZE < height; tile_y++)
+        {
+            for (int tile_x = 0; tile_x * TILE_SIZE < width; tile_x++)
+            {
+                if (engine == Engine::SPARSE && !active_tiles[tile_y * tiles_x + tile_x])
+                {
+                    continue;
+                }
+
+                const int x0 = tile_x * TILE_SIZE;
+                const int x1 = std::min(x0 + TILE_SIZE, width);
+                const int y1 = std::min((tile_y + 1) * TILE_SIZE, height);
+
+                for (int y = tile_y * TILE_SIZE; y < y1; y++)
+                {
+                    const Cell *before = current.row(y);
+                    const Cell *after = next_state.raw_row(y);
+
+                    for (int x = x0; x < x1; x++)
+                    {
+                        const bool was_alive = before[x] == Cell::ALIVE;
+                        const bool is_alive = after[x] == Cell::ALIVE;
+
+                        births += is_alive & !was_alive;
+                        deaths += was_alive & !is_alive;
+                    }
+                }
+
+                evaluated += static_cast<uint64_t>(x1 - x0) * (y1 - tile_y * TILE_SIZE);
+                tiles_active++;
+            }
+        }
+    }
+
+    stats.steps++;
+    stats.last_seconds = elapsed.count();
+    stats.total_seconds += elapsed.count();
+    stats.cells_evaluated = evaluated;
+    stats.cells_skipped = total_cells - evaluated;
+    stats.total_cells_evaluated += evaluated;
+    stats.total_cells_skipped += total_cells - evaluated;
+    stats.births = births;
+    stats.deaths = deaths;
+    stats.total_births += births;
+    stats.total_deaths += deaths;
+    stats.tiles_active = tiles_active;
+    stats.tiles_total = tiles_total;
+
+    // Buffers which are not in use by the engine are left empty, so only count what is actually held
+    stats.bytes_allocated = current_state.get_allocated_bytes() + next_state.get_allocated_bytes()
+                          + (static_cast<uint64_t>(packed_current_state.get_words_per_row())
+                             * packed_current_state.get_height() * 2) * sizeof(uint64_t)
+                          + static_cast<uint64_t>(tiled_current_state.get_tiles_x()) * tiled_current_state.get_tiles_y()
+                            * TiledGrid::TILE_CELLS * 2 * sizeof(Cell)
+                          + device_current_state.get_allocated_bytes() + device_next_state.get_allocated_bytes()
+                          + active_tiles.size() + changed_tiles.size() + dirty_tiles.size()
+                          + (tile_populations.size() + tile_deltas.size() + dirty_tile_list.size()) * sizeof(int);
+}
+
+/**
+ * World::step_scalar(y0, y1, toroidal)
+ *
+ * Private helper function computing a band of rows with Engine::SCALAR.
+ * Implemented by invoking World::count_neighbours(x, y, toroidal) for every cell.
+ *
+ * @param y0
+ *      The first row of the band.
+ *
+ * @param y1
+ *      The row after the last row of the band.
+ *
+ * @param toroidal
+ *      If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom.
+ */
+void World::step_scalar(int y0, int y1, bool toroidal)
+{
+    const Grid &current = current_state;
+
+    // For all cells in the band
+    for (int y = y0; y < y1; y++)
+    {
+        Cell *destination = next_state.raw_row(y);
+
+        for (int x = 0; x < get_width(); x++)
+        {
+            destination[x] = rule.next(count_neighbours(x, y, toroidal), current(x, y));
+        }
+    }
+}
+
+/**
+ * World::step_stencil(y0, y1)
+ *
+ * Private helper function computing a band of rows with Engine::STENCIL or Engine::SIMD.
+ *
+ * The state grids carry a ghost border, refreshed before each step with the opposite edges when toroidal or dead
+ * cells otherwise, so every cell has all 8 of its neighbours in memory. Each row is summed straight from the
+ * current state rows above, in line with, and below it by a row kernel, with no bounds checks, wrapping, or
+ * branches, and the same loop serves both topologies. Engine::STENCIL uses the auto-vectorized scalar kernel,
+ * and Engine::SIMD the hand-vectorized kernel for the best instruction set of the CPU.
+ *
+ * @param y0
+ *      The first row of the band.
+ *
+ * @param y1
+ *      The row after the last row of the band.
+ */
+void World::step_stencil(int y0, int y1)
+{
+    const int width = get_width();
+
+    const Simd::RowKernel sweep = engine == Engine::SIMD ? Simd::get_row_kernel() : Simd::sweep_interior_row;
+
+    const Grid &current = current_state;
+
+    for (int y = y0; y < y1; y++)
+    {
+        sweep(current.row(y - 1), current.row(y), current.row(y + 1), next_state.raw_row(y), 0, width, rule);
+    }
+}
+
+/**
+ * World::step_device()
+ *
+ * Private helper function computing the whole grid with Engine::GPU, by running the stencil kernel on the device
+ * from the current to the next device buffer, whose ghost border was refreshed on the device beforehand.
+ *
+ * Stats and cycle detection compare and hash the states on the host, so while either is enabled the new state
+ * is also copied back into the next state grid, alongside an up to date current state grid. This costs a copy of
+ * the grid every step, which otherwise is only made when the state is asked for.
+ */
+void World::step_device()
+{
+    DeviceGrid::step(device_current_state, device_next_state, rule);
+
+    if (stats_enabled || cycle_detection)
+    {
+        get_state();
+        device_next_state.download(next_state);
+    }
+}
+
+/**
+ * World::step_tiled(y0, y1)
+ *
+ * Private helper function computing a band of rows with Engine::TILED.
+ *
+ * The state is split into tiles of TILE_SIZE by TILE_SIZE cells, each stored contiguously with an apron holding
+ * copies of its neighbouring cells, refreshed before each step. The band is swept one tile at a time by the
+ * block kernel for the best instruction set of the CPU, reading the three rows around each cell from within the
+ * tile, so on grids many thousands of cells wide the rows above and below are still in the L1 cache when they
+ * are read. A band may start or end part way through a row of tiles.
+ *
+ * @param y0
+ *      The first row of the band.
+ *
+ * @param y1
+ *      The row after the last row of the band.
+ */
+void World::step_tiled(int y0, int y1)
+{
+    const Simd::BlockKernel sweep = Simd::get_block_kernel();
+
+    const TiledGrid &current = tiled_current_state;
+
+    for (int tile_y = y0 / TiledGrid::TILE_SIZE; tile_y * TiledGrid::TILE_SIZE < y1; tile_y++)
+    {
+        const int row_start = std::max(y0 - tile_y * TiledGrid::TILE_SIZE, 0);
+        const int row_end = std::min(y1 - tile_y * TiledGrid::TILE_SIZE, current.get_tile_height(tile_y));
+
+        for (int tile_x = 0; tile_x < current.get_tiles_x(); tile_x++)
+        {
+            sweep(current.tile_row(tile_x, tile_y, row_start), tiled_next_state.tile_row(tile_x, tile_y, row_start),
+                  TiledGrid::TILE_PITCH, current.get_tile_width(tile_x), row_end - row_start, rule);
+        }
+    }
+}
+
+/**
+ * World::update_ghost_borders()
+ *
+ * Private helper function giving both state grids a ghost border when the selected engine sweeps through one,
+ * and taking it away otherwise so the other engines keep a plain layout.
+ */
+void World::update_ghost_borders()
+{
+    const bool enabled = engine == Engine::STENCIL || engine == Engine::SIMD || engine == Engine::SPARSE;
+
+    current_state.set_ghost_border(enabled);
+    next_state.set_ghost_border(enabled);
+}
+
+/**
+ * World::refresh_ghost_borders(toroidal)
+ *
+ * Private helper function filling the ghost border of the current state, or the aprons of its tiles with
+ * Engine::TILED, or the ghost border on the device with Engine::GPU, before a step reads through them. The buffers
+ * of the other engines are empty or have no border, so refreshing them does nothing.
+ *
+ * @param toroidal
+ *      If true then the edges are wrapped to the opposite side of the grid, otherwise they are dead.
+ */
+void World::refresh_ghost_borders(bool toroidal)
+{
+    current_state.refresh_ghost_border(toroidal);
+    tiled_current_state.refresh_aprons(toroidal);
+    device_current_state.refresh_ghost_border(toroidal);
+}
+
+/**
+ * World::reset_tiles()
+ *
+ * Private helper function splitting the current state into tiles for Engine::SPARSE.
+ * Every tile is marked as active and changed, since nothing is known about the last step, and the population of
+ * each tile and of the whole world is counted from scratch.
+ */
+void World::reset_tiles()
+{
+    const int width = get_width();
+    const int height = get_height();
+
+    tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    active_tiles.assign(tiles_x * tiles_y, 1);
+    changed_tiles.assign(tiles_x * tiles_y, 0);
+    tile_populations.assign(tiles_x * tiles_y, 0);
+    tile_deltas.assign(tiles_x * tiles_y, 0);
+    alive_cells = 0;
+
+    // Nothing is known about what changed before, so every tile has to be reported
+    dirty_tiles.assign(tiles_x * tiles_y, 1);
+    dirty_tile_list.resize(tiles_x * tiles_y);
+
+    for (int tile = 0; tile < tiles_x * tiles_y; tile++)
+    {
+        dirty_tile_list[tile] = tile;
+    }
+
+    const Grid &current = current_state;
+
+    for (int y = 0; y < height; y++)
+    {
+        const Cell *cells = current.row(y);
+
+        for (int x = 0; x < width; x++)
+        {
+            if (cells[x] == Cell::ALIVE)
+            {
+                tile_populations[(y / TILE_SIZE) * tiles_x + x / TILE_SIZE]++;
+                alive_cells++;
+            }
+        }
+    }
+
+    current_state.set_cached_alive_cells(alive_cells);
+}
+
+/**
+ * World::step_sparse(y0, y1)
+ *
+ * Private helper function computing a band of rows with Engine::SPARSE.
+ * The band is rounded to whole rows of tiles, taking the rows of tiles which start within [y0, y1),
+ * so each tile is only ever computed and tallied by a single thread.
+ *
+ * @param y0
+ *      The first row of the band.
+ *
+ * @param y1
+ *      The row after the last row of the band.
+ */
+void World::step_sparse(int y0, int y1)
+{
+    const int first_tile_y = (y0 + TILE_SIZE - 1) / TILE_SIZE;
+    const int last_tile_y = (y1 + TILE_SIZE - 1) / TILE_SIZE;
+
+    for (int tile_y = first_tile_y; tile_y < last_tile_y; tile_y++)
+    {
+        for (int tile_x = 0; tile_x < tiles_x; tile_x++)
+        {
+            if (active_tiles[tile_y * tiles_x + tile_x])
+            {
+                step_tile(tile_x, tile_y);
+            }
+        }
+    }
+}
+
+/**
+ * World::step_tile(tile_x, tile_y)
+ *
+ * Private helper function computing the next state of a single tile for Engine::SPARSE.
+ * Every row of the tile is swept by Simd::sweep_interior_row as in Engine::STENCIL, reading the ghost border for
+ * the cells on the outer edge of the grid. The new population of the tile is tallied along the way, recording
+ * whether any cell changed.
+ *
+ * @param tile_x
+ *      The column of the tile.
+ *
+ * @param tile_y
+ *      The row of the tile.
+ */
+void World::step_tile(int tile_x, int tile_y)
+{
+    const int width = get_width();
+    const int height = get_height();
+    const int tile = tile_y * tiles_x + tile_x;
+
+    const int x0 = tile_x * TILE_SIZE;
+    const int x1 = std::min(x0 + TILE_SIZE, width);
+    const int y0 = tile_y * TILE_SIZE;
+    const int y1 = std::min(y0 + TILE_SIZE, height);
+
+    int population = 0;
+    bool changed = false;
+
+    const Grid &current = current_state;
+
+    for (int y = y0; y < y1; y++)
+    {
+        const Cell *middle = current.row(y);
+        Cell *destination = next_state.raw_row(y);
+
+        Simd::sweep_interior_row(current.row(y - 1), middle, current.row(y + 1), destination, x0, x1, rule);
+
+        changed |= std::memcmp(destination + x0, middle + x0, x1 - x0) != 0;
+
+        for (int x = x0; x < x1; x++)
+        {
+            population += destination[x] == Cell::ALIVE;
+        }
+    }
+
+    // An unchanged tile keeps its hash
+    if (cycle_detection && changed)
+    {
+        unit_hashes[tile] = hash_tile(tile_x, tile_y, next_state);
+    }
+
+    changed_tiles[tile] = changed;
+    tile_deltas[tile] = population - tile_populations[tile];
+    tile_populations[tile] = population;
+}
+
+/**
+ * World::step_blocked(depth, toroidal)
+ *
+ * Private helper function computing depth generations in a single pass over the grid, for World::advance with
+ * Engine::STENCIL or Engine::SIMD.
+ *
+ * The grid is split into blocks of BLOCK_SIZE by BLOCK_SIZE cells, each of which is stepped through every
+ * generation of the pass by World::step_block before moving on to the next, so each cell is read from the current
+ * state and written to the next state once per pass. Blocks only read the current state and only write their own
+ * cells of the next state, so they are shared out between the threads of the pool, and the grids are swapped once
+ * at the end.
+ *
+ * @param depth
+ *      The number of generations to compute.
+ *
+ * @param toroidal
+ *      If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom.
+ */
+void World::step_blocked(int depth, bool toroidal)
+{
+    const int width = get_width();
+    const int height = get_height();
+    const int blocks_x = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const int blocks = blocks_x * ((height + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+    auto step_blocks = [&](int first, int last) {
+        for (int block = first; block < last; block++)
+        {
+            const int x0 = block % blocks_x * BLOCK_SIZE;
+            const int y0 = block / blocks_x * BLOCK_SIZE;
+
+            step_block(x0, y0, std::min(x0 + BLOCK_SIZE, width), std::min(y0 + BLOCK_SIZE, height), depth,
+                       toroidal);
+        }
+    };
+
+    if (pool)
+    {
+        const int bands = pool->get_thread_count();
+
+        // An even share of the blocks per thread
+        pool->run([&](int band) {
+            step_blocks(static_cast<long long>(blocks) * band / bands,
+                        static_cast<long long>(blocks) * (band + 1) / bands);
+        });
+    }
+    else
+    {
+        step_blocks(0, blocks);
+    }
+
+    // Only the last generation of the pass is ever held in the grids, the rest are counted here
+    generation += depth - 1;
+    swap_states();
+}
+
+/**
+ * World::step_block(x0, y0, x1, y1, depth, toroidal)
+ *
+ * Private helper function computing depth generations of a block of cells for World::step_blocked.
+ *
+ * The block is copied into a window of scratch memory along with a halo depth cells wide around it, wrapped
+ * across the edges when toroidal and left dead past the edges otherwise. The window is then stepped back and forth
+ * between two buffers by the block kernel, each generation one cell further in from the edges of the window than
+ * the last, since the outermost cells lack the neighbours to be computed. After depth generations only the block
+ * itself is left, and is written to the next state. Cells of the window past the edges of the grid are never
+ * computed when not toroidal, so stay dead in every generation, exactly as World::step treats them.
+ *
+ * @param x0
+ *      The first column of the block.
+ *
+ * @param y0
+ *      The first row of the block.
+ *
+ * @param x1
+ *      The column after the last column of the block.
+ *
+ * @param y1
+ *      The row after the last row of the block.
+ *
+ * @param depth
+ *      The number of generations to compute.
+ *
+ * @param toroidal
+ *      If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom.
+ */
+void World::step_block(int x0, int y0, int x1, int y1, int depth, bool toroidal)
+{
+    const int width = get_width();
+    const int height = get_height();
+    const int window_width = x1 - x0 + 2 * depth;
+    const int window_height = y1 - y0 + 2 * depth;
+    const size_t window_cells = static_cast<size_t>(window_width) * window_height;
+
+    // Allocated for every block, so drawn from the recycled blocks of this thread
+    std::pmr::vector<Cell> buffers(2 * window_cells, Cell::DEAD, Memory::get_scratch_resource());
+    Cell *source = buffers.data();
+    Cell *destination = buffers.data() + window_cells;
+
+    const Grid &current = current_state;
+
+    for (int y = 0; y < window_height; y++)
+    {
+        int grid_y = y0 - depth + y;
+
+        if (toroidal)
+        {
+            grid_y = (grid_y % height + height) % height;
+        }
+        else if (grid_y < 0 || grid_y >= height)
+        {
+            continue;
+        }
+
+        const Cell *row = current.row(grid_y);
+        Cell *window_row = source + static_cast<ptrdiff_t>(y) * window_width;
+
+        if (toroidal)
+        {
+            // A halo deeper than the grid wraps around it more than once
+            for (int x = 0; x < window_width;)
+            {
+                const int grid_x = ((x0 - depth + x) % width + width) % width;
+                const int run = std::min(window_width - x, width - grid_x);
+
+                std::memcpy(window_row + x, row + grid_x, run);
+                x += run;
+            }
+        }
+        else
+        {
+            const int first = std::max(x0 - depth, 0);
+            const int last = std::min(x1 + depth, width);
+
+            std::memcpy(window_row + first - (x0 - depth), row + first, last - first);
+        }
+    }
+
+    // The cells of the window which lie within the grid
+    const int inside_x0 = toroidal ? 0 : std::max(depth - x0, 0);
+    const int inside_x1 = toroidal ? window_width : std::min(depth - x0 + width, window_width);
+    const int inside_y0 = toroidal ? 0 : std::max(depth - y0, 0);
+    const int inside_y1 = toroidal ? window_height : std::min(depth - y0 + height, window_height);
+
+    const Simd::BlockKernel sweep = engine == Engine::SIMD ? Simd::get_block_kernel() : Simd::sweep_interior_block;
+
+    for (int i = 1; i <= depth; i++)
+    {
+        const int sweep_x0 = std::max(i, inside_x0);
+        const int sweep_x1 = std::min(window_width - i, inside_x1);
+        const int sweep_y0 = std::max(i, inside_y0);
+        const int sweep_y1 = std::min(window_height - i, inside_y1);
+        const ptrdiff_t offset = static_cast<ptrdiff_t>(sweep_y0) * window_width + sweep_x0;
+
+        sweep(source + offset, destination + offset, window_width, sweep_x1 - sweep_x0, sweep_y1 - sweep_y0, rule);
+        std::swap(source, destination);
+    }
+
+    for (int y = y0; y < y1; y++)
+    {
+        std::memcpy(next_state.raw_row(y) + x0, source + static_cast<ptrdiff_t>(y - y0 + depth) * window_width + depth,
+                    x1 - x0);
+    }
+}
+
+/**
+ * shift_row_word(cells, index, words, width, toroidal, west, east)
+ *
+ * Helper function to line up the horizontal neighbours of the 64 cells in one word of a packed row.
+ * Bit i of west holds the cell to the left of cell i, and bit i of east holds the cell to the right,
+ * carrying cells across word boundaries and wrapping across the row ends when toroidal.
+ *
+ * @param cells
+ *      The packed row.
+ *
+ * @param index
+ *      The index of the word within the row.
+ *
+ * @param words
+ *      The number of words in the row.
+ *
+ * @param width
+ *      The number of cells in the row.
+ *
+ * @param toroidal
+ *      If true then the left edge of the row wraps to the right edge.
+ *
+ * @param west
+ *      Output word of left hand neighbours.
+ *
+ * @param east
+ *      Output word of right hand neighbours.
+ */
+static inline void shift_row_word(const uint64_t *cells, int index, int words, int width, bool toroidal,
+                                  uint64_t &west, uint64_t &east)
+{
+    const uint64_t centre = cells[index];
+    const int last_bit = (width - 1) % 64;
+
+    uint64_t west_carry = 0, east_carry = 0;
+
+    if (index > 0)
+    {
+        west_carry = cells[index - 1] >> 63;
+    }
+    else if (toroidal)
+    {
+        west_carry = (cells[words - 1] >> last_bit) & 1ULL;
+    }
+
+    if (index + 1 < words)
+    {
+        east_carry = cells[index + 1] << 63;
+    }
+    else if (toroidal)
+    {
+        east_carry = (cells[0] & 1ULL) << last_bit;
+    }
+
+    west = (centre << 1) | west_carry;
+    east = (centre >> 1) | east_carry;
+}
+
+/**
+ * World::step_packed(y0, y1, toroidal)
+ *
+ * Private helper function computing a band of rows with Engine::PACKED.
+ * Each word of the next state is computed from the three words above, in line with, and below it,
+ * shifted to align the left and right neighbours of all 64 cells, by life_word for Conway's Game of Life
+ * and by rule_word for any other rule.
+ * Rows outside the grid are read as dead unless toroidal, in which case the opposite edge is used.
+ *
+ * @param y0
+ *      The first row of the band.
+ *
+ * @param y1
+ *      The row after the last row of the band.
+ *
+ * @param toroidal
+ *      If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom.
+ */
+void World::step_packed(int y0, int y1, bool toroidal)
+{
+    const int width = packed_current_state.get_width();
+    const int height = packed_current_state.get_height();
+    const int words = packed_current_state.get_words_per_row();
+    const uint64_t padding_mask = packed_current_state.get_padding_mask();
+
+    // Conway's Game of Life keeps the shorter adder tree which only tells counts of 2 and 3 apart
+    const bool conway = rule.is<Conway>();
+    const uint16_t birth = rule.get_birth();
+    const uint16_t survival = rule.get_survival();
+
+    // Stands in for the rows beyond the top and bottom edges when not toroidal
+    const std::pmr::vector<uint64_t> empty_row(words, 0, Memory::get_scratch_resource());
+
+    for (int y = y0; y < y1 && words > 0; y++)
+    {
+        const uint64_t *above = packed_current_state.row(y > 0 ? y - 1 : height - 1);
+        const uint64_t *middle = packed_current_state.row(y);
+        const uint64_t *below = packed_current_state.row(y < height - 1 ? y + 1 : 0);
+        uint64_t *destination = packed_next_state.row(y);
+
+        if (!toroidal)
+        {
+            above = y > 0 ? above : empty_row.data();
+            below = y < height - 1 ? below : empty_row.data();
+        }
+
+        for (int i = 0; i < words; i++)
+        {
+            uint64_t north_west, north_east, west, east, south_west, south_east;
+
+            shift_row_word(above, i, words, width, toroidal, north_west, north_east);
+            shift_row_word(middle, i, words, width, toroidal, west, east);
+            shift_row_word(below, i, words, width, toroidal, south_west, south_east);
+
+            destination[i] = conway ? life_word(north_west, above[i], north_east,
+                                                west, middle[i], east,
+                                                south_west, below[i], south_east)
+                                    : rule_word(north_west, above[i], north_east,
+                                                west, middle[i], east,
+                                                south_west, below[i], south_east, birth, survival);
+        }
+
+        // Keep the padding bits 0
+        destination[words - 1] &= padding_mask;
+    }
+}
+
+/**
+ * hash_bytes(data, bytes, hash)
+ *
+ * Helper function folding a run of bytes into a running hash, 8 bytes at a time.
+ *
+ * @return
+ *      The running hash after the bytes.
+ */
+static inline uint64_t hash_bytes(const void *data, size_t bytes, uint64_t hash)
+{
+    const unsigned char *input = static_cast<const unsigned char *>(data);
+    size_t i = 0;
+
+    for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, input + i, sizeof(word));
+
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+        hash ^= hash >> 32;
+    }
+
+    for (; i < bytes; i++)
+    {
+        hash = (hash ^ input[i]) * 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * mix_hash(hash)
+ *
+ * Helper function scrambling every bit of a hash into every other, so the XOR of the hashes of different rows
+ * or tiles does not cancel out.
+ *
+ * @return
+ *      The mixed hash.
+ */
+static inline uint64_t mix_hash(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+/**
+ * World::hash_rows(y0, y1, next)
+ *
+ * Private helper function hashing rows [y0, y1) of the current or next state into the unit hashes, for every
+ * engine but Engine::SPARSE. Each row is seeded with its number, so moving a row changes the hash.
+ *
+ * @param next
+ *      True to hash the next state, just written by a step, false to hash the current state.
+ */
+void World::hash_rows(int y0, int y1, bool next)
+{
+    const int width = get_width();
+
+    for (int y = y0; y < y1; y++)
+    {
+        const uint64_t seed = mix_hash(static_cast<uint64_t>(y) + 0x632BE59BD9B4E019ULL);
+
+        if (engine == Engine::TILED)
+        {
+            const TiledGrid &state = next ? tiled_next_state : tiled_current_state;
+            uint64_t hash = seed;
+
+            // Chained across the tiles, so the hash is the same as if the row were contiguous
+            for (int tile_x = 0; tile_x < state.get_tiles_x(); tile_x++)
+            {
+                hash = hash_bytes(state.tile_row(tile_x, y / TiledGrid::TILE_SIZE, y % TiledGrid::TILE_SIZE),
+                                  state.get_tile_width(tile_x), hash);
+            }
+
+            unit_hashes[y] = mix_hash(hash);
+        }
+        else if (engine == Engine::PACKED)
+        {
+            const PackedGrid &state = next ? packed_next_state : packed_current_state;
+            const size_t bytes = state.get_words_per_row() * sizeof(uint64_t);
+
+            unit_hashes[y] = mix_hash(hash_bytes(state.row(y), bytes, seed));
+        }
+        else
+        {
+            // Brings the current state back from the device first with Engine::GPU
+            const Grid &state = next ? next_state : get_state();
+
+            unit_hashes[y] = mix_hash(hash_bytes(state.row(y), width, seed));
+        }
+    }
+}
+
+/**
+ * World::hash_tile(tile_x, tile_y, state)
+ *
+ * Private helper function hashing one tile of a state for Engine::SPARSE, seeded with the number of the tile.
+ *
+ * @return
+ *      The hash of the tile.
+ */
+uint64_t World::hash_tile(int tile_x, int tile_y, const Grid &state) const
+{
+    const int x0 = tile_x * TILE_SIZE;
+    const int x1 = std::min(x0 + TILE_SIZE, get_width());
+    const int y0 = tile_y * TILE_SIZE;
+    const int y1 = std::min(y0 + TILE_SIZE, get_height());
+
+    uint64_t hash = mix_hash(static_cast<uint64_t>(tile_y * tiles_x + tile_x) + 0x632BE59BD9B4E019ULL);
+
+    for (int y = y0; y < y1; y++)
+    {
+        hash = hash_bytes(state.row(y) + x0, x1 - x0, hash);
+    }
+
+    return mix_hash(hash);
+}
+
+/**
+ * World::record_state()
+ *
+ * Private helper function adding the hash of the new current state to the history, called once per step after
+ * the buffers are swapped. If the hash matches an earlier state the world is in a cycle, whose period is the
+ * distance back to the latest match.
+ */
+void World::record_state()
+{
+    uint64_t hash = 0;
+
+    for (const uint64_t unit_hash : unit_hashes)
+    {
+        hash ^= unit_hash;
+    }
+
+    // Search from the newest state back, so the shortest period is found
+    for (int i = 1; i <= CYCLE_HISTORY; i++)
+    {
+        const int entry = (history_next - i + CYCLE_HISTORY) % CYCLE_HISTORY;
+
+        if (history_generations[entry] == UINT64_MAX)
+        {
+            break;
+        }
+        else if (history_hashes[entry] == hash)
+        {
+            // Stepping on from a known cycle after skipping through it finds it again, keep the first sighting
+            if (cycle.period == 0)
+            {
+                cycle.period = generation - history_generations[entry];
+                cycle.generation = history_generations[entry];
+                cycle.detected = generation;
+            }
+
+            cycle_found = true;
+            break;
+        }
+    }
+
+    history_hashes[history_next] = hash;
+    history_generations[history_next] = generation;
+    history_next = (history_next + 1) % CYCLE_HISTORY;
+}
+
+/**
+ * World::reset_cycle_history()
+ *
+ * Private helper function forgetting every recorded state, then hashing the whole current state afresh as the
+ * first entry of the history. Frees the hashes when cycle detection is disabled.
+ */
+void World::reset_cycle_history()
+{
+    cycle_found = false;
+
+    if (!cycle_detection)
+    {
+        std::vector<uint64_t>().swap(unit_hashes);
+        std::vector<uint64_t>().swap(history_hashes);
+        std::vector<uint64_t>().swap(history_generations);
+        return;
+    }
+
+    if (engine == Engine::SPARSE)
+    {
+        unit_hashes.assign(tiles_x * tiles_y, 0);
+
+        for (int tile_y = 0; tile_y < tiles_y; tile_y++)
+        {
+            for (int tile_x = 0; tile_x < tiles_x; tile_x++)
+            {
+                unit_hashes[tile_y * tiles_x + tile_x] = hash_tile(tile_x, tile_y, current_state);
+            }
+        }
+    }
+    else
+    {
+        unit_hashes.assign(get_height(), 0);
+        hash_rows(0, get_height(), false);
+    }
+
+    history_hashes.assign(CYCLE_HISTORY, 0);
+    history_generations.assign(CYCLE_HISTORY, UINT64_MAX);
+    history_next = 0;
+
+    record_state();
+    cycle_found = false;
+}
+
+/**
+ * World::match_history_topology(toroidal)
+ *
+ * Private helper function forgetting the recorded states when the world is stepped on a different topology to
+ * before, since the states it passed through no longer predict where it goes next.
+ *
+ * With Engine::SPARSE every tile is also made active again, since tiles which settled on the old topology can
+ * change once the cells along the edges see, or stop seeing, the cells across the wrap.
+ *
+ * @param toroidal
+ *      Whether the coming steps are on a torus.
+ */
+void World::match_history_topology(bool toroidal)
+{
+    if (cycle_detection && toroidal != history_toroidal)
+    {
+        history_toroidal = toroidal;
+        cycle = WorldCycle();
+        reset_cycle_history();
+    }
+
+    if (engine == Engine::SPARSE && toroidal != last_toroidal)
+    {
+        active_tiles.assign(active_tiles.size(), 1);
+    }
+
+    last_toroidal = toroidal;
+}
+
+/**
+ * World::run_steps(steps, toroidal, stop_on_cycle)
+ *
+ * Private helper function running steps for World::advance.
+ *
+ * When the world has a thread pool, all of the steps are run by a single dispatch to the pool.
+ * Each thread loops over the generations computing its own band, and the threads meet at a single
+ * barrier per step, where the last thread to arrive swaps the grids.
+ *
+ * @param stop_on_cycle
+ *      True to stop after the step which finds a cycle.
+ *
+ * @return
+ *      The number of steps run.
+ */
+int World::run_steps(int steps, bool toroidal, bool stop_on_cycle)
+{
+    int taken = 0;
+    cycle_found = false;
+
+    if (pool && steps > 0 && engine != Engine::GPU)
+    {
+        const int height = get_height();
+        const int bands = pool->get_thread_count();
+
+        match_history_topology(toroidal);
+
+        // The ghost border of each new state is refreshed before any thread reads it
+        Barrier end_of_step(bands, [this, toroidal, &taken] {
+            swap_states();
+            refresh_ghost_borders(toroidal);
+            taken++;
+        });
+
+        refresh_ghost_borders(toroidal);
+
+        if (stats_enabled)
+        {
+            step_start = std::chrono::steady_clock::now();
+        }
+
+        pool->run([&](int band) {
+            const int y0 = static_cast<long long>(height) * band / bands;
+            const int y1 = static_cast<long long>(height) * (band + 1) / bands;
+
+            for (int i = 0; i < steps; i++)
+            {
+                step_rows(y0, y1, toroidal);
+                end_of_step.arrive_and_wait();
+
+                // Only changed in the barrier completion, so every thread sees the same value
+                if (stop_on_cycle && cycle_found)
+                {
+                    break;
+                }
+            }
+        });
+    }
+    else
+    {
+        while (taken < steps && !(stop_on_cycle && cycle_found))
+        {
+            step(toroidal);
+            taken++;
+        }
+    }
+
+    return taken;
+}
+
+/**
+ * World::advance(steps, toroidal)
+ *
+ * Advance multiple steps in the Game of Life.
+ * Should be implemented by invoking World::step(toroidal).
+ *
+ * With cycle detection enabled, advancing stops as soon as a cycle is found. Every whole period of the
+ * remaining steps is then skipped by adding it to the generation, and only the last part period is stepped,
+ * leaving the world in the same state as running every step. Skipped steps are not counted by the stats.
+ *
+ * With a temporal depth set by World::set_temporal_depth(generations), Engine::STENCIL and Engine::SIMD compute
+ * that many generations in each pass over the grid, with the same result as stepping through them one by one.
+ *
+ * @param steps
+ *      The number of steps to advance the world forward.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the grid as a torus, where the left edge
+ *      wraps to the right edge and the top to the bottom. Defaults to false.
+ */
+void World::advance(int steps, bool toroidal)
+{
+    const bool blocked = (engine == Engine::STENCIL || engine == Engine::SIMD) && !stats_enabled && !cycle_detection;
+
+    // Any last part pass shorter than two generations is cheaper to step the usual way
+    while (blocked && temporal_depth > 1 && steps > 1)
+    {
+        const int depth = std::min(steps, temporal_depth);
+
+        step_blocked(depth, toroidal);
+        steps -= depth;
+    }
+
+    const int taken = run_steps(steps, toroidal, cycle_detection);
+
+    if (taken < steps)
+    {
+        const uint64_t remaining = steps - taken;
+        generation += remaining - remaining % cycle.period;
+
+        // The generations in the history no longer follow on from the new generation
+        reset_cycle_history();
+        run_steps(static_cast<int>(remaining % cycle.period), toroidal, false);
     }
 }
\ No newline at end of file
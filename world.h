@@ -10,30 +10,176 @@
  */
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "device_grid.h"
 #include "grid.h"
+#include "packed_grid.h"
+#include "rule.h"
+#include "thread_pool.h"
+#include "tiled_grid.h"
+
+/**
+ * The kernel a World uses to compute each update step.
+ *      - Engine::STENCIL sweeps every cell with an unchecked, branch-free stencil, reading the neighbours of the
+ *        edge cells from a ghost border around the grid. This is the default.
+ *      - Engine::SCALAR counts the neighbours of every cell with World::count_neighbours.
+ *      - Engine::PACKED stores the state in 1 bit per cell and updates 64 cells at a time with bitwise adders.
+ *      - Engine::SIMD is Engine::STENCIL with hand-vectorized row kernels picked for the running CPU.
+ *      - Engine::SPARSE runs the stencil only over the 64x64 tiles which changed last step and their neighbours.
+ *      - Engine::TILED stores the state as 256x256 tiles in Morton order and sweeps each tile on its own with the
+ *        Engine::SIMD kernels, keeping the rows around every cell in cache on very wide grids.
+ *      - Engine::GPU keeps the state in two DeviceGrid buffers on an OpenMP offload device such as a GPU, and
+ *        steps it there with a tiled stencil, only copying the state back when it is asked for.
+ */
+enum class Engine
+{
+    STENCIL,
+    SCALAR,
+    PACKED,
+    SPARSE,
+    SIMD,
+    TILED,
+    GPU
+};
+
+/**
+ * Counters describing the work done by the steps of a World, collected while World::set_stats_enabled(true).
+ * Counters named total_ are summed over every step since the stats were last reset, the rest describe the last step.
+ */
+struct WorldStats
+{
+    uint64_t steps;
+    double total_seconds;
+    double last_seconds;
+    uint64_t cells_evaluated; // Cells recomputed by the last step
+    uint64_t cells_skipped; // Cells in tiles Engine::SPARSE left untouched during the last step
+    uint64_t total_cells_evaluated;
+    uint64_t total_cells_skipped;
+    uint64_t births;
+    uint64_t deaths;
+    uint64_t total_births;
+    uint64_t total_deaths;
+    int tiles_active; // TILE_SIZE by TILE_SIZE tiles recomputed by the last step
+    int tiles_total;
+    uint64_t bytes_allocated; // Bytes held by the state buffers and tile tables of the world
+};
+
+/**
+ * A cycle found by a World with World::set_cycle_detection(true), where the state repeats every period steps.
+ * A still life, or a world which has died out, has a period of 1.
+ */
+struct WorldCycle
+{
+    uint64_t period; // 0 until a cycle is found
+    uint64_t generation; // The first generation seen to be in the cycle
+    uint64_t detected; // The generation at which the cycle was noticed
+};
 
 /**
  * Declare the structure of the World class for representing a 2d grid world.
  *
  * A World holds two equally sized Grid objects for the current state and next state.
  *      - These buffers should be swapped using std::swap after each update step.
+ *      - With Engine::PACKED the state lives in two PackedGrid buffers instead, and the current state
+ *        Grid is only unpacked on demand by World::get_state().
+ *      - With Engine::TILED the state likewise lives in two TiledGrid buffers, copied back into the current
+ *        state Grid on demand.
+ *      - With Engine::GPU the state lives in two DeviceGrid buffers in device memory, swapped the same way, and
+ *        copied back into the current state Grid on demand.
+ *      - With Engine::SPARSE the grids are split into square tiles, tracking which tiles are active and the
+ *        population of each tile, so the alive count is updated from the tiles which were recomputed.
+ *
+ * A World can optionally own a persistent ThreadPool, splitting each step into one band of rows per thread.
  */
 class World
 {
     private:
-        const int UPPER_POPULATION_LIMIT = 3;
-        const int LOWER_POPULATION_LIMIT = 2;
-        
-        Grid current_state;
+        Engine engine;
+        Rule rule;
+        uint64_t generation;
+
+        mutable Grid current_state;
         Grid next_state;
 
+        PackedGrid packed_current_state;
+        PackedGrid packed_next_state;
+        TiledGrid tiled_current_state;
+        TiledGrid tiled_next_state;
+        DeviceGrid device_current_state;
+        DeviceGrid device_next_state;
+        mutable bool current_state_stale; // Set while the current state Grid is behind the packed, tiled or device state
+
+        int tiles_x;
+        int tiles_y;
+        std::vector<unsigned char> active_tiles; // Tiles recomputed by the next step
+        std::vector<unsigned char> changed_tiles; // Tiles which changed during the last step
+        std::vector<int> tile_populations;
+        std::vector<int> tile_deltas; // Change in population of each tile during the last step
+        int alive_cells;
+        std::vector<unsigned char> dirty_tiles; // Tiles which changed since the last World::take_changed_tiles
+        std::vector<int> dirty_tile_list;
+
+        std::shared_ptr<ThreadPool> pool; // Shared between copies of a world
+
+        bool stats_enabled;
+        WorldStats stats;
+        std::chrono::steady_clock::time_point step_start;
+
+        bool cycle_detection;
+        bool history_toroidal; // Whether the recorded history was stepped on a torus
+        bool last_toroidal; // Whether the last step was on a torus
+        std::vector<uint64_t> unit_hashes; // Hash of each row of the state, or of each tile with Engine::SPARSE
+        std::vector<uint64_t> history_hashes; // Ring of the hashes of the latest states
+        std::vector<uint64_t> history_generations;
+        int history_next;
+        WorldCycle cycle;
+        bool cycle_found; // Set by the step which found a cycle
+
+        int temporal_depth; // Generations World::advance computes per pass over the grid
+
         int count_neighbours(int x, int y, bool toroidal) const;
 
+        void step_rows(int y0, int y1, bool toroidal);
+        void step_stencil(int y0, int y1);
+        void step_scalar(int y0, int y1, bool toroidal);
+        void step_packed(int y0, int y1, bool toroidal);
+        void step_tiled(int y0, int y1);
+        void step_sparse(int y0, int y1);
+        void step_device();
+        void step_tile(int tile_x, int tile_y);
+        void step_block(int x0, int y0, int x1, int y1, int depth, bool toroidal);
+        void step_blocked(int depth, bool toroidal);
+        void update_ghost_borders();
+        void refresh_ghost_borders(bool toroidal);
+        void reset_tiles();
+        void swap_states();
+        void collect_stats();
+        void hash_rows(int y0, int y1, bool next);
+        uint64_t hash_tile(int tile_x, int tile_y, const Grid &state) const;
+        void record_state();
+        void reset_cycle_history();
+        void match_history_topology(bool toroidal);
+        int run_steps(int steps, bool toroidal, bool stop_on_cycle);
+
     public:
+        // Edge length of the square tiles used by Engine::SPARSE and for reporting changes
+        static const int TILE_SIZE = 64;
+
+        // Number of earlier states a cycle can be found against, the longest period that can be found
+        static const int CYCLE_HISTORY = 128;
+
+        // Edge length of the square blocks World::advance computes several generations of at a time
+        static const int BLOCK_SIZE = 256;
+
         World();
         World(int width, int height);
         explicit World(int square_size);
-        explicit World(Grid &initial_state);
+        explicit World(const Grid &initial_state);
+        explicit World(Grid &&initial_state);
 
         int get_width() const;
         int get_height() const;
@@ -41,6 +187,32 @@ class World
         int get_alive_cells() const;
         int get_dead_cells() const;
         const Grid &get_state() const;
+        Grid take_state();
+
+        uint64_t get_generation() const;
+        void set_generation(uint64_t new_generation);
+        std::vector<int> take_changed_tiles();
+
+        Engine get_engine() const;
+        void set_engine(Engine new_engine);
+
+        const Rule &get_rule() const;
+        void set_rule(const Rule &new_rule);
+
+        int get_threads() const;
+        void set_threads(int thread_count);
+
+        bool get_stats_enabled() const;
+        void set_stats_enabled(bool enabled);
+        const WorldStats &get_stats() const;
+        void reset_stats();
+
+        bool get_cycle_detection() const;
+        void set_cycle_detection(bool enabled);
+        const WorldCycle &get_cycle() const;
+
+        int get_temporal_depth() const;
+        void set_temporal_depth(int generations);
 
         void resize(int square_size);
         void resize(int new_width, int new_height);
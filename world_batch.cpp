@@ -0,0 +1,748 @@
+/**
+ * Implements a class for simulating many small, equally sized worlds together in one bit-sliced buffer.
+ *      - A WorldBatch holds any number of independent worlds of the same size and rule, for sweeps over random
+ *        soups or pattern collisions where constructing and stepping a World per board wastes cores and cache.
+ *          - The worlds are bit-sliced in groups of 64, each 64 bit word holding the same cell of every world of
+ *            its group, so one pass of the bitwise full adders of Engine::PACKED steps 64 worlds at once.
+ *          - Neighbouring cells are neighbouring words, so unlike Engine::PACKED no words are shifted.
+ *          - Every group lives in one contiguous buffer, with a ghost border one word wide around each plane,
+ *            refreshed before each step, so the edges need no special cases.
+ *
+ *      - Each world is checked for termination after every step, from masks ORed together while stepping.
+ *          - A world with no alive cells is WorldStatus::EXTINCT.
+ *          - A world which came out of the step unchanged is WorldStatus::STILL_LIFE.
+ *          - A world which came back to its state of two steps before is WorldStatus::OSCILLATOR.
+ *          - A finished world keeps the state it was in when it was noticed, and a group whose worlds have all
+ *            finished is skipped entirely, so finished worlds drop out of the batch early.
+ *
+ *      - Steps can be run in parallel on a persistent pool of threads with WorldBatch::set_threads(thread_count).
+ *          - Every group is split into one horizontal band of rows per thread, so even a single group is spread
+ *            across all the threads.
+ *          - Each band ORs its own termination masks together, which are combined once all bands are done.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#include <algorithm>
+#include <stdexcept>
+
+#include "memory_pool.h"
+#include "packed_grid.h"
+#include "world_batch.h"
+
+/**
+ * WorldBatch::WorldBatch()
+ *
+ * Construct an empty batch holding no worlds.
+ *
+ * @example
+ *
+ *      // Make an empty batch
+ *      WorldBatch batch;
+ *
+ */
+WorldBatch::WorldBatch() : WorldBatch::WorldBatch(0, 0, 0) {}
+
+/**
+ * WorldBatch::WorldBatch(width, height, count)
+ *
+ * Construct a batch of count worlds of the same size, every cell of which is initially dead.
+ * Every world starts off running, under the rules of Conway's Game of Life.
+ *
+ * @example
+ *
+ *      // Make a batch of 1000 16x16 soups
+ *      WorldBatch batch(16, 16, 1000);
+ *
+ *      for (int i = 0; i < batch.get_count(); i++)
+ *      {
+ *          batch.set_state(i, random_soup(16, 16));
+ *      }
+ *
+ * @param width
+ *      The width of every world.
+ *
+ * @param height
+ *      The height of every world.
+ *
+ * @param count
+ *      The number of worlds in the batch.
+ *
+ * @throws
+ *      Throws std::invalid_argument if the width, height, or count is negative.
+ */
+WorldBatch::WorldBatch(int width, int height, int count)
+    : width(width), height(height), count(count), groups(0), generation(0), rule()
+{
+    if (width < 0 || height < 0 || count < 0)
+    {
+        throw std::invalid_argument("ERROR: A batch cannot have a negative size or number of worlds.");
+    }
+
+    groups = (count + GROUP_SIZE - 1) / GROUP_SIZE;
+
+    planes.assign(static_cast<size_t>(groups) * HISTORY * get_plane_size(), 0);
+    current_planes.assign(groups, 0);
+    running.assign(groups, ~uint64_t(0));
+    statuses.assign(count, WorldStatus::RUNNING);
+    finished_generations.assign(count, 0);
+
+    // Lanes of the last group past the end of the batch are never run
+    if (count % GROUP_SIZE != 0)
+    {
+        running.back() = (uint64_t(1) << (count % GROUP_SIZE)) - 1;
+    }
+}
+
+/**
+ * WorldBatch::get_stride()
+ *
+ * Private helper function giving the number of words between vertically adjacent cells of a plane.
+ *
+ * @return
+ *      The width plus the ghost words either side of each row.
+ */
+int WorldBatch::get_stride() const
+{
+    return width + 2;
+}
+
+/**
+ * WorldBatch::get_plane_size()
+ *
+ * Private helper function giving the number of words in a plane, including the ghost border.
+ *
+ * @return
+ *      The number of words in each plane.
+ */
+size_t WorldBatch::get_plane_size() const
+{
+    return static_cast<size_t>(width + 2) * (height + 2);
+}
+
+/**
+ * WorldBatch::get_plane(group, plane)
+ *
+ * Private helper function finding cell (0, 0) of a plane of a group, so rows -1 and height and the words either
+ * side of each row are the ghost border.
+ *
+ * @param group
+ *      The index of the group.
+ *
+ * @param plane
+ *      The index of the plane within the group, from 0 to HISTORY - 1.
+ *
+ * @return
+ *      A pointer to the word holding cell (0, 0) of every world of the group.
+ */
+uint64_t *WorldBatch::get_plane(int group, int plane)
+{
+    return planes.data() + (static_cast<size_t>(group) * HISTORY + plane) * get_plane_size() + get_stride() + 1;
+}
+
+/**
+ * WorldBatch::get_plane(group, plane)
+ *
+ * Private helper function finding cell (0, 0) of a plane of a group, see WorldBatch::get_plane(group, plane).
+ *
+ * @return
+ *      A read-only pointer to the word holding cell (0, 0) of every world of the group.
+ */
+const uint64_t *WorldBatch::get_plane(int group, int plane) const
+{
+    return planes.data() + (static_cast<size_t>(group) * HISTORY + plane) * get_plane_size() + get_stride() + 1;
+}
+
+/**
+ * WorldBatch::check_index(world)
+ *
+ * Private helper function checking that a world is part of the batch.
+ *
+ * @throws
+ *      Throws std::out_of_range if the index is outside [0, count).
+ */
+void WorldBatch::check_index(int world) const
+{
+    if (world < 0 || world >= count)
+    {
+        throw std::out_of_range("ERROR: Requested world is not in the batch.");
+    }
+}
+
+/**
+ * WorldBatch::get_width()
+ *
+ * Gets the width of every world in the batch.
+ *
+ * @return
+ *      The width of the worlds.
+ */
+int WorldBatch::get_width() const
+{
+    return width;
+}
+
+/**
+ * WorldBatch::get_height()
+ *
+ * Gets the height of every world in the batch.
+ *
+ * @return
+ *      The height of the worlds.
+ */
+int WorldBatch::get_height() const
+{
+    return height;
+}
+
+/**
+ * WorldBatch::get_count()
+ *
+ * Gets the number of worlds in the batch, whether running or finished.
+ *
+ * @return
+ *      The number of worlds.
+ */
+int WorldBatch::get_count() const
+{
+    return count;
+}
+
+/**
+ * WorldBatch::get_running()
+ *
+ * Gets the number of worlds which have not yet finished.
+ *
+ * @return
+ *      The number of worlds with WorldStatus::RUNNING.
+ */
+int WorldBatch::get_running() const
+{
+    int total = 0;
+
+    for (const uint64_t mask : running)
+    {
+        total += __builtin_popcountll(mask);
+    }
+
+    return total;
+}
+
+/**
+ * WorldBatch::get_generation()
+ *
+ * Gets the number of steps taken by the batch.
+ *
+ * @return
+ *      The generation of the running worlds.
+ */
+uint64_t WorldBatch::get_generation() const
+{
+    return generation;
+}
+
+/**
+ * WorldBatch::get_rule()
+ *
+ * Gets the rule applied to every world by each update step.
+ *
+ * @return
+ *      A reference to the current rule, B3/S23 unless changed.
+ */
+const Rule &WorldBatch::get_rule() const
+{
+    return rule;
+}
+
+/**
+ * WorldBatch::set_rule(new_rule)
+ *
+ * Change the rule applied to every world by each update step. The states are preserved.
+ * Every finished world is started running again, since a world which finished under the old rule need not
+ * finish under the new rule.
+ *
+ * @param new_rule
+ *      The rule to apply in all following steps.
+ */
+void WorldBatch::set_rule(const Rule &new_rule)
+{
+    if (new_rule != rule)
+    {
+        rule = new_rule;
+
+        for (int world = 0; world < count; world++)
+        {
+            statuses[world] = WorldStatus::RUNNING;
+            running[world / GROUP_SIZE] |= uint64_t(1) << (world % GROUP_SIZE);
+        }
+    }
+}
+
+/**
+ * WorldBatch::get_threads()
+ *
+ * Gets the number of threads each step is split across.
+ *
+ * @return
+ *      The number of threads, 1 when steps are run serially.
+ */
+int WorldBatch::get_threads() const
+{
+    return pool ? pool->get_thread_count() : 1;
+}
+
+/**
+ * WorldBatch::set_threads(thread_count)
+ *
+ * Set the number of threads each step is split across, each computing one band of rows of every group.
+ * The threads are started once here, then reused by every following step.
+ *
+ * @example
+ *
+ *      // Step a batch of soups on 8 threads
+ *      WorldBatch batch(16, 16, 100000);
+ *      batch.set_threads(8);
+ *      batch.advance(1000);
+ *
+ * @param thread_count
+ *      The number of threads to use. Values of 1 or less run each step serially.
+ */
+void WorldBatch::set_threads(int thread_count)
+{
+    if (thread_count <= 1)
+    {
+        pool.reset();
+    }
+    else if (thread_count != get_threads())
+    {
+        pool = std::make_shared<ThreadPool>(thread_count);
+    }
+}
+
+/**
+ * WorldBatch::get_state(world)
+ *
+ * Gets the current state of a single world of the batch, unpacked into a grid.
+ * A finished world holds the state it was in when the batch noticed it finish.
+ *
+ * @example
+ *
+ *      // Print the first world of a batch
+ *      std::cout << batch.get_state(0) << std::endl;
+ *
+ * @param world
+ *      The index of the world.
+ *
+ * @return
+ *      A grid holding the state of the world.
+ *
+ * @throws
+ *      Throws std::out_of_range if the world is not in the batch.
+ */
+Grid WorldBatch::get_state(int world) const
+{
+    check_index(world);
+
+    const int group = world / GROUP_SIZE;
+    const int lane = world % GROUP_SIZE;
+    const uint64_t *plane = get_plane(group, current_planes[group]);
+
+    Grid state(width, height);
+
+    for (int y = 0; y < height; y++)
+    {
+        const uint64_t *words = plane + static_cast<size_t>(y) * get_stride();
+        Cell *cells = state.row(y);
+
+        for (int x = 0; x < width; x++)
+        {
+            cells[x] = (words[x] >> lane) & 1 ? Cell::ALIVE : Cell::DEAD;
+        }
+    }
+
+    return state;
+}
+
+/**
+ * WorldBatch::set_state(world, state)
+ *
+ * Replace the state of a single world of the batch, which is started running again.
+ * The state is also written as the generation before, so the world is never mistaken for an oscillator
+ * after its first step.
+ *
+ * @example
+ *
+ *      // Place a glider in the middle of the first world
+ *      Grid board(16, 16);
+ *      board.merge(Zoo::glider(), 7, 7);
+ *      batch.set_state(0, board);
+ *
+ * @param world
+ *      The index of the world.
+ *
+ * @param state
+ *      A grid holding the new state, which must be the size of the worlds of the batch.
+ *
+ * @throws
+ *      Throws std::out_of_range if the world is not in the batch, or std::invalid_argument if the grid is
+ *      the wrong size.
+ */
+void WorldBatch::set_state(int world, const Grid &state)
+{
+    check_index(world);
+
+    if (state.get_width() != width || state.get_height() != height)
+    {
+        throw std::invalid_argument("ERROR: The grid must be the same size as the worlds of the batch.");
+    }
+
+    const int group = world / GROUP_SIZE;
+    const uint64_t bit = uint64_t(1) << (world % GROUP_SIZE);
+
+    const int current = current_planes[group];
+    const int previous = (current + HISTORY - 1) % HISTORY;
+
+    for (const int plane : {current, previous})
+    {
+        uint64_t *words = get_plane(group, plane);
+
+        for (int y = 0; y < height; y++)
+        {
+            const Cell *cells = state.row(y);
+            uint64_t *row = words + static_cast<size_t>(y) * get_stride();
+
+            for (int x = 0; x < width; x++)
+            {
+                row[x] = (row[x] & ~bit) | (cells[x] == Cell::ALIVE ? bit : 0);
+            }
+        }
+    }
+
+    running[group] |= bit;
+    statuses[world] = WorldStatus::RUNNING;
+    finished_generations[world] = 0;
+}
+
+/**
+ * WorldBatch::get_alive_cells(world)
+ *
+ * Gets the number of alive cells in the current state of a single world of the batch.
+ *
+ * @param world
+ *      The index of the world.
+ *
+ * @return
+ *      The number of alive cells.
+ *
+ * @throws
+ *      Throws std::out_of_range if the world is not in the batch.
+ */
+int WorldBatch::get_alive_cells(int world) const
+{
+    check_index(world);
+
+    const int group = world / GROUP_SIZE;
+    const int lane = world % GROUP_SIZE;
+    const uint64_t *plane = get_plane(group, current_planes[group]);
+
+    int total = 0;
+
+    for (int y = 0; y < height; y++)
+    {
+        const uint64_t *words = plane + static_cast<size_t>(y) * get_stride();
+
+        for (int x = 0; x < width; x++)
+        {
+            total += (words[x] >> lane) & 1;
+        }
+    }
+
+    return total;
+}
+
+/**
+ * WorldBatch::get_status(world)
+ *
+ * Gets whether a world is still running, or how it finished.
+ *
+ * @example
+ *
+ *      // Count the soups which died out
+ *      int extinct = 0;
+ *
+ *      for (int i = 0; i < batch.get_count(); i++)
+ *      {
+ *          extinct += batch.get_status(i) == WorldStatus::EXTINCT;
+ *      }
+ *
+ * @param world
+ *      The index of the world.
+ *
+ * @return
+ *      The status of the world.
+ *
+ * @throws
+ *      Throws std::out_of_range if the world is not in the batch.
+ */
+WorldStatus WorldBatch::get_status(int world) const
+{
+    check_index(world);
+
+    return statuses[world];
+}
+
+/**
+ * WorldBatch::get_finished_generation(world)
+ *
+ * Gets the generation at which a world was noticed to have finished.
+ *
+ * @param world
+ *      The index of the world.
+ *
+ * @return
+ *      The generation of the batch after the step in which the world finished, or 0 if it is still running.
+ *
+ * @throws
+ *      Throws std::out_of_range if the world is not in the batch.
+ */
+uint64_t WorldBatch::get_finished_generation(int world) const
+{
+    check_index(world);
+
+    return finished_generations[world];
+}
+
+/**
+ * WorldBatch::refresh_ghost_border(plane, toroidal)
+ *
+ * Private helper function filling the ghost border of a plane with the words a stencil should see beyond each
+ * edge, copies of the opposite edges when toroidal and all dead otherwise, in time proportional to the perimeter.
+ *
+ * @param plane
+ *      A pointer to cell (0, 0) of the plane.
+ *
+ * @param toroidal
+ *      If true then the plane is treated as a torus.
+ */
+void WorldBatch::refresh_ghost_border(uint64_t *plane, bool toroidal) const
+{
+    if (width == 0 || height == 0)
+    {
+        return;
+    }
+
+    const int stride = get_stride();
+
+    for (int y = 0; y < height; y++)
+    {
+        uint64_t *row = plane + static_cast<size_t>(y) * stride;
+        row[-1] = toroidal ? row[width - 1] : 0;
+        row[width] = toroidal ? row[0] : 0;
+    }
+
+    uint64_t *top = plane - stride - 1;
+    uint64_t *bottom = plane + static_cast<size_t>(height) * stride - 1;
+
+    if (toroidal)
+    {
+        std::copy(bottom - stride, bottom, top);
+        std::copy(plane - 1, plane - 1 + stride, bottom);
+    }
+    else
+    {
+        std::fill(top, top + stride, 0);
+        std::fill(bottom, bottom + stride, 0);
+    }
+}
+
+/**
+ * sweep_row<CONWAY>(above, middle, below, previous, destination, width, running, birth, survival, summary)
+ *
+ * Helper function stepping one row of a group of worlds, ORing together the masks of the worlds with any
+ * alive cell, any changed cell, and any cell differing from the generation before.
+ * Finished worlds are masked out, keeping their current state.
+ */
+template <bool CONWAY>
+static void sweep_row(const uint64_t *above, const uint64_t *middle, const uint64_t *below,
+                      const uint64_t *previous, uint64_t *destination, int width, uint64_t running,
+                      uint16_t birth, uint16_t survival, uint64_t *summary)
+{
+    uint64_t alive = 0, changed = 0, cycled = 0;
+
+    for (int x = 0; x < width; x++)
+    {
+        uint64_t next = CONWAY ? life_word(above[x - 1], above[x], above[x + 1],
+                                           middle[x - 1], middle[x], middle[x + 1],
+                                           below[x - 1], below[x], below[x + 1])
+                               : rule_word(above[x - 1], above[x], above[x + 1],
+                                           middle[x - 1], middle[x], middle[x + 1],
+                                           below[x - 1], below[x], below[x + 1], birth, survival);
+
+        next = (next & running) | (middle[x] & ~running);
+        destination[x] = next;
+
+        alive |= next;
+        changed |= next ^ middle[x];
+        cycled |= next ^ previous[x];
+    }
+
+    summary[0] |= alive;
+    summary[1] |= changed;
+    summary[2] |= cycled;
+}
+
+/**
+ * WorldBatch::step_rows(group, y0, y1, summary)
+ *
+ * Private helper function computing rows [y0, y1) of the next state of a group.
+ *
+ * @param group
+ *      The index of the group.
+ *
+ * @param summary
+ *      Three masks to OR the worlds with alive cells, changed cells, and cells differing from the generation
+ *      before into.
+ */
+void WorldBatch::step_rows(int group, int y0, int y1, uint64_t *summary)
+{
+    const int stride = get_stride();
+    const int current = current_planes[group];
+
+    const uint64_t *source = get_plane(group, current);
+    const uint64_t *previous = get_plane(group, (current + HISTORY - 1) % HISTORY);
+    uint64_t *destination = get_plane(group, (current + 1) % HISTORY);
+
+    // Conway's Game of Life keeps the shorter adder tree which only tells counts of 2 and 3 apart
+    const bool conway = rule.is<Conway>();
+
+    for (int y = y0; y < y1; y++)
+    {
+        const size_t offset = static_cast<size_t>(y) * stride;
+        const uint64_t *middle = source + offset;
+
+        if (conway)
+        {
+            sweep_row<true>(middle - stride, middle, middle + stride, previous + offset, destination + offset,
+                            width, running[group], 0, 0, summary);
+        }
+        else
+        {
+            sweep_row<false>(middle - stride, middle, middle + stride, previous + offset, destination + offset,
+                             width, running[group], rule.get_birth(), rule.get_survival(), summary);
+        }
+    }
+}
+
+/**
+ * WorldBatch::step(toroidal)
+ *
+ * Steps every running world of the batch forward by one generation, then checks which of them have finished.
+ * Groups in which every world has finished are skipped.
+ *
+ * @example
+ *
+ *      // Step a batch of soups until they have all finished
+ *      while (batch.get_running() > 0)
+ *      {
+ *          batch.step();
+ *      }
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the step will consider the worlds to be toroidal, see World::step.
+ */
+void WorldBatch::step(bool toroidal)
+{
+    std::pmr::vector<int> active(Memory::get_scratch_resource());
+
+    for (int group = 0; group < groups; group++)
+    {
+        if (running[group])
+        {
+            refresh_ghost_border(get_plane(group, current_planes[group]), toroidal);
+            active.push_back(group);
+        }
+    }
+
+    const int bands = pool ? pool->get_thread_count() : 1;
+
+    // Three masks per group for each band, so no two threads write the same words
+    std::pmr::vector<uint64_t> summaries(static_cast<size_t>(bands) * groups * 3, 0, Memory::get_scratch_resource());
+
+    auto step_band = [&](int band) {
+        const int y0 = static_cast<long long>(height) * band / bands;
+        const int y1 = static_cast<long long>(height) * (band + 1) / bands;
+
+        for (const int group : active)
+        {
+            step_rows(group, y0, y1, &summaries[(static_cast<size_t>(band) * groups + group) * 3]);
+        }
+    };
+
+    if (pool)
+    {
+        pool->run(step_band);
+    }
+    else
+    {
+        step_band(0);
+    }
+
+    generation++;
+
+    for (const int group : active)
+    {
+        uint64_t alive = 0, changed = 0, cycled = 0;
+
+        for (int band = 0; band < bands; band++)
+        {
+            const uint64_t *summary = &summaries[(static_cast<size_t>(band) * groups + group) * 3];
+            alive |= summary[0];
+            changed |= summary[1];
+            cycled |= summary[2];
+        }
+
+        current_planes[group] = (current_planes[group] + 1) % HISTORY;
+
+        const uint64_t extinct = running[group] & ~alive;
+        const uint64_t still_life = running[group] & alive & ~changed;
+        const uint64_t oscillator = running[group] & alive & changed & ~cycled;
+        const uint64_t finished = extinct | still_life | oscillator;
+
+        for (uint64_t lanes = finished; lanes; lanes &= lanes - 1)
+        {
+            const int lane = __builtin_ctzll(lanes);
+            const int world = group * GROUP_SIZE + lane;
+
+            statuses[world] = (extinct >> lane) & 1 ? WorldStatus::EXTINCT
+                            : (still_life >> lane) & 1 ? WorldStatus::STILL_LIFE
+                            : WorldStatus::OSCILLATOR;
+            finished_generations[world] = generation;
+        }
+
+        running[group] &= ~finished;
+    }
+}
+
+/**
+ * WorldBatch::advance(steps, toroidal)
+ *
+ * Steps the batch forward by a number of generations, stopping early once every world has finished.
+ *
+ * @example
+ *
+ *      // Run every soup for at most 1000 generations on a torus
+ *      batch.advance(1000, true);
+ *
+ * @param steps
+ *      The most generations to step forward by.
+ *
+ * @param toroidal
+ *      Optional parameter. If true then the steps will consider the worlds to be toroidal.
+ */
+void WorldBatch::advance(int steps, bool toroidal)
+{
+    for (int i = 0; i < steps && get_running() > 0; i++)
+    {
+        step(toroidal);
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * Declares a class for simulating many small, equally sized worlds together in one bit-sliced buffer.
+ * Rich documentation for the api and behaviour the WorldBatch class can be found in world_batch.cpp.
+ *
+ * @author 961500
+ * @date April, 2020
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "grid.h"
+#include "rule.h"
+#include "thread_pool.h"
+
+/**
+ * How far a world of a WorldBatch has got, set by the step in which the batch noticed it stop changing.
+ *      - WorldStatus::RUNNING is still being stepped.
+ *      - WorldStatus::EXTINCT has no alive cells left.
+ *      - WorldStatus::STILL_LIFE came out of a step unchanged.
+ *      - WorldStatus::OSCILLATOR came back to its state of two generations before, i.e. has period 2.
+ */
+enum class WorldStatus
+{
+    RUNNING,
+    EXTINCT,
+    STILL_LIFE,
+    OSCILLATOR
+};
+
+/**
+ * Declare the structure of the WorldBatch class for representing a batch of independent worlds of the same size.
+ *
+ * The worlds are bit-sliced into groups of 64, where each 64 bit word holds the same cell of every world of a
+ * group, world i of the group in bit i. Each group is stored as three planes of words with a ghost border one
+ * word wide, holding the current state, the next state, and the state of the generation before.
+ */
+class WorldBatch
+{
+    private:
+        static const int GROUP_SIZE = 64;
+        static const int HISTORY = 3;
+
+        int width;
+        int height;
+        int count;
+        int groups;
+        uint64_t generation;
+        Rule rule;
+
+        std::vector<uint64_t> planes; // HISTORY planes per group, each of (width + 2) * (height + 2) words
+        std::vector<int> current_planes; // Index within its group of the plane holding the current state
+        std::vector<uint64_t> running; // Bit i of each word set while world i of the group is running
+
+        std::vector<WorldStatus> statuses;
+        std::vector<uint64_t> finished_generations;
+
+        std::shared_ptr<ThreadPool> pool;
+
+        int get_stride() const;
+        size_t get_plane_size() const;
+        uint64_t *get_plane(int group, int plane);
+        const uint64_t *get_plane(int group, int plane) const;
+
+        void check_index(int world) const;
+        void refresh_ghost_border(uint64_t *plane, bool toroidal) const;
+        void step_rows(int group, int y0, int y1, uint64_t *summary);
+
+    public:
+        WorldBatch();
+        WorldBatch(int width, int height, int count);
+
+        int get_width() const;
+        int get_height() const;
+        int get_count() const;
+        int get_running() const;
+        uint64_t get_generation() const;
+
+        const Rule &get_rule() const;
+        void set_rule(const Rule &new_rule);
+
+        int get_threads() const;
+        void set_threads(int thread_count);
+
+        Grid get_state(int world) const;
+        void set_state(int world, const Grid &state);
+        int get_alive_cells(int world) const;
+
+        WorldStatus get_status(int world) const;
+        uint64_t get_finished_generation(int world) const;
+
+        void step(bool toroidal = false);
+        void advance(int steps, bool toroidal = false);
+};
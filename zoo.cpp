@@ -9,6 +9,17 @@
  *              - followed by (height) number of lines, each containing (width) number of characters,
  *                terminated by a newline character.
  *              - (space) ' ' is Cell::DEAD, (hash) '#' is Cell::ALIVE.
+ *          - Ascii grids can also be read from and written to any std::istream or std::ostream.
+ *
+ *      - Grids can be loaded from and saved to the standard Life RLE pattern format.
+ *          - RLE files can carry any Life-like rule, which is read and written alongside the grid when asked for.
+ *          - RLE files are composed of:
+ *              - any number of comment lines starting with '#'.
+ *              - a header line "x = width, y = height", optionally followed by a rulestring ", rule = B3/S23".
+ *              - runs of an optional count followed by 'b' for Cell::DEAD, 'o' for Cell::ALIVE, or '$' for the
+ *                end of a row, terminated by '!'.
+ *
+ *      - HashlifeWorlds can be loaded from and saved to Golly's macrocell format, which stores the quadtree.
  *
  *      - Grids can be loaded from and saved to an binary file format.
  *          - Binary files are composed of:
@@ -17,16 +28,60 @@
  *              - followed by (width * height) number of individual bits in C-style row/column format,
  *                padded with zero or more 0 bits.
  *              - a 0 bit should be considered Cell::DEAD, a 1 bit should be considered Cell::ALIVE.
+ *          - Version 2 binary files are instead composed of little endian unsigned integers:
+ *              - a header of the 4 byte magic number 'BGOL', followed by 4 byte ints for the version (2),
+ *                width, height, tile size (a multiple of 64), and number of tiles in the index.
+ *              - an index of the tiles holding alive cells, in any order, each entry made of 4 byte ints for the
+ *                tile x and y, an 8 byte offset of its block from the start of the file, and 4 byte ints for
+ *                the block size and encoding (0 raw, 1 run length encoded).
+ *              - the blocks, each holding the rows of a tile padded to whole bytes, in the same bit order as v1.
+ *          - Binary files are loaded through a memory mapping, either into a Grid or directly into a PackedGrid,
+ *            with the version detected automatically. Regions can be loaded alone, decoding only the tiles needed.
+ *          - A board split between processes, such as a DistributedWorld, is saved as one v2 file by every process
+ *            encoding only its own region of whole tiles and writing the index entries and blocks into their places.
+ *
+ *      - Tile buffers are drawn from the per-thread pool of Memory::get_scratch_resource(), and each thread keeps
+ *        one stream buffer for ascii files, so loading and saving many small patterns reuses the same memory
+ *        instead of allocating and clearing it afresh each time.
  *
  * @author 961500
  * @date April, 2020
  */
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <climits>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <memory>
+#include <sstream>
 #include <stdexcept>
+#include <vector>
 
+#include "mapped_file.h"
+#include "memory_pool.h"
 #include "zoo.h"
 
+// Size of the stream buffers used for ascii files, large enough that a row rarely needs more than one refill
+static const size_t ASCII_BUFFER_SIZE = 1 << 20;
+
+/**
+ * ascii_buffer()
+ *
+ * Helper function returning the stream buffer for ascii files of the calling thread, ASCII_BUFFER_SIZE bytes long.
+ * It is allocated the first time and reused after, and never cleared, as a stream only reads back what it put there.
+ *
+ * @return
+ *      Returns the first byte of the buffer.
+ */
+static char *ascii_buffer()
+{
+    thread_local std::unique_ptr<char[]> buffer(new char[ASCII_BUFFER_SIZE]);
+    return buffer.get();
+}
+
 /**
  * Zoo::glider()
  *
@@ -132,39 +187,30 @@ Grid Zoo::light_weight_spaceship()
 }
 
 /**
- * Zoo::load_ascii(path)
+ * parse_ascii(in, source)
  *
- * Load an ascii file and parse it as a grid of cells.
- * Should be implemented using std::ifstream.
+ * Helper function parsing an ascii .gol stream into a grid of cells.
  *
- * @example
+ * Each row is read in a single call straight into the grid, since the characters for Cell::DEAD and
+ * Cell::ALIVE are the cell values themselves, and is then validated with a branch-free scan.
  *
- *      // Load an ascii file from a directory
- *      Grid grid = Zoo::load_ascii("path/to/file.gol");
+ * @param in
+ *      The stream to read from, positioned at the start of the header.
  *
- * @param path
- *      The std::string path to the file to read in.
+ * @param source
+ *      A lower case description of where the stream came from, for error messages.
  *
  * @return
  *      Returns the parsed grid.
  *
  * @throws
  *      Throws std::runtime_error or sub-class if:
- *          - The file cannot be opened.
- *          - The parsed width or height is not a positive integer.
+ *          - The parsed width or height is not a positive integer, or there are too many cells to index.
  *          - Newline characters are not found when expected during parsing.
  *          - The character for a cell is not the ALIVE or DEAD character.
  */
-Grid Zoo::load_ascii(const std::string path)
+static Grid parse_ascii(std::istream &in, const std::string &source)
 {
-    std::ifstream in(path);
-
-    // Check that file exists
-    if (!in.is_open())
-    {
-        throw std::runtime_error("ERROR: File '" + path + "' not found.");
-    }
-
     // Read width and height
     int width = 0;
     in >> width;
@@ -173,10 +219,9 @@ Grid Zoo::load_ascii(const std::string path)
     in >> height;
 
     // Check that width/height within bounds
-    if (width < 0 || height < 0)
+    if (width < 0 || height < 0 || static_cast<long long>(width) * height > INT_MAX)
     {
-        in.close();
-        throw std::range_error("ERROR: Invalid grid shape in file '" + path + "'.");
+        throw std::range_error("ERROR: Invalid grid shape in " + source + ".");
     }
 
     // Assemble grid and fill cells
@@ -184,48 +229,107 @@ Grid Zoo::load_ascii(const std::string path)
 
     in.get(); // Ignore first newline character
 
-    char current_char = 0;
-
-    // For all grid cells
+    // For all grid rows
     for (int y = 0; y < height; y++)
     {
+        Cell *cells = new_grid.row(y);
+
+        in.read(reinterpret_cast<char *>(cells), width);
+
+        // Check every character is a cell, without branching on each one
+        bool valid = in.gcount() == width;
+
         for (int x = 0; x < width; x++)
         {
-            current_char = in.get();
-
-            if (current_char == '#')
-            {
-                new_grid(x, y) = Cell::ALIVE;
-            }
-            else if (current_char == ' ')
-            {
-                new_grid(x, y) = Cell::DEAD;
-            }
-            else
-            {
-                in.close();
-                throw std::runtime_error("ERROR: File '" + path + "' is invalid.");
-            }
+            valid &= (cells[x] == Cell::ALIVE) | (cells[x] == Cell::DEAD);
         }
 
         // Ensure expected newline is present
-        if (in.get() != '\n')
+        if (!valid || in.get() != '\n')
         {
-            in.close();
-            throw std::runtime_error("ERROR: File '" + path + "' is invalid.");
+            std::string subject = source;
+            subject[0] = std::toupper(subject[0]);
+
+            throw std::runtime_error("ERROR: " + subject + " is invalid.");
         }
     }
 
-    in.close();
-
     return new_grid;
 }
 
+/**
+ * Zoo::load_ascii(path)
+ *
+ * Load an ascii file and parse it as a grid of cells.
+ * Should be implemented using std::ifstream.
+ * The file is read through a large buffer, a whole row at a time.
+ *
+ * @example
+ *
+ *      // Load an ascii file from a directory
+ *      Grid grid = Zoo::load_ascii("path/to/file.gol");
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The parsed width or height is not a positive integer.
+ *          - Newline characters are not found when expected during parsing.
+ *          - The character for a cell is not the ALIVE or DEAD character.
+ */
+Grid Zoo::load_ascii(const std::string &path)
+{
+    std::ifstream in;
+    in.rdbuf()->pubsetbuf(ascii_buffer(), ASCII_BUFFER_SIZE);
+    in.open(path);
+
+    // Check that file exists
+    if (!in.is_open())
+    {
+        throw std::runtime_error("ERROR: File '" + path + "' not found.");
+    }
+
+    return parse_ascii(in, "file '" + path + "'");
+}
+
+/**
+ * Zoo::load_ascii(in)
+ *
+ * Parse a grid of cells from a stream in the ascii .gol format, such as the output of a decompressor.
+ *
+ * @example
+ *
+ *      // Read a board piped in to the program
+ *      Grid grid = Zoo::load_ascii(std::cin);
+ *
+ * @param in
+ *      The stream to read from, which is left positioned after the last row.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The parsed width or height is not a positive integer.
+ *          - Newline characters are not found when expected during parsing.
+ *          - The character for a cell is not the ALIVE or DEAD character.
+ */
+Grid Zoo::load_ascii(std::istream &in)
+{
+    return parse_ascii(in, "stream");
+}
+
 /**
  * Zoo::save_ascii(path, grid)
  *
  * Save a grid as an ascii .gol file according to the specified file format.
  * Should be implemented using std::ofstream.
+ * The file is written through a large buffer, a whole row at a time.
  *
  * @example
  *
@@ -247,11 +351,13 @@ Grid Zoo::load_ascii(const std::string path)
  *      The grid to be written out to file.
  *
  * @throws
- *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ *      Throws std::runtime_error or sub-class if the file cannot be opened or written to.
  */
-void Zoo::save_ascii(const std::string path, const Grid grid)
+void Zoo::save_ascii(const std::string &path, const Grid &grid)
 {
-    std::ofstream out(path);
+    std::ofstream out;
+    out.rdbuf()->pubsetbuf(ascii_buffer(), ASCII_BUFFER_SIZE);
+    out.open(path);
 
     // Check file created successfully
     if (!out.is_open())
@@ -259,186 +365,1700 @@ void Zoo::save_ascii(const std::string path, const Grid grid)
         throw std::runtime_error("ERROR: Cannot write to file '" + path + "'.");
     }
 
+    save_ascii(out, grid);
+    out.close();
+
+    if (out.fail())
+    {
+        throw std::runtime_error("ERROR: Cannot write to file '" + path + "'.");
+    }
+}
+
+/**
+ * Zoo::save_ascii(out, grid)
+ *
+ * Write a grid to a stream in the ascii .gol format, such as the input of a compressor.
+ * Each row is written in a single call, since the cell values are the characters of the format.
+ *
+ * @example
+ *
+ *      // Pipe a board out of the program
+ *      Zoo::save_ascii(std::cout, Zoo::glider());
+ *
+ * @param out
+ *      The stream to write to.
+ *
+ * @param grid
+ *      The grid to be written out.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the stream cannot be written to.
+ */
+void Zoo::save_ascii(std::ostream &out, const Grid &grid)
+{
     // Write height/width header into first line
     out << grid.get_width() << " " << grid.get_height() << "\n";
 
-    // For all grid cells, write state
+    // For all grid rows, write states
     for (int y = 0; y < grid.get_height(); y++)
     {
-        for (int x = 0; x < grid.get_width(); x++)
-        {
-            out.put(
-                grid(x, y) == Cell::ALIVE ? '#' : ' ');
-        }
-
+        out.write(reinterpret_cast<const char *>(grid.row(y)), grid.get_width());
         out.put('\n');
     }
 
-    out.close();
+    if (out.fail())
+    {
+        throw std::runtime_error("ERROR: Cannot write to stream.");
+    }
 }
 
 /**
- * Zoo::load_binary(path)
+ * parse_rle(in, source, rule)
  *
- * Load a binary file and parse it as a grid of cells.
- * Should be implemented using std::ifstream.
+ * Helper function parsing a stream in the standard Life RLE format into a grid of cells.
  *
- * @example
+ * Comment lines starting with '#' are skipped up to the "x = width, y = height[, rule = rule]" header.
+ * Without a rule in the header the pattern is taken to be B3/S23.
+ * The body is then a list of runs, each an optional count followed by a tag, up to a final '!':
+ *      - 'b' for dead cells, 'o' for alive cells, and '$' for the end of a row.
+ *      - Whitespace between runs is ignored, and cells left out at the end of a row are dead.
+ * Runs are filled a whole span at a time, so large empty spaces cost nothing to parse.
  *
- *      // Load an binary file from a directory
- *      Grid grid = Zoo::load_binary("path/to/file.bgol");
+ * @param in
+ *      The stream to read from, positioned before the header.
  *
- * @param path
- *      The std::string path to the file to read in.
+ * @param source
+ *      A lower case description of where the stream came from, for error messages.
+ *
+ * @param rule
+ *      Output for the rule named in the header, or nullptr to only accept patterns for B3/S23.
  *
  * @return
  *      Returns the parsed grid.
  *
  * @throws
  *      Throws std::runtime_error or sub-class if:
- *          - The file cannot be opened.
- *          - The file ends unexpectedly.
+ *          - The header is missing or malformed, or names an invalid rule, or a rule other than B3/S23 when
+ *            the rule is not asked for.
+ *          - The width or height is too large, or there are too many cells to index.
+ *          - The body holds an unknown tag, does not end in '!', or runs outside the declared size.
  */
-Grid Zoo::load_binary(const std::string path)
+static Grid parse_rle(std::istream &in, const std::string &source, Rule *rule)
 {
-    std::ifstream in(path, std::ios::binary);
+    std::string subject = source;
+    subject[0] = std::toupper(subject[0]);
 
-    // Check file exists
-    if (!in.is_open())
+    const std::runtime_error invalid("ERROR: " + subject + " is invalid.");
+
+    // Skip any comments to the header
+    std::string line;
+
+    while (std::getline(in, line) && (line.empty() || line[0] == '#'))
     {
-        throw std::runtime_error("ERROR: File '" + path + "' not found.");
     }
 
-    // Read width and height
-    int width = 0;
-    in.read((char *)&width, sizeof(int));
+    line.erase(std::remove_if(line.begin(), line.end(), [](unsigned char c) { return std::isspace(c); }),
+               line.end());
 
-    int height = 0;
-    in.read((char *)&height, sizeof(int));
+    long long width = -1, height = -1;
+    Rule parsed_rule;
 
-    // Check width/height within bounds
-    if (width < 0 || height < 0)
+    std::istringstream fields(line);
+    std::string field;
+
+    while (std::getline(fields, field, ','))
     {
-        in.close();
-        throw std::range_error("ERROR: Invalid grid shape in file '" + path + "'.");
-    }
+        const size_t equals = field.find('=');
+
+        if (equals == std::string::npos)
+        {
+            throw invalid;
+        }
+
+        const std::string key = field.substr(0, equals);
+        std::string value = field.substr(equals + 1);
+
+        if (key == "x" || key == "y")
+        {
+            if (value.empty() || value.size() > 10 ||
+                !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); }))
+            {
+                throw std::range_error("ERROR: Invalid grid shape in " + source + ".");
+            }
+
+            (key == "x" ? width : height) = std::stoll(value);
+        }
+        else if (key == "rule")
+        {
+            Rule parsed;
+
+            try
+            {
+                parsed = Rule::parse(value);
+            }
+            catch (const std::invalid_argument &)
+            {
+                throw std::runtime_error("ERROR: Rule '" + value + "' in " + source + " is not supported.");
+            }
 
-    // Read x bytes of cell data into buffer
-    int read_size = ceil((width * height) / 8); // Number of bytes to read (inc. padding)
-    char *buffer = new char[read_size];
+            if (!rule && parsed != Rule())
+            {
+                throw std::runtime_error("ERROR: Rule '" + value + "' in " + source + " is not supported.");
+            }
 
-    in.read(buffer, read_size + 1);
+            parsed_rule = parsed;
+        }
+    }
 
-    // Check if file ended unexpectedly
-    if (in.fail())
+    if (width < 0 || height < 0)
     {
-        delete[] buffer;
-        in.close();
-        throw std::runtime_error("ERROR: File '" + path + "' is invalid.");
+        throw invalid;
     }
 
-    in.close(); // End of file reading
+    if (width * height > INT_MAX)
+    {
+        throw std::range_error("ERROR: Invalid grid shape in " + source + ".");
+    }
 
-    // Assemble grid cell-by-cell
     Grid new_grid(width, height);
 
-    int c_index = 0;
-    bool current_bit = false;
+    long long x = 0, y = 0, count = 0;
+    char c = 0;
 
-    for (int y = 0; y < height; y++)
+    while (in.get(c) && c != '!')
     {
-        for (int x = 0; x < width; x++)
+        if (std::isdigit(static_cast<unsigned char>(c)))
+        {
+            count = 10 * count + (c - '0');
+
+            // No run can be longer than the grid is wide or tall
+            if (count > INT_MAX)
+            {
+                throw invalid;
+            }
+
+            continue;
+        }
+
+        const long long run = (count == 0) ? 1 : count;
+        count = 0;
+
+        if (c == 'b' || c == 'o')
         {
-            // Get absolute position of the cell in the grid: [0, w * h)
-            c_index = x + (y * width);
+            if (x + run > width || y >= height)
+            {
+                throw invalid;
+            }
 
-            // Retrieve jth bit (ind % 8) from the ith byte (ind / 8) in the buffer
-            current_bit = (buffer[c_index / 8] >> c_index % 8) & 1U;
+            if (c == 'o')
+            {
+                std::fill_n(new_grid.row(y) + x, run, Cell::ALIVE);
+            }
 
-            // Set cell as appropriate
-            new_grid(x, y) = current_bit == true ? Cell::ALIVE : Cell::DEAD;
+            x += run;
+        }
+        else if (c == '$')
+        {
+            x = 0;
+            y += run;
+        }
+        else if (!std::isspace(static_cast<unsigned char>(c)))
+        {
+            throw invalid;
         }
     }
 
-    delete[] buffer;
+    if (c != '!')
+    {
+        throw invalid;
+    }
+
+    if (rule)
+    {
+        *rule = parsed_rule;
+    }
 
     return new_grid;
 }
 
 /**
- * Zoo::save_binary(path, grid)
- *
- * Save a grid as an binary .bgol file according to the specified file format.
- * Should be implemented using std::ofstream.
- *
- * @example
- *
- *      // Make an 8x8 grid
- *      Grid grid(8);
+ * load_rle_file(path, rule)
  *
- *      // Save a grid to an binary file in a directory
- *      try {
- *          Zoo::save_binary("path/to/file.bgol", grid);
- *      }
- *      catch (const std::exception &ex) {
- *          std::cerr << ex.what() << std::endl;
- *      }
+ * Helper function opening a pattern file in the standard Life RLE format and parsing it with parse_rle.
  *
  * @param path
- *      The std::string path to the file to write to.
+ *      The std::string path to the file to read in.
  *
- * @param grid
- *      The grid to be written out to file.
+ * @param rule
+ *      Output for the rule named in the header, or nullptr to only accept patterns for B3/S23.
  *
- * @throws
- *      Throws std::runtime_error or sub-class if the file cannot be opened.
+ * @return
+ *      Returns the parsed grid.
  */
-void Zoo::save_binary(const std::string path, const Grid grid)
+static Grid load_rle_file(const std::string &path, Rule *rule)
 {
-    std::ofstream out(path, std::ios::binary);
-
-    // Check file was created successfully
-    if (!out.is_open())
-    {
-        throw std::runtime_error("ERROR: Cannot write to file '" + path + "'.");
-    }
-
-    // Write width and height
-    int width = grid.get_width();
-    out.write(reinterpret_cast<char *>(&width), sizeof(width));
-
-    int height = grid.get_height();
-    out.write(reinterpret_cast<char *>(&height), sizeof(height));
+    std::ifstream in;
+    in.rdbuf()->pubsetbuf(ascii_buffer(), ASCII_BUFFER_SIZE);
+    in.open(path);
 
-    // Write cell data into char array buffer
-    int read_size = ceil(width * height / 8); // Number of bytes to read (inc. padding)
-    char *buffer = new char[read_size + 1];
-
-    int c_index = 0;
-
-    // For all grid cells, save state
-    for (int y = 0; y < height; y++)
+    // Check that file exists
+    if (!in.is_open())
     {
-        for (int x = 0; x < width; x++)
-        {
-            // Grid initialises with all cells DEAD, so only write those ALIVE
-            if (grid(x, y) == Cell::ALIVE)
-            {
-                // Get absolute position of the cell in the grid: [0, w * h)
-                c_index = x + (y * width);
-
-                // Set bit to true
-                buffer[c_index / 8] = (buffer[c_index / 8] & ~(1UL << c_index % 8)) | (1UL << c_index % 8);
-            }
-        }
+        throw std::runtime_error("ERROR: File '" + path + "' not found.");
     }
 
-    // Write buffer to file
-    out.write(buffer, read_size + 1);
+    return parse_rle(in, "file '" + path + "'", rule);
+}
 
-    // Clean-up before exit
-    delete[] buffer;
-    buffer = nullptr;
+/**
+ * Zoo::load_rle(path)
+ *
+ * Load a pattern file in the standard Life RLE format as a grid of cells the size of its declared bounding box.
+ * https://www.conwaylife.com/wiki/Run_Length_Encoded
+ *
+ * @example
+ *
+ *      // Load a pattern from a library
+ *      Grid grid = Zoo::load_rle("path/to/gosper_glider_gun.rle");
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The header is missing or malformed, or names a rule other than B3/S23.
+ *          - The width or height is too large, or there are too many cells to index.
+ *          - The body holds an unknown tag, does not end in '!', or runs outside the declared size.
+ */
+Grid Zoo::load_rle(const std::string &path)
+{
+    return load_rle_file(path, nullptr);
+}
 
-    out.close();
+/**
+ * Zoo::load_rle(path, rule)
+ *
+ * Load a pattern file in the standard Life RLE format along with the rule it was made for.
+ *
+ * @example
+ *
+ *      // Load a replicator and simulate it under its own rule
+ *      Rule rule;
+ *      Grid grid = Zoo::load_rle("path/to/replicator.rle", rule);
+ *      World world(grid);
+ *      world.set_rule(rule);
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @param rule
+ *      Output for the rule named in the header, B3/S23 if it names none.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The header is missing or malformed, or names an invalid rule.
+ *          - The width or height is too large, or there are too many cells to index.
+ *          - The body holds an unknown tag, does not end in '!', or runs outside the declared size.
+ */
+Grid Zoo::load_rle(const std::string &path, Rule &rule)
+{
+    return load_rle_file(path, &rule);
+}
+
+/**
+ * Zoo::load_rle(in)
+ *
+ * Parse a grid of cells from a stream in the standard Life RLE format.
+ *
+ * @example
+ *
+ *      // Read a pattern pasted in to the program
+ *      Grid grid = Zoo::load_rle(std::cin);
+ *
+ * @param in
+ *      The stream to read from, which is left positioned after the final '!'.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The header is missing or malformed, or names a rule other than B3/S23.
+ *          - The width or height is too large, or there are too many cells to index.
+ *          - The body holds an unknown tag, does not end in '!', or runs outside the declared size.
+ */
+Grid Zoo::load_rle(std::istream &in)
+{
+    return parse_rle(in, "stream", nullptr);
+}
+
+/**
+ * Zoo::save_rle(path, grid, rule)
+ *
+ * Save a grid as a pattern file in the standard Life RLE format.
+ *
+ * @example
+ *
+ *      // Save a glider to share with other Life programs
+ *      Zoo::save_rle("path/to/glider.rle", Zoo::glider());
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The grid to be written out to file.
+ *
+ * @param rule
+ *      Optional parameter. The rule to name in the header. Defaults to B3/S23.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened or written to.
+ */
+void Zoo::save_rle(const std::string &path, const Grid &grid, const Rule &rule)
+{
+    std::ofstream out;
+    out.rdbuf()->pubsetbuf(ascii_buffer(), ASCII_BUFFER_SIZE);
+    out.open(path);
+
+    // Check file created successfully
+    if (!out.is_open())
+    {
+        throw std::runtime_error("ERROR: Cannot write to file '" + path + "'.");
+    }
+
+    save_rle(out, grid, rule);
+    out.close();
+
+    if (out.fail())
+    {
+        throw std::runtime_error("ERROR: Cannot write to file '" + path + "'.");
+    }
+}
+
+/**
+ * Zoo::save_rle(out, grid, rule)
+ *
+ * Write a grid to a stream in the standard Life RLE format.
+ * Trailing dead cells of each row and trailing empty rows are left out, runs of empty rows are merged
+ * into a single count, and lines are wrapped at 70 characters.
+ *
+ * @example
+ *
+ *      // Print a pattern to paste in to another Life program
+ *      Zoo::save_rle(std::cout, Zoo::r_pentomino());
+ *
+ * @param out
+ *      The stream to write to.
+ *
+ * @param grid
+ *      The grid to be written out.
+ *
+ * @param rule
+ *      Optional parameter. The rule to name in the header. Defaults to B3/S23.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the stream cannot be written to.
+ */
+void Zoo::save_rle(std::ostream &out, const Grid &grid, const Rule &rule)
+{
+    const int max_line_length = 70;
+
+    out << "x = " << grid.get_width() << ", y = " << grid.get_height() << ", rule = " << rule.to_string() << "\n";
+
+    std::string line;
+
+    const auto add_run = [&](int count, char tag) {
+        const std::string run = (count > 1 ? std::to_string(count) : "") + tag;
+
+        if (line.size() + run.size() > max_line_length)
+        {
+            out << line << '\n';
+            line.clear();
+        }
+
+        line += run;
+    };
+
+    int written_rows = 0;
+
+    for (int y = 0; y < grid.get_height(); y++)
+    {
+        const Cell *cells = grid.row(y);
+        int end = grid.get_width();
+
+        while (end > 0 && cells[end - 1] == Cell::DEAD)
+        {
+            end--;
+        }
+
+        if (end == 0)
+        {
+            continue;
+        }
+
+        // End every row since the last one written, including any empty ones between
+        if (y > written_rows)
+        {
+            add_run(y - written_rows, '$');
+        }
+
+        for (int x = 0; x < end;)
+        {
+            int run_end = x + 1;
+
+            while (run_end < end && cells[run_end] == cells[x])
+            {
+                run_end++;
+            }
+
+            add_run(run_end - x, (cells[x] == Cell::ALIVE) ? 'o' : 'b');
+            x = run_end;
+        }
+
+        written_rows = y;
+    }
+
+    add_run(1, '!');
+    out << line << '\n';
+
+    if (out.fail())
+    {
+        throw std::runtime_error("ERROR: Cannot write to stream.");
+    }
+}
+
+/**
+ * Zoo::load_macrocell(path)
+ *
+ * Load a pattern file in Golly's macrocell format straight into the quadtree of a HashlifeWorld,
+ * without ever expanding it into a Grid. The default viewport of the world is the pattern's bounding box.
+ * https://www.conwaylife.com/wiki/Macrocell
+ *
+ * @example
+ *
+ *      // Load a huge pattern and see where it ends up after a billion generations
+ *      HashlifeWorld world = Zoo::load_macrocell("path/to/metapixel.mc");
+ *      world.advance(1000000000);
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @return
+ *      Returns a world holding the parsed pattern.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened, or is not a valid
+ *      B3/S23 macrocell pattern.
+ */
+HashlifeWorld Zoo::load_macrocell(const std::string &path)
+{
+    std::ifstream in;
+    in.rdbuf()->pubsetbuf(ascii_buffer(), ASCII_BUFFER_SIZE);
+    in.open(path);
+
+    // Check that file exists
+    if (!in.is_open())
+    {
+        throw std::runtime_error("ERROR: File '" + path + "' not found.");
+    }
+
+    return load_macrocell(in);
+}
+
+/**
+ * Zoo::load_macrocell(in)
+ *
+ * Parse a pattern from a stream in Golly's macrocell format straight into the quadtree of a HashlifeWorld.
+ *
+ * @example
+ *
+ *      // Read a pattern piped in to the program
+ *      HashlifeWorld world = Zoo::load_macrocell(std::cin);
+ *
+ * @param in
+ *      The stream to read from, which is read to the end.
+ *
+ * @return
+ *      Returns a world holding the parsed pattern.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the stream is not a valid B3/S23 macrocell pattern.
+ */
+HashlifeWorld Zoo::load_macrocell(std::istream &in)
+{
+    HashlifeWorld world;
+    world.read_macrocell(in);
+
+    return world;
+}
+
+/**
+ * Zoo::save_macrocell(path, world)
+ *
+ * Save the whole plane of a HashlifeWorld as a pattern file in Golly's macrocell format.
+ *
+ * @example
+ *
+ *      // Save a world after running it, to carry on later
+ *      Zoo::save_macrocell("path/to/pattern.mc", world);
+ *
+ *      // Grids can be saved by building a world from them first
+ *      Zoo::save_macrocell("path/to/glider.mc", HashlifeWorld(Zoo::glider()));
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param world
+ *      The world to be written out to file.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened or written to.
+ */
+void Zoo::save_macrocell(const std::string &path, const HashlifeWorld &world)
+{
+    std::ofstream out;
+    out.rdbuf()->pubsetbuf(ascii_buffer(), ASCII_BUFFER_SIZE);
+    out.open(path);
+
+    // Check file created successfully
+    if (!out.is_open())
+    {
+        throw std::runtime_error("ERROR: Cannot write to file '" + path + "'.");
+    }
+
+    save_macrocell(out, world);
+    out.close();
+
+    if (out.fail())
+    {
+        throw std::runtime_error("ERROR: Cannot write to file '" + path + "'.");
+    }
+}
+
+/**
+ * Zoo::save_macrocell(out, world)
+ *
+ * Write the whole plane of a HashlifeWorld to a stream in Golly's macrocell format.
+ *
+ * @example
+ *
+ *      // Print the quadtree of a world
+ *      Zoo::save_macrocell(std::cout, world);
+ *
+ * @param out
+ *      The stream to write to.
+ *
+ * @param world
+ *      The world to be written out.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the stream cannot be written to.
+ */
+void Zoo::save_macrocell(std::ostream &out, const HashlifeWorld &world)
+{
+    world.write_macrocell(out);
+
+    if (out.fail())
+    {
+        throw std::runtime_error("ERROR: Cannot write to stream.");
+    }
+}
+
+// The magic number opening every v2 binary file, before its version
+static const char BINARY_MAGIC[4] = {'B', 'G', 'O', 'L'};
+static const uint32_t BINARY_VERSION = 2;
+
+// Side length of the tiles written to v2 binary files, a multiple of 64 so tiles start on a PackedGrid word
+static const int BINARY_TILE_SIZE = 256;
+
+// The ways a v2 tile block can be encoded
+static const uint32_t ENCODING_RAW = 0;
+static const uint32_t ENCODING_RLE = 1;
+
+/**
+ * The header and tile index of a v2 binary file.
+ * Tiles holding no alive cells have no entry. Entries may come in any order, but are ordered row by row in files
+ * saved from a single Grid.
+ */
+struct BinaryIndex
+{
+    using Entry = Zoo::BinaryTile;
+
+    int width;
+    int height;
+    int tile_size;
+    std::vector<Entry> entries;
+};
+
+/**
+ * read_u32(data), read_u64(data)
+ *
+ * Helper functions reading a little endian unsigned integer from any byte, whatever the host byte order.
+ *
+ * @param data
+ *      The first byte of the integer.
+ *
+ * @return
+ *      The integer read.
+ */
+static inline uint32_t read_u32(const unsigned char *data)
+{
+    return static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 |
+           static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+}
+
+static inline uint64_t read_u64(const unsigned char *data)
+{
+    return static_cast<uint64_t>(read_u32(data)) | static_cast<uint64_t>(read_u32(data + 4)) << 32;
+}
+
+/**
+ * write_u32(out, value), write_u64(out, value)
+ *
+ * Helper functions writing an unsigned integer to a stream in little endian order, whatever the host byte order.
+ *
+ * @param out
+ *      The stream to write to.
+ *
+ * @param value
+ *      The integer to write.
+ */
+static void write_u32(std::ostream &out, uint32_t value)
+{
+    const char bytes[4] = {static_cast<char>(value), static_cast<char>(value >> 8),
+                           static_cast<char>(value >> 16), static_cast<char>(value >> 24)};
+
+    out.write(bytes, sizeof(bytes));
+}
+
+static void write_u64(std::ostream &out, uint64_t value)
+{
+    write_u32(out, static_cast<uint32_t>(value));
+    write_u32(out, static_cast<uint32_t>(value >> 32));
+}
+
+/**
+ * read_binary_header(file, path, width, height)
+ *
+ * Helper function reading and validating the header of a mapped v1 binary file, checking that the file is
+ * long enough to hold a bit for every cell.
+ *
+ * @param file
+ *      The mapped binary file.
+ *
+ * @param path
+ *      The path the file was mapped from, for error messages.
+ *
+ * @param width
+ *      Output width of the grid.
+ *
+ * @param height
+ *      Output height of the grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file ends before the end of the header or the cell data.
+ *          - The width or height is negative, or there are too many cells to index.
+ */
+static void read_binary_header(const MappedFile &file, const std::string &path, int &width, int &height)
+{
+    if (file.get_size() < 2 * sizeof(int))
+    {
+        throw std::runtime_error("ERROR: File '" + path + "' is invalid.");
+    }
+
+    std::memcpy(&width, file.get_data(), sizeof(int));
+    std::memcpy(&height, file.get_data() + sizeof(int), sizeof(int));
+
+    // Check width/height within bounds
+    if (width < 0 || height < 0 || static_cast<long long>(width) * height > INT_MAX)
+    {
+        throw std::range_error("ERROR: Invalid grid shape in file '" + path + "'.");
+    }
+
+    // Check the file is long enough for every cell
+    if (file.get_size() - 2 * sizeof(int) < (static_cast<size_t>(width) * height + 7) / 8)
+    {
+        throw std::runtime_error("ERROR: File '" + path + "' is invalid.");
+    }
+}
+
+/**
+ * is_binary_v2(file)
+ *
+ * Helper function detecting whether a mapped binary file is in the v2 format.
+ * A v1 file can never be mistaken for one, as the magic number and version read as a v1 header
+ * would make a grid with too many cells to index.
+ *
+ * @param file
+ *      The mapped binary file.
+ *
+ * @return
+ *      True if the file opens with the v2 magic number and version, false otherwise.
+ */
+static bool is_binary_v2(const MappedFile &file)
+{
+    return file.get_size() >= 8 &&
+           std::memcmp(file.get_data(), BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0 &&
+           read_u32(file.get_data() + 4) == BINARY_VERSION;
+}
+
+/**
+ * read_binary_index(file, path)
+ *
+ * Helper function reading and validating the header and tile index of a mapped v2 binary file.
+ * The blocks themselves are only checked to lie within the file, and are not decoded.
+ *
+ * @param file
+ *      The mapped binary file.
+ *
+ * @param path
+ *      The path the file was mapped from, for error messages.
+ *
+ * @return
+ *      The header and tile index of the file.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file ends before the end of the header or the tile index.
+ *          - The width or height does not fit in an int, or the tile size is not a positive multiple of 64.
+ *          - An entry names a tile outside the grid, a block outside the file, or an unknown encoding.
+ */
+static BinaryIndex read_binary_index(const MappedFile &file, const std::string &path)
+{
+    const unsigned char *data = file.get_data();
+    const size_t size = file.get_size();
+
+    if (size < Zoo::BINARY_HEADER_SIZE)
+    {
+        throw std::runtime_error("ERROR: File '" + path + "' is invalid.");
+    }
+
+    const uint32_t width = read_u32(data + 8);
+    const uint32_t height = read_u32(data + 12);
+    const uint32_t tile_size = read_u32(data + 16);
+    const uint32_t tile_count = read_u32(data + 20);
+
+    if (width > INT_MAX || height > INT_MAX)
+    {
+        throw std::range_error("ERROR: Invalid grid shape in file '" + path + "'.");
+    }
+
+    if (tile_size == 0 || tile_size % 64 != 0 || tile_size > INT_MAX)
+    {
+        throw std::runtime_error("ERROR: File '" + path + "' is invalid.");
+    }
+
+    const uint64_t tiles_x = (static_cast<uint64_t>(width) + tile_size - 1) / tile_size;
+    const uint64_t tiles_y = (static_cast<uint64_t>(height) + tile_size - 1) / tile_size;
+
+    // Check the index fits in the file, before trusting the tile count for an allocation
+    const uint64_t blocks_start =
+            Zoo::BINARY_HEADER_SIZE + static_cast<uint64_t>(tile_count) * Zoo::BINARY_ENTRY_SIZE;
+
+    if (tile_count > tiles_x * tiles_y || blocks_start > size)
+    {
+        throw std::runtime_error("ERROR: File '" + path + "' is invalid.");
+    }
+
+    BinaryIndex index;
+    index.width = width;
+    index.height = height;
+    index.tile_size = tile_size;
+    index.entries.resize(tile_count);
+
+    for (uint32_t i = 0; i < tile_count; i++)
+    {
+        const unsigned char *entry = data + Zoo::BINARY_HEADER_SIZE + i * Zoo::BINARY_ENTRY_SIZE;
+
+        const uint32_t tile_x = read_u32(entry);
+        const uint32_t tile_y = read_u32(entry + 4);
+        const uint64_t offset = read_u64(entry + 8);
+        const uint32_t block_size = read_u32(entry + 16);
+        const uint32_t encoding = read_u32(entry + 20);
+
+        if (tile_x >= tiles_x || tile_y >= tiles_y || offset < blocks_start || offset > size ||
+            block_size > size - offset || (encoding != ENCODING_RAW && encoding != ENCODING_RLE))
+        {
+            throw std::runtime_error("ERROR: File '" + path + "' is invalid.");
+        }
+
+        index.entries[i] = {static_cast<int>(tile_x), static_cast<int>(tile_y), offset, block_size, encoding};
+    }
+
+    return index;
+}
+
+/**
+ * rle_encode(input, output)
+ *
+ * Helper function compressing bytes with run length encoding, in the style of PackBits.
+ * Each run opens with a control byte c:
+ *      - If c < 128, the next c + 1 bytes are copied as they are.
+ *      - Otherwise, the next byte is repeated c - 125 times, so runs of 3 to 130 bytes can be stored in 2.
+ *
+ * @param input
+ *      The bytes to compress.
+ *
+ * @param output
+ *      Output compressed bytes, replacing any previous contents.
+ */
+static void rle_encode(const std::pmr::vector<unsigned char> &input, std::pmr::vector<unsigned char> &output)
+{
+    output.clear();
+
+    const size_t size = input.size();
+    size_t i = 0;
+
+    while (i < size)
+    {
+        size_t run = 1;
+
+        while (i + run < size && run < 130 && input[i + run] == input[i])
+        {
+            run++;
+        }
+
+        if (run >= 3)
+        {
+            output.push_back(static_cast<unsigned char>(run + 125));
+            output.push_back(input[i]);
+            i += run;
+            continue;
+        }
+
+        // Copy bytes as they are up to the next run worth encoding
+        size_t end = i;
+
+        while (end < size && end - i < 128 &&
+               !(end + 2 < size && input[end] == input[end + 1] && input[end] == input[end + 2]))
+        {
+            end++;
+        }
+
+        output.push_back(static_cast<unsigned char>(end - i - 1));
+        output.insert(output.end(), input.begin() + i, input.begin() + end);
+        i = end;
+    }
+}
+
+/**
+ * rle_decode(input, size, output, expected, path)
+ *
+ * Helper function decompressing bytes written by rle_encode, checking it produces exactly the expected
+ * number of bytes without reading or writing out of bounds.
+ *
+ * @param input
+ *      The first compressed byte.
+ *
+ * @param size
+ *      The number of compressed bytes.
+ *
+ * @param output
+ *      Output buffer for the decompressed bytes.
+ *
+ * @param expected
+ *      The number of bytes the block should decompress to, which the output buffer must hold.
+ *
+ * @param path
+ *      The path the block was read from, for error messages.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the block is truncated or decompresses to the wrong size.
+ */
+static void rle_decode(const unsigned char *input, size_t size, unsigned char *output, size_t expected,
+                       const std::string &path)
+{
+    size_t in = 0, out = 0;
+
+    while (in < size)
+    {
+        const unsigned char control = input[in++];
+
+        if (control < 128)
+        {
+            const size_t count = control + 1;
+
+            if (count > size - in || count > expected - out)
+            {
+                throw std::runtime_error("ERROR: File '" + path + "' is invalid.");
+            }
+
+            std::memcpy(output + out, input + in, count);
+            in += count;
+            out += count;
+        }
+        else
+        {
+            const size_t count = control - 125;
+
+            if (in == size || count > expected - out)
+            {
+                throw std::runtime_error("ERROR: File '" + path + "' is invalid.");
+            }
+
+            std::memset(output + out, input[in++], count);
+            out += count;
+        }
+    }
+
+    if (out != expected)
+    {
+        throw std::runtime_error("ERROR: File '" + path + "' is invalid.");
+    }
+}
+
+/**
+ * decode_tiles(file, path, index, x0, y0, x1, y1, visit)
+ *
+ * Helper function decoding only the tiles of a v2 binary file that intersect the region [x0, x1) by [y0, y1),
+ * passing each to a visitor. Raw blocks are passed straight from the mapping without being copied.
+ *
+ * @param visit
+ *      Called with the left and top coordinate, width and height of each decoded tile, followed by its bits,
+ *      stored row by row with ceil(width / 8) bytes per row and cell x of a row in bit x % 8 of byte x / 8.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if a block is invalid.
+ */
+template <typename Visitor>
+static void decode_tiles(const MappedFile &file, const std::string &path, const BinaryIndex &index,
+                         int x0, int y0, int x1, int y1, Visitor visit)
+{
+    std::pmr::vector<unsigned char> buffer(Memory::get_scratch_resource());
+
+    for (const BinaryIndex::Entry &entry : index.entries)
+    {
+        const long long tile_x0 = static_cast<long long>(entry.tile_x) * index.tile_size;
+        const long long tile_y0 = static_cast<long long>(entry.tile_y) * index.tile_size;
+
+        if (tile_x0 >= x1 || tile_y0 >= y1 || tile_x0 + index.tile_size <= x0 || tile_y0 + index.tile_size <= y0)
+        {
+            continue;
+        }
+
+        const int width = std::min<long long>(index.tile_size, index.width - tile_x0);
+        const int height = std::min<long long>(index.tile_size, index.height - tile_y0);
+        const size_t expected = static_cast<size_t>((width + 7) / 8) * height;
+
+        const unsigned char *block = file.get_data() + entry.offset;
+
+        if (entry.encoding == ENCODING_RAW)
+        {
+            if (entry.size != expected)
+            {
+                throw std::runtime_error("ERROR: File '" + path + "' is invalid.");
+            }
+        }
+        else
+        {
+            buffer.resize(expected);
+            rle_decode(block, entry.size, buffer.data(), expected, path);
+            block = buffer.data();
+        }
+
+        visit(static_cast<int>(tile_x0), static_cast<int>(tile_y0), width, height, block);
+    }
+}
+
+/**
+ * read_bits(data, size, bit, count)
+ *
+ * Helper function reading up to 64 consecutive bits from a little endian bit stream, starting at any bit.
+ * Whole words are read at a time, only falling back to reading byte by byte near the end of the stream.
+ *
+ * @param data
+ *      The first byte of the bit stream.
+ *
+ * @param size
+ *      The number of bytes in the bit stream.
+ *
+ * @param bit
+ *      The index of the first bit to read.
+ *
+ * @param count
+ *      The number of bits to read, from 1 to 64.
+ *
+ * @return
+ *      The bits read, with the first in bit 0 and any bits past count set to 0.
+ */
+static inline uint64_t read_bits(const unsigned char *data, size_t size, uint64_t bit, int count)
+{
+    const size_t first = bit / 8;
+    const int shift = bit % 8;
+
+    uint64_t word = 0;
+
+    if (first + 9 <= size)
+    {
+        std::memcpy(&word, data + first, sizeof(word));
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+
+        word >>= shift;
+
+        if (shift != 0)
+        {
+            word |= static_cast<uint64_t>(data[first + 8]) << (64 - shift);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < 9 && first + i < size; i++)
+        {
+            const uint64_t byte = data[first + i];
+
+            if (i < 8)
+            {
+                word |= (byte << (8 * i)) >> shift;
+            }
+            else if (shift != 0)
+            {
+                word |= byte << (64 - shift);
+            }
+        }
+    }
+
+    return count < 64 ? word & ((1ULL << count) - 1) : word;
+}
+
+/**
+ * expand_bits(data, size, bit, count, cells)
+ *
+ * Helper function expanding consecutive bits of a little endian bit stream into cells, starting at any bit.
+ * The bits are read a word at a time, and each byte of 8 cells is expanded with a lookup table.
+ *
+ * @param data
+ *      The first byte of the bit stream.
+ *
+ * @param size
+ *      The number of bytes in the bit stream.
+ *
+ * @param bit
+ *      The index of the first bit to expand.
+ *
+ * @param count
+ *      The number of bits to expand.
+ *
+ * @param cells
+ *      Output run of count cells.
+ */
+static void expand_bits(const unsigned char *data, size_t size, uint64_t bit, int count, Cell *cells)
+{
+    // The 8 cells of every possible byte, bit 0 first
+    static const std::vector<std::array<Cell, 8>> expansions = [] {
+        std::vector<std::array<Cell, 8>> table(256);
+
+        for (int byte = 0; byte < 256; byte++)
+        {
+            for (int i = 0; i < 8; i++)
+            {
+                table[byte][i] = ((byte >> i) & 1) ? Cell::ALIVE : Cell::DEAD;
+            }
+        }
+
+        return table;
+    }();
+
+    for (int x = 0; x < count; x += 64)
+    {
+        const int word_count = std::min(64, count - x);
+        const uint64_t word = read_bits(data, size, bit + x, word_count);
+
+        for (int i = 0; i < word_count; i += 8)
+        {
+            std::memcpy(cells + x + i, expansions[(word >> i) & 0xFF].data(), std::min(8, word_count - i));
+        }
+    }
+}
+
+/**
+ * Zoo::load_binary(path)
+ *
+ * Load a binary file and parse it as a grid of cells, detecting whether it is in the v1 or v2 format.
+ *
+ * The file is memory mapped rather than read into a buffer, so it is never held in memory twice.
+ * The cell data is decoded a word at a time, expanding each byte of 8 cells with a lookup table.
+ *
+ * @example
+ *
+ *      // Load an binary file from a directory
+ *      Grid grid = Zoo::load_binary("path/to/file.bgol");
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The parsed width or height is negative, or there are too many cells to index.
+ *          - The file ends unexpectedly, or a v2 tile block is invalid.
+ */
+Grid Zoo::load_binary(const std::string &path)
+{
+    const MappedFile file(path);
+
+    if (is_binary_v2(file))
+    {
+        const BinaryIndex index = read_binary_index(file, path);
+
+        if (static_cast<long long>(index.width) * index.height > INT_MAX)
+        {
+            throw std::range_error("ERROR: Invalid grid shape in file '" + path + "'.");
+        }
+
+        Grid new_grid(index.width, index.height);
+
+        decode_tiles(file, path, index, 0, 0, index.width, index.height,
+                     [&](int tile_x0, int tile_y0, int width, int height, const unsigned char *bits) {
+                         const size_t row_bytes = (width + 7) / 8;
+
+                         for (int y = 0; y < height; y++)
+                         {
+                             expand_bits(bits + y * row_bytes, row_bytes, 0, width,
+                                         new_grid.row(tile_y0 + y) + tile_x0);
+                         }
+                     });
+
+        return new_grid;
+    }
+
+    int width = 0, height = 0;
+    read_binary_header(file, path, width, height);
+
+    const unsigned char *data = file.get_data() + 2 * sizeof(int);
+    const size_t size = file.get_size() - 2 * sizeof(int);
+
+    Grid new_grid(width, height);
+
+    for (int y = 0; y < height; y++)
+    {
+        // Rows are not aligned in the file, so each row starts wherever the last finished
+        expand_bits(data, size, static_cast<uint64_t>(y) * width, width, new_grid.row(y));
+    }
+
+    return new_grid;
+}
+
+/**
+ * Zoo::load_binary_packed(path)
+ *
+ * Load a binary file straight into a bit-packed grid, without ever expanding it to a byte per cell,
+ * detecting whether it is in the v1 or v2 format.
+ * The file is memory mapped, and each 64 bit word of a row is read from the bit stream in one go.
+ *
+ * @example
+ *
+ *      // Load a huge board and simulate it with the packed engine
+ *      PackedGrid grid = Zoo::load_binary_packed("path/to/file.bgol");
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @return
+ *      Returns the parsed grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The parsed width or height is negative, or there are too many cells to index.
+ *          - The file ends unexpectedly, or a v2 tile block is invalid.
+ */
+PackedGrid Zoo::load_binary_packed(const std::string &path)
+{
+    const MappedFile file(path);
+
+    if (is_binary_v2(file))
+    {
+        const BinaryIndex index = read_binary_index(file, path);
+
+        if (static_cast<long long>(index.width) * index.height > INT_MAX)
+        {
+            throw std::range_error("ERROR: Invalid grid shape in file '" + path + "'.");
+        }
+
+        PackedGrid new_grid(index.width, index.height);
+
+        // Tiles are a multiple of 64 cells wide, so each starts on a word of the packed row
+        decode_tiles(file, path, index, 0, 0, index.width, index.height,
+                     [&](int tile_x0, int tile_y0, int width, int height, const unsigned char *bits) {
+                         const size_t row_bytes = (width + 7) / 8;
+
+                         for (int y = 0; y < height; y++)
+                         {
+                             uint64_t *words = new_grid.row(tile_y0 + y) + tile_x0 / 64;
+
+                             for (int i = 0; 64 * i < width; i++)
+                             {
+                                 words[i] = read_bits(bits + y * row_bytes, row_bytes, 64 * i,
+                                                      std::min(64, width - 64 * i));
+                             }
+                         }
+                     });
+
+        return new_grid;
+    }
+
+    int width = 0, height = 0;
+    read_binary_header(file, path, width, height);
+
+    const unsigned char *data = file.get_data() + 2 * sizeof(int);
+    const size_t size = file.get_size() - 2 * sizeof(int);
+
+    PackedGrid new_grid(width, height);
+
+    for (int y = 0; y < height; y++)
+    {
+        uint64_t *words = new_grid.row(y);
+        const uint64_t row_bit = static_cast<uint64_t>(y) * width;
+
+        // Bits past the width are left 0, keeping the padding clear
+        for (int i = 0; i < new_grid.get_words_per_row(); i++)
+        {
+            words[i] = read_bits(data, size, row_bit + 64 * i, std::min(64, width - 64 * i));
+        }
+    }
+
+    return new_grid;
+}
+
+/**
+ * Zoo::load_binary_region(path, x0, y0, x1, y1)
+ *
+ * Load only the region [x0, x1) by [y0, y1) of a binary file, detecting whether it is in the v1 or v2 format.
+ * Only the tiles of a v2 file that intersect the region are decompressed, so small windows can be read from
+ * boards far too large to load whole.
+ *
+ * @example
+ *
+ *      // Load the 100x100 square at the centre of a 1,000,000x1,000,000 board
+ *      Grid window = Zoo::load_binary_region("path/to/file.bgol", 499950, 499950, 500050, 500050);
+ *
+ * @param path
+ *      The std::string path to the file to read in.
+ *
+ * @param x0
+ *      Left coordinate of the region on x-axis.
+ *
+ * @param y0
+ *      Top coordinate of the region on y-axis.
+ *
+ * @param x1
+ *      Right coordinate of the region on x-axis (1 greater than the largest index).
+ *
+ * @param y1
+ *      Bottom coordinate of the region on y-axis (1 greater than the largest index).
+ *
+ * @return
+ *      Returns a grid of the region's size, with cell (0, 0) at (x0, y0) in the file.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if:
+ *          - The file cannot be opened.
+ *          - The parsed width or height is negative.
+ *          - The file ends unexpectedly, or a v2 tile block is invalid.
+ *          - The region falls outside the grid, has a negative size, or has too many cells to index.
+ */
+Grid Zoo::load_binary_region(const std::string &path, int x0, int y0, int x1, int y1)
+{
+    const MappedFile file(path);
+
+    const bool is_v2 = is_binary_v2(file);
+    BinaryIndex index;
+
+    if (is_v2)
+    {
+        index = read_binary_index(file, path);
+    }
+    else
+    {
+        read_binary_header(file, path, index.width, index.height);
+    }
+
+    if (x0 < 0 || y0 < 0 || x1 < x0 || y1 < y0 || x1 > index.width || y1 > index.height)
+    {
+        throw std::out_of_range("ERROR: Requested region is out of bounds.");
+    }
+
+    if (static_cast<long long>(x1 - x0) * (y1 - y0) > INT_MAX)
+    {
+        throw std::range_error("ERROR: Requested region is too large.");
+    }
+
+    Grid new_grid(x1 - x0, y1 - y0);
+
+    if (is_v2)
+    {
+        decode_tiles(file, path, index, x0, y0, x1, y1,
+                     [&](int tile_x0, int tile_y0, int width, int height, const unsigned char *bits) {
+                         const size_t row_bytes = (width + 7) / 8;
+
+                         // Clip the tile to the region
+                         const int left = std::max(x0, tile_x0), right = std::min(x1, tile_x0 + width);
+                         const int top = std::max(y0, tile_y0), bottom = std::min(y1, tile_y0 + height);
+
+                         for (int y = top; y < bottom; y++)
+                         {
+                             expand_bits(bits + (y - tile_y0) * row_bytes, row_bytes, left - tile_x0, right - left,
+                                         new_grid.row(y - y0) + (left - x0));
+                         }
+                     });
+    }
+    else
+    {
+        const unsigned char *data = file.get_data() + 2 * sizeof(int);
+        const size_t size = file.get_size() - 2 * sizeof(int);
+
+        for (int y = y0; y < y1; y++)
+        {
+            expand_bits(data, size, static_cast<uint64_t>(y) * index.width + x0, x1 - x0, new_grid.row(y - y0));
+        }
+    }
+
+    return new_grid;
+}
+
+/**
+ * save_binary_v2(out, grid)
+ *
+ * Helper function writing a grid to a stream in the v2 binary format.
+ *
+ * The whole grid is encoded as a single part first, so the index can be written before the blocks with the
+ * offsets of every block already known.
+ *
+ * @param out
+ *      The stream to write to.
+ *
+ * @param grid
+ *      The grid to be written out.
+ */
+static void save_binary_v2(std::ostream &out, const Grid &grid)
+{
+    const Zoo::BinaryPart part =
+            Zoo::encode_binary_part(grid, 0, 0, grid.get_width(), grid.get_height(), BINARY_TILE_SIZE);
+
+    Zoo::write_binary_header(out, grid.get_width(), grid.get_height(), BINARY_TILE_SIZE, part.tiles.size());
+    Zoo::write_binary_index(out, part, Zoo::BINARY_HEADER_SIZE + part.tiles.size() * Zoo::BINARY_ENTRY_SIZE);
+    out.write(part.blocks.data(), part.blocks.size());
+}
+
+/**
+ * Zoo::save_binary(path, grid, format)
+ *
+ * Save a grid as an binary .bgol file according to the specified file format.
+ * Should be implemented using std::ofstream.
+ *
+ * @example
+ *
+ *      // Make an 8x8 grid
+ *      Grid grid(8);
+ *
+ *      // Save a grid to an binary file in a directory
+ *      try {
+ *          Zoo::save_binary("path/to/file.bgol", grid);
+ *      }
+ *      catch (const std::exception &ex) {
+ *          std::cerr << ex.what() << std::endl;
+ *      }
+ *
+ *      // Save a mostly empty grid compressed, so only the tiles holding alive cells take up space
+ *      Zoo::save_binary("path/to/file.bgol", grid, Zoo::BinaryFormat::V2);
+ *
+ * @param path
+ *      The std::string path to the file to write to.
+ *
+ * @param grid
+ *      The grid to be written out to file.
+ *
+ * @param format
+ *      The version of the binary format to write, defaulting to BinaryFormat::V1.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened or written.
+ */
+void Zoo::save_binary(const std::string &path, const Grid &grid, BinaryFormat format)
+{
+    std::ofstream out(path, std::ios::binary);
+
+    // Check file was created successfully
+    if (!out.is_open())
+    {
+        throw std::runtime_error("ERROR: Cannot write to file '" + path + "'.");
+    }
+
+    if (format == BinaryFormat::V2)
+    {
+        save_binary_v2(out, grid);
+    }
+    else
+    {
+        // Write width and height
+        int width = grid.get_width();
+        out.write(reinterpret_cast<char *>(&width), sizeof(width));
+
+        int height = grid.get_height();
+        out.write(reinterpret_cast<char *>(&height), sizeof(height));
+
+        // Write cell data into char array buffer
+        int read_size = ceil(width * height / 8); // Number of bytes to read (inc. padding)
+        char *buffer = new char[read_size + 1](); // Zeroed, as only the alive bits are set
+
+        int c_index = 0;
+
+        // For all grid cells, save state
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                // Grid initialises with all cells DEAD, so only write those ALIVE
+                if (grid(x, y) == Cell::ALIVE)
+                {
+                    // Get absolute position of the cell in the grid: [0, w * h)
+                    c_index = x + (y * width);
+
+                    // Set bit to true
+                    buffer[c_index / 8] = (buffer[c_index / 8] & ~(1UL << c_index % 8)) | (1UL << c_index % 8);
+                }
+            }
+        }
+
+        // Write buffer to file
+        out.write(buffer, read_size + 1);
+
+        // Clean-up before exit
+        delete[] buffer;
+        buffer = nullptr;
+    }
+
+    if (out.fail())
+    {
+        throw std::runtime_error("ERROR: Cannot write to file '" + path + "'.");
+    }
+
+    out.close();
+}
+
+/**
+ * Zoo::read_binary_size(path, width, height)
+ *
+ * Read the width and height of the grid held in a binary file, detecting whether it is in the v1 or v2 format,
+ * without loading any cells. Used to size a board before each process loads its own region of it.
+ *
+ * @example
+ *
+ *      // Find the size of a board too large to load whole
+ *      int width, height;
+ *      Zoo::read_binary_size("path/to/file.bgol", width, height);
+ *
+ * @param path
+ *      The std::string path to the file to read.
+ *
+ * @param width
+ *      Output width of the grid.
+ *
+ * @param height
+ *      Output height of the grid.
+ *
+ * @throws
+ *      Throws std::runtime_error or sub-class if the file cannot be opened, or its header or tile index is invalid.
+ */
+void Zoo::read_binary_size(const std::string &path, int &width, int &height)
+{
+    const MappedFile file(path);
+
+    if (is_binary_v2(file))
+    {
+        const BinaryIndex index = read_binary_index(file, path);
+        width = index.width;
+        height = index.height;
+    }
+    else
+    {
+        read_binary_header(file, path, width, height);
+    }
+}
+
+/**
+ * Zoo::encode_binary_part(region, x0, y0, width, height, tile_size)
+ *
+ * Encode the tiles of a region of a board holding alive cells as the blocks of a v2 binary file.
+ * Each tile is run length encoded, falling back to storing it raw if that would be smaller, and its offset is
+ * counted from the start of the blocks of the part, to be moved into place by Zoo::write_binary_index.
+ *
+ * The region must be made of whole tiles, starting on a multiple of the tile size and ending on one or on the edge
+ * of the board, so that the parts of a board split along tile edges never share a tile.
+ *
+ * @example
+ *
+ *      // Encode the 512x256 region at (1024, 768) of a board, along with the index entries of its tiles
+ *      Zoo::BinaryPart part = Zoo::encode_binary_part(region, 1024, 768, board_width, board_height, 256);
+ *
+ * @param region
+ *      The cells of the region.
+ *
+ * @param x0
+ *      Left coordinate of the region within the board.
+ *
+ * @param y0
+ *      Top coordinate of the region within the board.
+ *
+ * @param width
+ *      The width of the whole board.
+ *
+ * @param height
+ *      The height of the whole board.
+ *
+ * @param tile_size
+ *      The side length of the tiles, a positive multiple of 64.
+ *
+ * @return
+ *      The index entries of the non-empty tiles of the region, row by row, and their blocks.
+ *
+ * @throws
+ *      Throws std::invalid_argument if the tile size is not a positive multiple of 64, or the region falls outside
+ *      the board or is not made of whole tiles.
+ */
+Zoo::BinaryPart Zoo::encode_binary_part(const Grid &region, int x0, int y0, int width, int height, int tile_size)
+{
+    const int x1 = x0 + region.get_width();
+    const int y1 = y0 + region.get_height();
+
+    if (tile_size <= 0 || tile_size % 64 != 0)
+    {
+        throw std::invalid_argument("ERROR: The tile size must be a positive multiple of 64.");
+    }
+
+    if (x0 < 0 || y0 < 0 || x1 > width || y1 > height || x0 % tile_size != 0 || y0 % tile_size != 0 ||
+        (x1 % tile_size != 0 && x1 != width) || (y1 % tile_size != 0 && y1 != height))
+    {
+        throw std::invalid_argument("ERROR: The region is not made of whole tiles of the board.");
+    }
+
+    BinaryPart part;
+    std::pmr::vector<unsigned char> raw(Memory::get_scratch_resource()), encoded(Memory::get_scratch_resource());
+
+    for (int tile_y0 = y0; tile_y0 < y1; tile_y0 += tile_size)
+    {
+        for (int tile_x0 = x0; tile_x0 < x1; tile_x0 += tile_size)
+        {
+            // Region coordinates of the tile, clipped to the edge of the board
+            const int left = tile_x0 - x0, right = std::min(x1, tile_x0 + tile_size) - x0;
+            const int top = tile_y0 - y0, bottom = std::min(y1, tile_y0 + tile_size) - y0;
+            const size_t row_bytes = (right - left + 7) / 8;
+
+            bool empty = true;
+
+            for (int y = top; y < bottom && empty; y++)
+            {
+                empty = std::memchr(region.row(y) + left, Cell::ALIVE, right - left) == nullptr;
+            }
+
+            if (empty)
+            {
+                continue;
+            }
+
+            raw.assign(row_bytes * (bottom - top), 0);
+
+            for (int y = top; y < bottom; y++)
+            {
+                const Cell *cells = region.row(y);
+                unsigned char *bits = raw.data() + (y - top) * row_bytes;
+
+                for (int x = left; x < right; x++)
+                {
+                    bits[(x - left) / 8] |= (cells[x] == Cell::ALIVE) << ((x - left) % 8);
+                }
+            }
+
+            rle_encode(raw, encoded);
+
+            const std::pmr::vector<unsigned char> &block = encoded.size() < raw.size() ? encoded : raw;
+
+            part.tiles.push_back({tile_x0 / tile_size, tile_y0 / tile_size, part.blocks.size(),
+                                  static_cast<uint32_t>(block.size()),
+                                  &block == &encoded ? ENCODING_RLE : ENCODING_RAW});
+            part.blocks.append(block.begin(), block.end());
+        }
+    }
+
+    return part;
+}
+
+/**
+ * Zoo::write_binary_header(out, width, height, tile_size, tile_count)
+ *
+ * Write the header of a v2 binary file, BINARY_HEADER_SIZE bytes long, to a stream.
+ *
+ * @param out
+ *      The stream to write to.
+ *
+ * @param width
+ *      The width of the board.
+ *
+ * @param height
+ *      The height of the board.
+ *
+ * @param tile_size
+ *      The side length of the tiles.
+ *
+ * @param tile_count
+ *      The number of entries in the tile index, summed over every part of the board.
+ *
+ * @throws
+ *      Throws std::range_error if there are too many tiles for the index to count.
+ */
+void Zoo::write_binary_header(std::ostream &out, int width, int height, int tile_size, uint64_t tile_count)
+{
+    if (tile_count > UINT32_MAX)
+    {
+        throw std::range_error("ERROR: Too many tiles to save in a binary file.");
+    }
+
+    out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    write_u32(out, BINARY_VERSION);
+    write_u32(out, width);
+    write_u32(out, height);
+    write_u32(out, tile_size);
+    write_u32(out, static_cast<uint32_t>(tile_count));
+}
+
+/**
+ * Zoo::write_binary_index(out, part, blocks_offset)
+ *
+ * Write the index entries of the tiles of a part to a stream, BINARY_ENTRY_SIZE bytes each, with the offset of
+ * every block moved from the start of the blocks of the part to the start of the file.
+ *
+ * @param out
+ *      The stream to write to.
+ *
+ * @param part
+ *      The encoded part.
+ *
+ * @param blocks_offset
+ *      The offset in the file the blocks of the part are written at.
+ */
+void Zoo::write_binary_index(std::ostream &out, const BinaryPart &part, uint64_t blocks_offset)
+{
+    for (const BinaryTile &tile : part.tiles)
+    {
+        write_u32(out, tile.tile_x);
+        write_u32(out, tile.tile_y);
+        write_u64(out, blocks_offset + tile.offset);
+        write_u32(out, tile.size);
+        write_u32(out, tile.encoding);
+    }
 }
\ No newline at end of file
@@ -10,22 +10,88 @@
  */
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
 #include <string>
+#include <vector>
 
 #include "grid.h"
+#include "hashlife.h"
+#include "packed_grid.h"
+#include "rule.h"
 
 /**
  * Declare the interface of the Zoo namespace for constructing lifeforms and saving and loading them from file.
  */
 namespace Zoo
 {
+    /**
+     * The versions of the binary file format.
+     *      - BinaryFormat::V1 is a raw bitmap of every cell, with native endian headers.
+     *      - BinaryFormat::V2 is an index of run length encoded tiles, skipping those with no alive cells.
+     */
+    enum class BinaryFormat
+    {
+        V1,
+        V2
+    };
+
+    // Sizes of the header of a v2 binary file and of each entry of its tile index, in bytes
+    const size_t BINARY_HEADER_SIZE = 24;
+    const size_t BINARY_ENTRY_SIZE = 24;
+
+    /**
+     * An entry of the tile index of a v2 binary file, locating the block of a tile holding alive cells.
+     */
+    struct BinaryTile
+    {
+        int tile_x;
+        int tile_y;
+        uint64_t offset; // From the start of the file, or of the blocks of a BinaryPart
+        uint32_t size;
+        uint32_t encoding; // 0 raw, 1 run length encoded
+    };
+
+    /**
+     * The tiles of a region of a board holding alive cells, encoded as v2 binary blocks by Zoo::encode_binary_part.
+     * A board split between processes is saved by each process encoding its own region, then writing its index
+     * entries with Zoo::write_binary_index and its blocks into their places in one shared file.
+     */
+    struct BinaryPart
+    {
+        std::vector<BinaryTile> tiles;
+        std::string blocks;
+    };
+
     Grid glider();
     Grid r_pentomino();
     Grid light_weight_spaceship();
 
-    Grid load_ascii(const std::string path);
-    void save_ascii(const std::string path, const Grid grid);
+    Grid load_ascii(const std::string &path);
+    Grid load_ascii(std::istream &in);
+    void save_ascii(const std::string &path, const Grid &grid);
+    void save_ascii(std::ostream &out, const Grid &grid);
+
+    Grid load_rle(const std::string &path);
+    Grid load_rle(const std::string &path, Rule &rule);
+    Grid load_rle(std::istream &in);
+    void save_rle(const std::string &path, const Grid &grid, const Rule &rule = Rule());
+    void save_rle(std::ostream &out, const Grid &grid, const Rule &rule = Rule());
+
+    HashlifeWorld load_macrocell(const std::string &path);
+    HashlifeWorld load_macrocell(std::istream &in);
+    void save_macrocell(const std::string &path, const HashlifeWorld &world);
+    void save_macrocell(std::ostream &out, const HashlifeWorld &world);
+
+    Grid load_binary(const std::string &path);
+    PackedGrid load_binary_packed(const std::string &path);
+    Grid load_binary_region(const std::string &path, int x0, int y0, int x1, int y1);
+    void save_binary(const std::string &path, const Grid &grid, BinaryFormat format = BinaryFormat::V1);
 
-    Grid load_binary(const std::string path);
-    void save_binary(const std::string path, const Grid grid);
+    void read_binary_size(const std::string &path, int &width, int &height);
+    BinaryPart encode_binary_part(const Grid &region, int x0, int y0, int width, int height, int tile_size);
+    void write_binary_header(std::ostream &out, int width, int height, int tile_size, uint64_t tile_count);
+    void write_binary_index(std::ostream &out, const BinaryPart &part, uint64_t blocks_offset);
 }; // !namespace Zoo
\ No newline at end of file